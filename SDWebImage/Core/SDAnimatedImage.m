@@ -166,7 +166,8 @@ static CGFloat SDImageScaleFromPath(NSString *string) {
     }
     if (animatedCoder) {
         // Animated Image
-        return [self initWithAnimatedCoder:animatedCoder scale:scale];
+        self = [self initWithAnimatedCoder:animatedCoder scale:scale];
+        return self;
     } else {
         // Static Image (Before 5.19 this code path return nil)
         UIImage *image = [[SDImageCodersManager sharedManager] decodedImageWithData:data options:options];
@@ -307,6 +308,21 @@ static CGFloat SDImageScaleFromPath(NSString *string) {
     return [self.animatedCoder animatedImageFrameAtIndex:index];
 }
 
+- (UIImage *)animatedImageFrameAtIndex:(NSUInteger)index targetPixelSize:(CGSize)targetPixelSize {
+    if (index >= self.animatedImageFrameCount) {
+        return nil;
+    }
+    if (self.isAllFramesLoaded) {
+        SDImageFrame *frame = [self.loadedAnimatedImageFrames objectAtIndex:index];
+        return frame.image;
+    }
+    id<SDAnimatedImageCoder> animatedCoder = self.animatedCoder;
+    if ([animatedCoder respondsToSelector:@selector(animatedImageFrameAtIndex:targetPixelSize:)]) {
+        return [animatedCoder animatedImageFrameAtIndex:index targetPixelSize:targetPixelSize];
+    }
+    return [animatedCoder animatedImageFrameAtIndex:index];
+}
+
 - (NSTimeInterval)animatedImageDurationAtIndex:(NSUInteger)index {
     if (index >= self.animatedImageFrameCount) {
         return 0;
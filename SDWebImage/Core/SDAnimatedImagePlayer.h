@@ -66,7 +66,27 @@ typedef NS_ENUM(NSUInteger, SDAnimatedImagePlaybackMode) {
 /// `NSUIntegerMax` means cache all the buffer. (Lowest CPU and Highest Memory)
 @property (nonatomic, assign) NSUInteger maxBufferSize;
 
-/// You can specify a runloop mode to let it rendering.
+/// Whether to skip frames when the decoding falls behind the display, instead of stalling on the missing frame. Default is NO.
+/// When YES, the player jumps to the latest decoded frame whose display time is reached, so the animation keeps the real-time pace with dropped frames. The frames are never skipped across the loop.
+@property (nonatomic, assign) BOOL allowsFrameSkipping;
+
+/// The pixel size of the rendering target. Default is CGSizeZero, means decode the full frame size.
+/// When set, the frames are decoded to fit this size if the provider implements `animatedImageFrameAtIndex:targetPixelSize:`, which save the memory and decode time for small rendering target. When the size changes significantly, the frame buffer is rebuilt at the new size.
+/// @note The players share the frame buffer with the same provider, the frames are decoded at the largest target pixel size of them.
+@property (nonatomic, assign) CGSize targetPixelSize;
+
+/// Provide a max buffer size by bytes shared by all the players in process. The players whose `maxBufferSize` is 0 share this budget and one decode queue. Default is 0.
+/// `0` means automatically adjust by calculating current memory usage.
+/// @note The visible playing players share the budget in proportion to their frame size, the invisible or paused players keep only one frame. The larger players get the higher decode priority.
+@property (class, nonatomic, assign) NSUInteger sharedMaxBufferSize;
+
+/// Whether the player is visible on screen. Default is YES.
+/// When NO, the player keep the current (poster) frame without decoding the next frames, and release its share of `sharedMaxBufferSize` to other players.
+/// All the visible playing players in the same `runLoopMode` are driven by one shared display link, the invisible player is removed from it and does not receive any refresh.
+/// @note `SDAnimatedImageView` update this value automatically. If you use the player directly, set this when the rendering target is scrolled out or covered.
+@property (nonatomic, assign, getter=isVisible) BOOL visible;
+
+/// You can specify a runloop mode to let it rendering. The players with the same runloop mode share one display link.
 /// Default is NSRunLoopCommonModes on multi-core device, NSDefaultRunLoopMode on single-core device
 @property (nonatomic, copy, nonnull) NSRunLoopMode runLoopMode;
 
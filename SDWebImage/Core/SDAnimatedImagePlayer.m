@@ -8,12 +8,12 @@
 
 #import "SDAnimatedImagePlayer.h"
 #import "NSImage+Compatibility.h"
-#import "SDDisplayLink.h"
-#import "SDDeviceHelper.h"
+#import "SDDisplayLinkHub.h"
 #import "SDImageFramePool.h"
+#import "SDAnimatedImageScheduler.h"
 #import "SDInternalMacros.h"
 
-@interface SDAnimatedImagePlayer () {
+@interface SDAnimatedImagePlayer () <SDDisplayLinkHubTarget> {
     NSRunLoopMode _runLoopMode;
 }
 
@@ -24,11 +24,14 @@
 @property (nonatomic, assign, readwrite) NSUInteger currentLoopCount;
 @property (nonatomic, strong) id<SDAnimatedImageProvider> animatedProvider;
 @property (nonatomic, assign) NSUInteger currentFrameBytes;
+// The buffer count and fetch priority of this player, the frame pool may be shared with other players
+@property (nonatomic, assign) NSUInteger maxBufferCount;
+@property (nonatomic, assign) NSOperationQueuePriority queuePriority;
 @property (nonatomic, assign) NSTimeInterval currentTime;
 @property (nonatomic, assign) BOOL bufferMiss;
 @property (nonatomic, assign) BOOL needsDisplayWhenImageBecomesAvailable;
 @property (nonatomic, assign) BOOL shouldReverse;
-@property (nonatomic, strong) SDDisplayLink *displayLink;
+@property (nonatomic, assign, readwrite) BOOL isPlaying;
 
 @end
 
@@ -47,6 +50,8 @@
         self.totalLoopCount = provider.animatedImageLoopCount;
         self.animatedProvider = provider;
         self.playbackRate = 1.0;
+        self.queuePriority = NSOperationQueuePriorityNormal;
+        _visible = YES;
         self.framePool = [SDImageFramePool registerProvider:provider];
     }
     return self;
@@ -59,33 +64,32 @@
 
 - (void)dealloc {
     // Dereference the frame pool, when zero the frame pool for provider will dealloc
+    [self.framePool removePlayer:self];
     [SDImageFramePool unregisterProvider:self.animatedProvider];
+    [SDAnimatedImageScheduler.sharedScheduler removePlayer:self];
+    // The display link hub does not retain the player, no need to unregister
 }
 
-#pragma mark - Private
++ (NSUInteger)sharedMaxBufferSize {
+    return SDAnimatedImageScheduler.sharedScheduler.maxBufferSize;
+}
 
-- (SDDisplayLink *)displayLink {
-    if (!_displayLink) {
-        _displayLink = [SDDisplayLink displayLinkWithTarget:self selector:@selector(displayDidRefresh:)];
-        [_displayLink addToRunLoop:[NSRunLoop mainRunLoop] forMode:self.runLoopMode];
-        [_displayLink stop];
-    }
-    return _displayLink;
++ (void)setSharedMaxBufferSize:(NSUInteger)sharedMaxBufferSize {
+    SDAnimatedImageScheduler.sharedScheduler.maxBufferSize = sharedMaxBufferSize;
 }
 
+#pragma mark - Private
+
 - (void)setRunLoopMode:(NSRunLoopMode)runLoopMode {
     if ([_runLoopMode isEqual:runLoopMode]) {
         return;
     }
-    if (_displayLink) {
-        if (_runLoopMode) {
-            [_displayLink removeFromRunLoop:[NSRunLoop mainRunLoop] forMode:_runLoopMode];
-        }
-        if (runLoopMode.length > 0) {
-            [_displayLink addToRunLoop:[NSRunLoop mainRunLoop] forMode:runLoopMode];
-        }
+    // Move to the hub of new mode
+    if (_runLoopMode) {
+        [[SDDisplayLinkHub hubForRunLoopMode:_runLoopMode] removeTarget:self];
     }
     _runLoopMode = [runLoopMode copy];
+    [self updateDisplayLinkState];
 }
 
 - (NSRunLoopMode)runLoopMode {
@@ -95,6 +99,47 @@
     return _runLoopMode;
 }
 
+- (void)setTargetPixelSize:(CGSize)targetPixelSize {
+    if (CGSizeEqualToSize(_targetPixelSize, targetPixelSize)) {
+        return;
+    }
+    _targetPixelSize = targetPixelSize;
+    CGSize previousPixelSize = self.framePool.targetPixelSize;
+    [self.framePool setTargetPixelSize:targetPixelSize forPlayer:self];
+    if (!CGSizeEqualToSize(previousPixelSize, self.framePool.targetPixelSize)) {
+        // The frame buffer is rebuilt, re-calculate the frame bytes and buffer count from the new frame
+        self.currentFrameBytes = 0;
+    }
+}
+
+- (void)setVisible:(BOOL)visible {
+    if (_visible == visible) {
+        return;
+    }
+    _visible = visible;
+    [self updateDisplayLinkState];
+    [self updateSchedulerState];
+}
+
+// Only the visible playing player is driven by the shared display link
+- (void)updateDisplayLinkState {
+    if (self.runLoopMode.length == 0) {
+        return;
+    }
+    SDDisplayLinkHub *hub = [SDDisplayLinkHub hubForRunLoopMode:self.runLoopMode];
+    if (self.isPlaying && self.isVisible) {
+        [hub addTarget:self];
+    } else {
+        [hub removeTarget:self];
+    }
+}
+
+// Report to the shared scheduler, so the budget can be redistributed between players
+- (void)updateSchedulerState {
+    BOOL active = self.isPlaying && self.isVisible;
+    [SDAnimatedImageScheduler.sharedScheduler updatePlayer:self frameBytes:self.currentFrameBytes active:active];
+}
+
 #pragma mark - State Control
 
 - (void)setupCurrentFrame {
@@ -141,24 +186,25 @@
 
 #pragma mark - Animation Control
 - (void)startPlaying {
-    [self.displayLink start];
+    self.isPlaying = YES;
+    [self updateDisplayLinkState];
+    [self updateSchedulerState];
     // Setup frame
     [self setupCurrentFrame];
 }
 
 - (void)stopPlaying {
-    // Using `_displayLink` here because when UIImageView dealloc, it may trigger `[self stopAnimating]`, we already release the display link in SDAnimatedImageView's dealloc method.
-    [_displayLink stop];
+    self.isPlaying = NO;
+    [self updateDisplayLinkState];
+    [self updateSchedulerState];
     // We need to reset the frame status, but not trigger any handle. This can ensure next time's playing status correct.
     [self resetCurrentFrameStatus];
 }
 
 - (void)pausePlaying {
-    [_displayLink stop];
-}
-
-- (BOOL)isPlaying {
-    return _displayLink.isRunning;
+    self.isPlaying = NO;
+    [self updateDisplayLinkState];
+    [self updateSchedulerState];
 }
 
 - (void)seekToFrameAtIndex:(NSUInteger)index loopCount:(NSUInteger)loopCount {
@@ -167,12 +213,17 @@
     }
     self.currentFrameIndex = index;
     self.currentLoopCount = loopCount;
-    self.currentFrame = [self.animatedProvider animatedImageFrameAtIndex:index];
+    // Use the buffered frame if available, or decode from provider
+    UIImage *frame = [self.framePool frameAtIndex:index];
+    if (!frame) {
+        frame = [self.animatedProvider animatedImageFrameAtIndex:index];
+    }
+    self.currentFrame = frame;
     [self handleFrameChange];
 }
 
 #pragma mark - Core Render
-- (void)displayDidRefresh:(SDDisplayLink *)displayLink {
+- (void)displayLinkHubDidRefreshWithDuration:(NSTimeInterval)duration {
     // If for some reason a wild call makes it through when we shouldn't be animating, bail.
     // Early return!
     if (!self.isPlaying) {
@@ -193,9 +244,6 @@
         return;
     }
     
-    // Calculate refresh duration
-    NSTimeInterval duration = self.displayLink.duration;
-    
     NSUInteger currentFrameIndex = self.currentFrameIndex;
     NSUInteger nextFrameIndex = (currentFrameIndex + 1) % totalFrameCount;
     
@@ -229,6 +277,12 @@
         }
         else {
             self.bufferMiss = YES;
+            if (self.allowsFrameSkipping && [self skipFramesWithDuration:duration]) {
+                // Skipped to the buffered frame, keep the lookahead window filled from it
+                [self prefetchFrameAtIndex:self.currentFrameIndex
+                                 nextIndex:self.currentFrameIndex];
+                return;
+            }
         }
     }
     
@@ -285,22 +339,108 @@
 // Or, most cases, the decode speed is faster than render speed, we fetch next frame
 - (void)prefetchFrameAtIndex:(NSUInteger)currentIndex
                    nextIndex:(NSUInteger)nextIndex {
-    NSUInteger fetchFrameIndex = currentIndex;
-    UIImage *fetchFrame = nil;
-    if (!self.bufferMiss) {
-        fetchFrameIndex = nextIndex;
-        fetchFrame = [self.framePool frameAtIndex:nextIndex];
+    NSUInteger fetchFrameIndex = self.bufferMiss ? currentIndex : nextIndex;
+    // Query the frame and the buffer state in one lock, since this is called on each display refresh
+    NSUInteger currentFrameCount = 0;
+    NSTimeInterval decodeDuration = 0;
+    UIImage *fetchFrame = [self.framePool frameAtIndex:fetchFrameIndex currentFrameCount:&currentFrameCount averageDecodeDuration:&decodeDuration];
+    if (self.bufferMiss) {
+        fetchFrame = nil;
     }
     BOOL bufferFull = NO;
-    if (self.framePool.currentFrameCount == self.totalFrameCount) {
+    if (currentFrameCount == self.totalFrameCount) {
         bufferFull = YES;
     }
-    if (!fetchFrame && !bufferFull) {
+    // Keep the lookahead window filled even if the next frame is ready, when the decode is slower than display
+    NSUInteger lookaheadCount = [self lookaheadCountWithFrameIndex:fetchFrameIndex decodeDuration:decodeDuration];
+    if ((!fetchFrame || lookaheadCount > 1) && !bufferFull) {
         // Calculate max buffer size
         [self calculateMaxBufferCountWithFrame:self.currentFrame];
-        // Prefetch next frame
-        [self.framePool prefetchFrameAtIndex:fetchFrameIndex];
+        // Update the playback order, the frame pool keep the frames which will be displayed soonest
+        SDAnimatedImagePlaybackMode playbackMode = self.playbackMode;
+        BOOL bounce = playbackMode == SDAnimatedImagePlaybackModeBounce || playbackMode == SDAnimatedImagePlaybackModeReversedBounce;
+        SDImageFramePlayback playback = {
+            .frameIndex = fetchFrameIndex,
+            // The lookahead frames can not exceed the buffer, or they are evicted before display
+            .lookaheadCount = MIN(lookaheadCount, MAX(self.maxBufferCount, 1)),
+            .maxBufferCount = self.maxBufferCount,
+            .queuePriority = self.queuePriority,
+            .reversed = bounce ? self.shouldReverse : playbackMode == SDAnimatedImagePlaybackModeReverse,
+            .bounce = bounce,
+        };
+        self.framePool.totalFrameCount = self.totalFrameCount;
+        // Prefetch next frames
+        [self.framePool prefetchFramesWithPlayback:playback forPlayer:self];
+    }
+}
+
+// The frame count to decode concurrently ahead, adapt to the measured decode duration against the frame duration
+- (NSUInteger)lookaheadCountWithFrameIndex:(NSUInteger)index decodeDuration:(NSTimeInterval)decodeDuration {
+    NSTimeInterval frameDuration = [self.animatedProvider animatedImageDurationAtIndex:index] / self.playbackRate;
+    if (decodeDuration <= 0 || frameDuration <= 0) {
+        return 1;
+    }
+    // One more frame to absorb the decode time jitter
+    NSUInteger lookaheadCount = ceil(decodeDuration / frameDuration) + 1;
+    NSUInteger maxLookaheadCount = MIN([NSProcessInfo processInfo].activeProcessorCount, self.totalFrameCount);
+    return MAX(MIN(lookaheadCount, maxLookaheadCount), 1);
+}
+
+// When falls behind, skip to the latest buffered frame whose display time is reached, instead of stalling on the missing frame
+- (BOOL)skipFramesWithDuration:(NSTimeInterval)duration {
+    self.currentTime += duration;
+    NSUInteger totalFrameCount = self.totalFrameCount;
+    BOOL bounce = self.playbackMode == SDAnimatedImagePlaybackModeBounce || self.playbackMode == SDAnimatedImagePlaybackModeReversedBounce;
+    BOOL shouldReverse = self.shouldReverse;
+    NSUInteger frameIndex = self.currentFrameIndex;
+    NSTimeInterval currentTime = self.currentTime;
+    NSUInteger skipFrameIndex = NSNotFound;
+    NSTimeInterval skipTime = 0;
+    BOOL skipShouldReverse = shouldReverse;
+    UIImage *skipFrame;
+    for (NSUInteger i = 0; i < totalFrameCount; i++) {
+        NSTimeInterval frameDuration = [self.animatedProvider animatedImageDurationAtIndex:frameIndex] / self.playbackRate;
+        if (currentTime < frameDuration) {
+            break;
+        }
+        NSUInteger nextFrameIndex;
+        if (bounce) {
+            if (frameIndex == 0) {
+                shouldReverse = NO;
+            } else if (frameIndex == totalFrameCount - 1) {
+                shouldReverse = YES;
+            }
+            nextFrameIndex = shouldReverse ? frameIndex - 1 : frameIndex + 1;
+        } else if (self.playbackMode == SDAnimatedImagePlaybackModeReverse) {
+            nextFrameIndex = frameIndex == 0 ? totalFrameCount - 1 : frameIndex - 1;
+        } else {
+            nextFrameIndex = (frameIndex + 1) % totalFrameCount;
+        }
+        // Do not skip across the loop, the loop count is handled by normal playback
+        if (nextFrameIndex == 0) {
+            break;
+        }
+        currentTime -= frameDuration;
+        frameIndex = nextFrameIndex;
+        UIImage *frame = [self.framePool frameAtIndex:frameIndex];
+        if (frame) {
+            skipFrameIndex = frameIndex;
+            skipTime = currentTime;
+            skipShouldReverse = shouldReverse;
+            skipFrame = frame;
+        }
+    }
+    if (skipFrameIndex == NSNotFound) {
+        return NO;
     }
+    self.currentFrameIndex = skipFrameIndex;
+    self.currentTime = skipTime;
+    self.shouldReverse = skipShouldReverse;
+    self.currentFrame = skipFrame;
+    [self handleFrameChange];
+    self.bufferMiss = NO;
+    self.needsDisplayWhenImageBecomesAvailable = NO;
+    return YES;
 }
 
 - (void)handleFrameChange {
@@ -320,31 +460,35 @@
     NSUInteger bytes = self.currentFrameBytes;
     if (bytes == 0) {
         bytes = CGImageGetBytesPerRow(frame.CGImage) * CGImageGetHeight(frame.CGImage);
+        CGSize targetPixelSize = self.framePool.targetPixelSize;
+        if (targetPixelSize.width > 0 && targetPixelSize.height > 0) {
+            // The frames are decoded to fit the target pixel size, which may be smaller than the current frame
+            bytes = MIN(bytes, (NSUInteger)(targetPixelSize.width * targetPixelSize.height * 4));
+        }
         if (bytes == 0) {
             bytes = 1024;
         } else {
             // Cache since most animated image each frame bytes is the same
             self.currentFrameBytes = bytes;
+            [self updateSchedulerState];
         }
     }
     
-    NSUInteger max = 0;
+    SDAnimatedImageScheduler *scheduler = SDAnimatedImageScheduler.sharedScheduler;
+    NSUInteger maxBufferCount = 0;
     if (self.maxBufferSize > 0) {
-        max = self.maxBufferSize;
+        maxBufferCount = (double)self.maxBufferSize / (double)bytes;
     } else {
-        // Calculate based on current memory, these factors are by experience
-        NSUInteger total = [SDDeviceHelper totalMemory];
-        NSUInteger free = [SDDeviceHelper freeMemory];
-        max = MIN(total * 0.2, free * 0.6);
+        // Share the process-wide budget with other players
+        maxBufferCount = [scheduler maxBufferCountForPlayer:self];
     }
-    
-    NSUInteger maxBufferCount = (double)max / (double)bytes;
     if (!maxBufferCount) {
         // At least 1 frame
         maxBufferCount = 1;
     }
     
-    self.framePool.maxBufferCount = maxBufferCount;
+    self.maxBufferCount = maxBufferCount;
+    self.queuePriority = [scheduler queuePriorityForPlayer:self];
 }
 
 + (NSString *)defaultRunLoopMode {
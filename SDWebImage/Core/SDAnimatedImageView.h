@@ -78,6 +78,14 @@ NS_SWIFT_UI_ACTOR
 /// Asynchronous setup animation playback mode. Default mode is SDAnimatedImagePlaybackModeNormal.
 @property (nonatomic, assign) SDAnimatedImagePlaybackMode playbackMode;
 
+/// Whether to skip frames when the decoding falls behind the display, instead of stalling on the missing frame. Default is NO.
+/// See `SDAnimatedImagePlayer.allowsFrameSkipping`
+@property (nonatomic, assign) BOOL allowsFrameSkipping;
+
+/// Whether to decode the animation frames at the view's display pixel size, instead of the full frame size. Default is NO.
+/// When YES, the view updates `SDAnimatedImagePlayer.targetPixelSize` from its bounds, screen scale and content mode during layout, so the small view like sticker decode and buffer much smaller frames. The content mode which does not scale the image always use the full frame size.
+@property (nonatomic, assign) BOOL shouldDecodeAtViewSize;
+
 /**
  Provide a max buffer size by bytes. This is used to adjust frame buffer count and can be useful when the decoding cost is expensive (such as Animated WebP software decoding). Default is 0.
  `0` means automatically adjust by calculating current memory usage.
@@ -93,6 +101,14 @@ NS_SWIFT_UI_ACTOR
  */
 @property (nonatomic, assign) BOOL shouldIncrementalLoad;
 
+/**
+ Whether or not to loop the frames received so far during incremental image load (streaming playback). This only take effect when `shouldIncrementalLoad` is YES.
+ If enable, the animation loops the available frames instead of stopping at the last frame, and the new frames join the loop when another `setImage:` trigger. The loop count is not counted until the image is complete.
+ When the complete image shares the same animated coder as the incremental image (like the final image of `SDWebImageProgressiveLoad`), the animation continues from the current frame without decoding the buffered frames again.
+ Default is NO.
+ */
+@property (nonatomic, assign) BOOL shouldLoopIncrementalFrames;
+
 /**
  Whether or not to clear the frame buffer cache when animation stopped. See `maxBufferSize`
  This is useful when you want to limit the memory usage during frequently visibility changes (such as image view inside a list view, then push and pop)
@@ -77,6 +77,16 @@
     return [self.transformer transformedImageWithImage:frame forKey:@""];
 }
 
+- (UIImage *)animatedImageFrameAtIndex:(NSUInteger)index targetPixelSize:(CGSize)targetPixelSize {
+    UIImage *frame;
+    if ([self.provider respondsToSelector:@selector(animatedImageFrameAtIndex:targetPixelSize:)]) {
+        frame = [self.provider animatedImageFrameAtIndex:index targetPixelSize:targetPixelSize];
+    } else {
+        frame = [self.provider animatedImageFrameAtIndex:index];
+    }
+    return [self.transformer transformedImageWithImage:frame forKey:@""];
+}
+
 @end
 
 @interface UIImageView () <CALayerDelegate>
@@ -181,15 +191,19 @@
     }
     
     // Check Progressive rendering
+    BOOL isStreamingFinished = [self isStreamingFinishedWithImage:image];
     [self updateIsProgressiveWithImage:image];
     
-    if (!self.isProgressive) {
+    if (!self.isProgressive && !isStreamingFinished) {
         // Stop animating
         self.player = nil;
         self.currentFrame = nil;
         self.currentFrameIndex = 0;
         self.currentLoopCount = 0;
     }
+    // The next partial image or the complete image of current streaming playback, which keeps the player. Both share the animated coder of current partial image (`isProgressive` checks the next partial image)
+    BOOL isSameStreamingSource = [self progressiveAnimatedCoderForImage:self.image] != nil && (self.isProgressive || isStreamingFinished);
+    BOOL isStreamingContinuation = self.player != nil && self.shouldLoopIncrementalFrames && isSameStreamingSource;
     
     // We need call super method to keep function. This will impliedly call `setNeedsDisplay`. But we have no way to avoid this when using animated image. So we call `setNeedsDisplay` again at the end.
     super.image = image;
@@ -222,8 +236,17 @@
         }
         
         // Custom Loop Count
-        if (self.shouldCustomLoopCount) {
+        if (self.isProgressive && self.shouldLoopIncrementalFrames) {
+            // Loop the frames received so far, do not stop before the image is complete
+            self.player.totalLoopCount = 0;
+        } else if (self.shouldCustomLoopCount) {
             self.player.totalLoopCount = self.animationRepeatCount;
+        } else if (isStreamingFinished) {
+            self.player.totalLoopCount = [(id<SDAnimatedImage>)image animatedImageLoopCount];
+        }
+        if (isStreamingFinished) {
+            // Continue from the current frame, start counting the loop from the complete image
+            [self.player seekToFrameAtIndex:self.player.currentFrameIndex loopCount:0];
         }
         
         // RunLoop Mode
@@ -237,6 +260,12 @@
         
         // Play Mode
         self.player.playbackMode = self.playbackMode;
+        
+        // Frame Skipping
+        self.player.allowsFrameSkipping = self.allowsFrameSkipping;
+        
+        // Decode Size
+        [self updatePlayerTargetPixelSize];
 
         // Setup handler
         @weakify(self);
@@ -250,6 +279,10 @@
             @strongify(self);
             // Progressive image reach the current last frame index. Keep the state and pause animating. Wait for later restart
             if (self.isProgressive) {
+                if (self.shouldLoopIncrementalFrames) {
+                    // Streaming playback, keep looping the frames received so far
+                    return;
+                }
                 NSUInteger lastFrameIndex = self.player.totalFrameCount - 1;
                 [self.player seekToFrameAtIndex:lastFrameIndex loopCount:0];
                 [self.player pausePlaying];
@@ -261,7 +294,10 @@
         // Ensure disabled highlighting; it's not supported (see `-setHighlighted:`).
         super.highlighted = NO;
         
-        [self stopAnimating];
+        if (!isStreamingContinuation) {
+            [self stopAnimating];
+        }
+        // Do not stop the streaming playback, which resets the frame index (`resetFrameIndexWhenStopped`) or clears the buffered frames (`clearBufferWhenStopped`)
         [self checkPlay];
     }
     [self.imageViewLayer setNeedsDisplay];
@@ -324,6 +360,16 @@
     return _playbackMode;
 }
 
+- (void)setAllowsFrameSkipping:(BOOL)allowsFrameSkipping {
+    _allowsFrameSkipping = allowsFrameSkipping;
+    self.player.allowsFrameSkipping = allowsFrameSkipping;
+}
+
+- (void)setShouldDecodeAtViewSize:(BOOL)shouldDecodeAtViewSize {
+    _shouldDecodeAtViewSize = shouldDecodeAtViewSize;
+    [self updatePlayerTargetPixelSize];
+}
+
 
 - (BOOL)shouldIncrementalLoad
 {
@@ -388,6 +434,21 @@
     [self checkPlay];
 }
 
+#if SD_MAC
+- (void)layout
+#else
+- (void)layoutSubviews
+#endif
+{
+#if SD_MAC
+    [super layout];
+#else
+    [super layoutSubviews];
+#endif
+    
+    [self updatePlayerTargetPixelSize];
+}
+
 #pragma mark - UIImageView Method Overrides
 #pragma mark Image Data
 
@@ -509,6 +570,79 @@
     BOOL isVisible = self.window && self.superview && ![self isHidden] && self.alpha > 0.0;
 #endif
     self.shouldAnimate = self.player && isVisible;
+    self.player.visible = isVisible;
+}
+
+#pragma mark Decode Size
+
+// Don't decode the frames larger than the view display, update whenever the layout or animated image is changed
+- (void)updatePlayerTargetPixelSize
+{
+    if (!self.player) {
+        return;
+    }
+    CGSize targetPixelSize = CGSizeZero;
+    if (self.shouldDecodeAtViewSize) {
+        targetPixelSize = [self displayPixelSizeWithImage:self.image];
+    }
+    self.player.targetPixelSize = targetPixelSize;
+}
+
+// The pixel size which covers the view bounds with the image aspect ratio. Return zero size if the content mode does not scale the image, or the view is not laid out yet, or the image is smaller than the view
+- (CGSize)displayPixelSizeWithImage:(UIImage *)image
+{
+    CGSize size = self.bounds.size;
+    CGSize imagePixelSize = CGSizeMake(image.size.width * image.scale, image.size.height * image.scale);
+    if (size.width <= 0 || size.height <= 0 || imagePixelSize.width <= 0 || imagePixelSize.height <= 0) {
+        return CGSizeZero;
+    }
+    CGFloat scale = 0;
+    BOOL scalesImage = NO;
+#if SD_UIKIT
+    scale = self.traitCollection.displayScale;
+    if (scale <= 0) {
+#if SD_VISION
+        scale = UITraitCollection.currentTraitCollection.displayScale;
+#else
+        scale = UIScreen.mainScreen.scale;
+#endif
+    }
+    switch (self.contentMode) {
+        case UIViewContentModeScaleToFill:
+        case UIViewContentModeScaleAspectFit:
+        case UIViewContentModeScaleAspectFill:
+            scalesImage = YES;
+            break;
+        default:
+            break;
+    }
+#else
+    scale = self.window.backingScaleFactor;
+    if (scale <= 0) {
+        scale = NSScreen.mainScreen.backingScaleFactor;
+    }
+    switch (self.imageScaling) {
+        case NSImageScaleProportionallyDown:
+        case NSImageScaleProportionallyUpOrDown:
+        case NSImageScaleAxesIndependently:
+            scalesImage = YES;
+            break;
+        default:
+            break;
+    }
+#endif
+    if (!scalesImage) {
+        return CGSizeZero;
+    }
+    if (scale <= 0) {
+        scale = 1;
+    }
+    // Use the larger ratio to cover the view for aspect fill and scale to fill, keep the image aspect ratio
+    CGFloat ratio = MAX(size.width * scale / imagePixelSize.width, size.height * scale / imagePixelSize.height);
+    if (ratio >= 1) {
+        return CGSizeZero;
+    }
+    return CGSizeMake(ceil(imagePixelSize.width * ratio), ceil(imagePixelSize.height * ratio));
 }
 
 // Update progressive status only after `setImage:` call.
@@ -537,6 +671,22 @@
     }
 }
 
+// Check if image is the complete image of current streaming playback, which shares the same animated coder, so the player and its buffered frames can be reused
+- (BOOL)isStreamingFinishedWithImage:(UIImage *)image
+{
+    if (!self.shouldIncrementalLoad || !self.shouldLoopIncrementalFrames || !self.isProgressive || !self.player) {
+        return NO;
+    }
+    if (image.sd_isIncremental || ![image.class conformsToProtocol:@protocol(SDAnimatedImage)] || ![image respondsToSelector:@selector(animatedCoder)]) {
+        return NO;
+    }
+    id<SDAnimatedImageCoder> animatedCoder = [(id<SDAnimatedImage>)image animatedCoder];
+    if (!animatedCoder) {
+        return NO;
+    }
+    return animatedCoder == [self progressiveAnimatedCoderForImage:self.image];
+}
+
 // Check if image can represent a `Progressive Animated Image` during loading
 - (id<SDAnimatedImageCoder, SDProgressiveImageCoder>)progressiveAnimatedCoderForImage:(UIImage *)image
 {
@@ -305,6 +305,14 @@ typedef NS_OPTIONS(NSUInteger, SDImageCacheOptions) {
  */
 - (void)diskImageDataQueryForKey:(nullable NSString *)key completion:(nullable SDImageCacheQueryDataCompletionBlock)completionBlock;
 
+/**
+ * Synchronously query the HTTP cache validator (ETag, Last-Modified and freshness) for the given key in disk cache. The validator is stored along with the image when using `SDWebImageRevalidateCached`.
+ *
+ *  @param key The unique key used to store the wanted image
+ *  @return The cache validator for the given key, or nil if not found.
+ */
+- (nullable SDImageCacheValidator *)diskCacheValidatorForKey:(nullable NSString *)key;
+
 /**
  * Asynchronously queries the cache with operation and call the completion when done.
  *
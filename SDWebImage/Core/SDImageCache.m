@@ -11,9 +11,11 @@
 #import "NSImage+Compatibility.h"
 #import "SDImageCodersManager.h"
 #import "SDImageCoderHelper.h"
+#import "SDImageFrameAtlasCoder.h"
 #import "SDAnimatedImage.h"
 #import "UIImage+MemoryCacheCost.h"
 #import "UIImage+Metadata.h"
+#import "UIImage+ForceDecode.h"
 #import "UIImage+ExtendedCacheData.h"
 #import "SDCallbackQueue.h"
 #import "SDImageTransformer.h" // TODO, remove this
@@ -26,6 +28,15 @@ static BOOL SDIsThumbnailKey(NSString *key) {
     return NO;
 }
 
+// The HTTP cache validator is stored in disk cache as a standalone entry beside the image data
+static inline NSString * _Nonnull SDCacheValidatorKeyForKey(NSString * _Nonnull key) {
+    return [key stringByAppendingString:@"-CacheValidator"];
+}
+
+static inline NSString * _Nonnull SDFrameAtlasKeyForKey(NSString * _Nonnull key) {
+    return [key stringByAppendingString:@"-FrameAtlas"];
+}
+
 @interface SDImageCacheToken ()
 
 @property (nonatomic, strong, nullable, readwrite) NSString *key;
@@ -266,6 +277,19 @@ static NSString * _defaultDiskCacheDirectory;
         data = [((id<SDAnimatedImage>)image) animatedImageData];
     }
     SDCallbackQueue *queue = context[SDWebImageContextCallbackQueue];
+    void(^storeToDisk)(NSData *, NSData *) = ^(NSData *diskData, NSData *atlasData) {
+        dispatch_async(self.ioQueue, ^{
+            [self _storeImageDataToDisk:diskData forKey:key];
+            [self _storeCacheValidator:image.sd_cacheValidator forKey:key];
+            [self _archivedDataWithImage:image forKey:key];
+            [self _storeFrameAtlasData:atlasData forKey:key];
+            if (completionBlock) {
+                [(queue ?: SDCallbackQueue.mainQueue) async:^{
+                    completionBlock();
+                }];
+            }
+        });
+    };
     if (!data && image) {
         dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_HIGH, 0), ^{
             // Check image's associated image format, may return .undefined
@@ -280,26 +304,15 @@ static NSString * _defaultDiskCacheDirectory;
                 }
             }
             NSData *encodedData = [[SDImageCodersManager sharedManager] encodedDataWithImage:image format:format options:context[SDWebImageContextImageEncodeOptions]];
-            dispatch_async(self.ioQueue, ^{
-                [self _storeImageDataToDisk:encodedData forKey:key];
-                [self _archivedDataWithImage:image forKey:key];
-                if (completionBlock) {
-                    [(queue ?: SDCallbackQueue.mainQueue) async:^{
-                        completionBlock();
-                    }];
-                }
-            });
+            storeToDisk(encodedData, [self _frameAtlasDataWithImage:image]);
         });
-    } else {
-        dispatch_async(self.ioQueue, ^{
-            [self _storeImageDataToDisk:data forKey:key];
-            [self _archivedDataWithImage:image forKey:key];
-            if (completionBlock) {
-                [(queue ?: SDCallbackQueue.mainQueue) async:^{
-                    completionBlock();
-                }];
-            }
+    } else if ([self _shouldRenderFrameAtlasWithImage:image]) {
+        // Render the frame atlas outside the io queue, which decodes every frame, only write the result in io queue
+        dispatch_async(dispatch_get_global_queue(QOS_CLASS_UTILITY, 0), ^{
+            storeToDisk(data, [self _frameAtlasDataWithImage:image]);
         });
+    } else {
+        storeToDisk(data, [self _frameAtlasDataWithImage:image]);
     }
 }
 
@@ -334,6 +347,110 @@ static NSString * _defaultDiskCacheDirectory;
     }
 }
 
+// Whether need to render the frame atlas, which decodes every frame of the image
+- (BOOL)_shouldRenderFrameAtlasWithImage:(UIImage *)image {
+    return self.config.frameAtlasLimitBytes > 0 && [image conformsToProtocol:@protocol(SDAnimatedImage)] && ![self.class isFrameAtlasImage:image];
+}
+
+// Render the frame atlas data for the image, call outside io queue when `_shouldRenderFrameAtlasWithImage:` is YES
+- (nullable NSData *)_frameAtlasDataWithImage:(UIImage *)image {
+    NSUInteger limitBytes = self.config.frameAtlasLimitBytes;
+    NSData *atlasData;
+    if (limitBytes > 0 && [image conformsToProtocol:@protocol(SDAnimatedImage)]) {
+        if ([self.class isFrameAtlasImage:image]) {
+            // Already from the atlas, copy the frames as it
+            atlasData = ((SDImageFrameAtlasCoder *)((id<SDAnimatedImage>)image).animatedCoder).frameAtlasData;
+            if (atlasData.length > limitBytes) {
+                atlasData = nil;
+            }
+        } else {
+            atlasData = [SDImageFrameAtlasCoder frameAtlasDataWithAnimatedProvider:(id<SDAnimatedImage>)image limitBytes:limitBytes];
+        }
+    }
+    return atlasData;
+}
+
+// Make sure to call from io queue by caller
+- (void)_storeFrameAtlasData:(nullable NSData *)atlasData forKey:(NSString *)key {
+    if (!key) {
+        return;
+    }
+    NSString *atlasKey = SDFrameAtlasKeyForKey(key);
+    if (atlasData) {
+        [self.diskCache setData:atlasData forKey:atlasKey];
+    } else {
+        // Remove the outdated atlas of previous image
+        [self.diskCache removeDataForKey:atlasKey];
+    }
+}
+
++ (BOOL)isFrameAtlasImage:(UIImage *)image {
+    if (![image respondsToSelector:@selector(animatedCoder)]) {
+        return NO;
+    }
+    return [((id<SDAnimatedImage>)image).animatedCoder isKindOfClass:SDImageFrameAtlasCoder.class];
+}
+
+// Make sure to call from io queue by caller
+- (nullable UIImage *)_frameAtlasImageForKey:(NSString *)key data:(NSData *)data options:(SDImageCacheOptions)options context:(SDWebImageContext *)context {
+    if (self.config.frameAtlasLimitBytes == 0 || !key || !data) {
+        return nil;
+    }
+    if (options & SDImageCacheDecodeFirstFrameOnly) {
+        return nil;
+    }
+    Class animatedImageClass = context[SDWebImageContextAnimatedImageClass];
+    if (![animatedImageClass isSubclassOfClass:[UIImage class]] || ![animatedImageClass conformsToProtocol:@protocol(SDAnimatedImage)]) {
+        return nil;
+    }
+    SDWebImageOptions imageOptions = [[self class] imageOptionsFromCacheOptions:options];
+    SDImageCoderOptions *decodeOptions = SDGetDecodeOptionsFromContext(context, imageOptions, key);
+    // The atlas keeps the full size frames, let the codec create the thumbnail or scale down
+    NSValue *thumbnailSizeValue = decodeOptions[SDImageCoderDecodeThumbnailPixelSize];
+#if SD_MAC
+    CGSize thumbnailSize = thumbnailSizeValue.sizeValue;
+#else
+    CGSize thumbnailSize = thumbnailSizeValue.CGSizeValue;
+#endif
+    if (thumbnailSize.width > 0 && thumbnailSize.height > 0) {
+        return nil;
+    }
+    if ([decodeOptions[SDImageCoderDecodeScaleDownLimitBytes] unsignedIntegerValue] > 0) {
+        return nil;
+    }
+    NSString *atlasKey = SDFrameAtlasKeyForKey(key);
+    // Memory map the atlas file, the frames are paged in on demand
+    NSData *atlasData;
+    NSString *atlasPath = [self.diskCache cachePathForKey:atlasKey];
+    if (atlasPath) {
+        atlasData = [NSData dataWithContentsOfFile:atlasPath options:NSDataReadingMappedIfSafe error:nil];
+    } else {
+        atlasData = [self.diskCache dataForKey:atlasKey];
+    }
+    if (!atlasData) {
+        return nil;
+    }
+    // Keep the original data, so the image can still be exported as the original format
+    SDImageCoderMutableOptions *coderOptions = [NSMutableDictionary dictionaryWithDictionary:decodeOptions];
+    coderOptions[SDImageFrameAtlasCoderSourceData] = data;
+    SDImageFrameAtlasCoder *coder = [[SDImageFrameAtlasCoder alloc] initWithAnimatedImageData:atlasData options:[coderOptions copy]];
+    if (!coder) {
+        return nil;
+    }
+    UIImage *image = [((id<SDAnimatedImage>)[animatedImageClass alloc]) initWithAnimatedCoder:coder scale:coder.scale];
+    if (!image) {
+        return nil;
+    }
+    if (options & SDImageCachePreloadAllFrames && [image respondsToSelector:@selector(preloadAllFrames)]) {
+        [((id<SDAnimatedImage>)image) preloadAllFrames];
+    }
+    image.sd_imageFormat = [NSData sd_imageFormatForImageData:data];
+    image.sd_isDecoded = YES;
+    // assign the decode options, to let manager check whether to re-decode if needed
+    image.sd_decodeOptions = decodeOptions;
+    return image;
+}
+
 - (void)storeImageToMemory:(UIImage *)image forKey:(NSString *)key {
     if (!image || !key) {
         return;
@@ -350,6 +467,9 @@ static NSString * _defaultDiskCacheDirectory;
     
     dispatch_sync(self.ioQueue, ^{
         [self _storeImageDataToDisk:imageData forKey:key];
+        // The validator and frame atlas of previous image does not match the new data
+        [self _storeCacheValidator:nil forKey:key];
+        [self.diskCache removeDataForKey:SDFrameAtlasKeyForKey(key)];
     });
 }
 
@@ -420,6 +540,34 @@ static NSString * _defaultDiskCacheDirectory;
     return imageData;
 }
 
+- (nullable SDImageCacheValidator *)diskCacheValidatorForKey:(nullable NSString *)key {
+    if (!key) {
+        return nil;
+    }
+    __block SDImageCacheValidator *validator = nil;
+    dispatch_sync(self.ioQueue, ^{
+        validator = [self _diskCacheValidatorForKey:key];
+    });
+    
+    return validator;
+}
+
+// Make sure to call from io queue by caller
+- (nullable SDImageCacheValidator *)_diskCacheValidatorForKey:(nullable NSString *)key {
+    if (!key) {
+        return nil;
+    }
+    NSData *data = [self.diskCache dataForKey:SDCacheValidatorKeyForKey(key)];
+    if (!data) {
+        return nil;
+    }
+    id dictionary = [NSPropertyListSerialization propertyListWithData:data options:NSPropertyListImmutable format:nil error:nil];
+    if (![dictionary isKindOfClass:NSDictionary.class]) {
+        return nil;
+    }
+    return [[SDImageCacheValidator alloc] initWithDictionaryRepresentation:dictionary];
+}
+
 - (nullable UIImage *)imageFromMemoryCacheForKey:(nullable NSString *)key {
     return [self.memoryCache objectForKey:key];
 }
@@ -442,7 +590,7 @@ static NSString * _defaultDiskCacheDirectory;
     }
     if (shouldCacheToMemory) {
         // check if we need sync logic
-        [self _syncDiskToMemoryWithImage:diskImage forKey:key];
+        [self _syncDiskToMemoryWithImage:diskImage forKey:key options:options context:context];
     }
 
     return diskImage;
@@ -518,13 +666,16 @@ static NSString * _defaultDiskCacheDirectory;
     if (!data) {
         return nil;
     }
-    UIImage *image = SDImageCacheDecodeImageData(data, key, [[self class] imageOptionsFromCacheOptions:options], context);
+    // Prefer the pre-rendered frame atlas, without codec work
+    UIImage *image = [self _frameAtlasImageForKey:key data:data options:options context:context];
+    if (!image) {
+        image = SDImageCacheDecodeImageData(data, key, [[self class] imageOptionsFromCacheOptions:options], context);
+    }
     [self _unarchiveObjectWithImage:image forKey:key];
     return image;
 }
 
-- (void)_syncDiskToMemoryWithImage:(UIImage *)diskImage forKey:(NSString *)key {
-    // earily check
+- (void)_syncDiskToMemoryWithImage:(UIImage *)diskImage forKey:(NSString *)key options:(SDImageCacheOptions)options context:(SDWebImageContext *)context {
     if (!self.config.shouldCacheImagesInMemory) {
         return;
     }
@@ -535,9 +686,10 @@ static NSString * _defaultDiskCacheDirectory;
     // However, caller (like SDWebImageManager) will query full key, with thumbnail size, and get thubmnail image
     // We should add a check here, currently it's a hack
     if (diskImage.sd_isThumbnail && !SDIsThumbnailKey(key)) {
-        SDImageCoderOptions *options = diskImage.sd_decodeOptions;
+        // The image's decode options contains the resolved thumbnail size (such as aspect fill), use the requested one to match the caller's key
+        SDImageCoderOptions *decodeOptions = SDGetDecodeOptionsFromContext(context, [[self class] imageOptionsFromCacheOptions:options], key);
         CGSize thumbnailSize = CGSizeZero;
-        NSValue *thumbnailSizeValue = options[SDImageCoderDecodeThumbnailPixelSize];
+        NSValue *thumbnailSizeValue = decodeOptions[SDImageCoderDecodeThumbnailPixelSize];
         if (thumbnailSizeValue != nil) {
     #if SD_MAC
             thumbnailSize = thumbnailSizeValue.sizeValue;
@@ -546,12 +698,17 @@ static NSString * _defaultDiskCacheDirectory;
     #endif
         }
         BOOL preserveAspectRatio = YES;
-        NSNumber *preserveAspectRatioValue = options[SDImageCoderDecodePreserveAspectRatio];
+        NSNumber *preserveAspectRatioValue = decodeOptions[SDImageCoderDecodePreserveAspectRatio];
         if (preserveAspectRatioValue != nil) {
             preserveAspectRatio = preserveAspectRatioValue.boolValue;
         }
         // Calculate the actual thumbnail key
-        NSString *thumbnailKey = SDThumbnailedKeyForKey(key, thumbnailSize, preserveAspectRatio);
+        NSString *thumbnailKey;
+        if (preserveAspectRatio && [decodeOptions[SDImageCoderDecodeThumbnailAspectFill] boolValue]) {
+            thumbnailKey = SDAspectFillThumbnailedKeyForKey(key, thumbnailSize);
+        } else {
+            thumbnailKey = SDThumbnailedKeyForKey(key, thumbnailSize, preserveAspectRatio);
+        }
         // Override the sync key
         key = thumbnailKey;
     }
@@ -703,7 +860,7 @@ static NSString * _defaultDiskCacheDirectory;
                 diskImage = [self diskImageForKey:key data:diskData options:options context:context];
                 // check if we need sync logic
                 if (shouldCacheToMemory) {
-                    [self _syncDiskToMemoryWithImage:diskImage forKey:key];
+                    [self _syncDiskToMemoryWithImage:diskImage forKey:key options:options context:context];
                 }
             }
         }
@@ -769,7 +926,7 @@ static NSString * _defaultDiskCacheDirectory;
 
     if (fromDisk) {
         dispatch_async(self.ioQueue, ^{
-            [self.diskCache removeDataForKey:key];
+            [self _removeImageFromDiskForKey:key];
             
             if (completion) {
                 dispatch_async(dispatch_get_main_queue(), ^{
@@ -806,6 +963,8 @@ static NSString * _defaultDiskCacheDirectory;
     }
     
     [self.diskCache removeDataForKey:key];
+    [self.diskCache removeDataForKey:SDCacheValidatorKeyForKey(key)];
+    [self.diskCache removeDataForKey:SDFrameAtlasKeyForKey(key)];
 }
 
 #pragma mark - Cache clean Ops
@@ -954,6 +1113,49 @@ static NSString * _defaultDiskCacheDirectory;
     [self storeImage:image imageData:imageData forKey:key options:0 context:nil cacheType:cacheType completion:completionBlock];
 }
 
+- (void)queryCacheValidatorForKey:(NSString *)key completion:(SDImageCacheQueryValidatorCompletionBlock)completionBlock {
+    dispatch_async(self.ioQueue, ^{
+        SDImageCacheValidator *validator = [self _diskCacheValidatorForKey:key];
+        if (completionBlock) {
+            dispatch_async(dispatch_get_main_queue(), ^{
+                completionBlock(validator);
+            });
+        }
+    });
+}
+
+- (void)storeCacheValidator:(SDImageCacheValidator *)validator forKey:(NSString *)key {
+    if (!key) {
+        return;
+    }
+    dispatch_async(self.ioQueue, ^{
+        [self _storeCacheValidator:validator forKey:key];
+        if (!validator) {
+            return;
+        }
+        // The validator is refreshed without the image data, touch the image file as well, so both of them expire together
+        NSString *imagePath = [self.diskCache cachePathForKey:key];
+        if (imagePath) {
+            [[NSFileManager defaultManager] setAttributes:@{NSFileModificationDate : [NSDate date]} ofItemAtPath:imagePath error:nil];
+        }
+    });
+}
+
+// Make sure to call from io queue by caller
+- (void)_storeCacheValidator:(nullable SDImageCacheValidator *)validator forKey:(nonnull NSString *)key {
+    NSString *validatorKey = SDCacheValidatorKeyForKey(key);
+    NSData *data;
+    if (validator) {
+        data = [NSPropertyListSerialization dataWithPropertyList:validator.dictionaryRepresentation format:NSPropertyListBinaryFormat_v1_0 options:0 error:nil];
+    }
+    if (data) {
+        [self.diskCache setData:data forKey:validatorKey];
+    } else {
+        // Remove the outdated validator of previous image
+        [self.diskCache removeDataForKey:validatorKey];
+    }
+}
+
 - (void)removeImageForKey:(NSString *)key cacheType:(SDImageCacheType)cacheType completion:(nullable SDWebImageNoParamsBlock)completionBlock {
     switch (cacheType) {
         case SDImageCacheTypeNone: {
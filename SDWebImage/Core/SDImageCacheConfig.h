@@ -100,6 +100,15 @@ typedef NS_ENUM(NSUInteger, SDImageCacheConfigExpireType) {
  */
 @property (assign, nonatomic) NSUInteger maxDiskSize;
 
+/**
+ * The maximum size of the pre-rendered frame atlas for each animated image, in bytes.
+ * When storing the animated image (which conforms to `SDAnimatedImage`) to disk, the frames are also rendered into a frame atlas next to the disk cache entry if the atlas is smaller than this value. When querying with `SDWebImageContextAnimatedImageClass`, the atlas is memory mapped and played without codec work (see `SDImageFrameAtlasCoder`).
+ * This is useful for the small looping animations like stickers and emoji. The atlas is uncompressed so it's much larger than the original data, keep this small.
+ * @note The atlas keeps the full size frames, so the query with thumbnail pixel size or scale down limit bytes decodes the original data instead. Storing the new data for the key removes the outdated atlas.
+ * Defaults to 0. Which means the frame atlas is disabled.
+ */
+@property (assign, nonatomic) NSUInteger frameAtlasLimitBytes;
+
 /**
  * The maximum "total cost" of the in-memory image cache. The cost function is the bytes size held in memory.
  * @note The memory cost is bytes size in memory, but not simple pixels count. For common ARGB8888 image, one pixel is 4 bytes (32 bits).
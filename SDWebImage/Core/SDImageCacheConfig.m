@@ -58,6 +58,7 @@ static const NSInteger kDefaultCacheMaxDiskAge = 60 * 60 * 24 * 7; // 1 week
     config.diskCacheWritingOptions = self.diskCacheWritingOptions;
     config.maxDiskAge = self.maxDiskAge;
     config.maxDiskSize = self.maxDiskSize;
+    config.frameAtlasLimitBytes = self.frameAtlasLimitBytes;
     config.maxMemoryCost = self.maxMemoryCost;
     config.maxMemoryCount = self.maxMemoryCount;
     config.diskCacheExpireType = self.diskCacheExpireType;
@@ -11,6 +11,7 @@
 #import "SDWebImageOperation.h"
 #import "SDWebImageDefine.h"
 #import "SDImageCoder.h"
+#import "SDImageCacheValidator.h"
 
 /// Image Cache Type
 typedef NS_ENUM(NSInteger, SDImageCacheType) {
@@ -42,6 +43,7 @@ typedef void(^SDImageCacheCalculateSizeBlock)(NSUInteger fileCount, NSUInteger t
 typedef NSString * _Nullable (^SDImageCacheAdditionalCachePathBlock)(NSString * _Nonnull key);
 typedef void(^SDImageCacheQueryCompletionBlock)(UIImage * _Nullable image, NSData * _Nullable data, SDImageCacheType cacheType);
 typedef void(^SDImageCacheContainsCompletionBlock)(SDImageCacheType containsCacheType);
+typedef void(^SDImageCacheQueryValidatorCompletionBlock)(SDImageCacheValidator * _Nullable validator);
 
 /**
  This is the built-in decoding process for image query from cache.
@@ -67,6 +69,12 @@ FOUNDATION_EXPORT SDImageCoderOptions * _Nonnull SDGetDecodeOptionsFromContext(S
 /// @param decodeOptions The image decoding options
 FOUNDATION_EXPORT void SDSetDecodeOptionsToContext(SDWebImageMutableContext * _Nonnull mutableContext, SDWebImageOptions * _Nonnull mutableOptions, SDImageCoderOptions * _Nonnull decodeOptions);
 
+/// Resolve the `SDImageCoderDecodeThumbnailAspectFill` decode option into the concrete thumbnail pixel size, by reading the image size from the image data header. The coder can then decode the thumbnail with the common aspect fit logic.
+/// @param decodeOptions The image decoding options
+/// @param imageData The image data to decode
+/// @return The decode options to pass to the coder. If the image size is unknown, the thumbnail pixel size is removed to decode the full size image
+FOUNDATION_EXPORT SDImageCoderOptions * _Nonnull SDResolveDecodeOptionsWithImageData(SDImageCoderOptions * _Nonnull decodeOptions, NSData * _Nonnull imageData);
+
 /**
  This is the image cache protocol to provide custom image cache for `SDWebImageManager`.
  Though the best practice to custom image cache, is to write your own class which conform `SDMemoryCache` or `SDDiskCache` protocol for `SDImageCache` class (See more on `SDImageCacheConfig.memoryCacheClass & SDImageCacheConfig.diskCacheClass`).
@@ -144,6 +152,26 @@ FOUNDATION_EXPORT void SDSetDecodeOptionsToContext(SDWebImageMutableContext * _N
          cacheType:(SDImageCacheType)cacheType
         completion:(nullable SDWebImageNoParamsBlock)completionBlock;
 
+#pragma mark - Revalidation, used by `SDWebImageRevalidateCached`
+/**
+ Query the HTTP cache validator (ETag, Last-Modified and freshness) for the given key. Completion is called asynchronously.
+
+ @param key The image cache key
+ @param completionBlock A block executed after the operation is finished
+ */
+- (void)queryCacheValidatorForKey:(nullable NSString *)key
+                       completion:(nullable SDImageCacheQueryValidatorCompletionBlock)completionBlock;
+
+/**
+ Store the HTTP cache validator for the given key, which is used to revalidate the cached image later.
+ This is called when the revalidation responds `304 Not Modified`, the cached image should expire together with the refreshed validator. The validator of a new downloaded image is attached as `sd_cacheValidator`, and should be stored atomically with the image data during `storeImage:imageData:forKey:options:context:cacheType:completion:`.
+
+ @param validator The cache validator to store, pass nil to remove
+ @param key The image cache key
+ */
+- (void)storeCacheValidator:(nullable SDImageCacheValidator *)validator
+                     forKey:(nullable NSString *)key;
+
 #pragma mark - Deprecated because SDWebImageManager does not use these APIs
 /**
  Remove the image from image cache for the given key. If cache type is memory only, completion is called synchronously, else asynchronously.
@@ -15,12 +15,14 @@
 #import "SDDeviceHelper.h"
 
 #import <CoreServices/CoreServices.h>
+#import <ImageIO/ImageIO.h>
 
 SDImageCoderOptions * _Nonnull SDGetDecodeOptionsFromContext(SDWebImageContext * _Nullable context, SDWebImageOptions options, NSString * _Nonnull cacheKey) {
     BOOL decodeFirstFrame = SD_OPTIONS_CONTAINS(options, SDWebImageDecodeFirstFrameOnly);
     NSNumber *scaleValue = context[SDWebImageContextImageScaleFactor];
     CGFloat scale = scaleValue.doubleValue >= 1 ? scaleValue.doubleValue : SDImageScaleFactorForKey(cacheKey); // Use cache key to detect scale
     NSNumber *preserveAspectRatioValue = context[SDWebImageContextImagePreserveAspectRatio];
+    NSNumber *thumbnailAspectFillValue = context[SDWebImageContextImageThumbnailAspectFill];
     NSValue *thumbnailSizeValue;
     BOOL shouldScaleDown = SD_OPTIONS_CONTAINS(options, SDWebImageScaleDownLargeImages);
     NSNumber *scaleDownLimitBytesValue = context[SDWebImageContextImageScaleDownLimitBytes];
@@ -61,6 +63,7 @@ SDImageCoderOptions * _Nonnull SDGetDecodeOptionsFromContext(SDWebImageContext *
     mutableCoderOptions[SDImageCoderDecodeScaleFactor] = @(scale);
     mutableCoderOptions[SDImageCoderDecodePreserveAspectRatio] = preserveAspectRatioValue;
     mutableCoderOptions[SDImageCoderDecodeThumbnailPixelSize] = thumbnailSizeValue;
+    mutableCoderOptions[SDImageCoderDecodeThumbnailAspectFill] = thumbnailAspectFillValue;
     mutableCoderOptions[SDImageCoderDecodeTypeIdentifierHint] = typeIdentifierHint;
     mutableCoderOptions[SDImageCoderDecodeFileExtensionHint] = fileExtensionHint;
     mutableCoderOptions[SDImageCoderDecodeScaleDownLimitBytes] = scaleDownLimitBytesValue;
@@ -79,6 +82,7 @@ void SDSetDecodeOptionsToContext(SDWebImageMutableContext * _Nonnull mutableCont
     mutableContext[SDWebImageContextImageScaleFactor] = decodeOptions[SDImageCoderDecodeScaleFactor];
     mutableContext[SDWebImageContextImagePreserveAspectRatio] = decodeOptions[SDImageCoderDecodePreserveAspectRatio];
     mutableContext[SDWebImageContextImageThumbnailPixelSize] = decodeOptions[SDImageCoderDecodeThumbnailPixelSize];
+    mutableContext[SDWebImageContextImageThumbnailAspectFill] = decodeOptions[SDImageCoderDecodeThumbnailAspectFill];
     mutableContext[SDWebImageContextImageScaleDownLimitBytes] = decodeOptions[SDImageCoderDecodeScaleDownLimitBytes];
     mutableContext[SDWebImageContextImageDecodeToHDR] = decodeOptions[SDImageCoderDecodeToHDR];
     
@@ -96,6 +100,65 @@ void SDSetDecodeOptionsToContext(SDWebImageMutableContext * _Nonnull mutableCont
     mutableContext[SDWebImageContextImageTypeIdentifierHint] = typeIdentifierHint;
 }
 
+SDImageCoderOptions * _Nonnull SDResolveDecodeOptionsWithImageData(SDImageCoderOptions * _Nonnull decodeOptions, NSData * _Nonnull imageData) {
+    if (![decodeOptions[SDImageCoderDecodeThumbnailAspectFill] boolValue]) {
+        return decodeOptions;
+    }
+    NSNumber *preserveAspectRatioValue = decodeOptions[SDImageCoderDecodePreserveAspectRatio];
+    if (preserveAspectRatioValue != nil && !preserveAspectRatioValue.boolValue) {
+        return decodeOptions;
+    }
+    CGSize thumbnailSize = CGSizeZero;
+    NSValue *thumbnailSizeValue = decodeOptions[SDImageCoderDecodeThumbnailPixelSize];
+    if (thumbnailSizeValue != nil) {
+#if SD_MAC
+        thumbnailSize = thumbnailSizeValue.sizeValue;
+#else
+        thumbnailSize = thumbnailSizeValue.CGSizeValue;
+#endif
+    }
+    SDImageCoderMutableOptions *mutableCoderOptions = [decodeOptions mutableCopy];
+    mutableCoderOptions[SDImageCoderDecodeThumbnailAspectFill] = nil;
+    if (thumbnailSize.width <= 0 || thumbnailSize.height <= 0) {
+        return [mutableCoderOptions copy];
+    }
+    // Only read the header, does not decode the image
+    CGFloat pixelWidth = 0;
+    CGFloat pixelHeight = 0;
+    CGImageSourceRef source = CGImageSourceCreateWithData((__bridge CFDataRef)imageData, nil);
+    if (source) {
+        NSDictionary *properties = (__bridge_transfer NSDictionary *)CGImageSourceCopyPropertiesAtIndex(source, 0, nil);
+        pixelWidth = [properties[(__bridge NSString *)kCGImagePropertyPixelWidth] doubleValue];
+        pixelHeight = [properties[(__bridge NSString *)kCGImagePropertyPixelHeight] doubleValue];
+        CGImagePropertyOrientation exifOrientation = [properties[(__bridge NSString *)kCGImagePropertyOrientation] unsignedIntValue];
+        if (exifOrientation >= kCGImagePropertyOrientationLeftMirrored) {
+            // The thumbnail applies the EXIF transform, which swaps the width and height
+            CGFloat temp = pixelWidth;
+            pixelWidth = pixelHeight;
+            pixelHeight = temp;
+        }
+        CFRelease(source);
+    }
+    if (pixelWidth <= 0 || pixelHeight <= 0) {
+        // Can not calculate the fill size, decode the full size image instead of the blurry one
+        mutableCoderOptions[SDImageCoderDecodeThumbnailPixelSize] = nil;
+        return [mutableCoderOptions copy];
+    }
+    CGFloat fillScale = MAX(thumbnailSize.width / pixelWidth, thumbnailSize.height / pixelHeight);
+    if (fillScale < 1) {
+        thumbnailSize = CGSizeMake(ceil(pixelWidth * fillScale), ceil(pixelHeight * fillScale));
+    } else {
+        // Never scale up
+        thumbnailSize = CGSizeMake(pixelWidth, pixelHeight);
+    }
+#if SD_MAC
+    mutableCoderOptions[SDImageCoderDecodeThumbnailPixelSize] = [NSValue valueWithSize:thumbnailSize];
+#else
+    mutableCoderOptions[SDImageCoderDecodeThumbnailPixelSize] = [NSValue valueWithCGSize:thumbnailSize];
+#endif
+    return [mutableCoderOptions copy];
+}
+
 UIImage * _Nullable SDImageCacheDecodeImageData(NSData * _Nonnull imageData, NSString * _Nonnull cacheKey, SDWebImageOptions options, SDWebImageContext * _Nullable context) {
     NSCParameterAssert(imageData);
     NSCParameterAssert(cacheKey);
@@ -104,6 +167,9 @@ UIImage * _Nullable SDImageCacheDecodeImageData(NSData * _Nonnull imageData, NSS
     BOOL decodeFirstFrame = SD_OPTIONS_CONTAINS(options, SDWebImageDecodeFirstFrameOnly);
     CGFloat scale = [coderOptions[SDImageCoderDecodeScaleFactor] doubleValue];
     
+    // The aspect fill thumbnail size depends on the image size
+    SDImageCoderOptions *decodeOptions = SDResolveDecodeOptionsWithImageData(coderOptions, imageData);
+    
     // Grab the image coder
     id<SDImageCoder> imageCoder = context[SDWebImageContextImageCoder];
     if (!imageCoder) {
@@ -114,7 +180,7 @@ UIImage * _Nullable SDImageCacheDecodeImageData(NSData * _Nonnull imageData, NSS
         Class animatedImageClass = context[SDWebImageContextAnimatedImageClass];
         // check whether we should use `SDAnimatedImage`
         if ([animatedImageClass isSubclassOfClass:[UIImage class]] && [animatedImageClass conformsToProtocol:@protocol(SDAnimatedImage)]) {
-            image = [[animatedImageClass alloc] initWithData:imageData scale:scale options:coderOptions];
+            image = [[animatedImageClass alloc] initWithData:imageData scale:scale options:decodeOptions];
             if (image) {
                 // Preload frames if supported
                 if (options & SDWebImagePreloadAllFrames && [image respondsToSelector:@selector(preloadAllFrames)]) {
@@ -129,7 +195,7 @@ UIImage * _Nullable SDImageCacheDecodeImageData(NSData * _Nonnull imageData, NSS
         }
     }
     if (!image) {
-        image = [imageCoder decodedImageWithData:imageData options:coderOptions];
+        image = [imageCoder decodedImageWithData:imageData options:decodeOptions];
     }
     if (image) {
         SDImageForceDecodePolicy policy = SDImageForceDecodePolicyAutomatic;
@@ -146,7 +212,7 @@ UIImage * _Nullable SDImageCacheDecodeImageData(NSData * _Nonnull imageData, NSS
 #pragma clang diagnostic pop
         image = [SDImageCoderHelper decodedImageWithImage:image policy:policy];
         // assign the decode options, to let manager check whether to re-decode if needed
-        image.sd_decodeOptions = coderOptions;
+        image.sd_decodeOptions = decodeOptions;
     }
     
     return image;
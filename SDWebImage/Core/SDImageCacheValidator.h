@@ -0,0 +1,58 @@
+/*
+ * This file is part of the SDWebImage package.
+ * (c) Olivier Poitrey <rs@dailymotion.com>
+ *
+ * For the full copyright and license information, please view the LICENSE
+ * file that was distributed with this source code.
+ */
+
+#import <Foundation/Foundation.h>
+#import "SDWebImageCompat.h"
+
+/**
+ The HTTP cache validator for the cached image, which contains the `ETag`, `Last-Modified` and freshness lifetime from the download response.
+ This is stored by `SDImageCache` along with the image, and used to issue the conditional request (`If-None-Match`/`If-Modified-Since`) when revalidating, see `SDWebImageRevalidateCached`. A `304 Not Modified` response only refreshes the freshness without transferring or decoding the image body.
+ */
+@interface SDImageCacheValidator : NSObject
+
+/// The `ETag` response header.
+@property (nonatomic, copy, readonly, nullable) NSString *entityTag;
+
+/// The `Last-Modified` response header.
+@property (nonatomic, copy, readonly, nullable) NSString *lastModified;
+
+/// The date when the cached image become stale, calculated from `Cache-Control: max-age` (or `Expires`) response header. Nil means always stale and need revalidation.
+@property (nonatomic, copy, readonly, nullable) NSDate *expirationDate;
+
+/// Whether the cached image is still fresh, which can be used without revalidation.
+@property (nonatomic, assign, readonly, getter=isFresh) BOOL fresh;
+
+/// Whether the validator can be used for conditional request, which means it has `ETag` or `Last-Modified`.
+@property (nonatomic, assign, readonly, getter=isConditional) BOOL conditional;
+
+/// The conditional request headers (`If-None-Match` and `If-Modified-Since`) for revalidation.
+@property (nonatomic, copy, readonly, nonnull) NSDictionary<NSString *, NSString *> *conditionalHeaders;
+
+/// Create the validator from the download response.
+/// @param response The HTTP URL response
+/// @return The validator, or nil if the response is not HTTP response, or contains no validator and freshness lifetime
++ (nullable instancetype)validatorWithResponse:(nullable NSURLResponse *)response;
+
+/// Create the validator from the `304 Not Modified` response when revalidating. The freshness is refreshed, and the validators are updated if the response provides new ones.
+/// @param response The `304 Not Modified` HTTP URL response
+- (nonnull instancetype)validatorByRefreshingWithResponse:(nullable NSURLResponse *)response;
+
+/// Create the validator from the dictionary representation, used for disk cache persistence.
+- (nullable instancetype)initWithDictionaryRepresentation:(nonnull NSDictionary<NSString *, id> *)dictionary;
+
+/// The property list compatible dictionary representation, used for disk cache persistence.
+@property (nonatomic, copy, readonly, nonnull) NSDictionary<NSString *, id> *dictionaryRepresentation;
+
+@end
+
+@interface UIImage (SDImageCacheValidator)
+
+/// The cache validator from the download response, which is stored by `SDWebImageManager` into image cache along with the image. Only available when using `SDWebImageRevalidateCached`.
+@property (nonatomic, strong, nullable) SDImageCacheValidator *sd_cacheValidator;
+
+@end
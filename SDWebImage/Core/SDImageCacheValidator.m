@@ -0,0 +1,164 @@
+/*
+ * This file is part of the SDWebImage package.
+ * (c) Olivier Poitrey <rs@dailymotion.com>
+ *
+ * For the full copyright and license information, please view the LICENSE
+ * file that was distributed with this source code.
+ */
+
+#import "SDImageCacheValidator.h"
+#import "objc/runtime.h"
+
+static NSString * const SDImageCacheValidatorEntityTagKey = @"entityTag";
+static NSString * const SDImageCacheValidatorLastModifiedKey = @"lastModified";
+static NSString * const SDImageCacheValidatorExpirationDateKey = @"expirationDate";
+
+// HTTP header field name is case-insensitive, `valueForHTTPHeaderField:` is only available on iOS 13+
+static NSString * _Nullable SDHTTPHeaderValue(NSHTTPURLResponse * _Nonnull response, NSString * _Nonnull field) {
+    __block NSString *value;
+    [response.allHeaderFields enumerateKeysAndObjectsUsingBlock:^(id _Nonnull key, id _Nonnull obj, BOOL * _Nonnull stop) {
+        if ([key isKindOfClass:NSString.class] && [key caseInsensitiveCompare:field] == NSOrderedSame) {
+            value = [obj isKindOfClass:NSString.class] ? obj : [obj description];
+            *stop = YES;
+        }
+    }];
+    return value;
+}
+
+// Calculate the expiration date from `Cache-Control` and `Expires`, return nil if no freshness lifetime
+static NSDate * _Nullable SDHTTPExpirationDate(NSHTTPURLResponse * _Nonnull response) {
+    NSString *cacheControl = SDHTTPHeaderValue(response, @"Cache-Control");
+    if (cacheControl) {
+        NSTimeInterval maxAge = -1;
+        for (NSString *component in [cacheControl componentsSeparatedByString:@","]) {
+            NSString *directive = [component stringByTrimmingCharactersInSet:NSCharacterSet.whitespaceCharacterSet].lowercaseString;
+            if ([directive isEqualToString:@"no-cache"] || [directive isEqualToString:@"no-store"]) {
+                // Must revalidate each time
+                return nil;
+            }
+            if ([directive hasPrefix:@"max-age="]) {
+                maxAge = [directive substringFromIndex:@"max-age=".length].doubleValue;
+            }
+        }
+        if (maxAge >= 0) {
+            // The response may be already aged in proxy cache
+            NSTimeInterval age = SDHTTPHeaderValue(response, @"Age").doubleValue;
+            return [NSDate dateWithTimeIntervalSinceNow:MAX(maxAge - age, 0)];
+        }
+    }
+    NSString *expires = SDHTTPHeaderValue(response, @"Expires");
+    if (expires) {
+        static NSDateFormatter *formatter;
+        static dispatch_once_t onceToken;
+        dispatch_once(&onceToken, ^{
+            formatter = [NSDateFormatter new];
+            formatter.locale = [NSLocale localeWithLocaleIdentifier:@"en_US_POSIX"];
+            formatter.timeZone = [NSTimeZone timeZoneWithAbbreviation:@"GMT"];
+            formatter.dateFormat = @"EEE, dd MMM yyyy HH:mm:ss zzz"; // RFC 7231 IMF-fixdate
+        });
+        @synchronized (formatter) {
+            return [formatter dateFromString:expires];
+        }
+    }
+    return nil;
+}
+
+@interface SDImageCacheValidator ()
+
+@property (nonatomic, copy, readwrite, nullable) NSString *entityTag;
+@property (nonatomic, copy, readwrite, nullable) NSString *lastModified;
+@property (nonatomic, copy, readwrite, nullable) NSDate *expirationDate;
+
+@end
+
+@implementation SDImageCacheValidator
+
++ (instancetype)validatorWithResponse:(NSURLResponse *)response {
+    if (![response isKindOfClass:NSHTTPURLResponse.class]) {
+        return nil;
+    }
+    NSHTTPURLResponse *HTTPResponse = (NSHTTPURLResponse *)response;
+    SDImageCacheValidator *validator = [[self alloc] init];
+    validator.entityTag = SDHTTPHeaderValue(HTTPResponse, @"ETag");
+    validator.lastModified = SDHTTPHeaderValue(HTTPResponse, @"Last-Modified");
+    validator.expirationDate = SDHTTPExpirationDate(HTTPResponse);
+    if (!validator.isConditional && !validator.expirationDate) {
+        return nil;
+    }
+    return validator;
+}
+
+- (instancetype)validatorByRefreshingWithResponse:(NSURLResponse *)response {
+    SDImageCacheValidator *validator = [[self.class alloc] init];
+    validator.entityTag = self.entityTag;
+    validator.lastModified = self.lastModified;
+    if ([response isKindOfClass:NSHTTPURLResponse.class]) {
+        NSHTTPURLResponse *HTTPResponse = (NSHTTPURLResponse *)response;
+        // A 304 response should contain the same validators, but it may provide the updated ones
+        validator.entityTag = SDHTTPHeaderValue(HTTPResponse, @"ETag") ?: self.entityTag;
+        validator.lastModified = SDHTTPHeaderValue(HTTPResponse, @"Last-Modified") ?: self.lastModified;
+        validator.expirationDate = SDHTTPExpirationDate(HTTPResponse);
+    }
+    return validator;
+}
+
+- (instancetype)initWithDictionaryRepresentation:(NSDictionary<NSString *,id> *)dictionary {
+    self = [super init];
+    if (self) {
+        id entityTag = dictionary[SDImageCacheValidatorEntityTagKey];
+        id lastModified = dictionary[SDImageCacheValidatorLastModifiedKey];
+        id expirationDate = dictionary[SDImageCacheValidatorExpirationDateKey];
+        _entityTag = [entityTag isKindOfClass:NSString.class] ? [entityTag copy] : nil;
+        _lastModified = [lastModified isKindOfClass:NSString.class] ? [lastModified copy] : nil;
+        _expirationDate = [expirationDate isKindOfClass:NSDate.class] ? [expirationDate copy] : nil;
+        if (!_entityTag && !_lastModified && !_expirationDate) {
+            return nil;
+        }
+    }
+    return self;
+}
+
+- (NSDictionary<NSString *,id> *)dictionaryRepresentation {
+    NSMutableDictionary<NSString *, id> *dictionary = [NSMutableDictionary dictionaryWithCapacity:3];
+    dictionary[SDImageCacheValidatorEntityTagKey] = self.entityTag;
+    dictionary[SDImageCacheValidatorLastModifiedKey] = self.lastModified;
+    dictionary[SDImageCacheValidatorExpirationDateKey] = self.expirationDate;
+    return [dictionary copy];
+}
+
+- (BOOL)isFresh {
+    return self.expirationDate && self.expirationDate.timeIntervalSinceNow > 0;
+}
+
+- (BOOL)isConditional {
+    return self.entityTag.length > 0 || self.lastModified.length > 0;
+}
+
+- (NSDictionary<NSString *,NSString *> *)conditionalHeaders {
+    NSMutableDictionary<NSString *, NSString *> *headers = [NSMutableDictionary dictionaryWithCapacity:2];
+    if (self.entityTag.length > 0) {
+        headers[@"If-None-Match"] = self.entityTag;
+    }
+    if (self.lastModified.length > 0) {
+        headers[@"If-Modified-Since"] = self.lastModified;
+    }
+    return [headers copy];
+}
+
+- (NSString *)description {
+    return [NSString stringWithFormat:@"<%@: %p; entityTag = %@; lastModified = %@; expirationDate = %@>", self.class, self, self.entityTag, self.lastModified, self.expirationDate];
+}
+
+@end
+
+@implementation UIImage (SDImageCacheValidator)
+
+- (SDImageCacheValidator *)sd_cacheValidator {
+    return objc_getAssociatedObject(self, @selector(sd_cacheValidator));
+}
+
+- (void)setSd_cacheValidator:(SDImageCacheValidator *)sd_cacheValidator {
+    objc_setAssociatedObject(self, @selector(sd_cacheValidator), sd_cacheValidator, OBJC_ASSOCIATION_RETAIN_NONATOMIC);
+}
+
+@end
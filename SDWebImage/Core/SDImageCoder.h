@@ -45,6 +45,13 @@ FOUNDATION_EXPORT SDImageCoderOption _Nonnull const SDImageCoderDecodePreserveAs
  */
 FOUNDATION_EXPORT SDImageCoderOption _Nonnull const SDImageCoderDecodeThumbnailPixelSize;
 
+/**
+ A Boolean value indicating whether the thumbnail should fill the `.decodeThumbnailPixelSize` (like aspect fill content mode) instead of fitting in it. The thumbnail keeps the aspect ratio, and the scale is `max(thumbnailWidth / imageWidth, thumbnailHeight / imageHeight)`, so one dimension may exceed the thumbnail pixel size. Only used when `.preserveAspectRatio` is YES.
+ Defaults to NO. (NSNumber)
+ @note The image loader and image cache resolve this option into the concrete `.decodeThumbnailPixelSize` from the image header before calling the coder, so the coder does not need to support it.
+ */
+FOUNDATION_EXPORT SDImageCoderOption _Nonnull const SDImageCoderDecodeThumbnailAspectFill;
+
 /**
  A NSString value indicating the source image's file extension. Example: "jpg", "nef", "tif", don't prefix the dot
  Some image file format share the same data structure but has different tag explanation, like TIFF and NEF/SRW, see https://en.wikipedia.org/wiki/TIFF
@@ -323,6 +330,18 @@ FOUNDATION_EXPORT SDImageCoderOption _Nonnull const SDImageCoderWebImageContext
  */
 - (NSTimeInterval)animatedImageDurationAtIndex:(NSUInteger)index;
 
+@optional
+/**
+ Returns the frame image from a specified index, decoded at the target pixel size instead of the full frame size. This is used by `SDAnimatedImagePlayer` to decode the frames at the display size, which save the memory and decode time for small rendering target.
+ The frame keeps the aspect ratio and fits the target pixel size (like `SDImageCoderDecodeThumbnailPixelSize` with `SDImageCoderDecodePreserveAspectRatio`), but not larger than the frame decoded by `animatedImageFrameAtIndex:`. The frame's point size should be the same as the full frame, by using a larger image scale.
+ @note If not implemented, or the target pixel size is zero, the full frame from `animatedImageFrameAtIndex:` is used.
+ 
+ @param index Frame index (zero based).
+ @param targetPixelSize The target pixel size of rendering.
+ @return Frame's image
+ */
+- (nullable UIImage *)animatedImageFrameAtIndex:(NSUInteger)index targetPixelSize:(CGSize)targetPixelSize;
+
 @end
 
 #pragma mark - Animated Coder
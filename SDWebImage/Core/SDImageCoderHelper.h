@@ -33,6 +33,16 @@ typedef NS_ENUM(NSUInteger, SDImageForceDecodePolicy) {
     SDImageForceDecodePolicyAlways
 };
 
+/// The row stride (bytesPerRow) policy for the bitmap created by decode, scale and render.
+typedef NS_ENUM(NSUInteger, SDImageRowAlignment) {
+    /// Align to 8 pixels (see `SDImagePixelFormat.alignment`, 32 bytes for RGBA8888), the minimum for render server to display without copy. Default.
+    SDImageRowAlignmentPixelFormat = 0,
+    /// Align to 64 bytes, the cache line size, so each row starts at the cache line, which helps SIMD processing and GPU upload. Use a little more memory for narrow image.
+    SDImageRowAlignmentCacheLine = 1,
+    /// Tightly packed without padding (width * bytesPerPixel), the smallest memory, but the rows may be misaligned.
+    SDImageRowAlignmentNone = 2
+};
+
 /// These enum is used to represent the High Dynamic Range type during image encoding/decoding.
 /// There are alao other HDR type in history before ISO Standard (ISO 21496-1), including Google and Apple's old OSs captured photos, but which is non-standard and we do not support.
 typedef NS_ENUM(NSUInteger, SDImageHDRType) {
@@ -150,6 +160,17 @@ typedef struct SDImagePixelFormat {
  */
 + (CGImageRef _Nullable)CGImageCreateDecoded:(_Nonnull CGImageRef)cgImage orientation:(CGImagePropertyOrientation)orientation CF_RETURNS_RETAINED;
 
+/**
+ Create a decoded CGImage by the provided CGImage, orientation and row alignment. This follows The Create Rule and you are response to call release after usage.
+ @note The other decode methods use `defaultRowAlignment`.
+
+ @param cgImage The CGImage
+ @param orientation The EXIF image orientation.
+ @param rowAlignment The row stride policy of the decoded bitmap
+ @return A new created decoded image
+ */
++ (CGImageRef _Nullable)CGImageCreateDecoded:(_Nonnull CGImageRef)cgImage orientation:(CGImagePropertyOrientation)orientation rowAlignment:(SDImageRowAlignment)rowAlignment CF_RETURNS_RETAINED;
+
 /**
  Create a scaled CGImage by the provided CGImage and size. This follows The Create Rule and you are response to call release after usage.
  It will detect whether the image size matching the scale size, if not, stretch the image to the target size.
@@ -163,6 +184,62 @@ typedef struct SDImagePixelFormat {
  */
 + (CGImageRef _Nullable)CGImageCreateScaled:(_Nonnull CGImageRef)cgImage size:(CGSize)size CF_RETURNS_RETAINED;
 
+/**
+ Create a scaled CGImage by the provided CGImage, size and row alignment. This follows The Create Rule and you are response to call release after usage.
+ @note The other scale methods use `defaultRowAlignment`.
+
+ @param cgImage The CGImage
+ @param size The scale size in pixel.
+ @param rowAlignment The row stride policy of the scaled bitmap
+ @return A new created scaled image
+ */
++ (CGImageRef _Nullable)CGImageCreateScaled:(_Nonnull CGImageRef)cgImage size:(CGSize)size rowAlignment:(SDImageRowAlignment)rowAlignment CF_RETURNS_RETAINED;
+
+/**
+ Calculate the bytesPerRow for the bitmap width with the row alignment.
+
+ @param width The bitmap width in pixel
+ @param bytesPerPixel The bytes per pixel, typically 4 for RGBA8888
+ @param rowAlignment The row stride policy
+ @return The bytesPerRow
+ */
++ (size_t)bytesPerRowWithWidth:(size_t)width bytesPerPixel:(size_t)bytesPerPixel rowAlignment:(SDImageRowAlignment)rowAlignment;
+
+/**
+ Create a normalized CGImage by the provided CGImage, which is in the preferred pixel format (see `preferredPixelFormat:`) with the preferred byte order, alpha info and byte-aligned row, so that it can be rendered without `CA::Render::copy_image`. This follows The Create Rule and you are response to call release after usage.
+ If the CGImage is already in the preferred pixel format, or it should not be converted (lazy, HDR, wide gamut or high bit depth, which loses the information after conversion, and grayscale or alpha only, which takes 4x memory after conversion), the same CGImage is retained and returned.
+ @note This is the decode-output normalizer used by all the built-in coders and transformers, see `normalizationConvertCount` for how many images needed conversion.
+ @note The output always uses `SDImageRowAlignmentPixelFormat` regardless of `defaultRowAlignment`, so the normalized image is never converted again.
+
+ @param cgImage The CGImage
+ @return A normalized CGImage
+ */
++ (CGImageRef _Nullable)CGImageCreateNormalized:(_Nonnull CGImageRef)cgImage CF_RETURNS_RETAINED;
+
+/**
+ Return the normalized image by the provided image, see `CGImageCreateNormalized:`. The scale, orientation and associated objects (like image format) are preserved.
+ @note Non-CGImage based, animated and vector images are returned directly.
+
+ @param image The image to be normalized
+ @return The normalized image
+ */
++ (UIImage * _Nullable)normalizedImageWithImage:(UIImage * _Nullable)image;
+
+/**
+ The number of CGImages checked by the normalizer (`CGImageCreateNormalized:`).
+ */
+@property (class, readonly) NSUInteger normalizationCheckCount;
+
+/**
+ The number of CGImages which needed conversion by the normalizer (`CGImageCreateNormalized:`). Without the normalizer, these images will be copied again by render server during display.
+ */
+@property (class, readonly) NSUInteger normalizationConvertCount;
+
+/**
+ Reset the normalization counters to zero.
+ */
++ (void)resetNormalizationStatistics;
+
 /** Scale the image size based on provided scale size, whether or not to preserve aspect ratio, whether or not to scale up.
  @note For example, if you implements thumnail decoding, pass `shouldScaleUp` to NO to avoid the calculated size larger than image size.
  
@@ -229,6 +306,19 @@ typedef struct SDImagePixelFormat {
  */
 @property (class, readwrite) NSUInteger defaultScaleDownLimitBytes;
 
+/**
+ Control the maximum number of tiles drawn concurrently, when scaling down largest images with Tile Decoding. Each worker draws one tile into its own rows of the destination bitmap at a time, so at most this number of tiles are in flight.
+ The tile size does not depend on this value, so the output is byte-identical for any concurrency. Set to 1 to draw the tiles serially on the calling thread, set to 0 to reset to default.
+ Defaults to `NSProcessInfo.activeProcessorCount`. The value is clamped to 4, because the tile memory is split for 4 tiles, so the tiles in flight use the same memory as the single tile of serial drawing.
+ */
+@property (class, readwrite) NSUInteger defaultScaleDownConcurrency;
+
+/**
+ Control the default row stride policy for the bitmap created by decode, scale and render (the CoreGraphics render on macOS, UIKit controls its own).
+ Defaults to `SDImageRowAlignmentPixelFormat`. The normalizer (`CGImageCreateNormalized:`) always uses `SDImageRowAlignmentPixelFormat`.
+ */
+@property (class, readwrite) SDImageRowAlignment defaultRowAlignment;
+
 #if SD_UIKIT || SD_WATCH
 /**
  Convert an EXIF image orientation to an iOS one.
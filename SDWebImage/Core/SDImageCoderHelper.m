@@ -19,7 +19,10 @@
 #import "SDInternalMacros.h"
 #import "SDDeviceHelper.h"
 #import "SDImageIOAnimatedCoderInternal.h"
+#import "SDImagePixelKernel.h"
+#import "SDImagePixelBufferPool.h"
 #import <Accelerate/Accelerate.h>
+#import <stdatomic.h>
 
 #define kCGColorSpaceDeviceRGB CFSTR("kCGColorSpaceDeviceRGB")
 
@@ -108,6 +111,30 @@ static UIImage * _Nonnull SDImageGetNonAlphaDummyImage(void) {
     return dummyImage;
 }
 
+// Scale the ARGB8888 buffer with the portable kernel, which only keeps a few filtered rows as the temporary memory
+static vImage_Error SDImageScaleARGB8888WithPixelKernel(const vImage_Buffer *inputBuffer, const vImage_Buffer *outputBuffer, CGImageAlphaInfo alphaInfo, CGImageByteOrderInfo byteOrderInfo) {
+    // The kernel filters each channel independently, the color need to be premultiplied to avoid the fringes around the transparent pixels
+    BOOL premultiply = alphaInfo == kCGImageAlphaFirst || alphaInfo == kCGImageAlphaLast;
+    BOOL alphaFirst = alphaInfo == kCGImageAlphaFirst || alphaInfo == kCGImageAlphaPremultipliedFirst || alphaInfo == kCGImageAlphaNoneSkipFirst;
+    // The 32-bit little endian reverse the bytes order in memory
+    if (byteOrderInfo == kCGImageByteOrder32Little) {
+        alphaFirst = !alphaFirst;
+    }
+    SDPixelAlphaPosition alphaPosition = alphaFirst ? SDPixelAlphaPositionFirst : SDPixelAlphaPositionLast;
+    SDPixelBuffer source = {inputBuffer->data, inputBuffer->width, inputBuffer->height, inputBuffer->rowBytes};
+    SDPixelBuffer destination = {outputBuffer->data, outputBuffer->width, outputBuffer->height, outputBuffer->rowBytes};
+    if (premultiply) {
+        SDPixelKernelPremultiply(&source, alphaPosition);
+    }
+    if (!SDPixelKernelResize(&source, &destination, SDPixelResizeFilterLanczos3)) {
+        return kvImageMemoryAllocationError;
+    }
+    if (premultiply) {
+        SDPixelKernelUnpremultiply(&destination, alphaPosition);
+    }
+    return kvImageNoError;
+}
+
 static SDImageCoderDecodeSolution kDefaultDecodeSolution = SDImageCoderDecodeSolutionAutomatic;
 
 static const size_t kBytesPerPixel = 4;
@@ -129,6 +156,12 @@ static CGFloat kDestImageLimitBytes = 30.f * kBytesPerMB;
 #endif
 
 static const CGFloat kDestSeemOverlap = 2.0f;   // the numbers of pixels to overlap the seems where tiles meet.
+static const NSUInteger kMaxTilesInFlight = 4; // the tile size is divided by this, so the tiles drawn concurrently use the same memory as one serial tile.
+static NSUInteger kScaleDownConcurrency = 0; // 0 means automatic
+static SDImageRowAlignment kDefaultRowAlignment = SDImageRowAlignmentPixelFormat;
+
+static atomic_ulong kNormalizationCheckCount;
+static atomic_ulong kNormalizationConvertCount;
 
 #if SD_MAC
 @interface SDAnimatedImageRep (Private)
@@ -440,6 +473,10 @@ static const CGFloat kDestSeemOverlap = 2.0f;   // the numbers of pixels to over
 }
 
 + (CGImageRef)CGImageCreateDecoded:(CGImageRef)cgImage orientation:(CGImagePropertyOrientation)orientation {
+    return [self CGImageCreateDecoded:cgImage orientation:orientation rowAlignment:self.defaultRowAlignment];
+}
+
++ (CGImageRef)CGImageCreateDecoded:(CGImageRef)cgImage orientation:(CGImagePropertyOrientation)orientation rowAlignment:(SDImageRowAlignment)rowAlignment {
     if (!cgImage) {
         return NULL;
     }
@@ -470,7 +507,10 @@ static const CGFloat kDestSeemOverlap = 2.0f;   // the numbers of pixels to over
     // Check #3330 for more detail about why this bitmap is choosen.
     // From v5.17.0, use runtime detection of bitmap info instead of hardcode.
     CGBitmapInfo bitmapInfo = [SDImageCoderHelper preferredPixelFormat:hasAlpha].bitmapInfo;
-    CGContextRef context = CGBitmapContextCreate(NULL, newWidth, newHeight, 8, 0, [self colorSpaceGetDeviceRGB], bitmapInfo);
+    // Use the pooled backing store, the decoded image shares it without copy
+    SDImagePixelBufferPool *pool = SDImagePixelBufferPool.sharedPool;
+    size_t bytesPerRow = [self bytesPerRowWithWidth:newWidth bytesPerPixel:kBytesPerPixel rowAlignment:rowAlignment];
+    CGContextRef context = [pool newBitmapContextWithWidth:newWidth height:newHeight bitsPerComponent:kBitsPerComponent bytesPerRow:bytesPerRow colorSpace:[self colorSpaceGetDeviceRGB] bitmapInfo:bitmapInfo];
     if (!context) {
         return NULL;
     }
@@ -479,13 +519,17 @@ static const CGFloat kDestSeemOverlap = 2.0f;   // the numbers of pixels to over
     CGAffineTransform transform = SDCGContextTransformFromOrientation(orientation, CGSizeMake(newWidth, newHeight));
     CGContextConcatCTM(context, transform);
     CGContextDrawImage(context, CGRectMake(0, 0, width, height), cgImage); // The rect is bounding box of CGImage, don't swap width & height
-    CGImageRef newImageRef = CGBitmapContextCreateImage(context);
+    CGImageRef newImageRef = [pool newImageFromBitmapContext:context];
     CGContextRelease(context);
     
     return newImageRef;
 }
 
 + (CGImageRef)CGImageCreateScaled:(CGImageRef)cgImage size:(CGSize)size {
+    return [self CGImageCreateScaled:cgImage size:size rowAlignment:self.defaultRowAlignment];
+}
+
++ (CGImageRef)CGImageCreateScaled:(CGImageRef)cgImage size:(CGSize)size rowAlignment:(SDImageRowAlignment)rowAlignment {
     if (!cgImage) {
         return NULL;
     }
@@ -531,9 +575,10 @@ static const CGFloat kDestSeemOverlap = 2.0f;   // the numbers of pixels to over
         alphaBitmapInfo |= kCGBitmapFloatComponents;
     }
     __block vImage_Buffer input_buffer = {}, output_buffer = {};
+    SDImagePixelBufferPool *pool = SDImagePixelBufferPool.sharedPool;
     @onExit {
         if (input_buffer.data) free(input_buffer.data);
-        if (output_buffer.data) free(output_buffer.data);
+        if (output_buffer.data) [pool recycleBuffer:output_buffer.data];
     };
     // Always provide alpha channel
     vImage_CGImageFormat format = (vImage_CGImageFormat) {
@@ -548,8 +593,11 @@ static const CGFloat kDestSeemOverlap = 2.0f;   // the numbers of pixels to over
     // input
     vImage_Error ret = vImageBuffer_InitWithCGImage(&input_buffer, &format, NULL, cgImage, kvImageNoFlags);
     if (ret != kvImageNoError) return NULL;
-    // output
-    vImageBuffer_Init(&output_buffer, size.height, size.width, (uint32_t)bitsPerComponent * components, kvImageNoFlags);
+    // output, the backing store is from pool
+    output_buffer.width = size.width;
+    output_buffer.height = size.height;
+    output_buffer.rowBytes = [self bytesPerRowWithWidth:output_buffer.width bytesPerPixel:bitsPerComponent * components / 8 rowAlignment:rowAlignment];
+    output_buffer.data = [pool acquireBufferWithLength:output_buffer.rowBytes * output_buffer.height];
     if (!output_buffer.data) return NULL;
     
     if (components == 4) {
@@ -559,6 +607,10 @@ static const CGFloat kDestSeemOverlap = 2.0f;   // the numbers of pixels to over
             ret = vImageScale_ARGB16U(&input_buffer, &output_buffer, NULL, kvImageHighQualityResampling);
         } else if (bitsPerComponent == 8) {
             ret = vImageScale_ARGB8888(&input_buffer, &output_buffer, NULL, kvImageHighQualityResampling);
+            if (ret == kvImageMemoryAllocationError) {
+                // vImage fails to allocate the temporary buffer for large image, fallback to the portable kernel
+                ret = SDImageScaleARGB8888WithPixelKernel(&input_buffer, &output_buffer, alphaInfo, byteOrderInfo);
+            }
         }
     } else {
         if (bitsPerComponent == 32) {
@@ -583,24 +635,89 @@ static const CGFloat kDestSeemOverlap = 2.0f;   // the numbers of pixels to over
         }
         if (ret != kvImageNoError) return NULL;
     }
-    vImage_CGImageFormat output_format = (vImage_CGImageFormat) {
-        .bitsPerComponent = (uint32_t)bitsPerComponent,
-        .bitsPerPixel = (uint32_t)bitsPerPixel,
-        .colorSpace = colorSpace,
-        .bitmapInfo = bitmapInfo,
-        .version = 0,
-        .decode = NULL,
-        .renderingIntent = renderingIntent
-    };
-    CGImageRef outputImage = vImageCreateCGImageFromBuffer(&output_buffer, &output_format, NULL, NULL, kvImageNoFlags, &ret);
-    if (ret != kvImageNoError) {
-        CGImageRelease(outputImage);
-        return NULL;
-    }
+    // The output image takes the ownership of pooled buffer without copy
+    CGDataProviderRef provider = [pool newDataProviderWithBuffer:output_buffer.data length:output_buffer.rowBytes * output_buffer.height];
+    if (!provider) return NULL;
+    output_buffer.data = NULL;
+    CGImageRef outputImage = CGImageCreate(output_buffer.width, output_buffer.height, bitsPerComponent, bitsPerPixel, output_buffer.rowBytes, colorSpace, bitmapInfo, provider, NULL, false, renderingIntent);
+    CGDataProviderRelease(provider);
     
     return outputImage;
 }
 
++ (CGImageRef)CGImageCreateNormalized:(CGImageRef)cgImage {
+    if (!cgImage) {
+        return NULL;
+    }
+    atomic_fetch_add_explicit(&kNormalizationCheckCount, 1, memory_order_relaxed);
+    if (![self shouldNormalizeCGImage:cgImage]) {
+        CGImageRetain(cgImage);
+        return cgImage;
+    }
+    // Always use the pixel format alignment, the output should pass `CGImageIsHardwareSupported:`, or it's converted again on each pass
+    CGImageRef normalizedImageRef = [self CGImageCreateDecoded:cgImage orientation:kCGImagePropertyOrientationUp rowAlignment:SDImageRowAlignmentPixelFormat];
+    if (!normalizedImageRef) {
+        CGImageRetain(cgImage);
+        return cgImage;
+    }
+    atomic_fetch_add_explicit(&kNormalizationConvertCount, 1, memory_order_relaxed);
+    return normalizedImageRef;
+}
+
++ (UIImage *)normalizedImageWithImage:(UIImage *)image {
+    if (!image || image.sd_isAnimated || image.sd_isVector) {
+        return image;
+    }
+    CGImageRef cgImage = image.CGImage;
+    if (!cgImage) {
+        return image;
+    }
+    CGImageRef normalizedImageRef = [self CGImageCreateNormalized:cgImage];
+    if (!normalizedImageRef) {
+        return image;
+    }
+    if (normalizedImageRef == cgImage) {
+        CGImageRelease(normalizedImageRef);
+        return image;
+    }
+#if SD_MAC
+    UIImage *normalizedImage = [[UIImage alloc] initWithCGImage:normalizedImageRef scale:image.scale orientation:kCGImagePropertyOrientationUp];
+#else
+    UIImage *normalizedImage = [[UIImage alloc] initWithCGImage:normalizedImageRef scale:image.scale orientation:image.imageOrientation];
+#endif
+    CGImageRelease(normalizedImageRef);
+    SDImageCopyAssociatedObject(image, normalizedImage);
+    normalizedImage.sd_isDecoded = YES;
+    return normalizedImage;
+}
+
++ (NSUInteger)normalizationCheckCount {
+    return atomic_load_explicit(&kNormalizationCheckCount, memory_order_relaxed);
+}
+
++ (NSUInteger)normalizationConvertCount {
+    return atomic_load_explicit(&kNormalizationConvertCount, memory_order_relaxed);
+}
+
++ (void)resetNormalizationStatistics {
+    atomic_store_explicit(&kNormalizationCheckCount, 0, memory_order_relaxed);
+    atomic_store_explicit(&kNormalizationConvertCount, 0, memory_order_relaxed);
+}
+
++ (size_t)bytesPerRowWithWidth:(size_t)width bytesPerPixel:(size_t)bytesPerPixel rowAlignment:(SDImageRowAlignment)rowAlignment {
+    size_t bytesPerRow = width * bytesPerPixel;
+    switch (rowAlignment) {
+        case SDImageRowAlignmentPixelFormat:
+            // https://github.com/path/FastImageCache#byte-alignment
+            return SDByteAlign(bytesPerRow, bytesPerPixel * 8);
+        case SDImageRowAlignmentCacheLine:
+            return SDByteAlign(bytesPerRow, 64);
+        case SDImageRowAlignmentNone:
+        default:
+            return bytesPerRow;
+    }
+}
+
 + (CGSize)scaledSizeWithImageSize:(CGSize)imageSize scaleSize:(CGSize)scaleSize preserveAspectRatio:(BOOL)preserveAspectRatio shouldScaleUp:(BOOL)shouldScaleUp {
     CGFloat width = imageSize.width;
     CGFloat height = imageSize.height;
@@ -795,14 +912,24 @@ static const CGFloat kDestSeemOverlap = 2.0f;   // the numbers of pixels to over
                                                          destResolution.width,
                                                          destResolution.height,
                                                          kBitsPerComponent,
-                                                         0,
+                                                         [self bytesPerRowWithWidth:destResolution.width bytesPerPixel:kBytesPerPixel rowAlignment:self.defaultRowAlignment],
                                                          colorspaceRef,
                                                          bitmapInfo);
         
         if (destContext == NULL) {
             return image;
         }
-        CGContextSetInterpolationQuality(destContext, kCGInterpolationHigh);
+        // Each tile draws into its own destination band which wraps the rows of destination bitmap, so the tiles can be drawn concurrently without lock.
+        uint8_t *destData = CGBitmapContextGetData(destContext);
+        size_t destBytesPerRow = CGBitmapContextGetBytesPerRow(destContext);
+        if (destData == NULL) {
+            CGContextRelease(destContext);
+            return image;
+        }
+        size_t destWidth = destResolution.width;
+        size_t destHeight = destResolution.height;
+        size_t sourceHeight = sourceResolution.height;
+        CGFloat scaleY = destResolution.height / sourceResolution.height;
         
         // Now define the size of the rectangle to be used for the
         // incremental bits from the input image to the output image.
@@ -813,48 +940,64 @@ static const CGFloat kDestSeemOverlap = 2.0f;   // the numbers of pixels to over
         // band. Therefore we fully utilize all of the pixel data that results
         // from a decoding operation by anchoring our tile size to the full
         // width of the input image.
-        CGRect sourceTile = CGRectZero;
-        sourceTile.size.width = sourceResolution.width;
         // The source tile height is dynamic. Since we specified the size
         // of the source tile in MB, see how many rows of pixels high it
-        // can be given the input image width.
-        sourceTile.size.height = MAX(1, (int)(tileTotalPixels / sourceTile.size.width));
-        sourceTile.origin.x = 0.0f;
-        // The output tile is the same proportions as the input tile, but
-        // scaled to image scale.
-        CGRect destTile;
-        destTile.size.width = destResolution.width;
-        destTile.size.height = sourceTile.size.height * imageScale;
-        destTile.origin.x = 0.0f;
+        // can be given the input image width. The tile size does not depend on concurrency, to keep the output identical.
+        size_t sourceTileHeight = MAX(1, (size_t)(tileTotalPixels / kMaxTilesInFlight / sourceResolution.width));
+        size_t destTileHeight = MAX(1, (size_t)(sourceTileHeight * scaleY));
         // The source seem overlap is proportionate to the destination seem overlap.
-        // this is the amount of pixels to overlap each tile as we assemble the output image.
-        float sourceSeemOverlap = (int)((kDestSeemOverlap/destResolution.height)*sourceResolution.height);
-        CGImageRef sourceTileImageRef;
+        // Each tile reads the extra source rows around its band, so the resampling filter does not see the tile edge.
+        size_t sourceSeemOverlap = (size_t)ceil(kDestSeemOverlap / scaleY);
         // calculate the number of read/write operations required to assemble the
         // output image.
-        int iterations = (int)( sourceResolution.height / sourceTile.size.height );
-        // If tile height doesn't divide the image height evenly, add another iteration
-        // to account for the remaining pixels.
-        int remainder = (int)sourceResolution.height % (int)sourceTile.size.height;
-        if(remainder) {
-            iterations++;
-        }
-        // Add seem overlaps to the tiles, but save the original tile height for y coordinate calculations.
-        float sourceTileHeightMinusOverlap = sourceTile.size.height;
-        sourceTile.size.height += sourceSeemOverlap;
-        destTile.size.height += kDestSeemOverlap;
-        for( int y = 0; y < iterations; ++y ) {
-            sourceTile.origin.y = y * sourceTileHeightMinusOverlap + sourceSeemOverlap;
-            destTile.origin.y = destResolution.height - (( y + 1 ) * sourceTileHeightMinusOverlap * imageScale + kDestSeemOverlap);
-            sourceTileImageRef = CGImageCreateWithImageInRect( sourceImageRef, sourceTile );
-            if( y == iterations - 1 && remainder ) {
-                float dify = destTile.size.height;
-                destTile.size.height = CGImageGetHeight( sourceTileImageRef ) * imageScale + kDestSeemOverlap;
-                dify -= destTile.size.height;
-                destTile.origin.y = MIN(0, destTile.origin.y + dify);
+        size_t iterations = (destHeight + destTileHeight - 1) / destTileHeight;
+        size_t concurrency = MIN(MAX(self.defaultScaleDownConcurrency, 1), iterations);
+        
+        void(^drawTile)(size_t) = ^(size_t y) {
+            size_t destTileMinY = y * destTileHeight;
+            size_t destTileMaxY = MIN(destTileMinY + destTileHeight, destHeight);
+            size_t bandHeight = destTileMaxY - destTileMinY;
+            size_t sourceTileMinY = (size_t)floor(destTileMinY / scaleY);
+            sourceTileMinY = sourceTileMinY > sourceSeemOverlap ? sourceTileMinY - sourceSeemOverlap : 0;
+            size_t sourceTileMaxY = MIN((size_t)ceil(destTileMaxY / scaleY) + sourceSeemOverlap, sourceHeight);
+            CGContextRef bandContext = CGBitmapContextCreate(destData + destTileMinY * destBytesPerRow,
+                                                             destWidth,
+                                                             bandHeight,
+                                                             kBitsPerComponent,
+                                                             destBytesPerRow,
+                                                             colorspaceRef,
+                                                             bitmapInfo);
+            if (!bandContext) {
+                return;
             }
-            CGContextDrawImage( destContext, destTile, sourceTileImageRef );
-            CGImageRelease( sourceTileImageRef );
+            CGContextSetInterpolationQuality(bandContext, kCGInterpolationHigh);
+            CGRect sourceTile = CGRectMake(0, sourceTileMinY, sourceResolution.width, sourceTileMaxY - sourceTileMinY);
+            CGImageRef sourceTileImageRef = CGImageCreateWithImageInRect(sourceImageRef, sourceTile);
+            if (sourceTileImageRef) {
+                // The band context's origin is bottom-left, place the source tile at its exact position in destination
+                CGFloat destTileTop = sourceTileMinY * scaleY - destTileMinY;
+                CGFloat destTileHeightWithOverlap = (sourceTileMaxY - sourceTileMinY) * scaleY;
+                CGRect destTile = CGRectMake(0, bandHeight - (destTileTop + destTileHeightWithOverlap), destWidth, destTileHeightWithOverlap);
+                CGContextDrawImage(bandContext, destTile, sourceTileImageRef);
+                CGImageRelease(sourceTileImageRef);
+            }
+            CGContextRelease(bandContext);
+        };
+        if (concurrency == 1) {
+            for (size_t y = 0; y < iterations; y++) {
+                @autoreleasepool {
+                    drawTile(y);
+                }
+            }
+        } else {
+            // Each worker draws one tile at a time, so at most `concurrency` tiles are in flight to bound the memory
+            dispatch_apply(concurrency, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t worker) {
+                for (size_t y = worker; y < iterations; y += concurrency) {
+                    @autoreleasepool {
+                        drawTile(y);
+                    }
+                }
+            });
         }
         
         CGImageRef destImageRef = CGBitmapContextCreateImage(destContext);
@@ -893,6 +1036,26 @@ static const CGFloat kDestSeemOverlap = 2.0f;   // the numbers of pixels to over
     kDestImageLimitBytes = defaultScaleDownLimitBytes;
 }
 
++ (NSUInteger)defaultScaleDownConcurrency {
+    if (kScaleDownConcurrency > 0) {
+        return kScaleDownConcurrency;
+    }
+    return MIN(MAX(NSProcessInfo.processInfo.activeProcessorCount, 1), kMaxTilesInFlight);
+}
+
++ (void)setDefaultScaleDownConcurrency:(NSUInteger)defaultScaleDownConcurrency {
+    // The tile memory is split for at most `kMaxTilesInFlight` tiles, more workers would exceed the limit bytes
+    kScaleDownConcurrency = MIN(defaultScaleDownConcurrency, kMaxTilesInFlight);
+}
+
++ (SDImageRowAlignment)defaultRowAlignment {
+    return kDefaultRowAlignment;
+}
+
++ (void)setDefaultRowAlignment:(SDImageRowAlignment)defaultRowAlignment {
+    kDefaultRowAlignment = defaultRowAlignment;
+}
+
 #if SD_UIKIT || SD_WATCH
 // Convert an EXIF image orientation to an iOS one.
 + (UIImageOrientation)imageOrientationFromEXIFOrientation:(CGImagePropertyOrientation)exifOrientation {
@@ -1012,6 +1175,45 @@ static const CGFloat kDestSeemOverlap = 2.0f;   // the numbers of pixels to over
     return YES;
 }
 
++ (BOOL)shouldNormalizeCGImage:(nonnull CGImageRef)cgImage {
+    // Lazy CGImage is decoded by force decode or render server, the decode output is the system preferred
+    if ([self CGImageIsLazy:cgImage]) {
+        return NO;
+    }
+    // Our redraw is 8 bits per components in device RGB, keep HDR, wide gamut and high bit depth
+    if ([self CGImageIsHDR:cgImage]) {
+        return NO;
+    }
+    if (CGImageGetBitsPerComponent(cgImage) > 8) {
+        return NO;
+    }
+    CGColorSpaceRef colorSpace = CGImageGetColorSpace(cgImage);
+    if (!colorSpace) {
+        // Alpha mask only
+        return NO;
+    }
+    if (CGColorSpaceGetModel(colorSpace) == kCGColorSpaceModelMonochrome) {
+        // Grayscale is rendered directly, the redraw expands the single channel to 4 channels (4x memory)
+        return NO;
+    }
+    if (@available(iOS 12.0, tvOS 12.0, macOS 10.14, watchOS 5.0, *)) {
+        if (CGColorSpaceIsWideGamutRGB(colorSpace)) {
+            return NO;
+        }
+    }
+    // Check byte order and alpha info
+    BOOL hasAlpha = [self CGImageContainsAlpha:cgImage];
+    SDImagePixelFormat pixelFormat = [self preferredPixelFormat:hasAlpha];
+    if (!SD_OPTIONS_CONTAINS(pixelFormat.bitmapInfo, kCGBitmapFloatComponents)) {
+        CGBitmapInfo mask = kCGBitmapAlphaInfoMask | kCGBitmapByteOrderMask | kCGBitmapFloatComponents;
+        if (CGImageGetBitsPerPixel(cgImage) != 32 || (CGImageGetBitmapInfo(cgImage) & mask) != (pixelFormat.bitmapInfo & mask)) {
+            return YES;
+        }
+    }
+    // Check row alignment and color space
+    return ![self CGImageIsHardwareSupported:cgImage];
+}
+
 + (BOOL)shouldScaleDownImagePixelSize:(CGSize)sourceResolution limitBytes:(NSUInteger)bytes {
     BOOL shouldScaleDown = YES;
     
@@ -0,0 +1,60 @@
+/*
+ * This file is part of the SDWebImage package.
+ * (c) Olivier Poitrey <rs@dailymotion.com>
+ *
+ * For the full copyright and license information, please view the LICENSE
+ * file that was distributed with this source code.
+ */
+
+#import "SDWebImageCompat.h"
+
+/// SDImageDecodeExecutor is a bounded executor to run the image decoding work, shared by all the download operations.
+/// Decoding is CPU and memory intensive, so instead of each download operation decoding in parallel, all the decoding work is submitted into this executor, whose concurrency is limited to the processor count.
+@interface SDImageDecodeExecutor : NSObject
+
+/// The shared executor used by `SDWebImageDownloaderOperation`.
+@property (nonnull, class, readonly) SDImageDecodeExecutor *sharedExecutor;
+
+/// The maximum number of decoding work run concurrently.
+/// Defaults to `NSProcessInfo.activeProcessorCount`.
+@property (nonatomic, assign) NSInteger maxConcurrentDecodeCount;
+
+/// The maximum number of pending decoding work, before the executor is marked as saturated. Optional decoding work (like progressive decoding) should be skipped when saturated, to apply backpressure.
+/// Defaults to 4 times of `maxConcurrentDecodeCount` at initialization.
+@property (nonatomic, assign) NSUInteger maxPendingDecodeCount;
+
+/// The current number of decoding work which is submitted but not finished, which is the queue depth.
+@property (nonatomic, assign, readonly) NSUInteger pendingDecodeCount;
+
+/// Whether the `pendingDecodeCount` reaches `maxPendingDecodeCount`.
+@property (nonatomic, assign, readonly, getter=isSaturated) BOOL saturated;
+
+/// The total number of finished decoding work (cancelled work is not counted).
+@property (nonatomic, assign, readonly) NSUInteger finishedDecodeCount;
+
+/// The total time (in seconds) spent on finished decoding work.
+@property (nonatomic, assign, readonly) NSTimeInterval totalDecodeDuration;
+
+/// The longest time (in seconds) spent on single decoding work.
+@property (nonatomic, assign, readonly) NSTimeInterval maxDecodeDuration;
+
+/// Create the executor with the concurrency.
+/// - Parameter maxConcurrentDecodeCount: The maximum number of decoding work run concurrently. Pass 0 to use processor count.
+- (nonnull instancetype)initWithMaxConcurrentDecodeCount:(NSInteger)maxConcurrentDecodeCount NS_DESIGNATED_INITIALIZER;
+
+/// Submits a decoding block for execution.
+/// - Parameters:
+///   - block: The block that contains the decoding work to perform.
+///   - dependencies: The operations should finish before this block executes, used to keep the order of decoding work from the same download. Can be nil.
+///   - queuePriority: The priority in the executor, typically inherited from the download operation.
+///   - qualityOfService: The quality of service for the block, typically inherited from the download operation.
+/// - Returns: The operation represents the decoding work, which can be cancelled.
+- (nonnull NSOperation *)addDecodeBlock:(nonnull dispatch_block_t)block
+                           dependencies:(nullable NSArray<NSOperation *> *)dependencies
+                          queuePriority:(NSOperationQueuePriority)queuePriority
+                       qualityOfService:(NSQualityOfService)qualityOfService;
+
+/// Reset the decoding metrics, `pendingDecodeCount` is not effected.
+- (void)resetMetrics;
+
+@end
@@ -0,0 +1,157 @@
+/*
+ * This file is part of the SDWebImage package.
+ * (c) Olivier Poitrey <rs@dailymotion.com>
+ *
+ * For the full copyright and license information, please view the LICENSE
+ * file that was distributed with this source code.
+ */
+
+#import "SDImageDecodeExecutor.h"
+#import "SDInternalMacros.h"
+
+@interface SDImageDecodeExecutor ()
+
+@property (nonatomic, strong, nonnull) NSOperationQueue *decodeQueue;
+@property (nonatomic, assign, readwrite) NSUInteger pendingDecodeCount;
+@property (nonatomic, assign, readwrite) NSUInteger finishedDecodeCount;
+@property (nonatomic, assign, readwrite) NSTimeInterval totalDecodeDuration;
+@property (nonatomic, assign, readwrite) NSTimeInterval maxDecodeDuration;
+
+@end
+
+@implementation SDImageDecodeExecutor {
+    SD_LOCK_DECLARE(_metricsLock); // A lock to keep the access to metrics thread-safe
+}
+
++ (SDImageDecodeExecutor *)sharedExecutor {
+    static dispatch_once_t onceToken;
+    static SDImageDecodeExecutor *executor;
+    dispatch_once(&onceToken, ^{
+        executor = [[SDImageDecodeExecutor alloc] init];
+    });
+    return executor;
+}
+
+- (instancetype)init {
+    return [self initWithMaxConcurrentDecodeCount:0];
+}
+
+- (instancetype)initWithMaxConcurrentDecodeCount:(NSInteger)maxConcurrentDecodeCount {
+    self = [super init];
+    if (self) {
+        if (maxConcurrentDecodeCount <= 0) {
+            maxConcurrentDecodeCount = MAX(NSProcessInfo.processInfo.activeProcessorCount, 1);
+        }
+        _decodeQueue = [NSOperationQueue new];
+        _decodeQueue.maxConcurrentOperationCount = maxConcurrentDecodeCount;
+        _decodeQueue.name = @"com.hackemist.SDImageDecodeExecutor.decodeQueue";
+        _maxPendingDecodeCount = maxConcurrentDecodeCount * 4;
+        SD_LOCK_INIT(_metricsLock);
+    }
+    return self;
+}
+
+#pragma mark - Properties
+
+- (NSInteger)maxConcurrentDecodeCount {
+    return self.decodeQueue.maxConcurrentOperationCount;
+}
+
+- (void)setMaxConcurrentDecodeCount:(NSInteger)maxConcurrentDecodeCount {
+    if (maxConcurrentDecodeCount <= 0) {
+        maxConcurrentDecodeCount = MAX(NSProcessInfo.processInfo.activeProcessorCount, 1);
+    }
+    self.decodeQueue.maxConcurrentOperationCount = maxConcurrentDecodeCount;
+}
+
+- (NSUInteger)pendingDecodeCount {
+    SD_LOCK(_metricsLock);
+    NSUInteger pendingDecodeCount = _pendingDecodeCount;
+    SD_UNLOCK(_metricsLock);
+    return pendingDecodeCount;
+}
+
+- (BOOL)isSaturated {
+    return self.pendingDecodeCount >= self.maxPendingDecodeCount;
+}
+
+- (NSUInteger)finishedDecodeCount {
+    SD_LOCK(_metricsLock);
+    NSUInteger finishedDecodeCount = _finishedDecodeCount;
+    SD_UNLOCK(_metricsLock);
+    return finishedDecodeCount;
+}
+
+- (NSTimeInterval)totalDecodeDuration {
+    SD_LOCK(_metricsLock);
+    NSTimeInterval totalDecodeDuration = _totalDecodeDuration;
+    SD_UNLOCK(_metricsLock);
+    return totalDecodeDuration;
+}
+
+- (NSTimeInterval)maxDecodeDuration {
+    SD_LOCK(_metricsLock);
+    NSTimeInterval maxDecodeDuration = _maxDecodeDuration;
+    SD_UNLOCK(_metricsLock);
+    return maxDecodeDuration;
+}
+
+#pragma mark - Execution
+
+- (NSOperation *)addDecodeBlock:(dispatch_block_t)block dependencies:(NSArray<NSOperation *> *)dependencies queuePriority:(NSOperationQueuePriority)queuePriority qualityOfService:(NSQualityOfService)qualityOfService {
+    NSParameterAssert(block);
+    SD_LOCK(_metricsLock);
+    _pendingDecodeCount += 1;
+    SD_UNLOCK(_metricsLock);
+    
+    @weakify(self);
+    NSBlockOperation *operation = [NSBlockOperation new];
+    __weak NSBlockOperation *weakOperation = operation;
+    [operation addExecutionBlock:^{
+        @strongify(self);
+        if (weakOperation.isCancelled) {
+            return;
+        }
+        CFAbsoluteTime startTime = CFAbsoluteTimeGetCurrent();
+        block();
+        NSTimeInterval duration = CFAbsoluteTimeGetCurrent() - startTime;
+        if (!self) {
+            return;
+        }
+        SD_LOCK(self->_metricsLock);
+        self->_finishedDecodeCount += 1;
+        self->_totalDecodeDuration += duration;
+        self->_maxDecodeDuration = MAX(self->_maxDecodeDuration, duration);
+        SD_UNLOCK(self->_metricsLock);
+    }];
+    // Cancelled operation does not execute the block, so decrease the pending count in completion block
+    operation.completionBlock = ^{
+        @strongify(self);
+        if (!self) {
+            return;
+        }
+        SD_LOCK(self->_metricsLock);
+        if (self->_pendingDecodeCount > 0) {
+            self->_pendingDecodeCount -= 1;
+        }
+        SD_UNLOCK(self->_metricsLock);
+    };
+    for (NSOperation *dependency in dependencies) {
+        [operation addDependency:dependency];
+    }
+    operation.queuePriority = queuePriority;
+    operation.qualityOfService = qualityOfService;
+    [self.decodeQueue addOperation:operation];
+    
+    return operation;
+}
+
+- (void)resetMetrics {
+    SD_LOCK(_metricsLock);
+    _finishedDecodeCount = 0;
+    _totalDecodeDuration = 0;
+    _maxDecodeDuration = 0;
+    SD_UNLOCK(_metricsLock);
+}
+
+@end
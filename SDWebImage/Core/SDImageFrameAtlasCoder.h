@@ -0,0 +1,47 @@
+/*
+ * This file is part of the SDWebImage package.
+ * (c) Olivier Poitrey <rs@dailymotion.com>
+ *
+ * For the full copyright and license information, please view the LICENSE
+ * file that was distributed with this source code.
+ */
+
+#import <Foundation/Foundation.h>
+#import "SDImageCoder.h"
+
+/**
+ The original image data (NSData) which the frame atlas is rendered from. If provided, `animatedImageData` returns it, so the image can be exported or re-encoded as the original format. Otherwise `animatedImageData` returns nil.
+ Defaults to nil.
+ */
+FOUNDATION_EXPORT SDImageCoderOption _Nonnull const SDImageFrameAtlasCoderSourceData;
+
+/**
+ The frame atlas coder for the pre-rendered animation frames. The frame atlas is a compact uncompressed container which stores all the frames in the preferred pixel format (see `SDImageCoderHelper.preferredPixelFormat:`), with the durations and loop count.
+ The frame is created directly from the atlas bytes without any codec work, so use the memory mapped data (`NSDataReadingMappedIfSafe`) to let the kernel page in the frames on demand.
+ This is designed for small looping animations like stickers and emoji, which are played again and again. `SDImageCache` use this to persist the frame atlas next to the disk cache entry, see `SDImageCacheConfig.frameAtlasLimitBytes`.
+ @note The frame atlas is a device local cache format, it's not registered in `SDImageCodersManager` by default and can not be encoded from image.
+ */
+@interface SDImageFrameAtlasCoder : NSObject <SDAnimatedImageCoder>
+
+@property (nonatomic, class, readonly, nonnull) SDImageFrameAtlasCoder *sharedCoder;
+
+/**
+ Render all the frames of the animated provider into the frame atlas data. The frames are drawn at the first frame's pixel size.
+
+ @param provider The animated provider, such as `SDAnimatedImage`
+ @param limitBytes The max bytes of frame atlas, 0 means no limit
+ @return The frame atlas data, or nil if the provider is not animated, or frame decoding failed, or exceed the limit bytes
+ */
++ (nullable NSData *)frameAtlasDataWithAnimatedProvider:(nonnull id<SDAnimatedImageProvider>)provider limitBytes:(NSUInteger)limitBytes;
+
+/**
+ The raw frame atlas data which this coder decodes from. Unlike `animatedImageData`, this is only readable by the frame atlas coder.
+ */
+@property (nonatomic, strong, readonly, nullable) NSData *frameAtlasData;
+
+/**
+ The image scale of the frames when the frame atlas is created, used as the default scale factor when decoding.
+ */
+@property (nonatomic, assign, readonly) CGFloat scale;
+
+@end
@@ -0,0 +1,287 @@
+/*
+ * This file is part of the SDWebImage package.
+ * (c) Olivier Poitrey <rs@dailymotion.com>
+ *
+ * For the full copyright and license information, please view the LICENSE
+ * file that was distributed with this source code.
+ */
+
+#import "SDImageFrameAtlasCoder.h"
+#import "SDImageCoderHelper.h"
+#import "SDImageFrame.h"
+#import "UIImage+ForceDecode.h"
+#import "UIImage+Metadata.h"
+#import "NSImage+Compatibility.h"
+#import "NSData+ImageContentType.h"
+
+static const uint32_t kSDFrameAtlasMagic = 0x41464453; // "SDFA" in little endian
+static const uint32_t kSDFrameAtlasVersion = 2;
+// The pixel data start is aligned to the cache line
+static const size_t kSDFrameAtlasPixelAlignment = 64;
+
+// The atlas is a device local cache, so use the native byte order
+typedef struct SDFrameAtlasHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t width;
+    uint32_t height;
+    uint32_t bytesPerRow;
+    uint32_t bitmapInfo;
+    uint32_t frameCount;
+    uint32_t loopCount;
+    uint32_t rowAlignment;
+    uint32_t reserved;
+    double scale;
+    // Followed by `double durations[frameCount]`, then the frames bitmap from the aligned offset
+} SDFrameAtlasHeader;
+
+// Calculate the pixel data offset and the total length of atlas, return false if overflow (the frame count is from file, and size_t is 32 bits on watchOS)
+static inline bool SDFrameAtlasGetLayout(size_t bytesPerRow, size_t height, size_t frameCount, size_t *pixelOffset, size_t *frameBytes, size_t *totalBytes) {
+    size_t durationBytes, headerBytes, pixelBytes;
+    if (__builtin_mul_overflow(sizeof(double), frameCount, &durationBytes)
+        || __builtin_add_overflow(sizeof(SDFrameAtlasHeader), durationBytes, &headerBytes)
+        || __builtin_add_overflow(headerBytes, kSDFrameAtlasPixelAlignment - 1, &headerBytes)
+        || __builtin_mul_overflow(bytesPerRow, height, frameBytes)
+        || __builtin_mul_overflow(*frameBytes, frameCount, &pixelBytes)) {
+        return false;
+    }
+    *pixelOffset = headerBytes / kSDFrameAtlasPixelAlignment * kSDFrameAtlasPixelAlignment;
+    return !__builtin_add_overflow(*pixelOffset, pixelBytes, totalBytes);
+}
+
+static void SDFrameAtlasReleaseData(void *info, const void *data, size_t size) {
+    if (info) {
+        CFRelease(info);
+    }
+}
+
+SDImageCoderOption const SDImageFrameAtlasCoderSourceData = @"frameAtlasSourceData";
+
+@implementation SDImageFrameAtlasCoder {
+    NSData *_atlasData;
+    NSData *_sourceData;
+    SDFrameAtlasHeader _header;
+    const double *_durations;
+    size_t _pixelOffset;
+    CGFloat _scale;
+}
+
++ (SDImageFrameAtlasCoder *)sharedCoder {
+    static SDImageFrameAtlasCoder *coder;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        coder = [[SDImageFrameAtlasCoder alloc] init];
+    });
+    return coder;
+}
+
+#pragma mark - Encode Atlas
+
++ (NSData *)frameAtlasDataWithAnimatedProvider:(id<SDAnimatedImageProvider>)provider limitBytes:(NSUInteger)limitBytes {
+    NSUInteger frameCount = provider.animatedImageFrameCount;
+    if (frameCount <= 1 || frameCount > UINT32_MAX) {
+        return nil;
+    }
+    UIImage *posterFrame = [provider animatedImageFrameAtIndex:0];
+    CGImageRef posterImageRef = posterFrame.CGImage;
+    if (!posterImageRef) {
+        return nil;
+    }
+    size_t width = CGImageGetWidth(posterImageRef);
+    size_t height = CGImageGetHeight(posterImageRef);
+    if (width == 0 || height == 0 || width > UINT32_MAX || height > UINT32_MAX) {
+        return nil;
+    }
+    SDImagePixelFormat pixelFormat = [SDImageCoderHelper preferredPixelFormat:YES];
+    SDImageRowAlignment rowAlignment = SDImageCoderHelper.defaultRowAlignment;
+    size_t bytesPerRow = [SDImageCoderHelper bytesPerRowWithWidth:width bytesPerPixel:4 rowAlignment:rowAlignment];
+    size_t pixelOffset, frameBytes, totalBytes;
+    if (bytesPerRow > UINT32_MAX || !SDFrameAtlasGetLayout(bytesPerRow, height, frameCount, &pixelOffset, &frameBytes, &totalBytes)) {
+        return nil;
+    }
+    if (limitBytes > 0 && totalBytes > limitBytes) {
+        return nil;
+    }
+    NSMutableData *atlasData = [NSMutableData dataWithLength:totalBytes];
+    if (!atlasData) {
+        return nil;
+    }
+    uint8_t *bytes = atlasData.mutableBytes;
+    SDFrameAtlasHeader *header = (SDFrameAtlasHeader *)bytes;
+    header->magic = kSDFrameAtlasMagic;
+    header->version = kSDFrameAtlasVersion;
+    header->width = (uint32_t)width;
+    header->height = (uint32_t)height;
+    header->bytesPerRow = (uint32_t)bytesPerRow;
+    header->bitmapInfo = pixelFormat.bitmapInfo;
+    header->frameCount = (uint32_t)frameCount;
+    header->loopCount = (uint32_t)MIN(provider.animatedImageLoopCount, UINT32_MAX);
+    header->rowAlignment = (uint32_t)rowAlignment;
+    header->scale = posterFrame.scale;
+    double *durations = (double *)(bytes + sizeof(SDFrameAtlasHeader));
+
+    CGColorSpaceRef colorSpace = [SDImageCoderHelper colorSpaceGetDeviceRGB];
+    for (NSUInteger i = 0; i < frameCount; i++) {
+        @autoreleasepool {
+            UIImage *frame = i == 0 ? posterFrame : [provider animatedImageFrameAtIndex:i];
+            CGImageRef frameImageRef = frame.CGImage;
+            if (!frameImageRef) {
+                return nil;
+            }
+            durations[i] = [provider animatedImageDurationAtIndex:i];
+            CGContextRef context = CGBitmapContextCreate(bytes + pixelOffset + frameBytes * i, width, height, 8, bytesPerRow, colorSpace, pixelFormat.bitmapInfo);
+            if (!context) {
+                return nil;
+            }
+            CGContextDrawImage(context, CGRectMake(0, 0, width, height), frameImageRef);
+            CGContextRelease(context);
+        }
+    }
+
+    return atlasData;
+}
+
+#pragma mark - Decode
+- (BOOL)canDecodeFromData:(nullable NSData *)data {
+    if (data.length < sizeof(SDFrameAtlasHeader)) {
+        return NO;
+    }
+    const SDFrameAtlasHeader *header = data.bytes;
+    return header->magic == kSDFrameAtlasMagic && header->version == kSDFrameAtlasVersion;
+}
+
+- (UIImage *)decodedImageWithData:(NSData *)data options:(nullable SDImageCoderOptions *)options {
+    SDImageFrameAtlasCoder *coder = [[SDImageFrameAtlasCoder alloc] initWithAnimatedImageData:data options:options];
+    if (!coder) {
+        return nil;
+    }
+    BOOL decodeFirstFrame = [options[SDImageCoderDecodeFirstFrameOnly] boolValue];
+    if (decodeFirstFrame) {
+        return [coder animatedImageFrameAtIndex:0];
+    }
+    NSUInteger frameCount = coder.animatedImageFrameCount;
+    NSMutableArray<SDImageFrame *> *frames = [NSMutableArray arrayWithCapacity:frameCount];
+    for (NSUInteger i = 0; i < frameCount; i++) {
+        UIImage *image = [coder animatedImageFrameAtIndex:i];
+        if (!image) {
+            return nil;
+        }
+        [frames addObject:[SDImageFrame frameWithImage:image duration:[coder animatedImageDurationAtIndex:i]]];
+    }
+    UIImage *animatedImage = [SDImageCoderHelper animatedImageWithFrames:frames];
+    animatedImage.sd_imageLoopCount = coder.animatedImageLoopCount;
+    NSData *sourceData = options[SDImageFrameAtlasCoderSourceData];
+    if (sourceData) {
+        animatedImage.sd_imageFormat = [NSData sd_imageFormatForImageData:sourceData];
+    }
+    return animatedImage;
+}
+
+#pragma mark - Encode
+- (BOOL)canEncodeToFormat:(SDImageFormat)format {
+    // The frame atlas is created from animated provider, see `frameAtlasDataWithAnimatedProvider:limitBytes:`
+    return NO;
+}
+
+- (NSData *)encodedDataWithImage:(UIImage *)image format:(SDImageFormat)format options:(nullable SDImageCoderOptions *)options {
+    return nil;
+}
+
+#pragma mark - SDAnimatedImageCoder
+- (nullable instancetype)initWithAnimatedImageData:(nullable NSData *)data options:(nullable SDImageCoderOptions *)options {
+    if (![self canDecodeFromData:data]) {
+        return nil;
+    }
+    self = [super init];
+    if (self) {
+        const SDFrameAtlasHeader *header = data.bytes;
+        if (header->width == 0 || header->height == 0 || header->frameCount == 0 || header->rowAlignment > SDImageRowAlignmentNone) {
+            return nil;
+        }
+        size_t minBytesPerRow;
+        if (__builtin_mul_overflow((size_t)header->width, (size_t)4, &minBytesPerRow)) {
+            return nil;
+        }
+        // The bytesPerRow must be the one calculated at write time, a corrupted value may read out of the frame
+        if (header->bytesPerRow < minBytesPerRow || header->bytesPerRow != [SDImageCoderHelper bytesPerRowWithWidth:header->width bytesPerPixel:4 rowAlignment:header->rowAlignment]) {
+            return nil;
+        }
+        size_t pixelOffset, frameBytes, totalBytes;
+        if (!SDFrameAtlasGetLayout(header->bytesPerRow, header->height, header->frameCount, &pixelOffset, &frameBytes, &totalBytes)) {
+            return nil;
+        }
+        if (data.length < totalBytes) {
+            // Truncated
+            return nil;
+        }
+        _atlasData = data;
+        _sourceData = options[SDImageFrameAtlasCoderSourceData];
+        _header = *header;
+        _durations = (const double *)((const uint8_t *)data.bytes + sizeof(SDFrameAtlasHeader));
+        _pixelOffset = pixelOffset;
+        CGFloat scale = header->scale;
+        NSNumber *scaleFactor = options[SDImageCoderDecodeScaleFactor];
+        if (scaleFactor != nil) {
+            scale = [scaleFactor doubleValue];
+        }
+        _scale = MAX(scale, 1);
+    }
+    return self;
+}
+
+- (CGFloat)scale {
+    return _scale;
+}
+
+- (NSData *)frameAtlasData {
+    return _atlasData;
+}
+
+- (NSData *)animatedImageData {
+    // The atlas is not readable by other coders, so export the original image data instead
+    return _sourceData;
+}
+
+- (NSUInteger)animatedImageFrameCount {
+    return _header.frameCount;
+}
+
+- (NSUInteger)animatedImageLoopCount {
+    return _header.loopCount;
+}
+
+- (NSTimeInterval)animatedImageDurationAtIndex:(NSUInteger)index {
+    if (index >= _header.frameCount) {
+        return 0;
+    }
+    return _durations[index];
+}
+
+- (UIImage *)animatedImageFrameAtIndex:(NSUInteger)index {
+    if (index >= _header.frameCount) {
+        return nil;
+    }
+    size_t frameBytes = (size_t)_header.bytesPerRow * _header.height;
+    const uint8_t *frameData = (const uint8_t *)_atlasData.bytes + _pixelOffset + frameBytes * index;
+    // The frame keeps the atlas data alive, no copy
+    CGDataProviderRef provider = CGDataProviderCreateWithData((__bridge_retained void *)_atlasData, frameData, frameBytes, SDFrameAtlasReleaseData);
+    if (!provider) {
+        return nil;
+    }
+    CGImageRef imageRef = CGImageCreate(_header.width, _header.height, 8, 32, _header.bytesPerRow, [SDImageCoderHelper colorSpaceGetDeviceRGB], _header.bitmapInfo, provider, NULL, false, kCGRenderingIntentDefault);
+    CGDataProviderRelease(provider);
+    if (!imageRef) {
+        return nil;
+    }
+#if SD_MAC
+    UIImage *image = [[UIImage alloc] initWithCGImage:imageRef scale:_scale orientation:kCGImagePropertyOrientationUp];
+#else
+    UIImage *image = [[UIImage alloc] initWithCGImage:imageRef scale:_scale orientation:UIImageOrientationUp];
+#endif
+    CGImageRelease(imageRef);
+    // Already in the preferred pixel format, no need to force decode again
+    image.sd_isDecoded = YES;
+    return image;
+}
+
+@end
@@ -9,6 +9,7 @@
 #import "SDImageGraphics.h"
 #import "NSImage+Compatibility.h"
 #import "SDImageCoderHelper.h"
+#import "SDImagePixelBufferPool.h"
 #import "objc/runtime.h"
 
 #if SD_MAC
@@ -41,7 +42,9 @@ static CGContextRef SDCGContextCreateBitmapContext(CGSize size, BOOL opaque, CGF
     } else {
         bitmapInfo = kCGBitmapByteOrderDefault | kCGImageAlphaNoneSkipLast;
     }
-    CGContextRef context = CGBitmapContextCreate(NULL, width, height, 8, 0, space, bitmapInfo);
+    // Use the pooled backing store, returned when the context is released
+    size_t bytesPerRow = [SDImageCoderHelper bytesPerRowWithWidth:width bytesPerPixel:4 rowAlignment:SDImageCoderHelper.defaultRowAlignment];
+    CGContextRef context = [SDImagePixelBufferPool.sharedPool newBitmapContextWithWidth:width height:height bitsPerComponent:8 bytesPerRow:bytesPerRow colorSpace:space bitmapInfo:bitmapInfo];
     if (!context) {
         return NULL;
     }
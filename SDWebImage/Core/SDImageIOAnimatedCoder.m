@@ -538,6 +538,13 @@ static BOOL SDImageIOPNGPluginBuggyNeedWorkaround(void) {
                 imageRef = decodedImageRef;
                 isLazy = NO;
             }
+        } else {
+            // Non-lazy output (like thumbnail or scaled) may be in the format which render server copy again, normalize it
+            CGImageRef normalizedImageRef = [SDImageCoderHelper CGImageCreateNormalized:imageRef];
+            if (normalizedImageRef) {
+                CGImageRelease(imageRef);
+                imageRef = normalizedImageRef;
+            }
         }
     } else if (animatedImage && !isHDRImage) {
         // iOS 15+, CGImageRef now retains CGImageSourceRef internally. To workaround its thread-safe issue, we have to strip CGImageSourceRef, using Force-Decode (or have to use SPI `CGImageSetImageSource`), See: https://github.com/SDWebImage/SDWebImage/issues/3273
@@ -1070,6 +1077,13 @@ static BOOL SDImageIOPNGPluginBuggyNeedWorkaround(void) {
         return NO;
     }
     NSUInteger frameCount = CGImageSourceGetCount(imageSource);
+    if (_incremental && !_finished) {
+        // The last frame may be partial during incremental loading, only count the complete frames
+        // So the frames decoded (and buffered by player) never change when new bytes available
+        while (frameCount > 0 && CGImageSourceGetStatusAtIndex(imageSource, frameCount - 1) != kCGImageStatusComplete) {
+            frameCount--;
+        }
+    }
     NSUInteger loopCount = [self.class imageLoopCountWithSource:imageSource];
     _loopCount = loopCount;
     
@@ -1145,6 +1159,64 @@ static BOOL SDImageIOPNGPluginBuggyNeedWorkaround(void) {
     return image;
 }
 
+- (UIImage *)animatedImageFrameAtIndex:(NSUInteger)index targetPixelSize:(CGSize)targetPixelSize {
+    // The frame size from the coder options, like thumbnail or limit bytes
+    CGSize framePixelSize = [self framePixelSize];
+    if (targetPixelSize.width <= 0 || targetPixelSize.height <= 0 || framePixelSize.width <= 0 || framePixelSize.height <= 0 || (targetPixelSize.width >= framePixelSize.width && targetPixelSize.height >= framePixelSize.height)) {
+        return [self animatedImageFrameAtIndex:index];
+    }
+    // Keep the aspect ratio of the frames above, which may be stretched to the thumbnail size
+    targetPixelSize = [SDImageCoderHelper scaledSizeWithImageSize:framePixelSize scaleSize:targetPixelSize preserveAspectRatio:YES shouldScaleUp:NO];
+    UIImage *image;
+    // Incremental Animation decoding may update frames when new bytes available
+    // Which should use lock to ensure frame count and frames match, ensure atomic logic
+    if (_incremental) {
+        SD_LOCK(_lock);
+        if (index >= _frames.count) {
+            SD_UNLOCK(_lock);
+            return nil;
+        }
+        image = [self safeAnimatedImageFrameAtIndex:index targetPixelSize:targetPixelSize];
+        SD_UNLOCK(_lock);
+    } else {
+        if (index >= _frames.count) {
+            return nil;
+        }
+        image = [self safeAnimatedImageFrameAtIndex:index targetPixelSize:targetPixelSize];
+    }
+    return image;
+}
+
+- (UIImage *)safeAnimatedImageFrameAtIndex:(NSUInteger)index targetPixelSize:(CGSize)targetPixelSize {
+    UIImage *image = [self.class createFrameAtIndex:index source:_imageSource scale:_scale preserveAspectRatio:_preserveAspectRatio thumbnailSize:targetPixelSize lazyDecode:_lazyDecode animatedImage:YES decodeToHDR:!_incremental || _finished ? _decodeToHDR : NO];
+    if (!image) {
+        return nil;
+    }
+    // Keep the same point size as the frame from `animatedImageFrameAtIndex:`
+    CGImageRef imageRef = image.CGImage;
+    size_t pixelWidth = CGImageGetWidth(imageRef);
+    CGFloat framePixelWidth = [self framePixelSize].width;
+    if (pixelWidth > 0 && pixelWidth < framePixelWidth) {
+        CGFloat scale = _scale * framePixelWidth / pixelWidth;
+#if SD_MAC
+        image = [[UIImage alloc] initWithCGImage:imageRef scale:scale orientation:kCGImagePropertyOrientationUp];
+#else
+        image = [[UIImage alloc] initWithCGImage:imageRef scale:scale orientation:image.imageOrientation];
+#endif
+    }
+    image.sd_imageFormat = self.class.imageFormat;
+    return image;
+}
+
+// The pixel size of the frames from `animatedImageFrameAtIndex:`, which reflect the thumbnail size
+- (CGSize)framePixelSize {
+    CGSize pixelSize = CGSizeMake(_width, _height);
+    if (_thumbnailSize.width > 0 && _thumbnailSize.height > 0 && (pixelSize.width > _thumbnailSize.width || pixelSize.height > _thumbnailSize.height)) {
+        pixelSize = [SDImageCoderHelper scaledSizeWithImageSize:pixelSize scaleSize:_thumbnailSize preserveAspectRatio:_preserveAspectRatio shouldScaleUp:NO];
+    }
+    return pixelSize;
+}
+
 - (UIImage *)safeAnimatedImageFrameAtIndex:(NSUInteger)index {
     UIImage *image = [self.class createFrameAtIndex:index source:_imageSource scale:_scale preserveAspectRatio:_preserveAspectRatio thumbnailSize:_thumbnailSize lazyDecode:_lazyDecode animatedImage:YES decodeToHDR:!_incremental || _finished ? _decodeToHDR : NO];
     if (!image) {
@@ -130,6 +130,7 @@ static NSString * kSDCGImageDestinationEncodeToISOGainmap = @"kCGImageDestinatio
     
     image = SDGraphicsGetImageFromCurrentImageContext();
     SDGraphicsEndImageContext();
+    image = [SDImageCoderHelper normalizedImageWithImage:image];
     
     CGPDFDocumentRelease(document);
     
@@ -23,6 +23,13 @@ typedef void(^SDImageLoaderCompletedBlock)(UIImage * _Nullable image, NSData * _
  */
 FOUNDATION_EXPORT SDWebImageContextOption _Nonnull const SDWebImageContextLoaderCachedImage;
 
+/**
+ A `SDImageCacheValidator` instance from `SDWebImageManager` when you specify `SDWebImageRevalidateCached` and the cached image is stale.
+ The image loader should send the conditional request with the validator's `conditionalHeaders`. If the remote image does not change (`304 Not Modified`), you should call the completion with `SDWebImageErrorCacheNotModified` error, with the response in `SDWebImageErrorDownloadResponseKey`. Else set the `sd_cacheValidator` of the new image, which will be stored into image cache. (SDImageCacheValidator)
+ @note If you don't implement `SDWebImageRevalidateCached` support, you do not need to care about this context option.
+ */
+FOUNDATION_EXPORT SDWebImageContextOption _Nonnull const SDWebImageContextLoaderCacheValidator;
+
 #pragma mark - Helper method
 
 /**
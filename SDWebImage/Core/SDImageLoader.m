@@ -17,6 +17,7 @@
 #import "objc/runtime.h"
 
 SDWebImageContextOption const SDWebImageContextLoaderCachedImage = @"loaderCachedImage";
+SDWebImageContextOption const SDWebImageContextLoaderCacheValidator = @"loaderCacheValidator";
 
 static void * SDImageLoaderProgressiveCoderKey = &SDImageLoaderProgressiveCoderKey;
 
@@ -46,6 +47,9 @@ UIImage * _Nullable SDImageLoaderDecodeImageData(NSData * _Nonnull imageData, NS
     BOOL decodeFirstFrame = SD_OPTIONS_CONTAINS(options, SDWebImageDecodeFirstFrameOnly);
     CGFloat scale = [coderOptions[SDImageCoderDecodeScaleFactor] doubleValue];
     
+    // The aspect fill thumbnail size depends on the image size
+    SDImageCoderOptions *decodeOptions = SDResolveDecodeOptionsWithImageData(coderOptions, imageData);
+    
     // Grab the image coder
     id<SDImageCoder> imageCoder = context[SDWebImageContextImageCoder];
     if (!imageCoder) {
@@ -56,7 +60,7 @@ UIImage * _Nullable SDImageLoaderDecodeImageData(NSData * _Nonnull imageData, NS
         // check whether we should use `SDAnimatedImage`
         Class animatedImageClass = context[SDWebImageContextAnimatedImageClass];
         if ([animatedImageClass isSubclassOfClass:[UIImage class]] && [animatedImageClass conformsToProtocol:@protocol(SDAnimatedImage)]) {
-            image = [[animatedImageClass alloc] initWithData:imageData scale:scale options:coderOptions];
+            image = [[animatedImageClass alloc] initWithData:imageData scale:scale options:decodeOptions];
             if (image) {
                 // Preload frames if supported
                 if (options & SDWebImagePreloadAllFrames && [image respondsToSelector:@selector(preloadAllFrames)]) {
@@ -71,7 +75,7 @@ UIImage * _Nullable SDImageLoaderDecodeImageData(NSData * _Nonnull imageData, NS
         }
     }
     if (!image) {
-        image = [imageCoder decodedImageWithData:imageData options:coderOptions];
+        image = [imageCoder decodedImageWithData:imageData options:decodeOptions];
     }
     if (image) {
         SDImageForceDecodePolicy policy = SDImageForceDecodePolicyAutomatic;
@@ -88,7 +92,7 @@ UIImage * _Nullable SDImageLoaderDecodeImageData(NSData * _Nonnull imageData, NS
 #pragma clang diagnostic pop
         image = [SDImageCoderHelper decodedImageWithImage:image policy:policy];
         // assign the decode options, to let manager check whether to re-decode if needed
-        image.sd_decodeOptions = coderOptions;
+        image.sd_decodeOptions = decodeOptions;
     }
     
     return image;
@@ -111,19 +115,26 @@ UIImage * _Nullable SDImageLoaderDecodeProgressiveImageData(NSData * _Nonnull im
     BOOL decodeFirstFrame = SD_OPTIONS_CONTAINS(options, SDWebImageDecodeFirstFrameOnly);
     CGFloat scale = [coderOptions[SDImageCoderDecodeScaleFactor] doubleValue];
     
+    // The aspect fill thumbnail size depends on the image size
+    SDImageCoderOptions *decodeOptions = SDResolveDecodeOptionsWithImageData(coderOptions, imageData);
+    if (!finished && coderOptions[SDImageCoderDecodeThumbnailPixelSize] != nil && decodeOptions[SDImageCoderDecodeThumbnailPixelSize] == nil) {
+        // The image size is not available in the partial data yet, wait for more data instead of decoding the full size image
+        return nil;
+    }
+    
     // Grab the progressive image coder
     id<SDProgressiveImageCoder> progressiveCoder = SDImageLoaderGetProgressiveCoder(operation);
     if (!progressiveCoder) {
         id<SDProgressiveImageCoder> imageCoder = context[SDWebImageContextImageCoder];
         // Check the progressive coder if provided
         if ([imageCoder respondsToSelector:@selector(initIncrementalWithOptions:)]) {
-            progressiveCoder = [[[imageCoder class] alloc] initIncrementalWithOptions:coderOptions];
+            progressiveCoder = [[[imageCoder class] alloc] initIncrementalWithOptions:decodeOptions];
         } else {
             // We need to create a new instance for progressive decoding to avoid conflicts
             for (id<SDImageCoder> coder in [SDImageCodersManager sharedManager].coders.reverseObjectEnumerator) {
                 if ([coder conformsToProtocol:@protocol(SDProgressiveImageCoder)] &&
                     [((id<SDProgressiveImageCoder>)coder) canIncrementalDecodeFromData:imageData]) {
-                    progressiveCoder = [[[coder class] alloc] initIncrementalWithOptions:coderOptions];
+                    progressiveCoder = [[[coder class] alloc] initIncrementalWithOptions:decodeOptions];
                     break;
                 }
             }
@@ -152,7 +163,7 @@ UIImage * _Nullable SDImageLoaderDecodeProgressiveImageData(NSData * _Nonnull im
         }
     }
     if (!image) {
-        image = [progressiveCoder incrementalDecodedImageWithOptions:coderOptions];
+        image = [progressiveCoder incrementalDecodedImageWithOptions:decodeOptions];
     }
     if (image) {
         SDImageForceDecodePolicy policy = SDImageForceDecodePolicyAutomatic;
@@ -169,7 +180,7 @@ UIImage * _Nullable SDImageLoaderDecodeProgressiveImageData(NSData * _Nonnull im
 #pragma clang diagnostic pop
         image = [SDImageCoderHelper decodedImageWithImage:image policy:policy];
         // assign the decode options, to let manager check whether to re-decode if needed
-        image.sd_decodeOptions = coderOptions;
+        image.sd_decodeOptions = decodeOptions;
         // mark the image as progressive (completed one are not mark as progressive)
         image.sd_isIncremental = !finished;
     }
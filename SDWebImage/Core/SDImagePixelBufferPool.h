@@ -0,0 +1,77 @@
+/*
+ * This file is part of the SDWebImage package.
+ * (c) Olivier Poitrey <rs@dailymotion.com>
+ *
+ * For the full copyright and license information, please view the LICENSE
+ * file that was distributed with this source code.
+ */
+
+#import <CoreGraphics/CoreGraphics.h>
+#import "SDWebImageCompat.h"
+
+/// SDImagePixelBufferPool is a size-bucketed pool of the bitmap backing store, used by the force decode, scale and render destinations.
+/// Instead of allocating the fresh multi-MB buffer for each decoded image (and page faulting it again), the decoded image holds the pooled buffer through a custom data provider, and returns the buffer to the pool when the image is released.
+/// The buffer length is rounded up to the bucket (at most 25% larger), so the images with similar size (like the cells in list) can reuse the buffers. The memory cache cost of the pooled image counts the whole bucket, see `backingStoreLengthForImage:`.
+@interface SDImagePixelBufferPool : NSObject
+
+/// The shared pool used by `SDImageCoderHelper` and `SDGraphicsImageRenderer`.
+@property (nonnull, class, readonly) SDImagePixelBufferPool *sharedPool;
+
+/// Whether to reuse the buffers. If NO, the buffer is allocated and freed directly, the idle buffers are removed.
+/// Defaults to YES.
+@property (nonatomic, assign, getter=isEnabled) BOOL enabled;
+
+/// The maximum total bytes of idle buffers kept in the pool. When exceeded, the oldest idle buffers are freed.
+/// Defaults to 32MB (8MB on watchOS). The idle buffers are also freed when receiving memory warning.
+@property (nonatomic, assign) NSUInteger maxIdleBytes;
+
+/// The current total bytes of idle buffers kept in the pool.
+@property (nonatomic, assign, readonly) NSUInteger idleBytes;
+
+/// The number of buffer requests served by the idle buffer.
+@property (nonatomic, assign, readonly) NSUInteger hitCount;
+
+/// The number of buffer requests which allocated the new buffer.
+@property (nonatomic, assign, readonly) NSUInteger missCount;
+
+/// The hit rate, `hitCount / (hitCount + missCount)`. 0 if no request.
+@property (nonatomic, assign, readonly) double hitRate;
+
+/// Reset the hit and miss count.
+- (void)resetStatistics;
+
+/// Free all the idle buffers. The buffers in use are not effected.
+- (void)removeAllIdleBuffers;
+
+/// Acquire the buffer which has at least the length bytes. The content is undefined.
+/// You should return it with `recycleBuffer:`, or pass it to `newDataProviderWithBuffer:`.
+/// @param length The bytes length
+/// @return The buffer, or NULL if allocation failed
+- (nullable void *)acquireBufferWithLength:(size_t)length;
+
+/// Return the buffer acquired from this pool.
+/// @param buffer The buffer
+- (void)recycleBuffer:(nonnull void *)buffer;
+
+/// Create the data provider which takes the ownership of the buffer acquired from this pool, the buffer is returned when the data provider is released.
+/// @param buffer The buffer
+/// @param length The bytes length the data provider provides
+- (nullable CGDataProviderRef)newDataProviderWithBuffer:(nonnull void *)buffer length:(size_t)length CF_RETURNS_RETAINED;
+
+/// Create the bitmap context whose backing store is from this pool. Arguments are the same as `CGBitmapContextCreate`, pass 0 bytesPerRow to use the byte aligned stride (see `SDImagePixelFormat.alignment`).
+/// The backing store is zero filled like the system one. The new allocated buffer is zero filled lazily by the kernel, only the reused buffer is cleared.
+/// The backing store is returned when the context (and the image created by `newImageFromBitmapContext:`) is released.
+- (nullable CGContextRef)newBitmapContextWithWidth:(size_t)width height:(size_t)height bitsPerComponent:(size_t)bitsPerComponent bytesPerRow:(size_t)bytesPerRow colorSpace:(nullable CGColorSpaceRef)colorSpace bitmapInfo:(CGBitmapInfo)bitmapInfo CF_RETURNS_RETAINED;
+
+/// Create the image which shares the backing store of the bitmap context without copy, unlike `CGBitmapContextCreateImage`.
+/// @warning The context must be created by `newBitmapContextWithWidth:...` of this pool, and you should not draw into that context after this call, or the image will be changed as well.
+/// @param context The bitmap context
+/// @return The image, or copied image from `CGBitmapContextCreateImage` if the context is not from this pool
+- (nullable CGImageRef)newImageFromBitmapContext:(nonnull CGContextRef)context CF_RETURNS_RETAINED;
+
+/// The bytes of the pooled backing store held by the image, which is the bucket length and may be larger than `bytesPerRow * height`.
+/// @param image The image created by `newDataProviderWithBuffer:length:` or `newImageFromBitmapContext:` of this pool
+/// @return The bucket length, or 0 if the image's backing store is not from this pool
+- (size_t)backingStoreLengthForImage:(nonnull CGImageRef)image;
+
+@end
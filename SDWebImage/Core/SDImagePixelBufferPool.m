@@ -0,0 +1,425 @@
+/*
+ * This file is part of the SDWebImage package.
+ * (c) Olivier Poitrey <rs@dailymotion.com>
+ *
+ * For the full copyright and license information, please view the LICENSE
+ * file that was distributed with this source code.
+ */
+
+#import "SDImagePixelBufferPool.h"
+#import "SDImageCoderHelper.h"
+#import "SDInternalMacros.h"
+
+// Round up the length to the bucket, each power of two is divided into 4 buckets, so at most 25% larger
+static inline size_t SDImagePixelBufferBucketLength(size_t length) {
+    static const size_t kMinimumBucketLength = 4096;
+    if (length <= kMinimumBucketLength) {
+        return kMinimumBucketLength;
+    }
+    size_t power = kMinimumBucketLength;
+    while (power <= length / 2) {
+        power *= 2;
+    }
+    return SDByteAlign(length, power / 4);
+}
+
+/// The idle buffer in pool
+@interface SDImagePixelBufferEntry : NSObject
+
+@property (nonatomic, assign) void *data;
+@property (nonatomic, assign) size_t length;
+
+@end
+
+@implementation SDImagePixelBufferEntry
+@end
+
+/// The reference counted owner of the pooled buffer, shared by the bitmap context and the image's data provider. The buffer is returned when all of them are released.
+@interface SDImagePixelBufferBox : NSObject
+
+@property (nonatomic, strong) SDImagePixelBufferPool *pool;
+@property (nonatomic, assign) void *data;
+@property (nonatomic, assign) size_t length; // bucket length
+
+@end
+
+@implementation SDImagePixelBufferBox
+
+- (void)dealloc {
+    if (_data) {
+        [_pool recycleBuffer:_data];
+    }
+}
+
+@end
+
+/// The info of the data provider, one for each provider, to untrack the provider when released
+@interface SDImagePixelBufferProviderInfo : NSObject
+
+@property (nonatomic, strong) SDImagePixelBufferBox *box;
+@property (nonatomic, assign) CGDataProviderRef provider;
+
+@end
+
+@implementation SDImagePixelBufferProviderInfo
+@end
+
+@interface SDImagePixelBufferPool ()
+
+- (void)untrackDataProvider:(CGDataProviderRef)provider;
+
+@end
+
+static void SDImagePixelBufferReleaseContext(void *releaseInfo, void *data) {
+    CFBridgingRelease(releaseInfo);
+}
+
+static void SDImagePixelBufferReleaseDataProvider(void *info, const void *data, size_t size) {
+    SDImagePixelBufferProviderInfo *providerInfo = CFBridgingRelease(info);
+    [providerInfo.box.pool untrackDataProvider:providerInfo.provider];
+}
+
+@interface SDImagePixelBufferPool ()
+
+@property (nonatomic, strong, nonnull) NSMutableArray<SDImagePixelBufferEntry *> *idleEntries; // oldest first
+@property (nonatomic, strong, nonnull) NSMapTable<id, SDImagePixelBufferBox *> *contextBoxes; // backing store pointer -> box, for the bitmap context
+@property (nonatomic, assign, readwrite) NSUInteger idleBytes;
+@property (nonatomic, assign, readwrite) NSUInteger hitCount;
+@property (nonatomic, assign, readwrite) NSUInteger missCount;
+
+@end
+
+@implementation SDImagePixelBufferPool {
+    SD_LOCK_DECLARE(_lock); // A lock to keep the access to buffers thread-safe
+    CFMutableDictionaryRef _bufferLengths; // buffer pointer in use -> bucket length
+    CFMutableDictionaryRef _providerLengths; // data provider of pooled image -> bucket length, for the memory cost
+}
+
++ (SDImagePixelBufferPool *)sharedPool {
+    static dispatch_once_t onceToken;
+    static SDImagePixelBufferPool *pool;
+    dispatch_once(&onceToken, ^{
+        pool = [[SDImagePixelBufferPool alloc] init];
+    });
+    return pool;
+}
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _enabled = YES;
+#if SD_WATCH
+        _maxIdleBytes = 8 * 1024 * 1024;
+#else
+        _maxIdleBytes = 32 * 1024 * 1024;
+#endif
+        _idleEntries = [NSMutableArray array];
+        _contextBoxes = [[NSMapTable alloc] initWithKeyOptions:NSPointerFunctionsOpaqueMemory | NSPointerFunctionsOpaquePersonality valueOptions:NSPointerFunctionsWeakMemory capacity:0];
+        _bufferLengths = CFDictionaryCreateMutable(kCFAllocatorDefault, 0, NULL, NULL);
+        _providerLengths = CFDictionaryCreateMutable(kCFAllocatorDefault, 0, NULL, NULL);
+        SD_LOCK_INIT(_lock);
+#if SD_UIKIT
+        [[NSNotificationCenter defaultCenter] addObserver:self
+                                                 selector:@selector(didReceiveMemoryWarning:)
+                                                     name:UIApplicationDidReceiveMemoryWarningNotification
+                                                   object:nil];
+#endif
+    }
+    return self;
+}
+
+- (void)dealloc {
+#if SD_UIKIT
+    [[NSNotificationCenter defaultCenter] removeObserver:self name:UIApplicationDidReceiveMemoryWarningNotification object:nil];
+#endif
+    for (SDImagePixelBufferEntry *entry in _idleEntries) {
+        free(entry.data);
+    }
+    // The buffers in use retain the pool, so no buffer in use now
+    CFRelease(_bufferLengths);
+    CFRelease(_providerLengths);
+}
+
+#if SD_UIKIT
+- (void)didReceiveMemoryWarning:(NSNotification *)notification {
+    [self removeAllIdleBuffers];
+}
+#endif
+
+#pragma mark - Properties
+
+- (void)setEnabled:(BOOL)enabled {
+    _enabled = enabled;
+    if (!enabled) {
+        [self removeAllIdleBuffers];
+    }
+}
+
+- (void)setMaxIdleBytes:(NSUInteger)maxIdleBytes {
+    SD_LOCK(_lock);
+    _maxIdleBytes = maxIdleBytes;
+    NSArray<SDImagePixelBufferEntry *> *evictedEntries = [self evictIdleEntriesIfNeeded];
+    SD_UNLOCK(_lock);
+    for (SDImagePixelBufferEntry *entry in evictedEntries) {
+        free(entry.data);
+    }
+}
+
+- (NSUInteger)idleBytes {
+    SD_LOCK(_lock);
+    NSUInteger idleBytes = _idleBytes;
+    SD_UNLOCK(_lock);
+    return idleBytes;
+}
+
+- (NSUInteger)hitCount {
+    SD_LOCK(_lock);
+    NSUInteger hitCount = _hitCount;
+    SD_UNLOCK(_lock);
+    return hitCount;
+}
+
+- (NSUInteger)missCount {
+    SD_LOCK(_lock);
+    NSUInteger missCount = _missCount;
+    SD_UNLOCK(_lock);
+    return missCount;
+}
+
+- (double)hitRate {
+    SD_LOCK(_lock);
+    NSUInteger total = _hitCount + _missCount;
+    double hitRate = total > 0 ? (double)_hitCount / total : 0;
+    SD_UNLOCK(_lock);
+    return hitRate;
+}
+
+- (void)resetStatistics {
+    SD_LOCK(_lock);
+    _hitCount = 0;
+    _missCount = 0;
+    SD_UNLOCK(_lock);
+}
+
+- (void)removeAllIdleBuffers {
+    SD_LOCK(_lock);
+    NSArray<SDImagePixelBufferEntry *> *idleEntries = [self.idleEntries copy];
+    [self.idleEntries removeAllObjects];
+    _idleBytes = 0;
+    SD_UNLOCK(_lock);
+    for (SDImagePixelBufferEntry *entry in idleEntries) {
+        free(entry.data);
+    }
+}
+
+// Must be called inside lock, free the returned entries outside lock
+- (NSArray<SDImagePixelBufferEntry *> *)evictIdleEntriesIfNeeded {
+    NSMutableArray<SDImagePixelBufferEntry *> *evictedEntries;
+    while (_idleBytes > _maxIdleBytes && self.idleEntries.count > 0) {
+        SDImagePixelBufferEntry *entry = self.idleEntries.firstObject;
+        [self.idleEntries removeObjectAtIndex:0];
+        _idleBytes -= entry.length;
+        if (!evictedEntries) {
+            evictedEntries = [NSMutableArray array];
+        }
+        [evictedEntries addObject:entry];
+    }
+    return evictedEntries;
+}
+
+#pragma mark - Buffer
+
+- (void *)acquireBufferWithLength:(size_t)length {
+    return [self acquireBufferWithLength:length zeroFilled:NO];
+}
+
+- (void *)acquireBufferWithLength:(size_t)length zeroFilled:(BOOL)zeroFilled {
+    if (length == 0) {
+        return NULL;
+    }
+    size_t bucketLength = SDImagePixelBufferBucketLength(length);
+    void *data = NULL;
+    SD_LOCK(_lock);
+    if (_enabled) {
+        // Prefer the recently returned one, which is more likely still in cache and resident
+        for (NSInteger i = self.idleEntries.count - 1; i >= 0; i--) {
+            SDImagePixelBufferEntry *entry = self.idleEntries[i];
+            if (entry.length == bucketLength) {
+                data = entry.data;
+                [self.idleEntries removeObjectAtIndex:i];
+                _idleBytes -= bucketLength;
+                break;
+            }
+        }
+    }
+    if (data) {
+        _hitCount++;
+    } else {
+        _missCount++;
+    }
+    SD_UNLOCK(_lock);
+    if (!data) {
+        // The large calloc maps the zero pages lazily, no need to touch them
+        data = zeroFilled ? calloc(1, bucketLength) : malloc(bucketLength);
+        if (!data) {
+            return NULL;
+        }
+    } else if (zeroFilled) {
+        // Only the reused buffer has the old content
+        memset(data, 0, length);
+    }
+    SD_LOCK(_lock);
+    CFDictionarySetValue(_bufferLengths, data, (const void *)(uintptr_t)bucketLength);
+    SD_UNLOCK(_lock);
+    return data;
+}
+
+- (void)recycleBuffer:(void *)buffer {
+    if (!buffer) {
+        return;
+    }
+    SD_LOCK(_lock);
+    const void *value = NULL;
+    if (!CFDictionaryGetValueIfPresent(_bufferLengths, buffer, &value)) {
+        SD_UNLOCK(_lock);
+        NSAssert(NO, @"The buffer is not acquired from this pool");
+        return;
+    }
+    CFDictionaryRemoveValue(_bufferLengths, buffer);
+    size_t bucketLength = (size_t)(uintptr_t)value;
+    NSArray<SDImagePixelBufferEntry *> *evictedEntries;
+    BOOL reused = NO;
+    if (_enabled && bucketLength <= _maxIdleBytes) {
+        SDImagePixelBufferEntry *entry = [SDImagePixelBufferEntry new];
+        entry.data = buffer;
+        entry.length = bucketLength;
+        [self.idleEntries addObject:entry];
+        _idleBytes += bucketLength;
+        evictedEntries = [self evictIdleEntriesIfNeeded];
+        reused = YES;
+    }
+    SD_UNLOCK(_lock);
+    if (!reused) {
+        free(buffer);
+    }
+    for (SDImagePixelBufferEntry *entry in evictedEntries) {
+        free(entry.data);
+    }
+}
+
+- (CGDataProviderRef)newDataProviderWithBuffer:(void *)buffer length:(size_t)length {
+    if (!buffer) {
+        return NULL;
+    }
+    SD_LOCK(_lock);
+    size_t bucketLength = (size_t)(uintptr_t)CFDictionaryGetValue(_bufferLengths, buffer);
+    SD_UNLOCK(_lock);
+    SDImagePixelBufferBox *box = [SDImagePixelBufferBox new];
+    box.pool = self;
+    box.data = buffer;
+    box.length = bucketLength;
+    return [self newDataProviderWithBox:box length:length];
+}
+
+- (CGDataProviderRef)newDataProviderWithBox:(SDImagePixelBufferBox *)box length:(size_t)length {
+    SDImagePixelBufferProviderInfo *info = [SDImagePixelBufferProviderInfo new];
+    info.box = box;
+    CGDataProviderRef provider = CGDataProviderCreateWithData((__bridge_retained void *)info, box.data, length, SDImagePixelBufferReleaseDataProvider);
+    if (!provider) {
+        return NULL;
+    }
+    info.provider = provider;
+    SD_LOCK(_lock);
+    CFDictionarySetValue(_providerLengths, provider, (const void *)(uintptr_t)box.length);
+    SD_UNLOCK(_lock);
+    return provider;
+}
+
+- (void)untrackDataProvider:(CGDataProviderRef)provider {
+    if (!provider) {
+        return;
+    }
+    SD_LOCK(_lock);
+    CFDictionaryRemoveValue(_providerLengths, provider);
+    SD_UNLOCK(_lock);
+}
+
+- (size_t)backingStoreLengthForImage:(CGImageRef)image {
+    CGDataProviderRef provider = image ? CGImageGetDataProvider(image) : NULL;
+    if (!provider) {
+        return 0;
+    }
+    SD_LOCK(_lock);
+    size_t length = (size_t)(uintptr_t)CFDictionaryGetValue(_providerLengths, provider);
+    SD_UNLOCK(_lock);
+    return length;
+}
+
+#pragma mark - Bitmap Context
+
+- (CGContextRef)newBitmapContextWithWidth:(size_t)width height:(size_t)height bitsPerComponent:(size_t)bitsPerComponent bytesPerRow:(size_t)bytesPerRow colorSpace:(CGColorSpaceRef)colorSpace bitmapInfo:(CGBitmapInfo)bitmapInfo {
+    if (width == 0 || height == 0) {
+        return NULL;
+    }
+    if (bytesPerRow == 0) {
+        // Same as `SDImagePixelFormat.alignment`, the 8 pixels bytesPerRow
+        size_t components = colorSpace ? CGColorSpaceGetNumberOfComponents(colorSpace) : 0;
+        CGImageAlphaInfo alphaInfo = bitmapInfo & kCGBitmapAlphaInfoMask;
+        if (alphaInfo != kCGImageAlphaNone) {
+            components += 1;
+        }
+        size_t bytesPerPixel = MAX(bitsPerComponent * components / 8, 1);
+        bytesPerRow = SDByteAlign(width * bytesPerPixel, bytesPerPixel * 8);
+    }
+    size_t length = bytesPerRow * height;
+    // The new bitmap context from system is zero filled, keep the same for alpha drawing
+    void *data = [self acquireBufferWithLength:length zeroFilled:YES];
+    if (!data) {
+        return NULL;
+    }
+    SDImagePixelBufferBox *box = [SDImagePixelBufferBox new];
+    box.pool = self;
+    box.data = data;
+    box.length = SDImagePixelBufferBucketLength(length);
+    CGContextRef context = CGBitmapContextCreateWithData(data, width, height, bitsPerComponent, bytesPerRow, colorSpace, bitmapInfo, SDImagePixelBufferReleaseContext, (__bridge void *)box);
+    if (!context) {
+        // box dealloc and recycle the buffer
+        return NULL;
+    }
+    // The context owns the box now, released in the release callback
+    CFBridgingRetain(box);
+    SD_LOCK(_lock);
+    [self.contextBoxes setObject:box forKey:(__bridge id)data];
+    SD_UNLOCK(_lock);
+    return context;
+}
+
+- (CGImageRef)newImageFromBitmapContext:(CGContextRef)context {
+    if (!context) {
+        return NULL;
+    }
+    void *data = CGBitmapContextGetData(context);
+    SDImagePixelBufferBox *box;
+    if (data) {
+        SD_LOCK(_lock);
+        box = [self.contextBoxes objectForKey:(__bridge id)data];
+        SD_UNLOCK(_lock);
+    }
+    if (!box) {
+        // Not from this pool
+        return CGBitmapContextCreateImage(context);
+    }
+    size_t width = CGBitmapContextGetWidth(context);
+    size_t height = CGBitmapContextGetHeight(context);
+    size_t bytesPerRow = CGBitmapContextGetBytesPerRow(context);
+    // The data provider shares the box with context
+    CGDataProviderRef provider = [self newDataProviderWithBox:box length:bytesPerRow * height];
+    if (!provider) {
+        return NULL;
+    }
+    CGImageRef imageRef = CGImageCreate(width, height, CGBitmapContextGetBitsPerComponent(context), CGBitmapContextGetBitsPerPixel(context), bytesPerRow, CGBitmapContextGetColorSpace(context), CGBitmapContextGetBitmapInfo(context), provider, NULL, false, kCGRenderingIntentDefault);
+    CGDataProviderRelease(provider);
+    return imageRef;
+}
+
+@end
@@ -28,6 +28,14 @@ FOUNDATION_EXPORT NSString * _Nullable SDTransformedKeyForKey(NSString * _Nullab
  */
 FOUNDATION_EXPORT NSString * _Nullable SDThumbnailedKeyForKey(NSString * _Nullable key, CGSize thumbnailPixelSize, BOOL preserveAspectRatio);
 
+/**
+ Return the thumbnailed cache key for the thumbnail which fills the thumbnail pixel size, see `SDWebImageContextImageThumbnailAspectFill`.
+ @param key The original cache key
+ @param thumbnailPixelSize The thumbnail pixel size
+ @return The thumbnailed cache key
+ */
+FOUNDATION_EXPORT NSString * _Nullable SDAspectFillThumbnailedKeyForKey(NSString * _Nullable key, CGSize thumbnailPixelSize);
+
 /**
  A transformer protocol to transform the image load from cache or from download.
  You can provide transformer to cache and manager (Through the `transformer` property or context option `SDWebImageContextImageTransformer`).
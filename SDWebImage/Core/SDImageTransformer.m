@@ -44,6 +44,11 @@ NSString * _Nullable SDThumbnailedKeyForKey(NSString * _Nullable key, CGSize thu
     return SDTransformedKeyForKey(key, thumbnailKey);
 }
 
+NSString * _Nullable SDAspectFillThumbnailedKeyForKey(NSString * _Nullable key, CGSize thumbnailPixelSize) {
+    NSString *thumbnailKey = [NSString stringWithFormat:@"Thumbnail({%f,%f},AspectFill)", thumbnailPixelSize.width, thumbnailPixelSize.height];
+    return SDTransformedKeyForKey(key, thumbnailKey);
+}
+
 @interface SDImagePipelineTransformer ()
 
 @property (nonatomic, copy, readwrite, nonnull) NSArray<id<SDImageTransformer>> *transformers;
@@ -0,0 +1,113 @@
+/*
+ * This file is part of the SDWebImage package.
+ * (c) Olivier Poitrey <rs@dailymotion.com>
+ *
+ * For the full copyright and license information, please view the LICENSE
+ * file that was distributed with this source code.
+ */
+
+#import <Foundation/Foundation.h>
+#import "SDWebImageCompat.h"
+#import "SDImageLoader.h"
+
+/**
+ This is the protocol to describe the server's batch endpoint, used by `SDWebImageBatchLoader`.
+ The adapter decides which URLs can be batched together, builds the batched request, and splits the batched response into each image.
+ */
+@protocol SDWebImageBatchLoaderAdapter <NSObject>
+
+@required
+
+/**
+ Return the batch key for the image URL. The URLs with the same batch key are collected into the same batched request, for example the tile server host.
+ @param url The image URL
+ @return The batch key, or nil if this URL can not be loaded by batch endpoint.
+ */
+- (nullable NSString *)batchKeyForURL:(nonnull NSURL *)url;
+
+/**
+ Build the batched request for the image URLs. The URLs are unique and share the same batch key.
+ @param URLs The image URLs
+ @param batchKey The batch key
+ @return The batched request, or nil to fail all the image URLs.
+ */
+- (nullable NSURLRequest *)batchRequestWithURLs:(nonnull NSArray<NSURL *> *)URLs batchKey:(nonnull NSString *)batchKey;
+
+/**
+ Split the batched response into the image data for each image URL. For multipart response, see `+[SDWebImageBatchLoader partsFromMultipartData:response:]`.
+ @param data The batched response data
+ @param response The batched response
+ @param URLs The image URLs in the batched request
+ @return The image data for each image URL. The missing image URL will fail with `SDWebImageErrorBadImageData`.
+ */
+- (nullable NSDictionary<NSURL *, NSData *> *)imageDataWithBatchData:(nonnull NSData *)data response:(nullable NSURLResponse *)response URLs:(nonnull NSArray<NSURL *> *)URLs;
+
+@optional
+
+/**
+ Split the batched response into the image for each image URL directly, such as cropping the sprite sheet. If implemented, this takes priority over `imageDataWithBatchData:response:URLs:`, and the built-in decoding process is skipped.
+ @note This is called on the global queue.
+ @param data The batched response data
+ @param response The batched response
+ @param URLs The image URLs in the batched request
+ @return The image for each image URL. The missing image URL will fail with `SDWebImageErrorBadImageData`.
+ */
+- (nullable NSDictionary<NSURL *, UIImage *> *)imagesWithBatchData:(nonnull NSData *)data response:(nullable NSURLResponse *)response URLs:(nonnull NSArray<NSURL *> *)URLs;
+
+@end
+
+/**
+ An image loader which collects the individual image requests within a short window, and issues one batched request to the server's batch endpoint, to reduce the request overhead of many tiny images, such as map tiles or emoji sprites.
+ Each caller is completed separately when the batched response is split. Cancelling a request only cancels the batched request when all the requests in that batch are cancelled.
+ Add it to `SDImageLoadersManager` alongside `SDWebImageDownloader`, the URLs which the adapter does not batch are loaded by the other loaders.
+ @note Progressive loading is not supported, the progress block is not called.
+ */
+@interface SDWebImageBatchLoader : NSObject <SDImageLoader>
+
+/**
+ The adapter to describe the server's batch endpoint.
+ */
+@property (nonatomic, strong, readonly, nonnull) id<SDWebImageBatchLoaderAdapter> adapter;
+
+/**
+ The URL session to send the batched request.
+ */
+@property (nonatomic, strong, readonly, nonnull) NSURLSession *session;
+
+/**
+ The time window (in seconds) to collect the requests into one batch, since the first request of that batch.
+ Defaults to 0.02.
+ */
+@property (nonatomic, assign) NSTimeInterval batchWindow;
+
+/**
+ The maximum number of image URLs in one batch. When reached, the batch is sent immediately without waiting the window.
+ Defaults to 50.
+ */
+@property (nonatomic, assign) NSUInteger maximumBatchSize;
+
+/**
+ Create the batch loader with the adapter, using the default session configuration.
+ @param adapter The batch endpoint adapter
+ */
+- (nonnull instancetype)initWithAdapter:(nonnull id<SDWebImageBatchLoaderAdapter>)adapter;
+
+/**
+ Create the batch loader with the adapter and session configuration.
+ @param adapter The batch endpoint adapter
+ @param sessionConfiguration The session configuration, nil means the default session configuration
+ */
+- (nonnull instancetype)initWithAdapter:(nonnull id<SDWebImageBatchLoaderAdapter>)adapter sessionConfiguration:(nullable NSURLSessionConfiguration *)sessionConfiguration NS_DESIGNATED_INITIALIZER;
+
+- (nonnull instancetype)init NS_UNAVAILABLE;
++ (nonnull instancetype)new  NS_UNAVAILABLE;
+
+/**
+ Split the `multipart/*` response body into parts, keyed by each part's `Content-Location` header (or `Content-ID` if no location).
+ @param data The response body
+ @param response The response, used to get the boundary from `Content-Type` header
+ @return The body data of each part, or nil if the response is not a valid multipart response.
+ */
++ (nullable NSDictionary<NSString *, NSData *> *)partsFromMultipartData:(nonnull NSData *)data response:(nullable NSURLResponse *)response;
+
+@end
@@ -0,0 +1,393 @@
+/*
+ * This file is part of the SDWebImage package.
+ * (c) Olivier Poitrey <rs@dailymotion.com>
+ *
+ * For the full copyright and license information, please view the LICENSE
+ * file that was distributed with this source code.
+ */
+
+#import "SDWebImageBatchLoader.h"
+#import "SDWebImageError.h"
+#import "SDCallbackQueue.h"
+#import "SDInternalMacros.h"
+
+@class SDWebImageBatch;
+
+// The operation for each individual image request
+@interface SDWebImageBatchLoaderOperation : NSObject <SDWebImageOperation>
+
+@property (nonatomic, strong, nonnull) NSURL *url;
+@property (nonatomic, assign) SDWebImageOptions options;
+@property (nonatomic, copy, nullable) SDWebImageContext *context;
+@property (nonatomic, copy, nullable) SDImageLoaderCompletedBlock completedBlock;
+@property (nonatomic, weak, nullable) SDWebImageBatchLoader *loader;
+@property (nonatomic, weak, nullable) SDWebImageBatch *batch;
+@property (assign, getter=isCancelled) BOOL cancelled;
+@property (assign, getter=isFinished) BOOL finished;
+
+@end
+
+// The requests collected into one batched request
+@interface SDWebImageBatch : NSObject
+
+@property (nonatomic, copy, nonnull) NSString *batchKey;
+@property (nonatomic, strong, nonnull) NSMutableArray<SDWebImageBatchLoaderOperation *> *operations;
+@property (nonatomic, strong, nonnull) NSMutableOrderedSet<NSURL *> *URLs;
+@property (nonatomic, strong, nullable) NSURLSessionTask *task;
+@property (nonatomic, assign, getter=isSent) BOOL sent;
+
+@end
+
+@implementation SDWebImageBatch
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _operations = [NSMutableArray array];
+        _URLs = [NSMutableOrderedSet orderedSet];
+    }
+    return self;
+}
+
+@end
+
+@interface SDWebImageBatchLoader ()
+
+@property (nonatomic, strong, readwrite, nonnull) id<SDWebImageBatchLoaderAdapter> adapter;
+@property (nonatomic, strong, readwrite, nonnull) NSURLSession *session;
+@property (nonatomic, strong, nonnull) NSMutableDictionary<NSString *, SDWebImageBatch *> *pendingBatches;
+@property (nonatomic, strong, nonnull) dispatch_queue_t batchQueue; // A serial queue to keep the access to batches thread-safe
+
+- (void)cancelOperation:(nonnull SDWebImageBatchLoaderOperation *)operation;
+
+@end
+
+@implementation SDWebImageBatchLoaderOperation
+
+- (void)cancel {
+    if (self.isCancelled) {
+        return;
+    }
+    self.cancelled = YES;
+    [self.loader cancelOperation:self];
+}
+
+@end
+
+// HTTP header field name is case-insensitive
+static NSString * _Nullable SDBatchHeaderValue(NSDictionary * _Nullable headers, NSString * _Nonnull field) {
+    __block NSString *value;
+    [headers enumerateKeysAndObjectsUsingBlock:^(id _Nonnull key, id _Nonnull obj, BOOL * _Nonnull stop) {
+        if ([key isKindOfClass:NSString.class] && [obj isKindOfClass:NSString.class] && [key caseInsensitiveCompare:field] == NSOrderedSame) {
+            value = obj;
+            *stop = YES;
+        }
+    }];
+    return value;
+}
+
+@implementation SDWebImageBatchLoader
+
+- (instancetype)initWithAdapter:(id<SDWebImageBatchLoaderAdapter>)adapter {
+    return [self initWithAdapter:adapter sessionConfiguration:nil];
+}
+
+- (instancetype)initWithAdapter:(id<SDWebImageBatchLoaderAdapter>)adapter sessionConfiguration:(NSURLSessionConfiguration *)sessionConfiguration {
+    self = [super init];
+    if (self) {
+        _adapter = adapter;
+        _session = [NSURLSession sessionWithConfiguration:sessionConfiguration ?: NSURLSessionConfiguration.defaultSessionConfiguration];
+        _batchWindow = 0.02;
+        _maximumBatchSize = 50;
+        _pendingBatches = [NSMutableDictionary dictionary];
+        _batchQueue = dispatch_queue_create("com.hackemist.SDWebImageBatchLoader", DISPATCH_QUEUE_SERIAL);
+    }
+    return self;
+}
+
+- (void)dealloc {
+    [_session invalidateAndCancel];
+}
+
+#pragma mark - SDImageLoader
+
+- (BOOL)canRequestImageForURL:(NSURL *)url {
+    return [self canRequestImageForURL:url options:0 context:nil];
+}
+
+- (BOOL)canRequestImageForURL:(NSURL *)url options:(SDWebImageOptions)options context:(SDWebImageContext *)context {
+    if (!url) {
+        return NO;
+    }
+    return [self.adapter batchKeyForURL:url] != nil;
+}
+
+- (id<SDWebImageOperation>)requestImageWithURL:(NSURL *)url options:(SDWebImageOptions)options context:(SDWebImageContext *)context progress:(SDImageLoaderProgressBlock)progressBlock completed:(SDImageLoaderCompletedBlock)completedBlock {
+    NSString *batchKey = url ? [self.adapter batchKeyForURL:url] : nil;
+    if (!batchKey) {
+        if (completedBlock) {
+            NSError *error = [NSError errorWithDomain:SDWebImageErrorDomain code:SDWebImageErrorInvalidURL userInfo:@{NSLocalizedDescriptionKey : @"Image url can not be batched"}];
+            SDCallbackQueue *queue = context[SDWebImageContextCallbackQueue];
+            [(queue ?: SDCallbackQueue.mainQueue) async:^{
+                completedBlock(nil, nil, error, YES);
+            }];
+        }
+        return nil;
+    }
+    SDWebImageBatchLoaderOperation *operation = [SDWebImageBatchLoaderOperation new];
+    operation.url = url;
+    operation.options = options;
+    operation.context = context;
+    operation.completedBlock = completedBlock;
+    operation.loader = self;
+
+    dispatch_async(self.batchQueue, ^{
+        if (operation.isCancelled) {
+            return;
+        }
+        SDWebImageBatch *batch = self.pendingBatches[batchKey];
+        if (!batch) {
+            batch = [SDWebImageBatch new];
+            batch.batchKey = batchKey;
+            self.pendingBatches[batchKey] = batch;
+            // Send after the window, since the first request of this batch
+            @weakify(self);
+            dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(MAX(self.batchWindow, 0) * NSEC_PER_SEC)), self.batchQueue, ^{
+                @strongify(self);
+                [self sendBatch:batch];
+            });
+        }
+        operation.batch = batch;
+        [batch.operations addObject:operation];
+        [batch.URLs addObject:url];
+        if (batch.URLs.count >= MAX(self.maximumBatchSize, 1)) {
+            [self sendBatch:batch];
+        }
+    });
+
+    return operation;
+}
+
+- (BOOL)shouldBlockFailedURLWithURL:(NSURL *)url error:(NSError *)error {
+    return [self shouldBlockFailedURLWithURL:url error:error options:0 context:nil];
+}
+
+- (BOOL)shouldBlockFailedURLWithURL:(NSURL *)url error:(NSError *)error options:(SDWebImageOptions)options context:(SDWebImageContext *)context {
+    // Only block the image which is missing or corrupted in batched response, the batched request failure may be recoverable
+    if ([error.domain isEqualToString:SDWebImageErrorDomain]) {
+        return error.code == SDWebImageErrorInvalidURL || error.code == SDWebImageErrorBadImageData;
+    }
+    return NO;
+}
+
+#pragma mark - Batch
+
+// Called on batch queue
+- (void)sendBatch:(nonnull SDWebImageBatch *)batch {
+    if (batch.isSent) {
+        return;
+    }
+    batch.sent = YES;
+    if (self.pendingBatches[batch.batchKey] == batch) {
+        [self.pendingBatches removeObjectForKey:batch.batchKey];
+    }
+    // Skip the URLs which all requests are cancelled
+    NSMutableOrderedSet<NSURL *> *URLs = [NSMutableOrderedSet orderedSetWithCapacity:batch.URLs.count];
+    for (SDWebImageBatchLoaderOperation *operation in batch.operations) {
+        if (!operation.isCancelled) {
+            [URLs addObject:operation.url];
+        }
+    }
+    if (URLs.count == 0) {
+        return;
+    }
+    NSArray<NSURL *> *URLArray = URLs.array;
+    NSURLRequest *request = [self.adapter batchRequestWithURLs:URLArray batchKey:batch.batchKey];
+    if (!request) {
+        NSError *error = [NSError errorWithDomain:SDWebImageErrorDomain code:SDWebImageErrorInvalidURL userInfo:@{NSLocalizedDescriptionKey : @"Batched request is nil"}];
+        [self finishBatch:batch error:error];
+        return;
+    }
+    @weakify(self);
+    batch.task = [self.session dataTaskWithRequest:request completionHandler:^(NSData * _Nullable data, NSURLResponse * _Nullable response, NSError * _Nullable error) {
+        @strongify(self);
+        if (!self) {
+            return;
+        }
+        if (!error && [response isKindOfClass:NSHTTPURLResponse.class]) {
+            NSInteger statusCode = ((NSHTTPURLResponse *)response).statusCode;
+            if (statusCode < 200 || statusCode >= 400) {
+                error = [NSError errorWithDomain:SDWebImageErrorDomain code:SDWebImageErrorInvalidDownloadStatusCode userInfo:@{NSLocalizedDescriptionKey : [NSString stringWithFormat:@"Batched download marked as failed because of invalid response status code %ld", (long)statusCode], SDWebImageErrorDownloadStatusCodeKey : @(statusCode), SDWebImageErrorDownloadResponseKey : response}];
+            }
+        }
+        if (!error && data.length == 0) {
+            error = [NSError errorWithDomain:SDWebImageErrorDomain code:SDWebImageErrorBadImageData userInfo:@{NSLocalizedDescriptionKey : @"Batched response data is nil"}];
+        }
+        if (error) {
+            [self finishBatch:batch error:error];
+            return;
+        }
+        // Split and decode in the global queue
+        dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+            [self finishBatch:batch data:data response:response URLs:URLArray];
+        });
+    }];
+    [batch.task resume];
+}
+
+- (void)finishBatch:(nonnull SDWebImageBatch *)batch error:(nonnull NSError *)error {
+    for (SDWebImageBatchLoaderOperation *operation in batch.operations) {
+        [self callCompletionBlockForOperation:operation image:nil data:nil error:error];
+    }
+}
+
+- (void)finishBatch:(nonnull SDWebImageBatch *)batch data:(nonnull NSData *)data response:(nullable NSURLResponse *)response URLs:(nonnull NSArray<NSURL *> *)URLs {
+    NSDictionary<NSURL *, UIImage *> *images;
+    NSDictionary<NSURL *, NSData *> *imageDatas;
+    if ([self.adapter respondsToSelector:@selector(imagesWithBatchData:response:URLs:)]) {
+        images = [self.adapter imagesWithBatchData:data response:response URLs:URLs];
+    } else {
+        imageDatas = [self.adapter imageDataWithBatchData:data response:response URLs:URLs];
+    }
+    for (SDWebImageBatchLoaderOperation *operation in batch.operations) {
+        if (operation.isCancelled) {
+            continue;
+        }
+        UIImage *image;
+        NSData *imageData;
+        if (images) {
+            image = images[operation.url];
+        } else {
+            imageData = imageDatas[operation.url];
+            if (imageData.length > 0) {
+                image = SDImageLoaderDecodeImageData(imageData, operation.url, operation.options, operation.context);
+            }
+        }
+        if (image) {
+            [self callCompletionBlockForOperation:operation image:image data:imageData error:nil];
+        } else {
+            NSString *description = imageData.length > 0 ? @"Downloaded image decode failed" : @"Image is missing in batched response";
+            [self callCompletionBlockForOperation:operation image:nil data:nil error:[NSError errorWithDomain:SDWebImageErrorDomain code:SDWebImageErrorBadImageData userInfo:@{NSLocalizedDescriptionKey : description}]];
+        }
+    }
+}
+
+- (void)cancelOperation:(nonnull SDWebImageBatchLoaderOperation *)operation {
+    [self callCompletionBlockForOperation:operation image:nil data:nil error:[NSError errorWithDomain:SDWebImageErrorDomain code:SDWebImageErrorCancelled userInfo:@{NSLocalizedDescriptionKey : @"Operation cancelled by user"}]];
+    dispatch_async(self.batchQueue, ^{
+        SDWebImageBatch *batch = operation.batch;
+        if (!batch.isSent) {
+            return;
+        }
+        // Cancel the batched request only when all the requests are cancelled
+        for (SDWebImageBatchLoaderOperation *batchOperation in batch.operations) {
+            if (!batchOperation.isCancelled) {
+                return;
+            }
+        }
+        [batch.task cancel];
+    });
+}
+
+- (void)callCompletionBlockForOperation:(nonnull SDWebImageBatchLoaderOperation *)operation
+                                  image:(nullable UIImage *)image
+                                   data:(nullable NSData *)data
+                                  error:(nullable NSError *)error {
+    // Each operation is completed only once, either finished or cancelled
+    @synchronized (operation) {
+        if (operation.isFinished) {
+            return;
+        }
+        operation.finished = YES;
+    }
+    SDImageLoaderCompletedBlock completedBlock = operation.completedBlock;
+    if (completedBlock) {
+        SDCallbackQueue *queue = operation.context[SDWebImageContextCallbackQueue];
+        [(queue ?: SDCallbackQueue.mainQueue) async:^{
+            completedBlock(image, data, error, YES);
+        }];
+    }
+}
+
+#pragma mark - Multipart
+
++ (NSDictionary<NSString *, NSData *> *)partsFromMultipartData:(NSData *)data response:(NSURLResponse *)response {
+    if (![response isKindOfClass:NSHTTPURLResponse.class]) {
+        return nil;
+    }
+    NSString *contentType = SDBatchHeaderValue(((NSHTTPURLResponse *)response).allHeaderFields, @"Content-Type");
+    if (![contentType.lowercaseString hasPrefix:@"multipart/"]) {
+        return nil;
+    }
+    NSString *boundary;
+    for (NSString *component in [contentType componentsSeparatedByString:@";"]) {
+        NSString *parameter = [component stringByTrimmingCharactersInSet:NSCharacterSet.whitespaceCharacterSet];
+        if ([parameter.lowercaseString hasPrefix:@"boundary="]) {
+            boundary = [[parameter substringFromIndex:@"boundary=".length] stringByTrimmingCharactersInSet:[NSCharacterSet characterSetWithCharactersInString:@"\""]];
+        }
+    }
+    if (boundary.length == 0) {
+        return nil;
+    }
+
+    NSData *delimiter = [[@"--" stringByAppendingString:boundary] dataUsingEncoding:NSUTF8StringEncoding];
+    NSData *lineBreak = [@"\r\n" dataUsingEncoding:NSUTF8StringEncoding];
+    NSData *headerBreak = [@"\r\n\r\n" dataUsingEncoding:NSUTF8StringEncoding];
+    const char *bytes = data.bytes;
+    NSUInteger length = data.length;
+    NSMutableDictionary<NSString *, NSData *> *parts = [NSMutableDictionary dictionary];
+
+    NSRange delimiterRange = [data rangeOfData:delimiter options:0 range:NSMakeRange(0, length)];
+    while (delimiterRange.location != NSNotFound) {
+        NSUInteger location = NSMaxRange(delimiterRange);
+        if (location + 2 <= length && bytes[location] == '-' && bytes[location + 1] == '-') {
+            // Close delimiter
+            break;
+        }
+        NSRange nextRange = [data rangeOfData:delimiter options:0 range:NSMakeRange(location, length - location)];
+        if (nextRange.location == NSNotFound) {
+            break;
+        }
+        // The part starts after the delimiter line, and ends before the CRLF of next delimiter
+        NSRange lineRange = [data rangeOfData:lineBreak options:0 range:NSMakeRange(location, nextRange.location - location)];
+        NSUInteger partStart = lineRange.location == NSNotFound ? location : NSMaxRange(lineRange);
+        NSUInteger partEnd = nextRange.location;
+        if (partEnd >= partStart + 2 && bytes[partEnd - 2] == '\r' && bytes[partEnd - 1] == '\n') {
+            partEnd -= 2;
+        }
+        if (partEnd > partStart) {
+            NSData *part = [data subdataWithRange:NSMakeRange(partStart, partEnd - partStart)];
+            NSString *key;
+            NSData *body;
+            if (part.length >= 2 && ((const char *)part.bytes)[0] == '\r' && ((const char *)part.bytes)[1] == '\n') {
+                // No headers
+                body = [part subdataWithRange:NSMakeRange(2, part.length - 2)];
+            } else {
+                NSRange headerRange = [part rangeOfData:headerBreak options:0 range:NSMakeRange(0, part.length)];
+                if (headerRange.location != NSNotFound) {
+                    NSString *headerString = [[NSString alloc] initWithData:[part subdataWithRange:NSMakeRange(0, headerRange.location)] encoding:NSUTF8StringEncoding];
+                    NSMutableDictionary<NSString *, NSString *> *headers = [NSMutableDictionary dictionary];
+                    for (NSString *line in [headerString componentsSeparatedByString:@"\r\n"]) {
+                        NSRange colonRange = [line rangeOfString:@":"];
+                        if (colonRange.location == NSNotFound) {
+                            continue;
+                        }
+                        NSString *name = [[line substringToIndex:colonRange.location] stringByTrimmingCharactersInSet:NSCharacterSet.whitespaceCharacterSet];
+                        NSString *value = [[line substringFromIndex:NSMaxRange(colonRange)] stringByTrimmingCharactersInSet:NSCharacterSet.whitespaceCharacterSet];
+                        headers[name] = value;
+                    }
+                    key = SDBatchHeaderValue(headers, @"Content-Location") ?: SDBatchHeaderValue(headers, @"Content-ID");
+                    body = [part subdataWithRange:NSMakeRange(NSMaxRange(headerRange), part.length - NSMaxRange(headerRange))];
+                }
+            }
+            if (key && body) {
+                parts[key] = body;
+            }
+        }
+        delimiterRange = nextRange;
+    }
+
+    return [parts copy];
+}
+
+@end
@@ -227,6 +227,21 @@ typedef NS_OPTIONS(NSUInteger, SDWebImageOptions) {
      * @note If you have complicated transition animation, just use `SDWebImageManager` and do UI state management by yourself, do not use the top-level API (`sd_setImageWithURL:`)
      */
     SDWebImageWaitTransition = 1 << 25,
+    
+    /**
+     * Even if the image is cached, revalidate it with the HTTP conditional request, without using NSURLCache like `SDWebImageRefreshCached`.
+     * The `ETag`, `Last-Modified` and freshness lifetime (`Cache-Control: max-age`) of the download response are stored by the image cache along with the image. When the cached image is still fresh, no request is sent. Otherwise the cached image is served instantly (stale-while-revalidate), and a conditional request (`If-None-Match`/`If-Modified-Since`) is sent. A `304 Not Modified` response only refreshes the freshness without transferring or decoding the image body. If the image changed, the completion block is called again with the new image.
+     * @note The image cache should implement `queryCacheValidatorForKey:completion:` and `storeCacheValidator:forKey:`, like `SDImageCache`. The image loader should support `SDWebImageContextLoaderCacheValidator`, like `SDWebImageDownloader`.
+     */
+    SDWebImageRevalidateCached = 1 << 27,
+    
+    /**
+     * By default, the image is decoded at full size unless `SDWebImageContextImageThumbnailPixelSize` is provided, so a large image is fully decoded even when displayed in a small view.
+     * This flag derive the thumbnail pixel size from the target view's bounds and screen scale, when the context does not provide one. The image is decoded to that size directly (for ImageIO coders, using `kCGImageSourceThumbnailMaxPixelSize`), which reduce the decoding time and memory.
+     * The view's content mode is considered: aspect fit use the bounds, scale to fill use the bounds without preserving aspect ratio, aspect fill scale the image by `max(viewWidth / imageWidth, viewHeight / imageHeight)` to cover the bounds (see `SDWebImageContextImageThumbnailAspectFill`). Other content modes (which does not scale the image) and the zero bounds (not laid out yet) are ignored.
+     * @note This options is UI level options, has no usage on ImageManager or other components. The thumbnail image is cached separately from the full size image.
+     */
+    SDWebImageThumbnailFromViewBounds = 1 << 28,
 };
 
 
@@ -315,6 +330,13 @@ FOUNDATION_EXPORT SDWebImageContextOption _Nonnull const SDWebImageContextImageP
  */
 FOUNDATION_EXPORT SDWebImageContextOption _Nonnull const SDWebImageContextImageThumbnailPixelSize;
 
+/**
+ A Boolean value indicating whether the thumbnail should fill the `.imageThumbnailPixelSize` (like aspect fill content mode) instead of fitting in it. The thumbnail keeps the aspect ratio, and the scale is calculated from the image size as `max(thumbnailWidth / imageWidth, thumbnailHeight / imageHeight)`. Only used when `.imagePreserveAspectRatio` is YES.
+ Defaults to NO. (NSNumber)
+ @note The `SDWebImageThumbnailFromViewBounds` option use this for the view with aspect fill content mode.
+ */
+FOUNDATION_EXPORT SDWebImageContextOption _Nonnull const SDWebImageContextImageThumbnailAspectFill;
+
 /**
  A NSString value (UTI) indicating the source image's file extension. Example: "public.jpeg-2000", "com.nikon.raw-image", "public.tiff"
  Some image file format share the same data structure but has different tag explanation, like TIFF and NEF/SRW, see https://en.wikipedia.org/wiki/TIFF
@@ -408,6 +430,12 @@ FOUNDATION_EXPORT SDWebImageContextOption _Nonnull const SDWebImageContextDownlo
  */
 FOUNDATION_EXPORT SDWebImageContextOption _Nonnull const SDWebImageContextDownloadDecryptor;
 
+/**
+ A id<SDWebImageCacheKeyFilter> instance to convert an URL into the download coalescing key. Download requests which produce the same coalescing key share one network task, and each request still get its own decoding (thumbnail, scale, etc) and transform result. If you provide one, it will ignore the `coalescingKeyFilter` in downloader and use provided one instead. (id<SDWebImageCacheKeyFilter>)
+ @note For example, return the URL without tracking query parameters, or pass the same instance as `SDWebImageContextCacheKeyFilter` to coalesce the requests which share the same cache key.
+ */
+FOUNDATION_EXPORT SDWebImageContextOption _Nonnull const SDWebImageContextDownloadCoalescingKeyFilter;
+
 /**
  A id<SDWebImageCacheKeyFilter> instance to convert an URL into a cache key. It's used when manager need cache key to use image cache. If you provide one, it will ignore the `cacheKeyFilter` in manager and use provided one instead. (id<SDWebImageCacheKeyFilter>)
  */
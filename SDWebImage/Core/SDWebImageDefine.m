@@ -146,6 +146,7 @@ SDWebImageContextOption const SDWebImageContextImageDecodeOptions = @"imageDecod
 SDWebImageContextOption const SDWebImageContextImageScaleFactor = @"imageScaleFactor";
 SDWebImageContextOption const SDWebImageContextImagePreserveAspectRatio = @"imagePreserveAspectRatio";
 SDWebImageContextOption const SDWebImageContextImageThumbnailPixelSize = @"imageThumbnailPixelSize";
+SDWebImageContextOption const SDWebImageContextImageThumbnailAspectFill = @"imageThumbnailAspectFill";
 SDWebImageContextOption const SDWebImageContextImageTypeIdentifierHint = @"imageTypeIdentifierHint";
 SDWebImageContextOption const SDWebImageContextImageScaleDownLimitBytes = @"imageScaleDownLimitBytes";
 SDWebImageContextOption const SDWebImageContextImageDecodeToHDR = @"imageDecodeToHDR";
@@ -159,5 +160,6 @@ SDWebImageContextOption const SDWebImageContextAnimatedImageClass = @"animatedIm
 SDWebImageContextOption const SDWebImageContextDownloadRequestModifier = @"downloadRequestModifier";
 SDWebImageContextOption const SDWebImageContextDownloadResponseModifier = @"downloadResponseModifier";
 SDWebImageContextOption const SDWebImageContextDownloadDecryptor = @"downloadDecryptor";
+SDWebImageContextOption const SDWebImageContextDownloadCoalescingKeyFilter = @"downloadCoalescingKeyFilter";
 SDWebImageContextOption const SDWebImageContextCacheKeyFilter = @"cacheKeyFilter";
 SDWebImageContextOption const SDWebImageContextCacheSerializer = @"cacheSerializer";
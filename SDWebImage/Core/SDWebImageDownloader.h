@@ -14,6 +14,8 @@
 #import "SDWebImageDownloaderRequestModifier.h"
 #import "SDWebImageDownloaderResponseModifier.h"
 #import "SDWebImageDownloaderDecryptor.h"
+#import "SDWebImageDownloaderStatistics.h"
+#import "SDWebImageCacheKeyFilter.h"
 #import "SDImageLoader.h"
 
 /// Downloader options
@@ -139,6 +141,18 @@ typedef SDImageLoaderCompletedBlock SDWebImageDownloaderCompletedBlock;
  */
 @property (nonatomic, strong, nullable, readonly) NSURLSessionTaskMetrics *metrics API_AVAILABLE(macos(10.12), ios(10.0), watchos(3.0), tvos(10.0));
 
+/**
+ Pause the progressive decoding for this download, for example when the view is scrolled off-screen. Once all the downloads sharing the same operation paused, the progressive decoding passes are skipped, the final image is still decoded.
+ Defaults to NO. This only take effect when using `SDWebImageDownloaderProgressiveLoad`.
+ @note The view category (`UIView+WebCache`) update this automatically during progressive loading, paused when the view is not in window or hidden.
+ */
+@property (nonatomic, assign, getter=isProgressiveDecodePaused) BOOL progressiveDecodePaused;
+
+/**
+ The download's skipped progressive decoding passes count. This will be 0 until the download stopped, or if download operation does not support it.
+ */
+@property (nonatomic, assign, readonly) NSUInteger skippedProgressiveDecodeCount;
+
 @end
 
 
@@ -178,6 +192,16 @@ typedef SDImageLoaderCompletedBlock SDWebImageDownloaderCompletedBlock;
  */
 @property (nonatomic, strong, nullable) id<SDWebImageDownloaderDecryptor> decryptor;
 
+/**
+ * Set the coalescing key filter to convert the download URL into the key used to coalesce download requests.
+ * Download requests which produce the same coalescing key share one network task, the response body is fetched once and each request still callback with its own decode options (thumbnail pixel size, scale factor, etc).
+ * Defaults to nil, means the URL's `absoluteString` is used, so only the identical URLs are coalesced.
+ * @note The first request's URL is used for the actual network task. So only return the same key for URLs which always respond the same image data, like the URLs differ only by tracking query parameters.
+ * @note If you want to coalesce the requests with the same cache key, you can use the same filter instance as `SDWebImageManager.cacheKeyFilter`.
+ * @note If you want to modify single request, consider using `SDWebImageContextDownloadCoalescingKeyFilter` context option.
+ */
+@property (nonatomic, strong, nullable) id<SDWebImageCacheKeyFilter> coalescingKeyFilter;
+
 /**
  * The configuration in use by the internal NSURLSession. If you want to provide a custom sessionConfiguration, use `SDWebImageDownloaderConfig.sessionConfiguration` and create a new downloader instance.
  @note This is immutable according to NSURLSession's documentation. Mutating this object directly has no effect.
@@ -194,6 +218,13 @@ typedef SDImageLoaderCompletedBlock SDWebImageDownloaderCompletedBlock;
  */
 @property (nonatomic, assign, readonly) NSUInteger currentDownloadCount;
 
+/**
+ * The aggregated data usage statistics of all the downloads, such as received bytes, time-to-first-byte and transfer time histograms, coalesced requests savings and cancelled bytes, grouped by host.
+ * Use `statistics.snapshot` to read the current value, and `statistics.reset` to start a new measurement (for example, per screen).
+ * @note Custom download operation class should implement the `statistics` property to record.
+ */
+@property (nonatomic, strong, readonly, nonnull) SDWebImageDownloaderStatistics *statistics;
+
 /**
  *  Returns the global shared downloader instance. Which use the `SDWebImageDownloaderConfig.defaultDownloaderConfig` config.
  */
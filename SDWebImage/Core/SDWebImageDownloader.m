@@ -28,6 +28,7 @@ static void * SDWebImageDownloaderContext = &SDWebImageDownloaderContext;
 @property (nonatomic, strong, nullable, readwrite) NSURLRequest *request;
 @property (nonatomic, strong, nullable, readwrite) NSURLResponse *response;
 @property (nonatomic, strong, nullable, readwrite) NSURLSessionTaskMetrics *metrics API_AVAILABLE(macos(10.12), ios(10.0), watchos(3.0), tvos(10.0));
+@property (nonatomic, assign, readwrite) NSUInteger skippedProgressiveDecodeCount;
 @property (nonatomic, weak, nullable, readwrite) id downloadOperationCancelToken;
 @property (nonatomic, weak, nullable) NSOperation<SDWebImageDownloaderOperation> *downloadOperation;
 @property (nonatomic, assign, getter=isCancelled) BOOL cancelled;
@@ -41,7 +42,7 @@ static void * SDWebImageDownloaderContext = &SDWebImageDownloaderContext;
 @interface SDWebImageDownloader () <NSURLSessionTaskDelegate, NSURLSessionDataDelegate>
 
 @property (strong, nonatomic, nonnull) NSOperationQueue *downloadQueue;
-@property (strong, nonatomic, nonnull) NSMutableDictionary<NSURL *, NSOperation<SDWebImageDownloaderOperation> *> *URLOperations;
+@property (strong, nonatomic, nonnull) NSMutableDictionary<NSString *, NSOperation<SDWebImageDownloaderOperation> *> *URLOperations;
 @property (strong, nonatomic, nullable) NSMutableDictionary<NSString *, NSString *> *HTTPHeaders;
 
 // The session in which data tasks will run
@@ -102,6 +103,7 @@ static void * SDWebImageDownloaderContext = &SDWebImageDownloaderContext;
         _downloadQueue.maxConcurrentOperationCount = _config.maxConcurrentDownloads;
         _downloadQueue.name = @"com.hackemist.SDWebImageDownloader.downloadQueue";
         _URLOperations = [NSMutableDictionary new];
+        _statistics = [SDWebImageDownloaderStatistics new];
         NSMutableDictionary<NSString *, NSString *> *headerDictionary = [NSMutableDictionary dictionary];
         NSString *userAgent = nil;
         // User-Agent Header; see http://www.w3.org/Protocols/rfc2616/rfc2616-sec14.html#sec14.43
@@ -218,8 +220,10 @@ static void * SDWebImageDownloaderContext = &SDWebImageDownloaderContext;
         cacheKey = url.absoluteString;
     }
     SDImageCoderOptions *decodeOptions = SDGetDecodeOptionsFromContext(context, [self.class imageOptionsFromDownloaderOptions:options], cacheKey);
+    // Different URLs which produce the same coalescing key share the same download operation
+    NSString *coalescingKey = [self coalescingKeyForURL:url context:context];
     SD_LOCK(_operationsLock);
-    NSOperation<SDWebImageDownloaderOperation> *operation = [self.URLOperations objectForKey:url];
+    NSOperation<SDWebImageDownloaderOperation> *operation = [self.URLOperations objectForKey:coalescingKey];
     // There is a case that the operation may be marked as finished or cancelled, but not been removed from `self.URLOperations`.
     BOOL shouldNotReuseOperation;
     if (operation) {
@@ -246,10 +250,10 @@ static void * SDWebImageDownloaderContext = &SDWebImageDownloaderContext;
                 return;
             }
             SD_LOCK(self->_operationsLock);
-            [self.URLOperations removeObjectForKey:url];
+            [self.URLOperations removeObjectForKey:coalescingKey];
             SD_UNLOCK(self->_operationsLock);
         };
-        [self.URLOperations setObject:operation forKey:url];
+        [self.URLOperations setObject:operation forKey:coalescingKey];
         // Add the handlers before submitting to operation queue, avoid the race condition that operation finished before setting handlers.
         downloadOperationCancelToken = [operation addHandlersForProgress:progressBlock completed:completedBlock decodeOptions:decodeOptions];
         // Add operation to operation queue only after all configuration done according to Apple's doc.
@@ -273,6 +277,28 @@ static void * SDWebImageDownloaderContext = &SDWebImageDownloaderContext;
 }
 
 #pragma mark Helper methods
+- (nonnull NSString *)coalescingKeyForURL:(nonnull NSURL *)url context:(nullable SDWebImageContext *)context {
+    id<SDWebImageCacheKeyFilter> coalescingKeyFilter;
+    if ([context valueForKey:SDWebImageContextDownloadCoalescingKeyFilter]) {
+        coalescingKeyFilter = [context valueForKey:SDWebImageContextDownloadCoalescingKeyFilter];
+    } else {
+        coalescingKeyFilter = self.coalescingKeyFilter;
+    }
+    NSString *coalescingKey;
+    if (coalescingKeyFilter) {
+        coalescingKey = [coalescingKeyFilter cacheKeyForURL:url];
+    }
+    // Fallback to the URL itself, which keep the same behavior as previous
+    if (!coalescingKey) {
+        coalescingKey = url.absoluteString;
+    }
+    // The conditional request may respond `304 Not Modified` without body, which can not be shared with the normal request
+    if (context[SDWebImageContextLoaderCacheValidator]) {
+        coalescingKey = [coalescingKey stringByAppendingString:@"-Revalidate"];
+    }
+    return coalescingKey;
+}
+
 #pragma clang diagnostic push
 #pragma clang diagnostic ignored "-Wdeprecated-declarations"
 + (SDWebImageOptions)imageOptionsFromDownloaderOptions:(SDWebImageDownloaderOptions)downloadOptions {
@@ -304,6 +330,15 @@ static void * SDWebImageDownloaderContext = &SDWebImageDownloaderContext;
     mutableRequest.allHTTPHeaderFields = self.HTTPHeaders;
     SD_UNLOCK(_HTTPHeadersLock);
     
+    // Conditional request to revalidate the cached image, the `304 Not Modified` response is handled by us but not NSURLCache
+    SDImageCacheValidator *cacheValidator = context[SDWebImageContextLoaderCacheValidator];
+    if (cacheValidator) {
+        mutableRequest.cachePolicy = NSURLRequestReloadIgnoringLocalCacheData;
+        [cacheValidator.conditionalHeaders enumerateKeysAndObjectsUsingBlock:^(NSString * _Nonnull field, NSString * _Nonnull value, BOOL * _Nonnull stop) {
+            [mutableRequest setValue:value forHTTPHeaderField:field];
+        }];
+    }
+    
     // Context Option
     SDWebImageMutableContext *mutableContext;
     if (context) {
@@ -374,6 +409,22 @@ static void * SDWebImageDownloaderContext = &SDWebImageDownloaderContext;
         operation.minimumProgressInterval = MIN(MAX(self.config.minimumProgressInterval, 0), 1);
     }
     
+    if ([operation respondsToSelector:@selector(setMinimumProgressiveDecodeInterval:)]) {
+        operation.minimumProgressiveDecodeInterval = MAX(self.config.minimumProgressiveDecodeInterval, 0);
+    }
+    
+    if ([operation respondsToSelector:@selector(setMinimumProgressiveDecodeBytes:)]) {
+        operation.minimumProgressiveDecodeBytes = self.config.minimumProgressiveDecodeBytes;
+    }
+    
+    if ([operation respondsToSelector:@selector(setHedgePolicy:)]) {
+        operation.hedgePolicy = self.config.hedgePolicy;
+    }
+    
+    if ([operation respondsToSelector:@selector(setStatistics:)]) {
+        operation.statistics = self.statistics;
+    }
+    
     if ([operation respondsToSelector:@selector(setAcceptableStatusCodes:)]) {
         operation.acceptableStatusCodes = self.config.acceptableStatusCodes;
     }
@@ -442,10 +493,15 @@ static void * SDWebImageDownloaderContext = &SDWebImageDownloaderContext;
         if ([operation respondsToSelector:@selector(dataTask)]) {
             // So we lock the operation here, and in `SDWebImageDownloaderOperation`, we use `@synchonzied (self)`, to ensure the thread safe between these two classes.
             NSURLSessionTask *operationTask;
+            NSURLSessionTask *hedgeTask;
             @synchronized (operation) {
                 operationTask = operation.dataTask;
+                if ([operation respondsToSelector:@selector(hedgeTask)]) {
+                    hedgeTask = operation.hedgeTask;
+                }
             }
-            if (operationTask.taskIdentifier == task.taskIdentifier) {
+            // The hedging task is racing with the data task, both of them should be routed to the operation
+            if (operationTask.taskIdentifier == task.taskIdentifier || (hedgeTask && hedgeTask.taskIdentifier == task.taskIdentifier)) {
                 returnOperation = operation;
                 break;
             }
@@ -577,6 +633,21 @@ didReceiveResponse:(NSURLResponse *)response
                 self.metrics = downloadOperation.metrics;
             }
         }
+        if ([downloadOperation respondsToSelector:@selector(skippedProgressiveDecodeCount)]) {
+            self.skippedProgressiveDecodeCount = downloadOperation.skippedProgressiveDecodeCount;
+        }
+    }
+}
+
+- (void)setProgressiveDecodePaused:(BOOL)progressiveDecodePaused {
+    @synchronized (self) {
+        _progressiveDecodePaused = progressiveDecodePaused;
+        if (self.isCancelled) {
+            return;
+        }
+        if ([self.downloadOperation respondsToSelector:@selector(setProgressiveDecodePaused:forToken:)]) {
+            [self.downloadOperation setProgressiveDecodePaused:progressiveDecodePaused forToken:self.downloadOperationCancelToken];
+        }
     }
 }
 
@@ -633,6 +704,25 @@ didReceiveResponse:(NSURLResponse *)response
         downloaderOptions |= SDWebImageDownloaderIgnoreCachedResponse;
     }
     
+    if (options & SDWebImageRevalidateCached) {
+        if (context[SDWebImageContextLoaderCacheValidator]) {
+            // force progressive off since the cached image is already served
+            downloaderOptions &= ~SDWebImageDownloaderProgressiveLoad;
+        }
+        // attach the response's cache validator to the downloaded image, which is stored by manager into image cache
+        __block SDWebImageDownloadToken *token;
+        SDImageLoaderCompletedBlock revalidateCompletedBlock = ^(UIImage * _Nullable image, NSData * _Nullable data, NSError * _Nullable error, BOOL finished) {
+            if (image && finished && !error) {
+                image.sd_cacheValidator = [SDImageCacheValidator validatorWithResponse:token.response];
+            }
+            if (completedBlock) {
+                completedBlock(image, data, error, finished);
+            }
+        };
+        token = [self downloadImageWithURL:url options:downloaderOptions context:context progress:progressBlock completed:revalidateCompletedBlock];
+        return token;
+    }
+    
     return [self downloadImageWithURL:url options:downloaderOptions context:context progress:progressBlock completed:completedBlock];
 }
 #pragma clang diagnostic pop
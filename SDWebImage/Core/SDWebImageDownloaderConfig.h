@@ -8,6 +8,7 @@
 
 #import <Foundation/Foundation.h>
 #import "SDWebImageCompat.h"
+#import "SDWebImageDownloaderHedgePolicy.h"
 
 /// Operation execution order
 typedef NS_ENUM(NSInteger, SDWebImageDownloaderExecutionOrder) {
@@ -55,6 +56,28 @@ typedef NS_ENUM(NSInteger, SDWebImageDownloaderExecutionOrder) {
  */
 @property (nonatomic, assign) double minimumProgressInterval;
 
+/**
+ * The minimum interval (in seconds) between two progressive decoding passes during network downloading. Each pass re-decode the whole image data received so far, so this can reduce the CPU usage for large progressive images.
+ * The actual interval is adaptive, it's at least twice of the previous pass's decoding time, which keep the progressive decoding use at most half of the time.
+ * @note This only take effect when using `SDWebImageDownloaderProgressiveLoad`. The final image callback does not get effected.
+ * Defaults to 0, which means each time we receive the new data from URLSession and no decoding is running, we start a new progressive decoding pass.
+ */
+@property (nonatomic, assign) NSTimeInterval minimumProgressiveDecodeInterval;
+
+/**
+ * The minimum received bytes between two progressive decoding passes during network downloading. The pass will be skipped if the newly received data since previous pass is less than this value.
+ * @note This only take effect when using `SDWebImageDownloaderProgressiveLoad`. The final image callback does not get effected.
+ * Defaults to 0, which means no limit.
+ */
+@property (nonatomic, assign) NSUInteger minimumProgressiveDecodeBytes;
+
+/**
+ * The hedging policy to reduce the tail latency. When a download request does not receive the first byte within the policy's deadline, a duplicate request is issued, and the first response wins.
+ * @note The policy instance is shared but not copied when copying the config, since it collects the time-to-first-byte samples and the hedge budget for all the downloads.
+ * Defaults to nil, which means hedging is disabled.
+ */
+@property (nonatomic, strong, nullable) SDWebImageDownloaderHedgePolicy *hedgePolicy;
+
 /**
  * The custom session configuration in use by NSURLSession. If you don't provide one, we will use `defaultSessionConfiguration` instead.
  * Defatuls to nil.
@@ -37,6 +37,9 @@ static SDWebImageDownloaderConfig * _defaultDownloaderConfig;
     config.maxConcurrentDownloads = self.maxConcurrentDownloads;
     config.downloadTimeout = self.downloadTimeout;
     config.minimumProgressInterval = self.minimumProgressInterval;
+    config.minimumProgressiveDecodeInterval = self.minimumProgressiveDecodeInterval;
+    config.minimumProgressiveDecodeBytes = self.minimumProgressiveDecodeBytes;
+    config.hedgePolicy = self.hedgePolicy;
     config.sessionConfiguration = [self.sessionConfiguration copyWithZone:zone];
     config.operationClass = self.operationClass;
     config.executionOrder = self.executionOrder;
@@ -0,0 +1,97 @@
+/*
+ * This file is part of the SDWebImage package.
+ * (c) Olivier Poitrey <rs@dailymotion.com>
+ *
+ * For the full copyright and license information, please view the LICENSE
+ * file that was distributed with this source code.
+ */
+
+#import <Foundation/Foundation.h>
+#import "SDWebImageCompat.h"
+#import "SDWebImageDownloaderRequestModifier.h"
+
+/**
+ The hedging policy for image downloader, to reduce the tail latency caused by the stalled connections.
+ When a download request does not receive the response (first byte) within the deadline, a duplicate request is issued. The first one which receives the response wins, and the other one is cancelled.
+ The deadline is the percentile of the recent time-to-first-byte samples, so only the slowest requests get hedged. The hedged requests are limited by a global budget, so hedging can not amplify the load to server.
+ @note The policy is stateful and thread-safe. It's shared between the downloaders which use the same policy instance (the `SDWebImageDownloaderConfig` copy does not copy the policy).
+ @note Only `GET` and `HEAD` requests are hedged, since they are idempotent.
+ */
+@interface SDWebImageDownloaderHedgePolicy : NSObject
+
+/**
+ * The percentile of the recent time-to-first-byte samples, used as the hedging deadline.
+ * The value should be 0.0-1.0.
+ * Defaults to 0.95, which means about 5% of the requests will be hedged.
+ */
+@property (nonatomic, assign) double deadlinePercentile;
+
+/**
+ * The deadline (in seconds) used when there are not enough time-to-first-byte samples.
+ * Defaults to 1.0.
+ */
+@property (nonatomic, assign) NSTimeInterval initialDeadline;
+
+/**
+ * The minimum deadline (in seconds), to avoid hedging the requests on a fast network.
+ * Defaults to 0.05.
+ */
+@property (nonatomic, assign) NSTimeInterval minimumDeadline;
+
+/**
+ * The ratio of hedged requests to all requests. Each request earns this ratio of hedge budget, and each hedged request costs 1.
+ * The value should be 0.0-1.0. Set to 0 to disable hedging.
+ * Defaults to 0.05, which means at most 5% extra requests are issued.
+ */
+@property (nonatomic, assign) double budgetRatio;
+
+/**
+ * The maximum hedge budget can be accumulated, this limits the burst of hedged requests when the network becomes stalled suddenly.
+ * Defaults to 10.
+ */
+@property (nonatomic, assign) NSUInteger maximumBudget;
+
+/**
+ * The request modifier to modify the duplicate request, such as to use an alternate host. Return nil will skip hedging for this request.
+ * Defaults to nil, means the duplicate request is the same as the original one.
+ */
+@property (nonatomic, strong, nullable) id<SDWebImageDownloaderRequestModifier> requestModifier;
+
+/**
+ * The current hedging deadline (in seconds) calculated from the recent time-to-first-byte samples.
+ */
+@property (nonatomic, assign, readonly) NSTimeInterval currentDeadline;
+
+/**
+ * The total number of hedged requests issued.
+ */
+@property (nonatomic, assign, readonly) NSUInteger hedgedRequestCount;
+
+/**
+ * The total number of hedged requests which receive the response before the original one.
+ */
+@property (nonatomic, assign, readonly) NSUInteger hedgeWinCount;
+
+/**
+ * Record a download request started, this earn the hedge budget by `budgetRatio`.
+ */
+- (void)recordRequest;
+
+/**
+ * Record the time-to-first-byte sample of a download request.
+ * @param duration The duration (in seconds) from the request started to the response received.
+ */
+- (void)recordTimeToFirstByte:(NSTimeInterval)duration;
+
+/**
+ * Try to acquire the hedge budget for a duplicate request.
+ * @return YES if the budget is enough and consumed, NO if the request should not be hedged.
+ */
+- (BOOL)acquireHedge;
+
+/**
+ * Record a hedged request receives the response before the original one.
+ */
+- (void)recordHedgeWin;
+
+@end
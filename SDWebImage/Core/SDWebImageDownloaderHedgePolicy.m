@@ -0,0 +1,121 @@
+/*
+ * This file is part of the SDWebImage package.
+ * (c) Olivier Poitrey <rs@dailymotion.com>
+ *
+ * For the full copyright and license information, please view the LICENSE
+ * file that was distributed with this source code.
+ */
+
+#import "SDWebImageDownloaderHedgePolicy.h"
+#import "SDInternalMacros.h"
+
+// The number of recent time-to-first-byte samples kept to calculate the percentile
+#define SD_HEDGE_SAMPLE_CAPACITY 64
+// The minimum number of samples before using the percentile as deadline
+#define SD_HEDGE_SAMPLE_MINIMUM 8
+
+@interface SDWebImageDownloaderHedgePolicy ()
+
+@property (nonatomic, assign, readwrite) NSUInteger hedgedRequestCount;
+@property (nonatomic, assign, readwrite) NSUInteger hedgeWinCount;
+
+@end
+
+@implementation SDWebImageDownloaderHedgePolicy {
+    SD_LOCK_DECLARE(_lock); // A lock to keep the access to samples and budget thread-safe
+    NSTimeInterval _samples[SD_HEDGE_SAMPLE_CAPACITY]; // ring buffer
+    NSUInteger _sampleIndex;
+    NSUInteger _sampleCount;
+    double _budget;
+}
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _deadlinePercentile = 0.95;
+        _initialDeadline = 1.0;
+        _minimumDeadline = 0.05;
+        _budgetRatio = 0.05;
+        _maximumBudget = 10;
+        SD_LOCK_INIT(_lock);
+    }
+    return self;
+}
+
+static int SDHedgeCompareSample(const void *a, const void *b) {
+    NSTimeInterval lhs = *(const NSTimeInterval *)a;
+    NSTimeInterval rhs = *(const NSTimeInterval *)b;
+    return (lhs > rhs) - (lhs < rhs);
+}
+
+- (NSTimeInterval)currentDeadline {
+    NSTimeInterval samples[SD_HEDGE_SAMPLE_CAPACITY];
+    SD_LOCK(_lock);
+    NSUInteger count = _sampleCount;
+    memcpy(samples, _samples, sizeof(NSTimeInterval) * count);
+    SD_UNLOCK(_lock);
+
+    NSTimeInterval deadline;
+    if (count < SD_HEDGE_SAMPLE_MINIMUM) {
+        deadline = self.initialDeadline;
+    } else {
+        qsort(samples, count, sizeof(NSTimeInterval), SDHedgeCompareSample);
+        double percentile = MIN(MAX(self.deadlinePercentile, 0), 1);
+        // nearest-rank percentile
+        NSUInteger rank = MAX((NSUInteger)ceil(percentile * count), 1);
+        deadline = samples[MIN(rank, count) - 1];
+    }
+    return MAX(deadline, self.minimumDeadline);
+}
+
+- (NSUInteger)hedgedRequestCount {
+    SD_LOCK(_lock);
+    NSUInteger hedgedRequestCount = _hedgedRequestCount;
+    SD_UNLOCK(_lock);
+    return hedgedRequestCount;
+}
+
+- (NSUInteger)hedgeWinCount {
+    SD_LOCK(_lock);
+    NSUInteger hedgeWinCount = _hedgeWinCount;
+    SD_UNLOCK(_lock);
+    return hedgeWinCount;
+}
+
+- (void)recordRequest {
+    double budgetRatio = MIN(MAX(self.budgetRatio, 0), 1);
+    SD_LOCK(_lock);
+    _budget = MIN(_budget + budgetRatio, (double)self.maximumBudget);
+    SD_UNLOCK(_lock);
+}
+
+- (void)recordTimeToFirstByte:(NSTimeInterval)duration {
+    if (duration < 0) {
+        return;
+    }
+    SD_LOCK(_lock);
+    _samples[_sampleIndex] = duration;
+    _sampleIndex = (_sampleIndex + 1) % SD_HEDGE_SAMPLE_CAPACITY;
+    _sampleCount = MIN(_sampleCount + 1, SD_HEDGE_SAMPLE_CAPACITY);
+    SD_UNLOCK(_lock);
+}
+
+- (BOOL)acquireHedge {
+    BOOL acquired = NO;
+    SD_LOCK(_lock);
+    if (_budget >= 1) {
+        _budget -= 1;
+        _hedgedRequestCount++;
+        acquired = YES;
+    }
+    SD_UNLOCK(_lock);
+    return acquired;
+}
+
+- (void)recordHedgeWin {
+    SD_LOCK(_lock);
+    _hedgeWinCount++;
+    SD_UNLOCK(_lock);
+}
+
+@end
@@ -40,13 +40,22 @@
 
 @optional
 @property (strong, nonatomic, readonly, nullable) NSURLSessionTask *dataTask;
+@property (strong, nonatomic, readonly, nullable) NSURLSessionTask *hedgeTask;
 @property (strong, nonatomic, readonly, nullable) NSURLSessionTaskMetrics *metrics API_AVAILABLE(macos(10.12), ios(10.0), watchos(3.0), tvos(10.0));
+@property (assign, nonatomic, readonly) NSUInteger skippedProgressiveDecodeCount;
+
+- (void)setProgressiveDecodePaused:(BOOL)paused forToken:(nullable id)token;
 
 // These operation-level config was inherited from downloader. See `SDWebImageDownloaderConfig` for documentation.
 @property (strong, nonatomic, nullable) NSURLCredential *credential;
 @property (assign, nonatomic) double minimumProgressInterval;
 @property (copy, nonatomic, nullable) NSIndexSet *acceptableStatusCodes;
 @property (copy, nonatomic, nullable) NSSet<NSString *> *acceptableContentTypes;
+@property (assign, nonatomic) NSTimeInterval minimumProgressiveDecodeInterval;
+@property (assign, nonatomic) NSUInteger minimumProgressiveDecodeBytes;
+@property (strong, nonatomic, nullable) SDWebImageDownloaderHedgePolicy *hedgePolicy;
+// This is inherited from downloader. See `SDWebImageDownloader.statistics` for documentation.
+@property (strong, nonatomic, nullable) SDWebImageDownloaderStatistics *statistics;
 
 @end
 
@@ -68,9 +77,15 @@
 
 /**
  * The operation's task
+ * @note When hedging, this is the task which receives the response first.
  */
 @property (strong, nonatomic, readonly, nullable) NSURLSessionTask *dataTask;
 
+/**
+ * The duplicate task issued by hedging, which is racing with `dataTask` for the response. This become nil once any of them receives the response.
+ */
+@property (strong, nonatomic, readonly, nullable) NSURLSessionTask *hedgeTask;
+
 /**
  * The collected metrics from `-URLSession:task:didFinishCollectingMetrics:`.
  * This can be used to collect the network metrics like download duration, DNS lookup duration, SSL handshake duration, etc. See Apple's documentation: https://developer.apple.com/documentation/foundation/urlsessiontaskmetrics
@@ -108,6 +123,35 @@
  */
 @property (copy, nonatomic, nullable) NSSet<NSString *> *acceptableContentTypes;
 
+/**
+ * The minimum interval (in seconds) between two progressive decoding passes. The actual interval is at least twice of the previous pass's decoding time.
+ * Defaults to 0, which means start a new pass whenever new data arrives and no decoding is running.
+ */
+@property (assign, nonatomic) NSTimeInterval minimumProgressiveDecodeInterval;
+
+/**
+ * The minimum received bytes between two progressive decoding passes.
+ * Defaults to 0, which means no limit.
+ */
+@property (assign, nonatomic) NSUInteger minimumProgressiveDecodeBytes;
+
+/**
+ * The hedging policy. If the request does not receive the response within the policy's deadline, a duplicate request is issued.
+ * Defaults to nil, which means hedging is disabled.
+ */
+@property (strong, nonatomic, nullable) SDWebImageDownloaderHedgePolicy *hedgePolicy;
+
+/**
+ * The statistics to record the data usage during download, such as received bytes and time-to-first-byte.
+ * Defaults to nil.
+ */
+@property (strong, nonatomic, nullable) SDWebImageDownloaderStatistics *statistics;
+
+/**
+ * The number of progressive decoding passes skipped during download. A pass is skipped when the previous pass is still running, when throttled by `minimumProgressiveDecodeInterval` or `minimumProgressiveDecodeBytes`, when the CPU is saturated (the load average reaches the active processor count, or serious thermal pressure), or when all the callbacks paused the progressive decoding.
+ */
+@property (assign, nonatomic, readonly) NSUInteger skippedProgressiveDecodeCount;
+
 /**
  * The options for the receiver.
  */
@@ -188,4 +232,12 @@
  */
 - (BOOL)cancel:(nullable id)token;
 
+/**
+ *  Pauses or resumes the progressive decoding for a set of callbacks, for example when the view is off-screen. Once all callbacks paused, the progressive decoding passes are skipped. The final image is always decoded and callback.
+ *
+ *  @param paused Whether to pause the progressive decoding for the callbacks
+ *  @param token the token representing a set of callbacks
+ */
+- (void)setProgressiveDecodePaused:(BOOL)paused forToken:(nullable id)token;
+
 @end
@@ -11,8 +11,11 @@
 #import "SDInternalMacros.h"
 #import "SDWebImageDownloaderResponseModifier.h"
 #import "SDWebImageDownloaderDecryptor.h"
+#import "SDWebImageCacheKeyFilter.h"
 #import "SDImageCacheDefine.h"
 #import "SDCallbackQueue.h"
+#import "SDImageDecodeExecutor.h"
+#import <stdatomic.h>
 
 // A handler to represent individual request
 @interface SDWebImageDownloaderOperationToken : NSObject
@@ -20,6 +23,7 @@
 @property (nonatomic, copy, nullable) SDWebImageDownloaderCompletedBlock completedBlock;
 @property (nonatomic, copy, nullable) SDWebImageDownloaderProgressBlock progressBlock;
 @property (nonatomic, copy, nullable) SDImageCoderOptions *decodeOptions;
+@property (nonatomic, assign, getter=isProgressiveDecodePaused) BOOL progressiveDecodePaused;
 
 @end
 
@@ -43,7 +47,9 @@
 
 @end
 
-@interface SDWebImageDownloaderOperation ()
+@interface SDWebImageDownloaderOperation () {
+    atomic_ulong _skippedProgressiveDecodeCount;
+}
 
 @property (strong, nonatomic, nonnull) NSMutableArray<SDWebImageDownloaderOperationToken *> *callbackTokens;
 
@@ -59,6 +65,9 @@
 @property (strong, nonatomic, nullable, readwrite) NSURLResponse *response;
 @property (strong, nonatomic, nullable) NSError *responseError;
 @property (assign, nonatomic) double previousProgress; // previous progress percent
+@property (assign, nonatomic) CFAbsoluteTime previousProgressiveDecodeTime; // previous progressive decoding pass start time
+@property (assign, nonatomic) NSTimeInterval previousProgressiveDecodeDuration; // previous progressive decoding pass cost
+@property (assign, nonatomic) NSUInteger previousProgressiveDecodeSize; // previous progressive decoding pass data length
 
 @property (assign, nonatomic, getter = isDownloadCompleted) BOOL downloadCompleted;
 
@@ -72,10 +81,16 @@
 @property (strong, nonatomic, nullable) NSURLSession *ownedSession;
 
 @property (strong, nonatomic, readwrite, nullable) NSURLSessionTask *dataTask;
+@property (strong, nonatomic, readwrite, nullable) NSURLSessionTask *hedgeTask;
+@property (weak, nonatomic, nullable) NSURLSessionTask *hedgeLoserTask; // the task lose the hedging race, whose delegate callbacks should be ignored
+@property (assign, nonatomic) CFAbsoluteTime requestStartTime; // for time-to-first-byte
+@property (assign, nonatomic) CFAbsoluteTime responseTime; // for transfer duration
+@property (strong, nonatomic, nullable) NSURL *responseURL; // the URL of the task which receives the response first
+@property (assign, nonatomic, getter = isFirstResponseReceived) BOOL firstResponseReceived;
 
 @property (strong, nonatomic, readwrite, nullable) NSURLSessionTaskMetrics *metrics API_AVAILABLE(macos(10.12), ios(10.0), watchos(3.0), tvos(10.0));
 
-@property (strong, nonatomic, nonnull) NSOperationQueue *coderQueue; // the serial operation queue to do image decoding
+@property (strong, nonatomic, nonnull) NSHashTable<NSOperation *> *coderOperations; // the decoding operations submitted to the shared decode executor
 
 @property (strong, nonatomic, nonnull) NSMapTable<SDImageCoderOptions *, UIImage *> *imageMap; // each variant of image is weak-referenced to avoid too many re-decode during downloading
 #if SD_UIKIT
@@ -84,6 +99,20 @@
 
 @end
 
+// The CPU is saturated when the runnable threads exceed the active cores, or the system throttles the CPU because of thermal pressure
+static BOOL SDIsCPUSaturated(void) {
+    double loadAverage;
+    if (getloadavg(&loadAverage, 1) == 1 && loadAverage >= NSProcessInfo.processInfo.activeProcessorCount) {
+        return YES;
+    }
+    if (@available(iOS 11.0, tvOS 11.0, macOS 10.10.3, watchOS 4.0, *)) {
+        if (NSProcessInfo.processInfo.thermalState >= NSProcessInfoThermalStateSerious) {
+            return YES;
+        }
+    }
+    return NO;
+}
+
 @implementation SDWebImageDownloaderOperation
 
 @synthesize executing = _executing;
@@ -113,9 +142,7 @@
         _expectedSize = 0;
         _unownedSession = session;
         _downloadCompleted = NO;
-        _coderQueue = [[NSOperationQueue alloc] init];
-        _coderQueue.maxConcurrentOperationCount = 1;
-        _coderQueue.name = @"com.hackemist.SDWebImageDownloaderOperation.coderQueue";
+        _coderOperations = [NSHashTable weakObjectsHashTable];
         _imageMap = [[NSMapTable alloc] initWithKeyOptions:NSPointerFunctionsStrongMemory valueOptions:NSPointerFunctionsWeakMemory capacity:1];
 #if SD_UIKIT
         _backgroundTaskId = UIBackgroundTaskInvalid;
@@ -167,6 +194,17 @@
     return shouldCancel;
 }
 
+- (NSUInteger)skippedProgressiveDecodeCount {
+    return atomic_load_explicit(&_skippedProgressiveDecodeCount, memory_order_relaxed);
+}
+
+- (void)setProgressiveDecodePaused:(BOOL)paused forToken:(nullable id)token {
+    if (![token isKindOfClass:SDWebImageDownloaderOperationToken.class]) return;
+    @synchronized (self) {
+        ((SDWebImageDownloaderOperationToken *)token).progressiveDecodePaused = paused;
+    }
+}
+
 - (void)start {
     @synchronized (self) {
         if (self.isCancelled) {
@@ -241,6 +279,11 @@
             self.dataTask.priority = NSURLSessionTaskPriorityDefault;
         }
         [self.dataTask resume];
+        self.requestStartTime = CFAbsoluteTimeGetCurrent();
+        [self.statistics recordRequestWithURL:self.request.URL];
+        if (self.hedgePolicy) {
+            [self scheduleHedgeRequest];
+        }
         NSArray<SDWebImageDownloaderOperationToken *> *tokens;
         @synchronized (self) {
             tokens = [self.callbackTokens copy];
@@ -277,10 +320,16 @@
     });
 
     if (self.dataTask) {
+        // The received data is thrown away
+        [self.statistics recordCancellationWithURL:self.responseURL ?: self.request.URL receivedBytes:self.receivedSize];
         // Cancel the URLSession, `URLSession:task:didCompleteWithError:` delegate callback will be ignored
         [self.dataTask cancel];
         self.dataTask = nil;
     }
+    if (self.hedgeTask) {
+        [self.hedgeTask cancel];
+        self.hedgeTask = nil;
+    }
     
     // NSOperation disallow setFinished=YES **before** operation's start method been called
     // We check for the initialized status, which is isExecuting == NO && isFinished = NO
@@ -306,6 +355,7 @@
     @synchronized (self) {
         [self.callbackTokens removeAllObjects];
         self.dataTask = nil;
+        self.hedgeTask = nil;
         
         if (self.ownedSession) {
             [self.ownedSession invalidateAndCancel];
@@ -362,7 +412,7 @@
                           finishedTokens:(NSArray<SDWebImageDownloaderOperationToken *> *)finishedTokens {
     @weakify(self);
     for (SDWebImageDownloaderOperationToken *token in pendingTokens) {
-        [self.coderQueue addOperationWithBlock:^{
+        [self addCoderOperationWithBlock:^{
             @strongify(self);
             if (!self) {
                 return;
@@ -373,9 +423,13 @@
                 image = [self.imageMap objectForKey:token.decodeOptions];
             }
             if (!image) {
-                // check if we already use progressive decoding, use that to produce faster decoding
-                id<SDProgressiveImageCoder> progressiveCoder = SDImageLoaderGetProgressiveCoder(self);
                 SDWebImageOptions options = [[self class] imageOptionsFromDownloaderOptions:self.options];
+                // check if we already use progressive decoding, use that to produce faster decoding
+                // the progressive coder is created with the operation's decode options, the coalesced callbacks with other decode options (like thumbnail) use the full decoding
+                id<SDProgressiveImageCoder> progressiveCoder;
+                if (SD_OPTIONS_CONTAINS(self.options, SDWebImageDownloaderProgressiveLoad) && (!token.decodeOptions || [token.decodeOptions isEqualToDictionary:[self progressiveDecodeOptions]])) {
+                    progressiveCoder = SDImageLoaderGetProgressiveCoder(self);
+                }
                 SDWebImageContext *context;
                 if (token.decodeOptions) {
                     SDWebImageMutableContext *mutableContext = [NSMutableDictionary dictionaryWithDictionary:self.context];
@@ -413,14 +467,160 @@
         [self checkDoneWithImageData:imageData
                       finishedTokens:[finishedTokens arrayByAddingObjectsFromArray:pendingTokens]];
     };
-    if (@available(iOS 13, tvOS 13, macOS 10.15, watchOS 6, *)) {
-        // seems faster than `addOperationWithBlock`
-        [self.coderQueue addBarrierBlock:doneBlock];
+    // decoding operations are serial, this does the same effect as barrier in semantics
+    [self addCoderOperationWithBlock:doneBlock];
+}
+
+// The decode options used by the progressive coder, see `SDImageLoaderDecodeProgressiveImageData`
+- (SDImageCoderOptions *)progressiveDecodeOptions {
+    id<SDWebImageCacheKeyFilter> cacheKeyFilter = self.context[SDWebImageContextCacheKeyFilter];
+    NSString *cacheKey;
+    if (cacheKeyFilter) {
+        cacheKey = [cacheKeyFilter cacheKeyForURL:self.request.URL];
     } else {
-        // serial queue, this does the same effect in semantics
-        [self.coderQueue addOperationWithBlock:doneBlock];
+        cacheKey = self.request.URL.absoluteString;
+    }
+    return SDGetDecodeOptionsFromContext(self.context, [[self class] imageOptionsFromDownloaderOptions:self.options], cacheKey);
+}
+
+#pragma mark - Decode Executor
+
+- (void)addCoderOperationWithBlock:(dispatch_block_t)block {
+    // All the downloads share one bounded decode executor, each download's decoding operation depend on the unfinished ones to keep serial
+    // Depend on all of them but not only the last one, because the cancelled operation may be ready before its dependencies finished
+    @synchronized (self.coderOperations) {
+        NSMutableArray<NSOperation *> *dependencies = [NSMutableArray array];
+        for (NSOperation *previousOperation in self.coderOperations) {
+            if (!previousOperation.isFinished) {
+                [dependencies addObject:previousOperation];
+            }
+        }
+        // inherit the priority from download operation
+        NSOperation *operation = [SDImageDecodeExecutor.sharedExecutor addDecodeBlock:block dependencies:dependencies queuePriority:self.queuePriority qualityOfService:self.qualityOfService];
+        [self.coderOperations addObject:operation];
+    }
+}
+
+- (NSUInteger)coderOperationCount {
+    NSUInteger count = 0;
+    @synchronized (self.coderOperations) {
+        for (NSOperation *operation in self.coderOperations) {
+            if (!operation.isFinished) {
+                count++;
+            }
+        }
+    }
+    return count;
+}
+
+- (void)cancelAllCoderOperations {
+    NSArray<NSOperation *> *operations;
+    @synchronized (self.coderOperations) {
+        operations = self.coderOperations.allObjects;
+    }
+    for (NSOperation *operation in operations) {
+        [operation cancel];
     }
+}
+
+#pragma mark - Hedging
 
+- (void)scheduleHedgeRequest {
+    SDWebImageDownloaderHedgePolicy *hedgePolicy = self.hedgePolicy;
+    [hedgePolicy recordRequest];
+    NSTimeInterval deadline = hedgePolicy.currentDeadline;
+    @weakify(self);
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(deadline * NSEC_PER_SEC)), dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+        @strongify(self);
+        [self startHedgeRequest];
+    });
+}
+
+- (BOOL)shouldStartHedgeRequest {
+    @synchronized (self) {
+        // The response already received, or the operation is finished
+        if (self.isCancelled || self.isFinished || self.isFirstResponseReceived || !self.dataTask || self.hedgeTask) {
+            return NO;
+        }
+    }
+    // Only hedge the idempotent request
+    NSString *HTTPMethod = self.request.HTTPMethod;
+    return !HTTPMethod || [HTTPMethod isEqualToString:@"GET"] || [HTTPMethod isEqualToString:@"HEAD"];
+}
+
+- (void)startHedgeRequest {
+    SDWebImageDownloaderHedgePolicy *hedgePolicy = self.hedgePolicy;
+    if (!hedgePolicy || ![self shouldStartHedgeRequest]) {
+        return;
+    }
+    NSURLRequest *request = self.request;
+    if (hedgePolicy.requestModifier) {
+        request = [hedgePolicy.requestModifier modifiedRequestWithRequest:request];
+        if (!request) {
+            return;
+        }
+    }
+    NSURLSessionTask *hedgeTask;
+    @synchronized (self) {
+        // Check again since the request modifier may take time
+        if (![self shouldStartHedgeRequest]) {
+            return;
+        }
+        NSURLSession *session = self.ownedSession ?: self.unownedSession;
+        if (!session.delegate) {
+            return;
+        }
+        // Consume the budget at last, so the skipped hedging does not cost
+        if (![hedgePolicy acquireHedge]) {
+            return;
+        }
+        hedgeTask = [session dataTaskWithRequest:request];
+        hedgeTask.priority = self.dataTask.priority;
+        self.hedgeTask = hedgeTask;
+    }
+    [hedgeTask resume];
+}
+
+// The first response wins the hedging race and the other task is cancelled. Return NO if the task already lose the race
+- (BOOL)resolveHedgeWithTask:(NSURLSessionTask *)task {
+    @synchronized (self) {
+        if (self.hedgeLoserTask && task == self.hedgeLoserTask) {
+            return NO;
+        }
+        if (self.hedgeTask) {
+            if (task == self.hedgeTask) {
+                [self.dataTask cancel];
+                self.hedgeLoserTask = self.dataTask;
+                self.dataTask = task;
+                [self.hedgePolicy recordHedgeWin];
+            } else if (task == self.dataTask) {
+                [self.hedgeTask cancel];
+                self.hedgeLoserTask = self.hedgeTask;
+            } else {
+                return NO;
+            }
+            self.hedgeTask = nil;
+        }
+        if (!self.isFirstResponseReceived) {
+            self.firstResponseReceived = YES;
+            [self recordFirstResponseWithTask:task];
+        }
+        return YES;
+    }
+}
+
+- (void)recordFirstResponseWithTask:(NSURLSessionTask *)task {
+    self.responseTime = CFAbsoluteTimeGetCurrent();
+    self.responseURL = task.originalRequest.URL ?: self.request.URL;
+    NSTimeInterval timeToFirstByte = self.responseTime - self.requestStartTime;
+    [self.hedgePolicy recordTimeToFirstByte:timeToFirstByte];
+    [self.statistics recordResponseWithURL:self.responseURL timeToFirstByte:timeToFirstByte];
+}
+
+- (BOOL)isHedgeLoserTask:(NSURLSessionTask *)task {
+    @synchronized (self) {
+        return self.hedgeLoserTask && task == self.hedgeLoserTask;
+    }
 }
 
 #pragma mark NSURLSessionDataDelegate
@@ -429,6 +629,14 @@
           dataTask:(NSURLSessionDataTask *)dataTask
 didReceiveResponse:(NSURLResponse *)response
  completionHandler:(void (^)(NSURLSessionResponseDisposition disposition))completionHandler {
+    // When hedging, only the first response is used
+    if (![self resolveHedgeWithTask:dataTask]) {
+        if (completionHandler) {
+            completionHandler(NSURLSessionResponseCancel);
+        }
+        return;
+    }
+    
     NSURLSessionResponseDisposition disposition = NSURLSessionResponseAllow;
     
     // Check response modifier, if return nil, will marked as cancelled.
@@ -511,6 +719,8 @@ didReceiveResponse:(NSURLResponse *)response
 }
 
 - (void)URLSession:(NSURLSession *)session dataTask:(NSURLSessionDataTask *)dataTask didReceiveData:(NSData *)data {
+    if ([self isHedgeLoserTask:dataTask]) return;
+    
     if (!self.imageData) {
         self.imageData = [[NSMutableData alloc] initWithCapacity:self.expectedSize];
     }
@@ -521,6 +731,7 @@ didReceiveResponse:(NSURLResponse *)response
     @synchronized (self) {
         tokens = [self.callbackTokens copy];
     }
+    
     if (self.expectedSize == 0) {
         // Unknown expectedSize, immediately call progressBlock and return
         for (SDWebImageDownloaderOperationToken *token in tokens) {
@@ -553,10 +764,12 @@ didReceiveResponse:(NSURLResponse *)response
         NSData *imageData = self.imageData;
         
         // keep maximum one progressive decode process during download
-        if (imageData && self.coderQueue.operationCount == 0) {
+        if (imageData && [self coderOperationCount] == 0 && [self shouldStartProgressiveDecodeWithTokens:tokens]) {
+            self.previousProgressiveDecodeTime = CFAbsoluteTimeGetCurrent();
+            self.previousProgressiveDecodeSize = self.receivedSize;
             // NSOperation have autoreleasepool, don't need to create extra one
             @weakify(self);
-            [self.coderQueue addOperationWithBlock:^{
+            [self addCoderOperationWithBlock:^{
                 @strongify(self);
                 if (!self) {
                     return;
@@ -567,13 +780,19 @@ didReceiveResponse:(NSURLResponse *)response
                         return;
                     }
                 }
+                CFAbsoluteTime startTime = CFAbsoluteTimeGetCurrent();
                 UIImage *image = SDImageLoaderDecodeProgressiveImageData(imageData, self.request.URL, NO, self, [[self class] imageOptionsFromDownloaderOptions:self.options], self.context);
+                @synchronized (self) {
+                    self.previousProgressiveDecodeDuration = CFAbsoluteTimeGetCurrent() - startTime;
+                }
                 if (image) {
                     // We do not keep the progressive decoding image even when `finished`=YES. Because they are for view rendering but not take full function from downloader options. And some coders implementation may not keep consistent between progressive decoding and normal decoding.
                     
                     [self callCompletionBlocksWithImage:image imageData:nil error:nil finished:NO];
                 }
             }];
+        } else if (imageData) {
+            atomic_fetch_add_explicit(&_skippedProgressiveDecodeCount, 1, memory_order_relaxed);
         }
     }
     
@@ -605,12 +824,33 @@ didReceiveResponse:(NSURLResponse *)response
 - (void)URLSession:(NSURLSession *)session task:(NSURLSessionTask *)task didCompleteWithError:(NSError *)error {
     // If we already cancel the operation or anything mark the operation finished, don't callback twice
     if (self.isFinished) return;
+    if ([self isHedgeLoserTask:task]) return;
+    
+    @synchronized (self) {
+        // One of the hedging tasks failed before any response, let the other one continue
+        if (error && self.hedgeTask) {
+            if (task == self.dataTask) {
+                self.dataTask = self.hedgeTask;
+            }
+            self.hedgeLoserTask = task;
+            self.hedgeTask = nil;
+            return;
+        }
+    }
     
     self.downloadCompleted = YES;
     
     NSArray<SDWebImageDownloaderOperationToken *> *tokens;
     @synchronized (self) {
         tokens = [self.callbackTokens copy];
+        NSTimeInterval transferDuration = self.responseTime > 0 ? CFAbsoluteTimeGetCurrent() - self.responseTime : 0;
+        // The `304 Not Modified` response is cancelled by us, but it's a successful request
+        NSError *statisticsError = error;
+        if ([self.responseError.domain isEqualToString:SDWebImageErrorDomain] && self.responseError.code == SDWebImageErrorCacheNotModified) {
+            statisticsError = nil;
+        }
+        // The cancelled callbacks are already removed, only count the ones still waiting for this request
+        [self.statistics recordCompletionWithURL:self.responseURL ?: self.request.URL receivedBytes:self.receivedSize transferDuration:transferDuration coalescedCount:tokens.count > 0 ? tokens.count - 1 : 0 error:statisticsError];
         self.dataTask = nil;
         __block typeof(self) strongSelf = self;
         dispatch_async(dispatch_get_main_queue(), ^{
@@ -650,7 +890,7 @@ didReceiveResponse:(NSURLResponse *)response
                     [self done];
                 } else {
                     // decode the image in coder queue, cancel all previous decoding process
-                    [self.coderQueue cancelAllOperations];
+                    [self cancelAllCoderOperations];
                     [self startCoderOperationWithImageData:imageData
                                              pendingTokens:tokens
                                             finishedTokens:@[]];
@@ -698,7 +938,11 @@ didReceiveResponse:(NSURLResponse *)response
 }
 
 - (void)URLSession:(NSURLSession *)session task:(NSURLSessionTask *)task didFinishCollectingMetrics:(NSURLSessionTaskMetrics *)metrics API_AVAILABLE(macos(10.12), ios(10.0), watchos(3.0), tvos(10.0)) {
+    if ([self isHedgeLoserTask:task]) return;
     self.metrics = metrics;
+    if (metrics.transactionMetrics.lastObject.resourceFetchType == NSURLSessionTaskMetricsResourceFetchTypeLocalCache) {
+        [self.statistics recordURLCacheHitWithURL:self.request.URL];
+    }
 }
 
 #pragma mark Helper methods
@@ -716,6 +960,46 @@ didReceiveResponse:(NSURLResponse *)response
 }
 #pragma clang diagnostic pop
 
+- (BOOL)shouldStartProgressiveDecodeWithTokens:(NSArray<SDWebImageDownloaderOperationToken *> *)tokens {
+    // Skip when all the callbacks paused the progressive decoding (such as the view is off-screen)
+    BOOL allPaused = tokens.count > 0;
+    @synchronized (self) {
+        for (SDWebImageDownloaderOperationToken *token in tokens) {
+            if (!token.isProgressiveDecodePaused) {
+                allPaused = NO;
+                break;
+            }
+        }
+    }
+    if (allPaused) {
+        return NO;
+    }
+    // Skip when the shared decode executor has too many pending decoding, to apply backpressure
+    if (SDImageDecodeExecutor.sharedExecutor.isSaturated) {
+        return NO;
+    }
+    // Skip when the CPU is saturated, the final image is still decoded
+    if (SDIsCPUSaturated()) {
+        return NO;
+    }
+    // Check the bytes gained since previous pass
+    if (self.minimumProgressiveDecodeBytes > 0 && self.receivedSize - self.previousProgressiveDecodeSize < self.minimumProgressiveDecodeBytes) {
+        return NO;
+    }
+    // Check the elapsed time since previous pass, adaptive to the decoding cost
+    if (self.minimumProgressiveDecodeInterval > 0) {
+        NSTimeInterval previousDuration;
+        @synchronized (self) {
+            previousDuration = self.previousProgressiveDecodeDuration;
+        }
+        NSTimeInterval interval = MAX(self.minimumProgressiveDecodeInterval, previousDuration * 2);
+        if (CFAbsoluteTimeGetCurrent() - self.previousProgressiveDecodeTime < interval) {
+            return NO;
+        }
+    }
+    return YES;
+}
+
 - (BOOL)shouldContinueWhenAppEntersBackground {
     return SD_OPTIONS_CONTAINS(self.options, SDWebImageDownloaderContinueInBackground);
 }
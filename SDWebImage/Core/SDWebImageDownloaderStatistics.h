@@ -0,0 +1,89 @@
+/*
+ * This file is part of the SDWebImage package.
+ * (c) Olivier Poitrey <rs@dailymotion.com>
+ *
+ * For the full copyright and license information, please view the LICENSE
+ * file that was distributed with this source code.
+ */
+
+#import <Foundation/Foundation.h>
+#import "SDWebImageCompat.h"
+
+/**
+ An immutable snapshot of the download statistics, for all the hosts or a single host.
+ The histograms are the count of samples in each bucket, see `SDWebImageDownloaderStatistics.histogramBucketUpperBounds`.
+ */
+@interface SDWebImageDownloaderStatisticsSnapshot : NSObject
+
+/// The number of network requests started. The coalesced requests which share another request are not counted.
+@property (nonatomic, assign, readonly) NSUInteger requestCount;
+/// The number of network requests finished successfully.
+@property (nonatomic, assign, readonly) NSUInteger completedCount;
+/// The number of network requests failed, not including the cancelled ones.
+@property (nonatomic, assign, readonly) NSUInteger failedCount;
+/// The number of network requests cancelled.
+@property (nonatomic, assign, readonly) NSUInteger cancelledCount;
+/// The number of network requests served from `NSURLCache` without network load. Only available on iOS 10/macOS 10.12 and above, which has task metrics.
+@property (nonatomic, assign, readonly) NSUInteger URLCacheHitCount;
+/// The total bytes of response body received.
+@property (nonatomic, assign, readonly) unsigned long long receivedBytes;
+/// The bytes received by the cancelled requests, which are thrown away.
+@property (nonatomic, assign, readonly) unsigned long long cancelledBytes;
+/// The number of requests which coalesced into another network request, see `SDWebImageDownloader.coalescingKeyFilter`.
+@property (nonatomic, assign, readonly) NSUInteger coalescedRequestCount;
+/// The bytes saved by the coalesced requests, which is the response body size multiplied by the coalesced count.
+@property (nonatomic, assign, readonly) unsigned long long coalescedBytes;
+/// The time-to-first-byte histogram, from request started to response received.
+@property (nonatomic, copy, readonly, nonnull) NSArray<NSNumber *> *timeToFirstByteHistogram;
+/// The transfer time histogram, from response received to request finished.
+@property (nonatomic, copy, readonly, nonnull) NSArray<NSNumber *> *transferDurationHistogram;
+/// The per host snapshots. Only available for the snapshot for all the hosts, nil for single host's snapshot.
+@property (nonatomic, copy, readonly, nullable) NSDictionary<NSString *, SDWebImageDownloaderStatisticsSnapshot *> *hostSnapshots;
+
+@end
+
+/**
+ The aggregated, low-overhead counters of the download data usage. This is updated by the download operation from the URLSession delegate callbacks.
+ Use `snapshot` to read the current value, and `reset` to start a new measurement, for example when a screen appears.
+ @note Thread-safe.
+ */
+@interface SDWebImageDownloaderStatistics : NSObject
+
+/// The upper bounds (in seconds) of the histogram buckets. The last bucket has no upper bound, which is represented as `DBL_MAX`.
+@property (nonatomic, class, readonly, nonnull) NSArray<NSNumber *> *histogramBucketUpperBounds;
+
+/// Take the snapshot for the current statistics.
+- (nonnull SDWebImageDownloaderStatisticsSnapshot *)snapshot;
+
+/// Clear all the statistics.
+- (void)reset;
+
+#pragma mark - Recording
+
+/// Record a network request started.
+/// @param URL The request URL, the host is used to group the statistics
+- (void)recordRequestWithURL:(nullable NSURL *)URL;
+
+/// Record the response received.
+/// @param URL The request URL
+/// @param timeToFirstByte The duration (in seconds) from the request started to the response received
+- (void)recordResponseWithURL:(nullable NSURL *)URL timeToFirstByte:(NSTimeInterval)timeToFirstByte;
+
+/// Record the network request finished. The received bytes are recorded once here (or in cancellation), but not for each data chunk.
+/// @param URL The request URL
+/// @param receivedBytes The total length of received data
+/// @param transferDuration The duration (in seconds) from the response received to the request finished
+/// @param coalescedCount The number of extra requests which share this network request
+/// @param error The error if failed, nil for success (including the `304 Not Modified` response)
+- (void)recordCompletionWithURL:(nullable NSURL *)URL receivedBytes:(NSUInteger)receivedBytes transferDuration:(NSTimeInterval)transferDuration coalescedCount:(NSUInteger)coalescedCount error:(nullable NSError *)error;
+
+/// Record the network request cancelled.
+/// @param URL The request URL
+/// @param receivedBytes The length of received data which is thrown away
+- (void)recordCancellationWithURL:(nullable NSURL *)URL receivedBytes:(NSUInteger)receivedBytes;
+
+/// Record the network request is served from `NSURLCache`.
+/// @param URL The request URL
+- (void)recordURLCacheHitWithURL:(nullable NSURL *)URL;
+
+@end
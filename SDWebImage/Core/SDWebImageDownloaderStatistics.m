@@ -0,0 +1,203 @@
+/*
+ * This file is part of the SDWebImage package.
+ * (c) Olivier Poitrey <rs@dailymotion.com>
+ *
+ * For the full copyright and license information, please view the LICENSE
+ * file that was distributed with this source code.
+ */
+
+#import "SDWebImageDownloaderStatistics.h"
+#import "SDInternalMacros.h"
+
+#define SD_STATISTICS_BUCKET_COUNT 8
+// The upper bounds (in seconds) of the histogram buckets, the last one is unbounded
+static const NSTimeInterval SDStatisticsBucketUpperBounds[SD_STATISTICS_BUCKET_COUNT] = {0.05, 0.1, 0.25, 0.5, 1, 2.5, 5, DBL_MAX};
+
+static inline NSUInteger SDStatisticsBucketIndex(NSTimeInterval duration) {
+    for (NSUInteger i = 0; i < SD_STATISTICS_BUCKET_COUNT - 1; i++) {
+        if (duration <= SDStatisticsBucketUpperBounds[i]) {
+            return i;
+        }
+    }
+    return SD_STATISTICS_BUCKET_COUNT - 1;
+}
+
+static inline NSArray<NSNumber *> *SDStatisticsHistogramArray(const NSUInteger *histogram) {
+    NSMutableArray<NSNumber *> *array = [NSMutableArray arrayWithCapacity:SD_STATISTICS_BUCKET_COUNT];
+    for (NSUInteger i = 0; i < SD_STATISTICS_BUCKET_COUNT; i++) {
+        [array addObject:@(histogram[i])];
+    }
+    return [array copy];
+}
+
+// The mutable counters for all the hosts or a single host, protected by the statistics lock
+@interface SDWebImageDownloaderStatisticsCounter : NSObject {
+    @public
+    NSUInteger _requestCount;
+    NSUInteger _completedCount;
+    NSUInteger _failedCount;
+    NSUInteger _cancelledCount;
+    NSUInteger _URLCacheHitCount;
+    unsigned long long _receivedBytes;
+    unsigned long long _cancelledBytes;
+    NSUInteger _coalescedRequestCount;
+    unsigned long long _coalescedBytes;
+    NSUInteger _timeToFirstByteHistogram[SD_STATISTICS_BUCKET_COUNT];
+    NSUInteger _transferDurationHistogram[SD_STATISTICS_BUCKET_COUNT];
+}
+
+@end
+
+@implementation SDWebImageDownloaderStatisticsCounter
+@end
+
+@interface SDWebImageDownloaderStatisticsSnapshot ()
+
+@property (nonatomic, assign, readwrite) NSUInteger requestCount;
+@property (nonatomic, assign, readwrite) NSUInteger completedCount;
+@property (nonatomic, assign, readwrite) NSUInteger failedCount;
+@property (nonatomic, assign, readwrite) NSUInteger cancelledCount;
+@property (nonatomic, assign, readwrite) NSUInteger URLCacheHitCount;
+@property (nonatomic, assign, readwrite) unsigned long long receivedBytes;
+@property (nonatomic, assign, readwrite) unsigned long long cancelledBytes;
+@property (nonatomic, assign, readwrite) NSUInteger coalescedRequestCount;
+@property (nonatomic, assign, readwrite) unsigned long long coalescedBytes;
+@property (nonatomic, copy, readwrite, nonnull) NSArray<NSNumber *> *timeToFirstByteHistogram;
+@property (nonatomic, copy, readwrite, nonnull) NSArray<NSNumber *> *transferDurationHistogram;
+@property (nonatomic, copy, readwrite, nullable) NSDictionary<NSString *, SDWebImageDownloaderStatisticsSnapshot *> *hostSnapshots;
+
+@end
+
+@implementation SDWebImageDownloaderStatisticsSnapshot
+
+- (instancetype)initWithCounter:(SDWebImageDownloaderStatisticsCounter *)counter {
+    self = [super init];
+    if (self) {
+        _requestCount = counter->_requestCount;
+        _completedCount = counter->_completedCount;
+        _failedCount = counter->_failedCount;
+        _cancelledCount = counter->_cancelledCount;
+        _URLCacheHitCount = counter->_URLCacheHitCount;
+        _receivedBytes = counter->_receivedBytes;
+        _cancelledBytes = counter->_cancelledBytes;
+        _coalescedRequestCount = counter->_coalescedRequestCount;
+        _coalescedBytes = counter->_coalescedBytes;
+        _timeToFirstByteHistogram = SDStatisticsHistogramArray(counter->_timeToFirstByteHistogram);
+        _transferDurationHistogram = SDStatisticsHistogramArray(counter->_transferDurationHistogram);
+    }
+    return self;
+}
+
+- (NSString *)description {
+    return [NSString stringWithFormat:@"<%@: %p; requests = %lu; received = %llu bytes; cancelled = %llu bytes; coalesced = %llu bytes>", self.class, self, (unsigned long)self.requestCount, self.receivedBytes, self.cancelledBytes, self.coalescedBytes];
+}
+
+@end
+
+@interface SDWebImageDownloaderStatistics ()
+
+@property (nonatomic, strong, nonnull) SDWebImageDownloaderStatisticsCounter *totalCounter;
+@property (nonatomic, strong, nonnull) NSMutableDictionary<NSString *, SDWebImageDownloaderStatisticsCounter *> *hostCounters;
+
+@end
+
+@implementation SDWebImageDownloaderStatistics {
+    SD_LOCK_DECLARE(_lock); // A lock to keep the access to counters thread-safe
+}
+
++ (NSArray<NSNumber *> *)histogramBucketUpperBounds {
+    NSMutableArray<NSNumber *> *array = [NSMutableArray arrayWithCapacity:SD_STATISTICS_BUCKET_COUNT];
+    for (NSUInteger i = 0; i < SD_STATISTICS_BUCKET_COUNT; i++) {
+        [array addObject:@(SDStatisticsBucketUpperBounds[i])];
+    }
+    return [array copy];
+}
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _totalCounter = [SDWebImageDownloaderStatisticsCounter new];
+        _hostCounters = [NSMutableDictionary dictionary];
+        SD_LOCK_INIT(_lock);
+    }
+    return self;
+}
+
+- (SDWebImageDownloaderStatisticsSnapshot *)snapshot {
+    SD_LOCK(_lock);
+    SDWebImageDownloaderStatisticsSnapshot *snapshot = [[SDWebImageDownloaderStatisticsSnapshot alloc] initWithCounter:self.totalCounter];
+    NSMutableDictionary<NSString *, SDWebImageDownloaderStatisticsSnapshot *> *hostSnapshots = [NSMutableDictionary dictionaryWithCapacity:self.hostCounters.count];
+    [self.hostCounters enumerateKeysAndObjectsUsingBlock:^(NSString * _Nonnull host, SDWebImageDownloaderStatisticsCounter * _Nonnull counter, BOOL * _Nonnull stop) {
+        hostSnapshots[host] = [[SDWebImageDownloaderStatisticsSnapshot alloc] initWithCounter:counter];
+    }];
+    SD_UNLOCK(_lock);
+    snapshot.hostSnapshots = hostSnapshots;
+    return snapshot;
+}
+
+- (void)reset {
+    SD_LOCK(_lock);
+    self.totalCounter = [SDWebImageDownloaderStatisticsCounter new];
+    [self.hostCounters removeAllObjects];
+    SD_UNLOCK(_lock);
+}
+
+#pragma mark - Recording
+
+// Update the counters for all the hosts and the URL's host
+- (void)updateCountersWithURL:(nullable NSURL *)URL block:(void(^)(SDWebImageDownloaderStatisticsCounter *counter))block {
+    NSString *host = URL.host ?: @"";
+    SD_LOCK(_lock);
+    SDWebImageDownloaderStatisticsCounter *hostCounter = self.hostCounters[host];
+    if (!hostCounter) {
+        hostCounter = [SDWebImageDownloaderStatisticsCounter new];
+        self.hostCounters[host] = hostCounter;
+    }
+    block(self.totalCounter);
+    block(hostCounter);
+    SD_UNLOCK(_lock);
+}
+
+- (void)recordRequestWithURL:(NSURL *)URL {
+    [self updateCountersWithURL:URL block:^(SDWebImageDownloaderStatisticsCounter *counter) {
+        counter->_requestCount++;
+    }];
+}
+
+- (void)recordResponseWithURL:(NSURL *)URL timeToFirstByte:(NSTimeInterval)timeToFirstByte {
+    NSUInteger index = SDStatisticsBucketIndex(timeToFirstByte);
+    [self updateCountersWithURL:URL block:^(SDWebImageDownloaderStatisticsCounter *counter) {
+        counter->_timeToFirstByteHistogram[index]++;
+    }];
+}
+
+- (void)recordCompletionWithURL:(NSURL *)URL receivedBytes:(NSUInteger)receivedBytes transferDuration:(NSTimeInterval)transferDuration coalescedCount:(NSUInteger)coalescedCount error:(NSError *)error {
+    NSUInteger index = SDStatisticsBucketIndex(transferDuration);
+    [self updateCountersWithURL:URL block:^(SDWebImageDownloaderStatisticsCounter *counter) {
+        counter->_receivedBytes += receivedBytes;
+        if (error) {
+            counter->_failedCount++;
+        } else {
+            counter->_completedCount++;
+            counter->_transferDurationHistogram[index]++;
+            counter->_coalescedRequestCount += coalescedCount;
+            counter->_coalescedBytes += (unsigned long long)receivedBytes * coalescedCount;
+        }
+    }];
+}
+
+- (void)recordCancellationWithURL:(NSURL *)URL receivedBytes:(NSUInteger)receivedBytes {
+    [self updateCountersWithURL:URL block:^(SDWebImageDownloaderStatisticsCounter *counter) {
+        counter->_cancelledCount++;
+        counter->_receivedBytes += receivedBytes;
+        counter->_cancelledBytes += receivedBytes;
+    }];
+}
+
+- (void)recordURLCacheHitWithURL:(NSURL *)URL {
+    [self updateCountersWithURL:URL block:^(SDWebImageDownloaderStatisticsCounter *counter) {
+        counter->_URLCacheHitCount++;
+    }];
+}
+
+@end
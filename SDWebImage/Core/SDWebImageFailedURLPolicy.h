@@ -0,0 +1,107 @@
+/*
+ * This file is part of the SDWebImage package.
+ * (c) Olivier Poitrey <rs@dailymotion.com>
+ *
+ * For the full copyright and license information, please view the LICENSE
+ * file that was distributed with this source code.
+ */
+
+#import <Foundation/Foundation.h>
+#import "SDWebImageCompat.h"
+
+/**
+ The retry policy for failed URLs, used by `SDWebImageManager.failedURLPolicy`. Instead of blocking the failed URL permanently, the URL is blocked for a backoff interval which grows exponentially on each consecutive failure, with random jitter to avoid the synchronized retries.
+ The failure record is forgotten after `entryTimeToLive`, and at most `maximumEntryCount` records are kept, so the tracker is bounded.
+ It also contains a per-host circuit breaker: when a host fails for `hostFailureThreshold` consecutive times, all the URLs of that host are blocked for `hostOpenDuration`. After that, a single probe request is allowed, its success closes the circuit and its failure opens the circuit again. So a dead host does not occupy the download slots.
+ @note The policy is stateful and thread-safe.
+ */
+@interface SDWebImageFailedURLPolicy : NSObject
+
+/**
+ * The backoff interval (in seconds) after the first failure.
+ * Defaults to 1.0.
+ */
+@property (nonatomic, assign) NSTimeInterval initialBackoff;
+
+/**
+ * The multiplier applied to the backoff interval on each consecutive failure.
+ * Defaults to 2.0.
+ */
+@property (nonatomic, assign) double backoffMultiplier;
+
+/**
+ * The maximum backoff interval (in seconds).
+ * Defaults to 300 (5 minutes).
+ */
+@property (nonatomic, assign) NSTimeInterval maximumBackoff;
+
+/**
+ * The random jitter ratio of the backoff interval. The actual interval is in the range of `backoff * (1 ± jitter)`.
+ * The value should be 0.0-1.0. Set to 0 to disable jitter.
+ * Defaults to 0.2.
+ */
+@property (nonatomic, assign) double jitter;
+
+/**
+ * The time (in seconds) to keep the failure record since the last failure. After that, the consecutive failure count of that URL is reset.
+ * Defaults to 600 (10 minutes).
+ */
+@property (nonatomic, assign) NSTimeInterval entryTimeToLive;
+
+/**
+ * The maximum number of failed URLs to track. When exceeded, the expired records and then the least recently failed records are removed.
+ * Defaults to 256.
+ */
+@property (nonatomic, assign) NSUInteger maximumEntryCount;
+
+/**
+ * The consecutive failures of a host to open the circuit. Only the network errors and server errors (5xx status code) are counted, the other errors are the problem of the URL but not the host. Set to 0 to disable the circuit breaker.
+ * Defaults to 5.
+ */
+@property (nonatomic, assign) NSUInteger hostFailureThreshold;
+
+/**
+ * The time (in seconds) the circuit keeps open, during which all the URLs of that host are blocked.
+ * Defaults to 30.
+ */
+@property (nonatomic, assign) NSTimeInterval hostOpenDuration;
+
+/**
+ * Check whether the URL should be blocked now.
+ * @param url The image URL
+ * @param ignoreBackoff Whether to ignore the URL backoff (such as `SDWebImageRetryFailed`), the host circuit breaker is still checked.
+ * @return YES if the URL or its host is still in backoff, NO to allow the request. When the host circuit is half-open, only the first call returns NO as the probe request.
+ */
+- (BOOL)shouldBlockURL:(nonnull NSURL *)url ignoreBackoff:(BOOL)ignoreBackoff;
+
+/**
+ * Check whether the host circuit of URL is open.
+ * @param url The image URL
+ */
+- (BOOL)isHostBlockedForURL:(nonnull NSURL *)url;
+
+/**
+ * Record the URL failed to load, this increase the backoff interval.
+ * @param url The image URL
+ * @param error The load error
+ */
+- (void)recordFailureForURL:(nonnull NSURL *)url error:(nullable NSError *)error;
+
+/**
+ * Record the URL loaded successfully, this removes the failure record and closes the host circuit.
+ * @param url The image URL
+ */
+- (void)recordSuccessForURL:(nonnull NSURL *)url;
+
+/**
+ * Remove the failure record of URL, the host circuit is not affected.
+ * @param url The image URL
+ */
+- (void)removeURL:(nonnull NSURL *)url;
+
+/**
+ * Remove all the failure records and reset all the host circuits.
+ */
+- (void)removeAllURLs;
+
+@end
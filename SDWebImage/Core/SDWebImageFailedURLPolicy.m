@@ -0,0 +1,243 @@
+/*
+ * This file is part of the SDWebImage package.
+ * (c) Olivier Poitrey <rs@dailymotion.com>
+ *
+ * For the full copyright and license information, please view the LICENSE
+ * file that was distributed with this source code.
+ */
+
+#import "SDWebImageFailedURLPolicy.h"
+#import "SDWebImageError.h"
+#import "SDInternalMacros.h"
+
+// Whether the error means the host is unavailable, instead of the URL itself is invalid
+static BOOL SDFailedURLIsHostError(NSError * _Nullable error) {
+    if ([error.domain isEqualToString:NSURLErrorDomain]) {
+        // The device is offline, which is not the problem of the host
+        return (   error.code != NSURLErrorCancelled
+                && error.code != NSURLErrorNotConnectedToInternet
+                && error.code != NSURLErrorInternationalRoamingOff
+                && error.code != NSURLErrorDataNotAllowed);
+    }
+    if ([error.domain isEqualToString:SDWebImageErrorDomain] && error.code == SDWebImageErrorInvalidDownloadStatusCode) {
+        NSInteger statusCode = [error.userInfo[SDWebImageErrorDownloadStatusCodeKey] integerValue];
+        return statusCode >= 500;
+    }
+    return NO;
+}
+
+// The failure record of a URL
+@interface SDWebImageFailedURLEntry : NSObject
+
+@property (nonatomic, assign) NSUInteger failureCount;
+@property (nonatomic, assign) CFAbsoluteTime lastFailureTime;
+@property (nonatomic, assign) CFAbsoluteTime retryTime;
+
+@end
+
+@implementation SDWebImageFailedURLEntry
+@end
+
+// The circuit breaker state of a host
+@interface SDWebImageFailedHostEntry : NSObject
+
+@property (nonatomic, assign) NSUInteger failureCount;
+@property (nonatomic, assign) CFAbsoluteTime openUntilTime;
+@property (nonatomic, assign) CFAbsoluteTime probeTime; // 0 means no probe request in flight
+
+@end
+
+@implementation SDWebImageFailedHostEntry
+@end
+
+@interface SDWebImageFailedURLPolicy ()
+
+@property (nonatomic, strong, nonnull) NSMutableDictionary<NSURL *, SDWebImageFailedURLEntry *> *URLEntries;
+@property (nonatomic, strong, nonnull) NSMutableDictionary<NSString *, SDWebImageFailedHostEntry *> *hostEntries;
+
+@end
+
+@implementation SDWebImageFailedURLPolicy {
+    SD_LOCK_DECLARE(_lock); // A lock to keep the access to entries thread-safe
+}
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _initialBackoff = 1.0;
+        _backoffMultiplier = 2.0;
+        _maximumBackoff = 300;
+        _jitter = 0.2;
+        _entryTimeToLive = 600;
+        _maximumEntryCount = 256;
+        _hostFailureThreshold = 5;
+        _hostOpenDuration = 30;
+        _URLEntries = [NSMutableDictionary dictionary];
+        _hostEntries = [NSMutableDictionary dictionary];
+        SD_LOCK_INIT(_lock);
+    }
+    return self;
+}
+
+- (NSTimeInterval)backoffForFailureCount:(NSUInteger)failureCount {
+    NSTimeInterval backoff = self.initialBackoff * pow(MAX(self.backoffMultiplier, 1), (double)failureCount - 1);
+    backoff = MIN(backoff, self.maximumBackoff);
+    double jitter = MIN(MAX(self.jitter, 0), 1);
+    if (jitter > 0) {
+        // Uniform in [1 - jitter, 1 + jitter]
+        double random = (double)arc4random() / UINT32_MAX;
+        backoff *= 1 + jitter * (random * 2 - 1);
+    }
+    return MAX(backoff, 0);
+}
+
+- (BOOL)shouldBlockURL:(NSURL *)url ignoreBackoff:(BOOL)ignoreBackoff {
+    if (!url) {
+        return NO;
+    }
+    CFAbsoluteTime now = CFAbsoluteTimeGetCurrent();
+    BOOL shouldBlock = NO;
+    SD_LOCK(_lock);
+    SDWebImageFailedURLEntry *entry = self.URLEntries[url];
+    if (entry) {
+        if (now - entry.lastFailureTime >= self.entryTimeToLive) {
+            [self.URLEntries removeObjectForKey:url];
+        } else if (!ignoreBackoff && now < entry.retryTime) {
+            shouldBlock = YES;
+        }
+    }
+    if (!shouldBlock) {
+        shouldBlock = [self shouldBlockHost:url.host time:now probe:YES];
+    }
+    SD_UNLOCK(_lock);
+    return shouldBlock;
+}
+
+- (BOOL)isHostBlockedForURL:(NSURL *)url {
+    if (!url) {
+        return NO;
+    }
+    SD_LOCK(_lock);
+    BOOL shouldBlock = [self shouldBlockHost:url.host time:CFAbsoluteTimeGetCurrent() probe:NO];
+    SD_UNLOCK(_lock);
+    return shouldBlock;
+}
+
+// Must be called inside the lock
+- (BOOL)shouldBlockHost:(NSString *)host time:(CFAbsoluteTime)now probe:(BOOL)probe {
+    if (!host || self.hostFailureThreshold == 0) {
+        return NO;
+    }
+    SDWebImageFailedHostEntry *hostEntry = self.hostEntries[host];
+    if (!hostEntry || hostEntry.failureCount < self.hostFailureThreshold) {
+        // Closed
+        return NO;
+    }
+    if (now < hostEntry.openUntilTime) {
+        // Open
+        return YES;
+    }
+    // Half-open, allow a single probe request. If the probe does not report back (such as cancelled), allow another one after the open duration
+    if (hostEntry.probeTime > 0 && now - hostEntry.probeTime < self.hostOpenDuration) {
+        return YES;
+    }
+    if (probe) {
+        hostEntry.probeTime = now;
+    }
+    return NO;
+}
+
+- (void)recordFailureForURL:(NSURL *)url error:(NSError *)error {
+    if (!url) {
+        return;
+    }
+    CFAbsoluteTime now = CFAbsoluteTimeGetCurrent();
+    SD_LOCK(_lock);
+    SDWebImageFailedURLEntry *entry = self.URLEntries[url];
+    if (!entry || now - entry.lastFailureTime >= self.entryTimeToLive) {
+        entry = [SDWebImageFailedURLEntry new];
+        self.URLEntries[url] = entry;
+    }
+    entry.failureCount += 1;
+    entry.lastFailureTime = now;
+    entry.retryTime = now + [self backoffForFailureCount:entry.failureCount];
+    [self trimURLEntriesWithTime:now];
+
+    NSString *host = url.host;
+    if (host && self.hostFailureThreshold > 0) {
+        if (SDFailedURLIsHostError(error)) {
+            SDWebImageFailedHostEntry *hostEntry = self.hostEntries[host];
+            if (!hostEntry) {
+                hostEntry = [SDWebImageFailedHostEntry new];
+                self.hostEntries[host] = hostEntry;
+            }
+            hostEntry.failureCount += 1;
+            if (hostEntry.failureCount >= self.hostFailureThreshold) {
+                // Open (or re-open after the probe failed)
+                hostEntry.openUntilTime = now + self.hostOpenDuration;
+                hostEntry.probeTime = 0;
+            }
+        } else {
+            // The host is reachable, close the circuit
+            [self.hostEntries removeObjectForKey:host];
+        }
+    }
+    SD_UNLOCK(_lock);
+}
+
+// Must be called inside the lock
+- (void)trimURLEntriesWithTime:(CFAbsoluteTime)now {
+    if (self.URLEntries.count <= self.maximumEntryCount) {
+        return;
+    }
+    // Remove the expired entries firstly
+    NSTimeInterval timeToLive = self.entryTimeToLive;
+    NSSet<NSURL *> *expiredURLs = [self.URLEntries keysOfEntriesPassingTest:^BOOL(NSURL * _Nonnull key, SDWebImageFailedURLEntry * _Nonnull entry, BOOL * _Nonnull stop) {
+        return now - entry.lastFailureTime >= timeToLive;
+    }];
+    [self.URLEntries removeObjectsForKeys:expiredURLs.allObjects];
+    if (self.URLEntries.count <= self.maximumEntryCount) {
+        return;
+    }
+    // Then remove the least recently failed entries
+    NSArray<NSURL *> *sortedURLs = [self.URLEntries keysSortedByValueUsingComparator:^NSComparisonResult(SDWebImageFailedURLEntry * _Nonnull entry1, SDWebImageFailedURLEntry * _Nonnull entry2) {
+        if (entry1.lastFailureTime < entry2.lastFailureTime) {
+            return NSOrderedAscending;
+        } else if (entry1.lastFailureTime > entry2.lastFailureTime) {
+            return NSOrderedDescending;
+        }
+        return NSOrderedSame;
+    }];
+    NSUInteger removeCount = self.URLEntries.count - self.maximumEntryCount;
+    [self.URLEntries removeObjectsForKeys:[sortedURLs subarrayWithRange:NSMakeRange(0, removeCount)]];
+}
+
+- (void)recordSuccessForURL:(NSURL *)url {
+    if (!url) {
+        return;
+    }
+    SD_LOCK(_lock);
+    [self.URLEntries removeObjectForKey:url];
+    if (url.host) {
+        [self.hostEntries removeObjectForKey:url.host];
+    }
+    SD_UNLOCK(_lock);
+}
+
+- (void)removeURL:(NSURL *)url {
+    if (!url) {
+        return;
+    }
+    SD_LOCK(_lock);
+    [self.URLEntries removeObjectForKey:url];
+    SD_UNLOCK(_lock);
+}
+
+- (void)removeAllURLs {
+    SD_LOCK(_lock);
+    [self.URLEntries removeAllObjects];
+    [self.hostEntries removeAllObjects];
+    SD_UNLOCK(_lock);
+}
+
+@end
@@ -14,6 +14,7 @@
 #import "SDWebImageCacheKeyFilter.h"
 #import "SDWebImageCacheSerializer.h"
 #import "SDWebImageOptionsProcessor.h"
+#import "SDWebImageFailedURLPolicy.h"
 
 typedef void(^SDExternalCompletionBlock)(UIImage * _Nullable image, NSError * _Nullable error, SDImageCacheType cacheType, NSURL * _Nullable imageURL);
 
@@ -183,6 +184,14 @@ SDWebImageManager *manager = [SDWebImageManager sharedManager];
  */
 @property (nonatomic, strong, nullable) id<SDWebImageOptionsProcessor> optionsProcessor;
 
+/**
+ The retry policy for failed URLs, which blocks the failed URL temporarily with exponential backoff, and blocks the unavailable host with circuit breaker. See `SDWebImageFailedURLPolicy`.
+ When set, all the failed URLs (except cancelled) are tracked by the policy, and `SDWebImageRetryFailed` only ignores the URL backoff but not the host circuit breaker. The policy is checked only when the image is not in cache and about to be downloaded, so the cached image is always served.
+ The failed URL is still blocked permanently if `shouldBlockFailedURL` returns YES, until calling `removeFailedURL:`, no matter whether the policy is set.
+ Defaults to nil.
+ */
+@property (nonatomic, strong, nullable) SDWebImageFailedURLPolicy *failedURLPolicy;
+
 /**
  * Check one or more operations running
  */
@@ -8,7 +8,9 @@
 
 #import "SDWebImageManager.h"
 #import "SDImageCache.h"
+#import "SDImageCacheValidator.h"
 #import "SDWebImageDownloader.h"
+#import "SDImageCoderHelper.h"
 #import "UIImage+Metadata.h"
 #import "SDAssociatedObject.h"
 #import "SDWebImageError.h"
@@ -164,7 +166,11 @@ static id<SDImageLoader> _defaultImageLoader;
         if (preserveAspectRatioValue != nil) {
             preserveAspectRatio = preserveAspectRatioValue.boolValue;
         }
-        key = SDThumbnailedKeyForKey(key, thumbnailSize, preserveAspectRatio);
+        if (preserveAspectRatio && [context[SDWebImageContextImageThumbnailAspectFill] boolValue]) {
+            key = SDAspectFillThumbnailedKeyForKey(key, thumbnailSize);
+        } else {
+            key = SDThumbnailedKeyForKey(key, thumbnailSize, preserveAspectRatio);
+        }
     }
     
     // Transformer Key Appending
@@ -209,7 +215,7 @@ static id<SDImageLoader> _defaultImageLoader;
     operation.manager = self;
 
     BOOL isFailedUrl = NO;
-    if (url) {
+    if (url && !(options & SDWebImageRetryFailed)) {
         SD_LOCK(_failedURLsLock);
         isFailedUrl = [self.failedURLs containsObject:url];
         SD_UNLOCK(_failedURLsLock);
@@ -218,7 +224,7 @@ static id<SDImageLoader> _defaultImageLoader;
     // Preprocess the options and context arg to decide the final the result for manager
     SDWebImageOptionsResult *result = [self processedResultForURL:url options:options context:context];
 
-    if (url.absoluteString.length == 0 || (!(options & SDWebImageRetryFailed) && isFailedUrl)) {
+    if (url.absoluteString.length == 0 || isFailedUrl) {
         NSString *description = isFailedUrl ? @"Image url is blacklisted" : @"Image url is nil";
         NSInteger code = isFailedUrl ? SDWebImageErrorBlackListed : SDWebImageErrorInvalidURL;
         [self callCompletionBlockForOperation:operation completion:completedBlock error:[NSError errorWithDomain:SDWebImageErrorDomain code:code userInfo:@{NSLocalizedDescriptionKey : description}] queue:result.context[SDWebImageContextCallbackQueue] url:url];
@@ -269,12 +275,14 @@ static id<SDImageLoader> _defaultImageLoader;
     SD_LOCK(_failedURLsLock);
     [self.failedURLs removeObject:url];
     SD_UNLOCK(_failedURLsLock);
+    [self.failedURLPolicy removeURL:url];
 }
 
 - (void)removeAllFailedURLs {
     SD_LOCK(_failedURLsLock);
     [self.failedURLs removeAllObjects];
     SD_UNLOCK(_failedURLsLock);
+    [self.failedURLPolicy removeAllURLs];
 }
 
 #pragma mark - Private
@@ -307,6 +315,7 @@ static id<SDImageLoader> _defaultImageLoader;
         SDWebImageMutableContext *mutableContext = [context mutableCopy];
         mutableContext[SDWebImageContextImageThumbnailPixelSize] = nil;
         mutableContext[SDWebImageContextImagePreserveAspectRatio] = nil;
+        mutableContext[SDWebImageContextImageThumbnailAspectFill] = nil;
         @weakify(operation);
         operation.cacheOperation = [imageCache queryImageForKey:key options:options context:mutableContext cacheType:queryCacheType completion:^(UIImage * _Nullable cachedImage, NSData * _Nullable cachedData, SDImageCacheType cacheType) {
             @strongify(operation);
@@ -324,6 +333,12 @@ static id<SDImageLoader> _defaultImageLoader;
                     [self callOriginalCacheProcessForOperation:operation url:url options:options context:context progress:progressBlock completed:completedBlock];
                     return;
                 }
+            } else if (options & SDWebImageRevalidateCached) {
+                if ([imageCache respondsToSelector:@selector(queryCacheValidatorForKey:completion:)]) {
+                    // Continue revalidate process
+                    [self callRevalidateProcessForOperation:operation url:url options:options context:context cachedImage:cachedImage cachedData:cachedData cacheType:cacheType progress:progressBlock completed:completedBlock];
+                    return;
+                }
             }
             // Continue download process
             [self callDownloadProcessForOperation:operation url:url options:options context:context cachedImage:cachedImage cachedData:cachedData cacheType:cacheType progress:progressBlock completed:completedBlock];
@@ -386,6 +401,53 @@ static id<SDImageLoader> _defaultImageLoader;
     }
 }
 
+// Revalidate process
+- (void)callRevalidateProcessForOperation:(nonnull SDWebImageCombinedOperation *)operation
+                                      url:(nonnull NSURL *)url
+                                  options:(SDWebImageOptions)options
+                                  context:(SDWebImageContext *)context
+                              cachedImage:(nonnull UIImage *)cachedImage
+                               cachedData:(nullable NSData *)cachedData
+                                cacheType:(SDImageCacheType)cacheType
+                                 progress:(nullable SDImageLoaderProgressBlock)progressBlock
+                                completed:(nullable SDInternalCompletionBlock)completedBlock {
+    // Grab the image cache to use
+    id<SDImageCache> imageCache = context[SDWebImageContextImageCache];
+    if (!imageCache) {
+        imageCache = self.imageCache;
+    }
+    NSString *key = [self cacheKeyForURL:url context:context];
+    @weakify(operation);
+    [imageCache queryCacheValidatorForKey:key completion:^(SDImageCacheValidator * _Nullable validator) {
+        @strongify(operation);
+        if (!operation || operation.isCancelled) {
+            // Image combined operation cancelled by user
+            [self callCompletionBlockForOperation:operation completion:completedBlock error:[NSError errorWithDomain:SDWebImageErrorDomain code:SDWebImageErrorCancelled userInfo:@{NSLocalizedDescriptionKey : @"Operation cancelled by user during querying the cache"}] queue:context[SDWebImageContextCallbackQueue] url:url];
+            [self safelyRemoveOperationFromRunning:operation];
+            return;
+        }
+        if (validator.isFresh) {
+            // The cached image is still fresh, skip the revalidation
+            [self callDownloadProcessForOperation:operation url:url options:options & ~(SDWebImageRefreshCached | SDWebImageRevalidateCached) context:context cachedImage:cachedImage cachedData:cachedData cacheType:cacheType progress:progressBlock completed:completedBlock];
+            return;
+        }
+        SDWebImageContext *revalidateContext = context;
+        if (validator.isConditional) {
+            // Pass the validator to the image loader to send the conditional request
+            SDWebImageMutableContext *mutableContext;
+            if (context) {
+                mutableContext = [context mutableCopy];
+            } else {
+                mutableContext = [NSMutableDictionary dictionary];
+            }
+            mutableContext[SDWebImageContextLoaderCacheValidator] = validator;
+            revalidateContext = [mutableContext copy];
+        }
+        // Continue download process, the stale cached image is served instantly
+        [self callDownloadProcessForOperation:operation url:url options:options context:revalidateContext cachedImage:cachedImage cachedData:cachedData cacheType:cacheType progress:progressBlock completed:completedBlock];
+    }];
+}
+
 // Download process
 - (void)callDownloadProcessForOperation:(nonnull SDWebImageCombinedOperation *)operation
                                     url:(nonnull NSURL *)url
@@ -409,13 +471,20 @@ static id<SDImageLoader> _defaultImageLoader;
     
     // Check whether we should download image from network
     BOOL shouldDownload = !SD_OPTIONS_CONTAINS(options, SDWebImageFromCacheOnly);
-    shouldDownload &= (!cachedImage || options & SDWebImageRefreshCached);
+    shouldDownload &= (!cachedImage || options & SDWebImageRefreshCached || options & SDWebImageRevalidateCached);
     shouldDownload &= (![self.delegate respondsToSelector:@selector(imageManager:shouldDownloadImageForURL:)] || [self.delegate imageManager:self shouldDownloadImageForURL:url]);
     if ([imageLoader respondsToSelector:@selector(canRequestImageForURL:options:context:)]) {
         shouldDownload &= [imageLoader canRequestImageForURL:url options:options context:context];
     } else {
         shouldDownload &= [imageLoader canRequestImageForURL:url];
     }
+    // Check the failed URL policy only when the request is about to send, so the cached image is still served, and does not take the probe request of half-open host
+    BOOL isFailedURL = NO;
+    SDWebImageFailedURLPolicy *failedURLPolicy = self.failedURLPolicy;
+    if (shouldDownload && failedURLPolicy) {
+        isFailedURL = [failedURLPolicy shouldBlockURL:url ignoreBackoff:SD_OPTIONS_CONTAINS(options, SDWebImageRetryFailed)];
+        shouldDownload = !isFailedURL;
+    }
     if (shouldDownload) {
         if (cachedImage && options & SDWebImageRefreshCached) {
             // If image was found in the cache but SDWebImageRefreshCached is provided, notify about the cached image
@@ -430,6 +499,9 @@ static id<SDImageLoader> _defaultImageLoader;
             }
             mutableContext[SDWebImageContextLoaderCachedImage] = cachedImage;
             context = [mutableContext copy];
+        } else if (cachedImage && options & SDWebImageRevalidateCached) {
+            // If image was found in the cache but stale, serve the cached image instantly, and revalidate it with the conditional request (stale-while-revalidate)
+            [self callCompletionBlockForOperation:operation completion:completedBlock image:cachedImage data:cachedData error:nil cacheType:cacheType finished:YES queue:context[SDWebImageContextCallbackQueue] url:url];
         }
         
         @weakify(operation);
@@ -440,6 +512,13 @@ static id<SDImageLoader> _defaultImageLoader;
                 [self callCompletionBlockForOperation:operation completion:completedBlock error:[NSError errorWithDomain:SDWebImageErrorDomain code:SDWebImageErrorCancelled userInfo:@{NSLocalizedDescriptionKey : @"Operation cancelled by user during sending the request"}] queue:context[SDWebImageContextCallbackQueue] url:url];
             } else if (cachedImage && options & SDWebImageRefreshCached && [error.domain isEqualToString:SDWebImageErrorDomain] && error.code == SDWebImageErrorCacheNotModified) {
                 // Image refresh hit the NSURLCache cache, do not call the completion block
+            } else if (cachedImage && options & SDWebImageRevalidateCached && [error.domain isEqualToString:SDWebImageErrorDomain] && error.code == SDWebImageErrorCacheNotModified) {
+                // Image revalidation responds not modified, only refresh the freshness, do not call the completion block
+                SDImageCacheValidator *validator = context[SDWebImageContextLoaderCacheValidator];
+                if (validator) {
+                    NSURLResponse *response = error.userInfo[SDWebImageErrorDownloadResponseKey];
+                    [self storeCacheValidator:[validator validatorByRefreshingWithResponse:response] url:url context:context];
+                }
             } else if ([error.domain isEqualToString:SDWebImageErrorDomain] && error.code == SDWebImageErrorCancelled) {
                 // Download operation cancelled by user before sending the request, don't block failed URL
                 [self callCompletionBlockForOperation:operation completion:completedBlock error:error queue:context[SDWebImageContextCallbackQueue] url:url];
@@ -452,7 +531,12 @@ static id<SDImageLoader> _defaultImageLoader;
                     [self.failedURLs addObject:url];
                     SD_UNLOCK(self->_failedURLsLock);
                 }
+                // The policy only blocks the URL temporarily, so the transient errors are tracked as well
+                [failedURLPolicy recordFailureForURL:url error:error];
             } else {
+                if (finished) {
+                    [failedURLPolicy recordSuccessForURL:url];
+                }
                 if ((options & SDWebImageRetryFailed)) {
                     SD_LOCK(self->_failedURLsLock);
                     [self.failedURLs removeObject:url];
@@ -469,6 +553,10 @@ static id<SDImageLoader> _defaultImageLoader;
     } else if (cachedImage) {
         [self callCompletionBlockForOperation:operation completion:completedBlock image:cachedImage data:cachedData error:nil cacheType:cacheType finished:YES queue:context[SDWebImageContextCallbackQueue] url:url];
         [self safelyRemoveOperationFromRunning:operation];
+    } else if (isFailedURL) {
+        // Image not in cache and the URL is still in backoff
+        [self callCompletionBlockForOperation:operation completion:completedBlock error:[NSError errorWithDomain:SDWebImageErrorDomain code:SDWebImageErrorBlackListed userInfo:@{NSLocalizedDescriptionKey : @"Image url is blacklisted"}] queue:context[SDWebImageContextCallbackQueue] url:url];
+        [self safelyRemoveOperationFromRunning:operation];
     } else {
         // Image not in cache and download disallowed by delegate
         [self callCompletionBlockForOperation:operation completion:completedBlock image:nil data:nil error:nil cacheType:SDImageCacheTypeNone finished:YES queue:context[SDWebImageContextCallbackQueue] url:url];
@@ -509,6 +597,22 @@ static id<SDImageLoader> _defaultImageLoader;
         dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_HIGH, 0), ^{
             // Case that transformer on thumbnail, which this time need full pixel image
             UIImage *transformedImage = [transformer transformedImageWithImage:cacheImage forKey:key];
+            // Custom transformer may output the bitmap which render server copy again, normalize it unless force-decode is disabled
+            SDImageForceDecodePolicy policy = SDImageForceDecodePolicyAutomatic;
+            NSNumber *policyValue = context[SDWebImageContextImageForceDecodePolicy];
+            if (policyValue != nil) {
+                policy = policyValue.unsignedIntegerValue;
+            }
+            // TODO: Deprecated, remove in SD 6.0...
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wdeprecated-declarations"
+            if (SD_OPTIONS_CONTAINS(options, SDWebImageAvoidDecodeImage)) {
+                policy = SDImageForceDecodePolicyNever;
+            }
+#pragma clang diagnostic pop
+            if (policy != SDImageForceDecodePolicyNever) {
+                transformedImage = [SDImageCoderHelper normalizedImageWithImage:transformedImage];
+            }
             if (transformedImage) {
                 // We need keep some metadata from the full size image when needed
                 // Because most of our transformer does not care about these information
@@ -520,6 +624,8 @@ static id<SDImageLoader> _defaultImageLoader;
                 if (preserveImageMetadata) {
                     SDImageCopyAssociatedObject(cacheImage, transformedImage);
                 }
+                // The transformed image is revalidated with the same remote resource
+                transformedImage.sd_cacheValidator = cacheImage.sd_cacheValidator;
                 // Mark the transformed
                 transformedImage.sd_isTransformed = YES;
                 [self callStoreOriginCacheProcessForOperation:operation url:url options:options context:context originalImage:originalImage cacheImage:transformedImage originalData:originalData cacheData:nil cacheType:cacheType finished:finished completed:completedBlock];
@@ -680,6 +786,20 @@ static id<SDImageLoader> _defaultImageLoader;
     }
 }
 
+- (void)storeCacheValidator:(nullable SDImageCacheValidator *)validator
+                        url:(nonnull NSURL *)url
+                    context:(nullable SDWebImageContext *)context {
+    id<SDImageCache> imageCache = context[SDWebImageContextImageCache];
+    if (!imageCache) {
+        imageCache = self.imageCache;
+    }
+    if (![imageCache respondsToSelector:@selector(storeCacheValidator:forKey:)]) {
+        return;
+    }
+    NSString *key = [self cacheKeyForURL:url context:context];
+    [imageCache storeCacheValidator:validator forKey:key];
+}
+
 - (void)callCompletionBlockForOperation:(nullable SDWebImageCombinedOperation*)operation
                              completion:(nullable SDInternalCompletionBlock)completionBlock
                                   error:(nullable NSError *)error
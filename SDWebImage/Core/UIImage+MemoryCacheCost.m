@@ -9,6 +9,7 @@
 #import "UIImage+MemoryCacheCost.h"
 #import "objc/runtime.h"
 #import "NSImage+Compatibility.h"
+#import "SDImagePixelBufferPool.h"
 
 FOUNDATION_STATIC_INLINE NSUInteger SDMemoryCacheCostForImage(UIImage *image) {
     CGImageRef imageRef = image.CGImage;
@@ -16,6 +17,8 @@ FOUNDATION_STATIC_INLINE NSUInteger SDMemoryCacheCostForImage(UIImage *image) {
         return 0;
     }
     NSUInteger bytesPerFrame = CGImageGetBytesPerRow(imageRef) * CGImageGetHeight(imageRef);
+    // The pooled backing store is rounded up to the bucket, count the whole bucket
+    bytesPerFrame = MAX(bytesPerFrame, [SDImagePixelBufferPool.sharedPool backingStoreLengthForImage:imageRef]);
     NSUInteger frameCount;
 #if SD_MAC
     frameCount = 1;
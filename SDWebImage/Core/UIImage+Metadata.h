@@ -89,6 +89,7 @@
 /**
  A dictionary value contains the decode options when decoded from SDWebImage loading system (say, `SDImageCacheDecodeImageData/SDImageLoaderDecode[Progressive]ImageData`)
  It may not always available and only image decoding related options will be saved. (including [.decodeScaleFactor, .decodeThumbnailPixelSize, .decodePreserveAspectRatio, .decodeFirstFrameOnly])
+ The options are the resolved ones passed to the coder, so an aspect fill thumbnail (`.decodeThumbnailAspectFill`) is saved as the concrete `.decodeThumbnailPixelSize` calculated from the image size.
  @note This is used to identify and check the image is from thumbnail decoding, and the callback's data **will be nil** (because this time the data saved to disk does not match the image return to you. If you need full size data, query the cache with full size url key)
  @warning You should not store object inside which keep strong reference to image itself, which will cause retain cycle.
  @warning This API exist only because of current SDWebImageDownloader bad design which does not callback the context we call it. There will be refactor in future (API break), use with caution.
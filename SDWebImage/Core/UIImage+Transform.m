@@ -10,6 +10,7 @@
 #import "NSImage+Compatibility.h"
 #import "SDImageGraphics.h"
 #import "SDGraphicsImageRenderer.h"
+#import "SDImageCoderHelper.h"
 #import "NSBezierPath+SDRoundedCorners.h"
 #import "SDInternalMacros.h"
 #import <Accelerate/Accelerate.h>
@@ -1016,6 +1017,12 @@ static NSString * _Nullable SDGetCIFilterNameFromBlendMode(CGBlendMode blendMode
         free(input->data);
     }
     free(output->data);
+    if (effectCGImage) {
+        // The vImage buffer format follows the input image, normalize for display
+        CGImageRef normalizedCGImage = [SDImageCoderHelper CGImageCreateNormalized:effectCGImage];
+        CGImageRelease(effectCGImage);
+        effectCGImage = normalizedCGImage;
+    }
 #if SD_UIKIT || SD_WATCH
     UIImage *outputImage = [UIImage imageWithCGImage:effectCGImage scale:self.scale orientation:self.imageOrientation];
 #else
@@ -1047,6 +1054,11 @@ static NSString * _Nullable SDGetCIFilterNameFromBlendMode(CGBlendMode blendMode
     
     CGImageRef imageRef = [context createCGImage:outputImage fromRect:outputImage.extent];
     if (!imageRef) return nil;
+    // The Core Image output format is decided by the context, normalize for display
+    CGImageRef normalizedImageRef = [SDImageCoderHelper CGImageCreateNormalized:imageRef];
+    CGImageRelease(imageRef);
+    imageRef = normalizedImageRef;
+    if (!imageRef) return nil;
     
 #if SD_UIKIT
     UIImage *image = [UIImage imageWithCGImage:imageRef scale:self.scale orientation:self.imageOrientation];
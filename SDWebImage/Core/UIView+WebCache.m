@@ -14,9 +14,53 @@
 #import "SDWebImageTransitionInternal.h"
 #import "SDImageCache.h"
 #import "SDCallbackQueue.h"
+#import "SDWebImageDownloader.h"
+#import <stdatomic.h>
 
 const int64_t SDWebImageProgressUnitCountUnknown = 1LL;
 
+#if SD_UIKIT || SD_MAC
+// Coalesce the progressive decoding pause check of one image load, which need the main queue to check the view visibility
+// Once the check find the view visible, the next check only happens when a partial image is delivered, instead of every progress callback
+@interface SDWebImageProgressiveDecodePauseState : NSObject {
+    atomic_bool _checking;
+    atomic_bool _paused;
+}
+
+// Returns NO if another check is pending, or `onlyWhenPaused` is YES and the last check did not pause
+- (BOOL)beginCheckOnlyWhenPaused:(BOOL)onlyWhenPaused;
+- (void)endCheckWithPaused:(BOOL)paused;
+
+@end
+
+@implementation SDWebImageProgressiveDecodePauseState
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        atomic_init(&_checking, false);
+        // The visibility is unknown before the first check
+        atomic_init(&_paused, true);
+    }
+    return self;
+}
+
+- (BOOL)beginCheckOnlyWhenPaused:(BOOL)onlyWhenPaused {
+    if (onlyWhenPaused && !atomic_load_explicit(&_paused, memory_order_acquire)) {
+        return NO;
+    }
+    bool expected = false;
+    return atomic_compare_exchange_strong_explicit(&_checking, &expected, true, memory_order_acq_rel, memory_order_relaxed);
+}
+
+- (void)endCheckWithPaused:(BOOL)paused {
+    atomic_store_explicit(&_paused, paused, memory_order_release);
+    atomic_store_explicit(&_checking, false, memory_order_release);
+}
+
+@end
+#endif
+
 @implementation UIView (WebCache)
 
 - (nullable NSString *)sd_latestOperationKey {
@@ -89,6 +133,29 @@ const int64_t SDWebImageProgressUnitCountUnknown = 1LL;
         context = [mutableContext copy];
     }
     self.sd_latestOperationKey = validOperationKey;
+#if SD_UIKIT || SD_MAC
+    if (SD_OPTIONS_CONTAINS(options, SDWebImageThumbnailFromViewBounds) && !context[SDWebImageContextImageThumbnailPixelSize]) {
+        // derive the thumbnail pixel size from view bounds, to avoid full size decoding for small view
+        BOOL preserveAspectRatio = YES;
+        BOOL aspectFill = NO;
+        CGSize thumbnailPixelSize = [self sd_thumbnailPixelSizeFromBoundsPreserveAspectRatio:&preserveAspectRatio aspectFill:&aspectFill];
+        if (thumbnailPixelSize.width > 0 && thumbnailPixelSize.height > 0) {
+            SDWebImageMutableContext *mutableContext = [context mutableCopy];
+#if SD_MAC
+            mutableContext[SDWebImageContextImageThumbnailPixelSize] = [NSValue valueWithSize:thumbnailPixelSize];
+#else
+            mutableContext[SDWebImageContextImageThumbnailPixelSize] = [NSValue valueWithCGSize:thumbnailPixelSize];
+#endif
+            if (!context[SDWebImageContextImagePreserveAspectRatio]) {
+                mutableContext[SDWebImageContextImagePreserveAspectRatio] = @(preserveAspectRatio);
+            }
+            if (!context[SDWebImageContextImageThumbnailAspectFill]) {
+                mutableContext[SDWebImageContextImageThumbnailAspectFill] = @(aspectFill);
+            }
+            context = [mutableContext copy];
+        }
+    }
+#endif
     if (!(SD_OPTIONS_CONTAINS(options, SDWebImageAvoidAutoCancelImage))) {
         // cancel previous loading for the same set-image operation key by default
         [self sd_cancelImageLoadOperationWithKey:validOperationKey];
@@ -143,12 +210,34 @@ const int64_t SDWebImageProgressUnitCountUnknown = 1LL;
         id<SDWebImageIndicator> imageIndicator = self.sd_imageIndicator;
 #endif
         
+        @weakify(self);
+#if SD_UIKIT || SD_MAC
+        // Pause the progressive decoding when the view is off-screen, the final image is still decoded
+        void(^checkProgressiveDecodePaused)(BOOL onlyWhenPaused);
+        if (SD_OPTIONS_CONTAINS(options, SDWebImageProgressiveLoad)) {
+            SDWebImageProgressiveDecodePauseState *pauseState = [SDWebImageProgressiveDecodePauseState new];
+            checkProgressiveDecodePaused = ^(BOOL onlyWhenPaused) {
+                if (![pauseState beginCheckOnlyWhenPaused:onlyWhenPaused]) {
+                    return;
+                }
+                dispatch_async(dispatch_get_main_queue(), ^{
+                    @strongify(self);
+                    BOOL paused = [self sd_updateProgressiveDecodePausedForOperationKey:validOperationKey];
+                    [pauseState endCheckWithPaused:paused];
+                });
+            };
+        }
+#endif
         SDImageLoaderProgressBlock combinedProgressBlock = ^(NSInteger receivedSize, NSInteger expectedSize, NSURL * _Nullable targetURL) {
             if (imageProgress) {
                 imageProgress.totalUnitCount = expectedSize;
                 imageProgress.completedUnitCount = receivedSize;
             }
 #if SD_UIKIT || SD_MAC
+            if (checkProgressiveDecodePaused) {
+                // Keep checking during download only when paused, to resume once the view is visible again
+                checkProgressiveDecodePaused(YES);
+            }
             if ([imageIndicator respondsToSelector:@selector(updateIndicatorProgress:)]) {
                 double progress = 0;
                 if (expectedSize != 0) {
@@ -164,7 +253,6 @@ const int64_t SDWebImageProgressUnitCountUnknown = 1LL;
                 progressBlock(receivedSize, expectedSize, targetURL);
             }
         };
-        @weakify(self);
         operation = [manager loadImageWithURL:url options:options context:context progress:combinedProgressBlock completed:^(UIImage *image, NSData *data, NSError *error, SDImageCacheType cacheType, BOOL finished, NSURL *imageURL) {
             @strongify(self);
             if (!self) { return; }
@@ -178,6 +266,9 @@ const int64_t SDWebImageProgressUnitCountUnknown = 1LL;
             // check and stop image indicator
             if (finished) {
                 [self sd_stopImageIndicatorWithQueue:queue];
+            } else if (image && checkProgressiveDecodePaused) {
+                // Check again before the next progressive decoding pass
+                checkProgressiveDecodePaused(NO);
             }
 #endif
             
@@ -447,6 +538,90 @@ const int64_t SDWebImageProgressUnitCountUnknown = 1LL;
 
 #if SD_UIKIT || SD_MAC
 
+#pragma mark - Thumbnail
+
+// Return zero size if the content mode does not scale the image, or the view is not laid out yet
+- (CGSize)sd_thumbnailPixelSizeFromBoundsPreserveAspectRatio:(BOOL *)preserveAspectRatio aspectFill:(BOOL *)aspectFill {
+    CGSize size = self.bounds.size;
+    if (size.width <= 0 || size.height <= 0) {
+        return CGSizeZero;
+    }
+    CGFloat scale = 0;
+    CGSize thumbnailSize = CGSizeZero;
+#if SD_UIKIT
+    scale = self.traitCollection.displayScale;
+    if (scale <= 0) {
+#if SD_VISION
+        scale = UITraitCollection.currentTraitCollection.displayScale;
+#else
+        scale = UIScreen.mainScreen.scale;
+#endif
+    }
+    switch (self.contentMode) {
+        case UIViewContentModeScaleAspectFit:
+            thumbnailSize = size;
+            *preserveAspectRatio = YES;
+            break;
+        case UIViewContentModeScaleToFill:
+            thumbnailSize = size;
+            *preserveAspectRatio = NO;
+            break;
+        case UIViewContentModeScaleAspectFill:
+            // The image scale is `max(viewWidth / imageWidth, viewHeight / imageHeight)`, calculated during decoding when the image size is known
+            thumbnailSize = size;
+            *preserveAspectRatio = YES;
+            *aspectFill = YES;
+            break;
+        default:
+            break;
+    }
+#elif SD_MAC
+    scale = self.window.backingScaleFactor;
+    if (scale <= 0) {
+        scale = NSScreen.mainScreen.backingScaleFactor;
+    }
+    if ([self isKindOfClass:NSImageView.class]) {
+        switch (((NSImageView *)self).imageScaling) {
+            case NSImageScaleProportionallyDown:
+            case NSImageScaleProportionallyUpOrDown:
+                thumbnailSize = size;
+                *preserveAspectRatio = YES;
+                break;
+            case NSImageScaleAxesIndependently:
+                thumbnailSize = size;
+                *preserveAspectRatio = NO;
+                break;
+            default:
+                break;
+        }
+    }
+#endif
+    if (scale <= 0) {
+        scale = 1;
+    }
+    return CGSizeMake(ceil(thumbnailSize.width * scale), ceil(thumbnailSize.height * scale));
+}
+
+#pragma mark - Progressive
+
+// Pause the progressive decoding of the loading image if the view is not visible, returns whether the decoding is paused
+- (BOOL)sd_updateProgressiveDecodePausedForOperationKey:(NSString *)key {
+    BOOL visible = self.window != nil && !self.isHidden;
+    id<SDWebImageOperation> operation = [self sd_imageLoadOperationForKey:key];
+    if (![operation isKindOfClass:SDWebImageCombinedOperation.class]) {
+        return !visible;
+    }
+    id<SDWebImageOperation> loaderOperation = ((SDWebImageCombinedOperation *)operation).loaderOperation;
+    if (![loaderOperation isKindOfClass:SDWebImageDownloadToken.class]) {
+        return !visible;
+    }
+    SDWebImageDownloadToken *token = (SDWebImageDownloadToken *)loaderOperation;
+    if (token.isProgressiveDecodePaused == visible) {
+        token.progressiveDecodePaused = !visible;
+    }
+    return !visible;
+}
+
 #pragma mark - Image Transition
 - (SDWebImageTransition *)sd_imageTransition {
     return objc_getAssociatedObject(self, @selector(sd_imageTransition));
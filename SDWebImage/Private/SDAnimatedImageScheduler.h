@@ -0,0 +1,50 @@
+/*
+* This file is part of the SDWebImage package.
+* (c) Olivier Poitrey <rs@dailymotion.com>
+*
+* For the full copyright and license information, please view the LICENSE
+* file that was distributed with this source code.
+*/
+
+#import <Foundation/Foundation.h>
+#import "SDWebImageCompat.h"
+
+@class SDAnimatedImagePlayer;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// A process-wide animation scheduler, all the players share one frame memory budget and one decode queue, instead of each player decoding and buffering on its own.
+/// The on-screen playing players share the budget, the other players keep only one frame. The larger players get the higher decode priority.
+@interface SDAnimatedImageScheduler : NSObject
+
+@property (nonatomic, class, readonly) SDAnimatedImageScheduler *sharedScheduler;
+
+/// The shared decode queue for all frame pools, the max concurrent count is limited by the active processor count
+@property (nonatomic, strong, readonly) NSOperationQueue *decodeQueue;
+
+/// The total frame buffer bytes shared by all players, default 0
+/// `0` means automatically adjust by calculating current memory usage.
+@property (atomic, assign) NSUInteger maxBufferSize;
+
+/// Update the player's state, call this when the player starts, stops, changes visibility or frame bytes.
+/// @note The scheduler does not retain or access the player, only use it as key.
+/// @param player The player
+/// @param frameBytes The bytes of each frame, 0 if unknown
+/// @param active Whether the player is on-screen and playing
+- (void)updatePlayer:(SDAnimatedImagePlayer *)player frameBytes:(NSUInteger)frameBytes active:(BOOL)active;
+
+/// Remove the player from the budget, call this when the player dealloc
+/// @param player The player
+- (void)removePlayer:(SDAnimatedImagePlayer *)player;
+
+/// Return the max buffer count the player can use from the shared budget, at least 1
+/// @param player The player
+- (NSUInteger)maxBufferCountForPlayer:(SDAnimatedImagePlayer *)player;
+
+/// Return the decode priority for the player, on-screen and larger players are higher
+/// @param player The player
+- (NSOperationQueuePriority)queuePriorityForPlayer:(SDAnimatedImagePlayer *)player;
+
+@end
+
+NS_ASSUME_NONNULL_END
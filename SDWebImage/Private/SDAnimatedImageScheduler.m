@@ -0,0 +1,163 @@
+/*
+* This file is part of the SDWebImage package.
+* (c) Olivier Poitrey <rs@dailymotion.com>
+*
+* For the full copyright and license information, please view the LICENSE
+* file that was distributed with this source code.
+*/
+
+#import "SDAnimatedImageScheduler.h"
+#import "SDDeviceHelper.h"
+#import "SDInternalMacros.h"
+
+// The automatic budget query the free memory, which is a syscall, cache it for a while
+static const CFTimeInterval kAutomaticBudgetInterval = 1;
+
+@interface SDAnimatedImageSchedulerEntry : NSObject
+
+@property (nonatomic, assign) NSUInteger frameBytes;
+@property (nonatomic, assign) BOOL active;
+
+@end
+
+@implementation SDAnimatedImageSchedulerEntry
+@end
+
+@interface SDAnimatedImageScheduler () {
+    SD_LOCK_DECLARE(_lock);
+}
+
+@property (nonatomic, strong, readwrite) NSOperationQueue *decodeQueue;
+// Key is the raw pointer of player, so it's safe to remove during player's dealloc
+@property (nonatomic, strong) NSMapTable<SDAnimatedImagePlayer *, SDAnimatedImageSchedulerEntry *> *entries;
+@property (nonatomic, assign) NSUInteger activeBytes;
+@property (nonatomic, assign) NSUInteger activeCount;
+@property (nonatomic, assign) NSUInteger automaticBudget;
+@property (nonatomic, assign) CFAbsoluteTime automaticBudgetTime;
+
+@end
+
+@implementation SDAnimatedImageScheduler
+
++ (SDAnimatedImageScheduler *)sharedScheduler {
+    static SDAnimatedImageScheduler *scheduler;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        scheduler = [[SDAnimatedImageScheduler alloc] init];
+    });
+    return scheduler;
+}
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        SD_LOCK_INIT(_lock);
+        _entries = [NSMapTable mapTableWithKeyOptions:NSPointerFunctionsOpaqueMemory | NSPointerFunctionsOpaquePersonality valueOptions:NSPointerFunctionsStrongMemory | NSPointerFunctionsObjectPersonality];
+        _decodeQueue = [[NSOperationQueue alloc] init];
+        // Keep one core for main thread rendering
+        NSUInteger processorCount = [NSProcessInfo processInfo].activeProcessorCount;
+        _decodeQueue.maxConcurrentOperationCount = MAX(1, MIN(processorCount - 1, 4));
+        _decodeQueue.name = @"com.hackemist.SDAnimatedImageScheduler.decodeQueue";
+    }
+    return self;
+}
+
+- (void)updatePlayer:(SDAnimatedImagePlayer *)player frameBytes:(NSUInteger)frameBytes active:(BOOL)active {
+    if (!player) {
+        return;
+    }
+    SD_LOCK(_lock);
+    SDAnimatedImageSchedulerEntry *entry = [self.entries objectForKey:player];
+    if (!entry) {
+        entry = [SDAnimatedImageSchedulerEntry new];
+        [self.entries setObject:entry forKey:player];
+    }
+    [self removeEntryFromActive:entry];
+    if (frameBytes > 0) {
+        entry.frameBytes = frameBytes;
+    }
+    entry.active = active;
+    [self addEntryToActive:entry];
+    SD_UNLOCK(_lock);
+}
+
+- (void)removePlayer:(SDAnimatedImagePlayer *)player {
+    if (!player) {
+        return;
+    }
+    SD_LOCK(_lock);
+    SDAnimatedImageSchedulerEntry *entry = [self.entries objectForKey:player];
+    if (entry) {
+        [self removeEntryFromActive:entry];
+        [self.entries removeObjectForKey:player];
+    }
+    SD_UNLOCK(_lock);
+}
+
+- (NSUInteger)maxBufferCountForPlayer:(SDAnimatedImagePlayer *)player {
+    NSUInteger budget = self.maxBufferSize;
+    if (budget == 0) {
+        budget = [self currentAutomaticBudget];
+    }
+    NSUInteger maxBufferCount = 1;
+    SD_LOCK(_lock);
+    SDAnimatedImageSchedulerEntry *entry = [self.entries objectForKey:player];
+    if (entry.active && entry.frameBytes > 0 && self.activeBytes > 0) {
+        // Each active player get the share in proportion to its frame bytes, which means the same buffer count (the same buffered duration for similar frame rate)
+        maxBufferCount = (double)budget / (double)self.activeBytes;
+    }
+    SD_UNLOCK(_lock);
+    // At least 1 frame, the off-screen or paused player keep only the current (poster) frame
+    return MAX(maxBufferCount, 1);
+}
+
+- (NSOperationQueuePriority)queuePriorityForPlayer:(SDAnimatedImagePlayer *)player {
+    NSOperationQueuePriority priority = NSOperationQueuePriorityVeryLow;
+    SD_LOCK(_lock);
+    SDAnimatedImageSchedulerEntry *entry = [self.entries objectForKey:player];
+    if (entry.active) {
+        // Larger than average players are visually more important
+        if (self.activeCount > 0 && entry.frameBytes >= self.activeBytes / self.activeCount) {
+            priority = NSOperationQueuePriorityHigh;
+        } else {
+            priority = NSOperationQueuePriorityNormal;
+        }
+    }
+    SD_UNLOCK(_lock);
+    return priority;
+}
+
+#pragma mark - Private
+
+// Should be called inside lock
+- (void)addEntryToActive:(SDAnimatedImageSchedulerEntry *)entry {
+    if (entry.active) {
+        self.activeBytes += entry.frameBytes;
+        self.activeCount += 1;
+    }
+}
+
+// Should be called inside lock
+- (void)removeEntryFromActive:(SDAnimatedImageSchedulerEntry *)entry {
+    if (entry.active) {
+        self.activeBytes -= entry.frameBytes;
+        self.activeCount -= 1;
+    }
+}
+
+- (NSUInteger)currentAutomaticBudget {
+    SD_LOCK(_lock);
+    CFAbsoluteTime now = CFAbsoluteTimeGetCurrent();
+    if (self.automaticBudget == 0 || now - self.automaticBudgetTime > kAutomaticBudgetInterval) {
+        // Calculate based on current memory, these factors are by experience
+        NSUInteger total = [SDDeviceHelper totalMemory];
+        NSUInteger free = [SDDeviceHelper freeMemory];
+        self.automaticBudget = MIN(total * 0.2, free * 0.6);
+        self.automaticBudgetTime = now;
+    }
+    NSUInteger budget = self.automaticBudget;
+    SD_UNLOCK(_lock);
+    return budget;
+}
+
+@end
@@ -0,0 +1,50 @@
+/*
+* This file is part of the SDWebImage package.
+* (c) Olivier Poitrey <rs@dailymotion.com>
+*
+* For the full copyright and license information, please view the LICENSE
+* file that was distributed with this source code.
+*/
+
+#import <Foundation/Foundation.h>
+#import "SDWebImageCompat.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+@protocol SDDisplayLinkHubTarget <NSObject>
+
+/// Called on each display refresh when the target is registered
+/// @param duration The elapsed time since the target's previous refresh (or one refresh interval for the first refresh after registered)
+- (void)displayLinkHubDidRefreshWithDuration:(NSTimeInterval)duration;
+
+@end
+
+/// A shared display link which drive all the registered targets in one batch, instead of each target owning a display link.
+/// Each run loop mode has its own hub. The display link only runs when there are registered targets. Do not retain the target.
+@interface SDDisplayLinkHub : NSObject
+
+/// Return the shared hub for the run loop mode
+/// @param runLoopMode The run loop mode
++ (instancetype)hubForRunLoopMode:(NSRunLoopMode)runLoopMode;
+
+/// The number of the registered targets
+@property (nonatomic, readonly) NSUInteger targetCount;
+
+/// Whether the display link is running
+@property (nonatomic, readonly) BOOL isRunning;
+
+/// Register the target to receive the display refresh, and start the display link if needed
+/// @param target The target
+- (void)addTarget:(id<SDDisplayLinkHubTarget>)target;
+
+/// Unregister the target, the display link stops when there are no targets
+/// @param target The target
+- (void)removeTarget:(id<SDDisplayLinkHubTarget>)target;
+
+/// Whether the target is registered
+/// @param target The target
+- (BOOL)containsTarget:(id<SDDisplayLinkHubTarget>)target;
+
+@end
+
+NS_ASSUME_NONNULL_END
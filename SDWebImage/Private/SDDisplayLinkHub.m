@@ -0,0 +1,201 @@
+/*
+* This file is part of the SDWebImage package.
+* (c) Olivier Poitrey <rs@dailymotion.com>
+*
+* For the full copyright and license information, please view the LICENSE
+* file that was distributed with this source code.
+*/
+
+#import "SDDisplayLinkHub.h"
+#import "SDDisplayLink.h"
+#import "SDInternalMacros.h"
+
+@interface SDDisplayLinkHubEntry : NSObject
+
+@property (nonatomic, weak) id<SDDisplayLinkHubTarget> target;
+// The hub time of the target's previous refresh
+@property (nonatomic, assign) NSTimeInterval lastTime;
+// Set when unregistered, so the refresh in progress skips it without lock
+@property (atomic, assign, getter=isRemoved) BOOL removed;
+
+@end
+
+@implementation SDDisplayLinkHubEntry
+@end
+
+@interface SDDisplayLinkHub () {
+    SD_LOCK_DECLARE(_lock);
+}
+
+@property (nonatomic, copy) NSRunLoopMode runLoopMode;
+@property (nonatomic, strong) SDDisplayLink *displayLink;
+@property (nonatomic, strong) NSMutableArray<SDDisplayLinkHubEntry *> *entries;
+// The immutable copy of entries for refresh, rebuilt only after the targets changed
+@property (nonatomic, copy) NSArray<SDDisplayLinkHubEntry *> *entriesSnapshot;
+// The accumulated refresh duration since the hub created, each target's timing is relative to this
+@property (nonatomic, assign) NSTimeInterval currentTime;
+
+@end
+
+// Lock to ensure atomic behavior
+SD_LOCK_DECLARE_STATIC(_runLoopModeHubMapLock);
+
+@implementation SDDisplayLinkHub
+
++ (NSMutableDictionary<NSRunLoopMode, SDDisplayLinkHub *> *)runLoopModeHubMap {
+    static NSMutableDictionary<NSRunLoopMode, SDDisplayLinkHub *> *runLoopModeHubMap;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        runLoopModeHubMap = [NSMutableDictionary dictionary];
+    });
+    return runLoopModeHubMap;
+}
+
++ (void)initialize {
+    // Lock to ensure atomic behavior
+    SD_LOCK_INIT(_runLoopModeHubMapLock);
+}
+
++ (instancetype)hubForRunLoopMode:(NSRunLoopMode)runLoopMode {
+    SD_LOCK(_runLoopModeHubMapLock);
+    SDDisplayLinkHub *hub = self.runLoopModeHubMap[runLoopMode];
+    if (!hub) {
+        hub = [[SDDisplayLinkHub alloc] initWithRunLoopMode:runLoopMode];
+        self.runLoopModeHubMap[runLoopMode] = hub;
+    }
+    SD_UNLOCK(_runLoopModeHubMapLock);
+    return hub;
+}
+
+- (instancetype)initWithRunLoopMode:(NSRunLoopMode)runLoopMode {
+    self = [super init];
+    if (self) {
+        SD_LOCK_INIT(_lock);
+        _runLoopMode = [runLoopMode copy];
+        _entries = [NSMutableArray array];
+        _displayLink = [SDDisplayLink displayLinkWithTarget:self selector:@selector(displayDidRefresh:)];
+        [_displayLink addToRunLoop:[NSRunLoop mainRunLoop] forMode:runLoopMode];
+        [_displayLink stop];
+    }
+    return self;
+}
+
+- (NSUInteger)targetCount {
+    NSUInteger count = 0;
+    SD_LOCK(_lock);
+    for (SDDisplayLinkHubEntry *entry in self.entries) {
+        // The released targets are not counted
+        if (entry.target) {
+            count++;
+        }
+    }
+    SD_UNLOCK(_lock);
+    return count;
+}
+
+- (BOOL)isRunning {
+    return self.displayLink.isRunning;
+}
+
+- (void)addTarget:(id<SDDisplayLinkHubTarget>)target {
+    if (!target) {
+        return;
+    }
+    SD_LOCK(_lock);
+    if (![self entryForTarget:target]) {
+        SDDisplayLinkHubEntry *entry = [SDDisplayLinkHubEntry new];
+        entry.target = target;
+        // Start timing from now, the time spent unregistered is not counted
+        entry.lastTime = self.currentTime;
+        [self.entries addObject:entry];
+        self.entriesSnapshot = nil;
+    }
+    SD_UNLOCK(_lock);
+    if (!self.displayLink.isRunning) {
+        [self.displayLink start];
+    }
+}
+
+- (void)removeTarget:(id<SDDisplayLinkHubTarget>)target {
+    if (!target) {
+        return;
+    }
+    SD_LOCK(_lock);
+    SDDisplayLinkHubEntry *entry = [self entryForTarget:target];
+    if (entry) {
+        entry.removed = YES;
+        [self.entries removeObjectIdenticalTo:entry];
+        self.entriesSnapshot = nil;
+    }
+    SD_UNLOCK(_lock);
+    // The display link is stopped on next refresh when no targets, avoid restarting during a batch of changes
+}
+
+- (BOOL)containsTarget:(id<SDDisplayLinkHubTarget>)target {
+    if (!target) {
+        return NO;
+    }
+    SD_LOCK(_lock);
+    BOOL contains = [self entryForTarget:target] != nil;
+    SD_UNLOCK(_lock);
+    return contains;
+}
+
+// Should be called inside lock
+- (SDDisplayLinkHubEntry *)entryForTarget:(id<SDDisplayLinkHubTarget>)target {
+    for (SDDisplayLinkHubEntry *entry in self.entries) {
+        if (entry.target == target) {
+            return entry;
+        }
+    }
+    return nil;
+}
+
+#pragma mark - Core Render
+- (void)displayDidRefresh:(SDDisplayLink *)displayLink {
+    NSTimeInterval currentTime = self.currentTime + displayLink.duration;
+    self.currentTime = currentTime;
+    
+    // Snapshot the targets, the targets may be registered or unregistered during refresh. The snapshot is reused until the targets change
+    SD_LOCK(_lock);
+    NSArray<SDDisplayLinkHubEntry *> *entries = self.entriesSnapshot;
+    if (!entries) {
+        entries = [self.entries copy];
+        self.entriesSnapshot = entries;
+    }
+    SD_UNLOCK(_lock);
+    
+    if (entries.count == 0) {
+        [displayLink stop];
+        return;
+    }
+    
+    BOOL hasReleasedTarget = NO;
+    for (SDDisplayLinkHubEntry *entry in entries) {
+        // Skip the target which is unregistered by the previous target's callback
+        if (entry.isRemoved) {
+            continue;
+        }
+        id<SDDisplayLinkHubTarget> target = entry.target;
+        if (!target) {
+            hasReleasedTarget = YES;
+            continue;
+        }
+        NSTimeInterval duration = currentTime - entry.lastTime;
+        entry.lastTime = currentTime;
+        [target displayLinkHubDidRefreshWithDuration:duration];
+    }
+    
+    if (hasReleasedTarget) {
+        // The hub does not retain the target, remove the entries of released targets
+        SD_LOCK(_lock);
+        NSIndexSet *releasedIndexes = [self.entries indexesOfObjectsPassingTest:^BOOL(SDDisplayLinkHubEntry * _Nonnull entry, NSUInteger idx, BOOL * _Nonnull stop) {
+            return entry.target == nil;
+        }];
+        [self.entries removeObjectsAtIndexes:releasedIndexes];
+        self.entriesSnapshot = nil;
+        SD_UNLOCK(_lock);
+    }
+}
+
+@end
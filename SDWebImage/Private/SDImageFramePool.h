@@ -10,9 +10,30 @@
 #import "SDWebImageCompat.h"
 #import "SDImageCoder.h"
 
+@class SDAnimatedImagePlayer;
+
 NS_ASSUME_NONNULL_BEGIN
 
+/// The playback state of one player, the players which share a frame pool keep their own state
+typedef struct SDImageFramePlayback {
+    /// The frame index to display next, which is never evicted
+    NSUInteger frameIndex;
+    /// The frame count to decode concurrently ahead, including the frame index
+    NSUInteger lookaheadCount;
+    /// The max buffer count of this player, 0 means unlimited. The pool keeps the sum of all the players
+    NSUInteger maxBufferCount;
+    /// The priority of the fetch operations for this player
+    NSOperationQueuePriority queuePriority;
+    /// Whether the playback is from last frame to first currently
+    BOOL reversed;
+    /// Whether the playback direction is reversed at both ends, instead of wrapping around
+    BOOL bounce;
+} SDImageFramePlayback;
+
 /// A per-provider (provider means, AnimatedImage object) based frame pool, each player who use the same provider share the same frame buffer
+/// The `SDAnimatedImage` providers with the same class, data and decode parameters (coder, scale, and the decoded pixel size which reflect the thumbnail size) share one frame pool as well, even if they are different instances (such as from memory cache and disk cache). The incremental animated image is not shared.
+/// The providers are matched by the decode parameters and a few sampled bytes first, the data is hashed only when another instance matches, and the first registered provider is hashed ahead on the decode queue.
+/// The decoded frames are handed off to the display side through a single-producer/single-consumer ring with atomic indexes. The decoder threads are serialized by their own lock and only take the frame buffer lock when the ring is full, so the display side reads (which still take the frame buffer lock) do not wait for the decoding. A frame is no longer treated as fetching once it is decoded, even if the display side has not read it yet.
 @interface SDImageFramePool : NSObject
 
 /// Register and return back a frame pool, also increase reference count
@@ -20,17 +41,65 @@ NS_ASSUME_NONNULL_BEGIN
 /// Unregister a frame pool, also decrease reference count, if zero dealloc the frame pool
 + (void)unregisterProvider:(id<SDAnimatedImageProvider>)provider;
 
+/// Prefetch the frames for the player, in the player's playback order, see `setPlayback:forPlayer:`. The frames displayed soonest by any player are kept when exceed the buffer count, which are evicted on the decode queue.
+/// @param player The player
+- (void)prefetchFramesForPlayer:(SDAnimatedImagePlayer *)player;
+/// Update the playback state of the player and prefetch the frames, in one lock, see `prefetchFramesForPlayer:`
+/// @param playback The playback state
+/// @param player The player, not retained and only used as key
+- (void)prefetchFramesWithPlayback:(SDImageFramePlayback)playback forPlayer:(SDAnimatedImagePlayer *)player;
+/// Update the playback state of the player
+/// @param playback The playback state
+/// @param player The player, not retained and only used as key
+- (void)setPlayback:(SDImageFramePlayback)playback forPlayer:(SDAnimatedImagePlayer *)player;
+/// The playback state of the player, zero if not set
+- (SDImageFramePlayback)playbackForPlayer:(SDAnimatedImagePlayer *)player;
+
 /// Prefetch the current frame, query using `frameAtIndex:` by caller to check whether finished.
+/// The methods without player use the pool's own playback state below (`maxBufferCount`, `maxConcurrentCount`, `queuePriority`, `reversed` and `bounce`), along with the registered players.
 - (void)prefetchFrameAtIndex:(NSUInteger)index;
+/// Prefetch the current frame and the following frames in playback order (see `reversed` and `bounce`), which are decoded concurrently up to `maxConcurrentCount`.
+/// @param index The first frame index to fetch
+/// @param lookaheadCount The frame count to fetch, including the first frame
+- (void)prefetchFrameAtIndex:(NSUInteger)index lookaheadCount:(NSUInteger)lookaheadCount;
 
-/// Control the max buffer count for current frame pool, used for RAM/CPU balance, default unlimited
+/// Control the max buffer count for the callers without player, used for RAM/CPU balance, default unlimited
 @property (nonatomic, assign) NSUInteger maxBufferCount;
-/// Control the max concurrent fetch queue operation count, used for CPU balance, default 1
+/// Control the max concurrent fetch operation count for the callers without player, used for CPU balance, default 1
+/// @note The fetch operations run in the decode queue shared by all frame pools, see `SDAnimatedImageScheduler`
 @property (nonatomic, assign) NSUInteger maxConcurrentCount;
+/// Control the priority of fetch operation in the shared decode queue for the callers without player, default normal
+@property (nonatomic, assign) NSOperationQueuePriority queuePriority;
+/// The moving average of frame decode duration in seconds, 0 if no frame decoded yet
+@property (nonatomic, readonly) NSTimeInterval averageDecodeDuration;
+
+/// The total frame count, 0 means use the largest buffered index. Updated by the player
+@property (nonatomic, assign) NSUInteger totalFrameCount;
+/// Whether the playback is from last frame to first currently, for the callers without player
+@property (nonatomic, assign, getter=isReversed) BOOL reversed;
+/// Whether the playback direction is reversed at both ends, instead of wrapping around, for the callers without player
+@property (nonatomic, assign, getter=isBounce) BOOL bounce;
+
+/// The pixel size to decode the frames at, the largest one requested by the players of this pool. CGSizeZero means the full frame size
+/// @note The provider should implement `animatedImageFrameAtIndex:targetPixelSize:`, or the full frames are used
+@property (nonatomic, readonly) CGSize targetPixelSize;
+/// Update the target pixel size requested by the player, CGSizeZero means the player need the full frame size
+/// When the pool's target pixel size changes significantly (larger than current, or less than half of current), the frame buffer is invalidated and rebuilt at the new size
+/// @param targetPixelSize The target pixel size
+/// @param player The player, not retained and only used as key
+- (void)setTargetPixelSize:(CGSize)targetPixelSize forPlayer:(SDAnimatedImagePlayer *)player;
+/// Remove the target pixel size and playback state of the player, call this when the player dealloc
+/// @param player The player
+- (void)removePlayer:(SDAnimatedImagePlayer *)player;
 
 // Frame Operations
 @property (nonatomic, readonly) NSUInteger currentFrameCount;
 - (nullable UIImage *)frameAtIndex:(NSUInteger)index;
+/// Query the frame along with the buffer state in one lock, for the caller on each display refresh
+/// @param index The frame index
+/// @param currentFrameCount The `currentFrameCount` snapshot, pass NULL if not need
+/// @param averageDecodeDuration The `averageDecodeDuration` snapshot, pass NULL if not need
+- (nullable UIImage *)frameAtIndex:(NSUInteger)index currentFrameCount:(nullable NSUInteger *)currentFrameCount averageDecodeDuration:(nullable NSTimeInterval *)averageDecodeDuration;
 - (void)setFrame:(nullable UIImage *)frame atIndex:(NSUInteger)index;
 - (void)removeFrameAtIndex:(NSUInteger)index;
 - (void)removeAllFrames;
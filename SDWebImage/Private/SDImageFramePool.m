@@ -8,22 +8,250 @@
 
 #import "SDImageFramePool.h"
 #import "SDInternalMacros.h"
+#import "SDAnimatedImageScheduler.h"
+#import "SDAnimatedImage.h"
+#import "UIImage+Metadata.h"
+#import "NSImage+Compatibility.h"
 #import "objc/runtime.h"
+#import <stdatomic.h>
+#import <CommonCrypto/CommonDigest.h>
 
-@interface SDImageFramePool ()
+/// The frames count to play from the `fromIndex` to `toIndex`, treat the frames as a ring in the playback order.
+/// For bounce mode, the direction is reversed at the first and last frame, instead of wrapping around.
+static inline NSUInteger SDFramePlaybackDistance(NSUInteger fromIndex, NSUInteger toIndex, NSUInteger count, BOOL reversed, BOOL bounce) {
+    if (bounce) {
+        if (!reversed) {
+            return toIndex >= fromIndex ? toIndex - fromIndex : (count - 1 - fromIndex) + (count - 1 - toIndex);
+        } else {
+            return toIndex <= fromIndex ? fromIndex - toIndex : fromIndex + toIndex;
+        }
+    }
+    if (!reversed) {
+        return (toIndex + count - fromIndex) % count;
+    } else {
+        return (fromIndex + count - toIndex) % count;
+    }
+}
+
+/// The next frame index in playback order, update the direction for bounce mode
+static inline NSUInteger SDFramePlaybackNextIndex(NSUInteger index, NSUInteger count, BOOL *reversed, BOOL bounce) {
+    if (count <= 1) {
+        return 0;
+    }
+    if (bounce) {
+        if (index == 0) {
+            *reversed = NO;
+        } else if (index >= count - 1) {
+            *reversed = YES;
+        }
+        return *reversed ? index - 1 : index + 1;
+    }
+    if (!*reversed) {
+        return (index + 1) % count;
+    } else {
+        return index == 0 ? count - 1 : index - 1;
+    }
+}
+
+// The weight of the latest sample for the decode duration moving average
+static const double kDecodeDurationSmoothing = 0.25;
+
+// The capacity of frame handoff ring, power of 2. The decoded frames wait here until the display side drains them
+#define kSDFrameHandoffCapacity 64
+// Avoid false sharing between the producer and consumer index
+#define kSDFrameHandoffCacheLineSize 64
+// The max frame count to fetch in one prefetch call, the rest are fetched by the next prefetch
+#define kSDFramePrefetchCapacity 64
+
+/// The playback state of a player, the player is the raw pointer, so it's safe to remove during player's dealloc
+typedef struct SDFramePlayerPlayback {
+    const void *player;
+    SDImageFramePlayback playback;
+} SDFramePlayerPlayback;
+
+typedef struct SDFrameHandoffSlot {
+    void *frame; // Retained, NULL if decode failed
+    NSUInteger index;
+    NSUInteger generation;
+    NSTimeInterval decodeDuration;
+} SDFrameHandoffSlot;
+
+/// A single-producer/single-consumer ring buffer. The producer is the decoder threads (serialized by the producer lock), the consumer is the display side (serialized by the frame buffer lock).
+/// The decoder threads do not take the frame buffer lock unless the ring is full, so the display side reads only contend with each other, not with the decoding.
+typedef struct SDFrameHandoffRing {
+    atomic_ulong head; // Written by consumer only
+    char padding[kSDFrameHandoffCacheLineSize - sizeof(atomic_ulong)];
+    atomic_ulong tail; // Written by producer only
+    SDFrameHandoffSlot slots[kSDFrameHandoffCapacity];
+} SDFrameHandoffRing;
+
+/// Producer side, return NO if the ring is full
+static BOOL SDFrameHandoffRingPush(SDFrameHandoffRing *ring, UIImage *frame, NSUInteger index, NSUInteger generation, NSTimeInterval decodeDuration) {
+    unsigned long tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    // Acquire the consumer's read of the slot before overwrite it
+    unsigned long head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    if (tail - head >= kSDFrameHandoffCapacity) {
+        return NO;
+    }
+    SDFrameHandoffSlot *slot = &ring->slots[tail & (kSDFrameHandoffCapacity - 1)];
+    slot->frame = (__bridge_retained void *)frame;
+    slot->index = index;
+    slot->generation = generation;
+    slot->decodeDuration = decodeDuration;
+    // Publish the slot
+    atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+    return YES;
+}
+
+// The sampled bytes count for the frame pool key, each sample is 8 bytes
+#define kSDFramePoolKeySampleCount 8
+
+/// The frame pool key for the animated image, which decodes the same frames when the data and decode parameters are the same, no matter which instance
+/// The key is compared by the decode parameters and a few sampled bytes only, which does not read (or page in the memory mapped) the whole data. The providers with equal key are confirmed by the SHA-256 digest of data before sharing one pool, see `isContentEqualToKey:`
+@interface SDImageFramePoolContentKey : NSObject
+
+@property (nonatomic, assign, readonly) Class providerClass;
+@property (nonatomic, assign, readonly) Class coderClass;
+@property (nonatomic, assign, readonly) NSUInteger length;
+@property (nonatomic, assign, readonly) NSUInteger frameCount;
+@property (nonatomic, assign, readonly) CGFloat scale;
+// The poster frame pixel size, reflect the thumbnail size and aspect ratio used by the coder
+@property (nonatomic, assign, readonly) size_t pixelWidth;
+@property (nonatomic, assign, readonly) size_t pixelHeight;
+@property (nonatomic, assign, readonly) uint64_t sample;
+
+@end
+
+@implementation SDImageFramePoolContentKey {
+    // The key is associated to the animated image, do not retain it
+    __weak SDAnimatedImage *_animatedImage;
+    SD_LOCK_DECLARE(_digestLock);
+    BOOL _digestComputed;
+    BOOL _hasDigest;
+    unsigned char _digest[CC_SHA256_DIGEST_LENGTH];
+}
+
+- (instancetype)initWithAnimatedImage:(SDAnimatedImage *)animatedImage {
+    NSData *data = animatedImage.animatedImageData;
+    CGImageRef imageRef = animatedImage.CGImage;
+    if (!data || data.length > UINT32_MAX || !imageRef) {
+        return nil;
+    }
+    self = [super init];
+    if (self) {
+        SD_LOCK_INIT(_digestLock);
+        _animatedImage = animatedImage;
+        _providerClass = animatedImage.class;
+        _coderClass = [animatedImage.animatedCoder class];
+        _length = data.length;
+        _frameCount = animatedImage.animatedImageFrameCount;
+        _scale = animatedImage.scale;
+        _pixelWidth = CGImageGetWidth(imageRef);
+        _pixelHeight = CGImageGetHeight(imageRef);
+        // FNV-1a over the sampled bytes, which spread from the header to the end
+        const unsigned char *bytes = data.bytes;
+        uint64_t sample = 14695981039346656037ULL;
+        for (NSUInteger i = 0; i < kSDFramePoolKeySampleCount; i++) {
+            NSUInteger offset = _length > 8 ? (_length - 8) / (kSDFramePoolKeySampleCount - 1) * i : 0;
+            NSUInteger sampleLength = MIN(_length - offset, 8);
+            for (NSUInteger j = 0; j < sampleLength; j++) {
+                sample = (sample ^ bytes[offset + j]) * 1099511628211ULL;
+            }
+        }
+        _sample = sample;
+    }
+    return self;
+}
+
+- (NSUInteger)hash {
+    return (NSUInteger)_sample ^ _length ^ (_pixelWidth << 16) ^ _pixelHeight;
+}
+
+- (BOOL)isEqual:(id)object {
+    if (self == object) {
+        return YES;
+    }
+    if (![object isKindOfClass:SDImageFramePoolContentKey.class]) {
+        return NO;
+    }
+    SDImageFramePoolContentKey *other = object;
+    return _sample == other->_sample
+    && _providerClass == other->_providerClass
+    && _coderClass == other->_coderClass
+    && _length == other->_length
+    && _frameCount == other->_frameCount
+    && _scale == other->_scale
+    && _pixelWidth == other->_pixelWidth
+    && _pixelHeight == other->_pixelHeight;
+}
+
+// Hash the data once, return NO if the animated image is released before computed
+- (BOOL)computeDigest {
+    SD_LOCK(_digestLock);
+    if (!_digestComputed) {
+        NSData *data = _animatedImage.animatedImageData;
+        if (data.length == _length) {
+            CC_SHA256(data.bytes, (CC_LONG)data.length, _digest);
+            _hasDigest = YES;
+        }
+        _digestComputed = YES;
+    }
+    BOOL hasDigest = _hasDigest;
+    SD_UNLOCK(_digestLock);
+    return hasDigest;
+}
+
+// Whether the two equal keys have the same data, which hash the data of both if not yet
+- (BOOL)isContentEqualToKey:(SDImageFramePoolContentKey *)other {
+    if (self == other) {
+        return YES;
+    }
+    if (![self isEqual:other] || ![self computeDigest] || ![other computeDigest]) {
+        return NO;
+    }
+    // The digest is immutable once computed
+    return memcmp(_digest, other->_digest, CC_SHA256_DIGEST_LENGTH) == 0;
+}
+
+@end
+
+@interface SDImageFramePool () {
+    SD_LOCK_DECLARE(_frameBufferLock);
+    NSUInteger _bufferedCount;
+    NSTimeInterval _averageDecodeDuration;
+    CGSize _targetPixelSize;
+    NSUInteger _targetPixelSizeGeneration; // Increased when the target pixel size changed, the in-flight frames of previous size are dropped. Written inside both lock
+    SD_LOCK_DECLARE(_handoffProducerLock); // Lock order: frame buffer lock, then producer lock
+    SDFrameHandoffRing *_handoffRing;
+    // The playback state of the players which share this pool, a plain array since it's updated on each display refresh
+    SDFramePlayerPlayback *_playerPlaybacks;
+    NSUInteger _playerPlaybackCount;
+    NSUInteger _playerPlaybackCapacity;
+    BOOL _evictionScheduled;
+}
 
 @property (class, readonly) NSMapTable *providerFramePoolMap;
 
-@property (weak) id<SDAnimatedImageProvider> provider;
+// Any of the alive registered providers
+@property (nonatomic, weak, readonly) id<SDAnimatedImageProvider> provider;
+// All the registered providers which share this pool, weak
+@property (nonatomic, strong) NSHashTable<id<SDAnimatedImageProvider>> *providers;
 @property (atomic) NSUInteger registerCount;
+// The key of the first registered provider, nil if the pool is not shared by content
+@property (nonatomic, strong) SDImageFramePoolContentKey *contentKey;
 
-@property (nonatomic, strong) NSMutableDictionary<NSNumber *, UIImage *> *frameBuffer;
-@property (nonatomic, strong) NSOperationQueue *fetchQueue;
+// Index-keyed slots, NULL means the frame is not buffered
+@property (nonatomic, strong) NSPointerArray *frameBuffer;
+// The frames being decoded, guarded by the producer lock, so the decoder clears it when finished, without waiting for the display side to drain
+@property (nonatomic, strong) NSMutableIndexSet *fetchingIndexes;
+// Key is the raw pointer of player, so it's safe to remove during player's dealloc
+@property (nonatomic, strong) NSMapTable<SDAnimatedImagePlayer *, NSValue *> *playerTargetPixelSizes;
 
 @end
 
 // Lock to ensure atomic behavior
 SD_LOCK_DECLARE_STATIC(_providerFramePoolMapLock);
+SD_LOCK_DECLARE_STATIC(_poolKeyLock);
 
 @implementation SDImageFramePool
 
@@ -31,7 +259,7 @@ SD_LOCK_DECLARE_STATIC(_providerFramePoolMapLock);
     static NSMapTable *providerFramePoolMap;
     static dispatch_once_t onceToken;
     dispatch_once(&onceToken, ^{
-        // Key use `hash` && `isEqual:`
+        // Key use `hash` && `isEqual:`, value is the pools whose keys are equal, but the data may be different
         providerFramePoolMap = [NSMapTable mapTableWithKeyOptions:NSPointerFunctionsStrongMemory | NSPointerFunctionsObjectPersonality valueOptions:NSPointerFunctionsStrongMemory | NSPointerFunctionsObjectPointerPersonality];
     });
     return providerFramePoolMap;
@@ -41,10 +269,15 @@ SD_LOCK_DECLARE_STATIC(_providerFramePoolMapLock);
 - (instancetype)init {
     self = [super init];
     if (self) {
-        _frameBuffer = [NSMutableDictionary dictionary];
-        _fetchQueue = [[NSOperationQueue alloc] init];
-        _fetchQueue.maxConcurrentOperationCount = 1;
-        _fetchQueue.name = @"com.hackemist.SDImageFramePool.fetchQueue";
+        SD_LOCK_INIT(_frameBufferLock);
+        SD_LOCK_INIT(_handoffProducerLock);
+        _handoffRing = calloc(1, sizeof(SDFrameHandoffRing));
+        _frameBuffer = [NSPointerArray strongObjectsPointerArray];
+        _providers = [NSHashTable hashTableWithOptions:NSPointerFunctionsWeakMemory | NSPointerFunctionsObjectPointerPersonality];
+        _fetchingIndexes = [NSMutableIndexSet indexSet];
+        _playerTargetPixelSizes = [NSMapTable mapTableWithKeyOptions:NSPointerFunctionsOpaqueMemory | NSPointerFunctionsOpaquePersonality valueOptions:NSPointerFunctionsStrongMemory | NSPointerFunctionsObjectPersonality];
+        _maxConcurrentCount = 1;
+        _queuePriority = NSOperationQueuePriorityNormal;
 #if SD_UIKIT
         [[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(didReceiveMemoryWarning:) name:UIApplicationDidReceiveMemoryWarningNotification object:nil];
 #endif
@@ -56,6 +289,20 @@ SD_LOCK_DECLARE_STATIC(_providerFramePoolMapLock);
 #if SD_UIKIT
     [[NSNotificationCenter defaultCenter] removeObserver:self name:UIApplicationDidReceiveMemoryWarningNotification object:nil];
 #endif
+    if (_handoffRing) {
+        // Release the frames not drained
+        unsigned long head = atomic_load_explicit(&_handoffRing->head, memory_order_relaxed);
+        unsigned long tail = atomic_load_explicit(&_handoffRing->tail, memory_order_acquire);
+        for (unsigned long i = head; i != tail; i++) {
+            void *frame = _handoffRing->slots[i & (kSDFrameHandoffCapacity - 1)].frame;
+            if (frame) {
+                CFRelease(frame);
+            }
+        }
+        free(_handoffRing);
+        _handoffRing = NULL;
+    }
+    free(_playerPlaybacks);
 }
 
 - (void)didReceiveMemoryWarning:(NSNotification *)notification {
@@ -65,101 +312,588 @@ SD_LOCK_DECLARE_STATIC(_providerFramePoolMapLock);
 + (void)initialize {
     // Lock to ensure atomic behavior
     SD_LOCK_INIT(_providerFramePoolMapLock);
+    SD_LOCK_INIT(_poolKeyLock);
+}
+
++ (id)poolKeyForProvider:(id<SDAnimatedImageProvider>)provider {
+    if (![provider isKindOfClass:SDAnimatedImage.class]) {
+        // Such as the transformed frame provider, whose frames are not only decided by the data
+        return provider;
+    }
+    SDAnimatedImage *animatedImage = (SDAnimatedImage *)provider;
+    if (animatedImage.sd_isIncremental) {
+        // The data is still growing
+        return provider;
+    }
+    // Create the key only once for each instance, the players on different threads may register at the same time
+    SD_LOCK(_poolKeyLock);
+    SDImageFramePoolContentKey *key = objc_getAssociatedObject(animatedImage, @selector(poolKeyForProvider:));
+    SD_UNLOCK(_poolKeyLock);
+    if (!key) {
+        SDImageFramePoolContentKey *newKey = [[SDImageFramePoolContentKey alloc] initWithAnimatedImage:animatedImage];
+        if (!newKey) {
+            return provider;
+        }
+        SD_LOCK(_poolKeyLock);
+        key = objc_getAssociatedObject(animatedImage, @selector(poolKeyForProvider:));
+        if (!key) {
+            key = newKey;
+            objc_setAssociatedObject(animatedImage, @selector(poolKeyForProvider:), key, OBJC_ASSOCIATION_RETAIN);
+        }
+        SD_UNLOCK(_poolKeyLock);
+    }
+    return key;
 }
 
 + (instancetype)registerProvider:(id<SDAnimatedImageProvider>)provider {
+    id key = [self poolKeyForProvider:provider];
+    SDImageFramePoolContentKey *contentKey = [key isKindOfClass:SDImageFramePoolContentKey.class] ? key : nil;
     // Lock to ensure atomic behavior
     SD_LOCK(_providerFramePoolMapLock);
-    SDImageFramePool *framePool = [self.providerFramePoolMap objectForKey:provider];
+    NSArray<SDImageFramePool *> *framePools = [[self.providerFramePoolMap objectForKey:key] copy];
+    SD_UNLOCK(_providerFramePoolMapLock);
+    SDImageFramePool *framePool;
+    for (SDImageFramePool *pool in framePools) {
+        if ([pool containsProvider:provider] || !contentKey) {
+            framePool = pool;
+            break;
+        }
+    }
     if (!framePool) {
+        // Another instance with equal key, confirm the data outside the lock, which hash the data only when collide
+        for (SDImageFramePool *pool in framePools) {
+            if ([pool.contentKey isContentEqualToKey:contentKey]) {
+                framePool = pool;
+                break;
+            }
+        }
+    }
+    BOOL created = NO;
+    SD_LOCK(_providerFramePoolMapLock);
+    NSMutableArray<SDImageFramePool *> *currentFramePools = [self.providerFramePoolMap objectForKey:key];
+    if (!framePool || ![currentFramePools containsObject:framePool]) {
+        // Not found, or already removed by unregister
         framePool = [[SDImageFramePool alloc] init];
-        framePool.provider = provider;
-        [self.providerFramePoolMap setObject:framePool forKey:provider];
+        framePool.contentKey = contentKey;
+        if (!currentFramePools) {
+            currentFramePools = [NSMutableArray array];
+            [self.providerFramePoolMap setObject:currentFramePools forKey:key];
+        }
+        [currentFramePools addObject:framePool];
+        created = YES;
     }
+    [framePool addProvider:provider];
     framePool.registerCount += 1;
     SD_UNLOCK(_providerFramePoolMapLock);
+    if (created && contentKey) {
+        // Hash the data on the decode queue ahead, so the other instance with equal key only need to hash its own data
+        [SDAnimatedImageScheduler.sharedScheduler.decodeQueue addOperationWithBlock:^{
+            [contentKey computeDigest];
+        }];
+    }
     return framePool;
 }
 
 + (void)unregisterProvider:(id<SDAnimatedImageProvider>)provider {
+    id key = [self poolKeyForProvider:provider];
     // Lock to ensure atomic behavior
     SD_LOCK(_providerFramePoolMapLock);
-    SDImageFramePool *framePool = [self.providerFramePoolMap objectForKey:provider];
+    NSMutableArray<SDImageFramePool *> *framePools = [self.providerFramePoolMap objectForKey:key];
+    SDImageFramePool *framePool;
+    for (SDImageFramePool *pool in framePools) {
+        if ([pool containsProvider:provider]) {
+            framePool = pool;
+            break;
+        }
+    }
     if (!framePool) {
         SD_UNLOCK(_providerFramePoolMapLock);
         return;
     }
     framePool.registerCount -= 1;
     if (framePool.registerCount == 0) {
-        [self.providerFramePoolMap removeObjectForKey:provider];
+        [framePools removeObjectIdenticalTo:framePool];
+        if (framePools.count == 0) {
+            [self.providerFramePoolMap removeObjectForKey:key];
+        }
     }
     SD_UNLOCK(_providerFramePoolMapLock);
 }
 
+- (id<SDAnimatedImageProvider>)provider {
+    SD_LOCK(_frameBufferLock);
+    // Any of the alive providers decode the same frames
+    id<SDAnimatedImageProvider> provider = self.providers.anyObject;
+    SD_UNLOCK(_frameBufferLock);
+    return provider;
+}
+
+- (void)addProvider:(id<SDAnimatedImageProvider>)provider {
+    SD_LOCK(_frameBufferLock);
+    [self.providers addObject:provider];
+    SD_UNLOCK(_frameBufferLock);
+}
+
+- (BOOL)containsProvider:(id<SDAnimatedImageProvider>)provider {
+    SD_LOCK(_frameBufferLock);
+    BOOL contains = [self.providers containsObject:provider];
+    SD_UNLOCK(_frameBufferLock);
+    return contains;
+}
+
 - (void)prefetchFrameAtIndex:(NSUInteger)index {
-    @synchronized (self) {
-        NSUInteger frameCount = self.frameBuffer.count;
-        if (frameCount > self.maxBufferCount) {
-            // Remove the frame buffer if need
-            // TODO, use LRU or better algorithm to detect which frames to clear
-            self.frameBuffer[@(index - 1)] = nil;
-            self.frameBuffer[@(index + 1)] = nil;
+    [self prefetchFrameAtIndex:index lookaheadCount:1];
+}
+
+- (void)prefetchFrameAtIndex:(NSUInteger)index lookaheadCount:(NSUInteger)lookaheadCount {
+    SDImageFramePlayback playback = {
+        .frameIndex = index,
+        .lookaheadCount = lookaheadCount,
+        .maxBufferCount = self.maxBufferCount,
+        .queuePriority = self.queuePriority,
+        .reversed = self.isReversed,
+        .bounce = self.isBounce,
+    };
+    [self prefetchWithPlayback:playback player:nil maxConcurrentCount:self.maxConcurrentCount];
+}
+
+- (void)prefetchFramesForPlayer:(SDAnimatedImagePlayer *)player {
+    if (!player) {
+        return;
+    }
+    SDImageFramePlayback playback = [self playbackForPlayer:player];
+    [self prefetchWithPlayback:playback player:player maxConcurrentCount:playback.lookaheadCount];
+}
+
+- (void)prefetchFramesWithPlayback:(SDImageFramePlayback)playback forPlayer:(SDAnimatedImagePlayer *)player {
+    if (!player) {
+        return;
+    }
+    [self prefetchWithPlayback:playback player:player maxConcurrentCount:playback.lookaheadCount];
+}
+
+- (void)setPlayback:(SDImageFramePlayback)playback forPlayer:(SDAnimatedImagePlayer *)player {
+    if (!player) {
+        return;
+    }
+    SD_LOCK(_frameBufferLock);
+    SDFramePlayerPlayback *playerPlayback = [self playerPlaybackForPlayer:player create:YES];
+    if (playerPlayback) {
+        playerPlayback->playback = playback;
+    }
+    SD_UNLOCK(_frameBufferLock);
+}
+
+- (SDImageFramePlayback)playbackForPlayer:(SDAnimatedImagePlayer *)player {
+    SDImageFramePlayback playback = {0};
+    if (!player) {
+        return playback;
+    }
+    SD_LOCK(_frameBufferLock);
+    SDFramePlayerPlayback *playerPlayback = [self playerPlaybackForPlayer:player create:NO];
+    if (playerPlayback) {
+        playback = playerPlayback->playback;
+    }
+    SD_UNLOCK(_frameBufferLock);
+    return playback;
+}
+
+// The player is nil for the callers without player, which use the pool's own playback state
+- (void)prefetchWithPlayback:(SDImageFramePlayback)playback player:(SDAnimatedImagePlayer *)player maxConcurrentCount:(NSUInteger)maxConcurrentCount {
+    NSUInteger index = playback.frameIndex;
+    NSUInteger fetchIndexes[kSDFramePrefetchCapacity];
+    NSUInteger fetchCount = 0;
+    SD_LOCK(_frameBufferLock);
+    if (player) {
+        SDFramePlayerPlayback *playerPlayback = [self playerPlaybackForPlayer:player create:YES];
+        if (playerPlayback) {
+            playerPlayback->playback = playback;
+        }
+    }
+    // Limit the in-flight fetch count, since the decode queue is shared with other frame pools
+    maxConcurrentCount = MAX(maxConcurrentCount, 1);
+    // The buffer is shared by the players, so keep the sum of their buffer count, any of them is 0 means unlimited
+    NSUInteger maxBufferCount = player ? 0 : playback.maxBufferCount;
+    BOOL unlimited = !player && playback.maxBufferCount == 0;
+    for (NSUInteger i = 0; i < _playerPlaybackCount; i++) {
+        SDImageFramePlayback otherPlayback = _playerPlaybacks[i].playback;
+        if (_playerPlaybacks[i].player != (__bridge const void *)player) {
+            // Other players are decoding ahead as well
+            maxConcurrentCount += otherPlayback.lookaheadCount;
+        }
+        if (otherPlayback.maxBufferCount == 0) {
+            unlimited = YES;
+        }
+        maxBufferCount += otherPlayback.maxBufferCount;
+    }
+    // Block the producers, so each frame is either drained into buffer, or still in `fetchingIndexes`
+    SD_LOCK(_handoffProducerLock);
+    [self drainHandoffFrames];
+    NSUInteger totalFrameCount = MAX(MAX(self.totalFrameCount, self.frameBuffer.count), index + 1);
+    NSUInteger lookaheadCount = MIN(MAX(playback.lookaheadCount, 1), totalFrameCount);
+    BOOL reversed = playback.reversed;
+    NSUInteger fetchIndex = index;
+    for (NSUInteger i = 0; i < lookaheadCount && fetchCount < kSDFramePrefetchCapacity; i++) {
+        if (self.fetchingIndexes.count >= maxConcurrentCount) {
+            break;
         }
+        BOOL buffered = fetchIndex < self.frameBuffer.count && [self.frameBuffer pointerAtIndex:fetchIndex] != NULL;
+        if (!buffered && ![self.fetchingIndexes containsIndex:fetchIndex]) {
+            [self.fetchingIndexes addIndex:fetchIndex];
+            fetchIndexes[fetchCount++] = fetchIndex;
+        }
+        fetchIndex = SDFramePlaybackNextIndex(fetchIndex, totalFrameCount, &reversed, playback.bounce);
+    }
+    SD_UNLOCK(_handoffProducerLock);
+    // Remove the frame buffer if need, which scans the whole buffer against each player, so do it on the decode queue
+    BOOL shouldEvict = !unlimited && !_evictionScheduled && _bufferedCount > maxBufferCount;
+    if (shouldEvict) {
+        _evictionScheduled = YES;
     }
+    CGSize targetPixelSize = _targetPixelSize;
+    NSUInteger targetPixelSizeGeneration = _targetPixelSizeGeneration;
+    SD_UNLOCK(_frameBufferLock);
     
-    if (self.fetchQueue.operationCount == 0) {
-        // Prefetch next frame in background queue
-        id<SDAnimatedImageProvider> animatedProvider = self.provider;
-        @weakify(self);
+    @weakify(self);
+    NSOperationQueuePriority queuePriority = playback.queuePriority;
+    if (shouldEvict) {
+        BOOL hasOwnPlayback = !player;
         NSOperation *operation = [NSBlockOperation blockOperationWithBlock:^{
             @strongify(self);
             if (!self) {
                 return;
             }
-            UIImage *frame = [animatedProvider animatedImageFrameAtIndex:index];
-            
-            [self setFrame:frame atIndex:index];
+            [self evictFramesWithOwnPlayback:hasOwnPlayback ? &playback : NULL];
         }];
-        [self.fetchQueue addOperation:operation];
+        operation.queuePriority = queuePriority;
+        [SDAnimatedImageScheduler.sharedScheduler.decodeQueue addOperation:operation];
+    }
+    if (fetchCount == 0) {
+        return;
+    }
+    
+    // Prefetch frames in background queue, the provider should be re-entrant
+    id<SDAnimatedImageProvider> animatedProvider = self.provider;
+    BOOL decodeAtTargetPixelSize = targetPixelSize.width > 0 && targetPixelSize.height > 0 && [animatedProvider respondsToSelector:@selector(animatedImageFrameAtIndex:targetPixelSize:)];
+    for (NSUInteger i = 0; i < fetchCount; i++) {
+        NSUInteger idx = fetchIndexes[i];
+        NSOperation *operation = [NSBlockOperation blockOperationWithBlock:^{
+            @strongify(self);
+            if (!self) {
+                return;
+            }
+            CFAbsoluteTime startTime = CFAbsoluteTimeGetCurrent();
+            UIImage *frame;
+            if (decodeAtTargetPixelSize) {
+                frame = [animatedProvider animatedImageFrameAtIndex:idx targetPixelSize:targetPixelSize];
+            } else {
+                frame = [animatedProvider animatedImageFrameAtIndex:idx];
+            }
+            NSTimeInterval decodeDuration = CFAbsoluteTimeGetCurrent() - startTime;
+            [self handoffFrame:frame atIndex:idx generation:targetPixelSizeGeneration decodeDuration:decodeDuration];
+        }];
+        operation.queuePriority = queuePriority;
+        [SDAnimatedImageScheduler.sharedScheduler.decodeQueue addOperation:operation];
     }
 }
 
-- (void)setMaxConcurrentCount:(NSUInteger)maxConcurrentCount {
-    self.fetchQueue.maxConcurrentOperationCount = maxConcurrentCount;
+- (CGSize)targetPixelSize {
+    SD_LOCK(_frameBufferLock);
+    CGSize targetPixelSize = _targetPixelSize;
+    SD_UNLOCK(_frameBufferLock);
+    return targetPixelSize;
 }
 
-- (NSUInteger)currentFrameCount {
-    NSUInteger frameCount = 0;
-    @synchronized (self) {
-        frameCount = self.frameBuffer.count;
+- (void)setTargetPixelSize:(CGSize)targetPixelSize forPlayer:(SDAnimatedImagePlayer *)player {
+    if (!player) {
+        return;
+    }
+#if SD_MAC
+    NSValue *value = [NSValue valueWithSize:targetPixelSize];
+#else
+    NSValue *value = [NSValue valueWithCGSize:targetPixelSize];
+#endif
+    SD_LOCK(_frameBufferLock);
+    [self.playerTargetPixelSizes setObject:value forKey:player];
+    [self updateTargetPixelSize];
+    SD_UNLOCK(_frameBufferLock);
+}
+
+- (void)removePlayer:(SDAnimatedImagePlayer *)player {
+    if (!player) {
+        return;
+    }
+    SD_LOCK(_frameBufferLock);
+    SDFramePlayerPlayback *playerPlayback = [self playerPlaybackForPlayer:player create:NO];
+    if (playerPlayback) {
+        // Move the last one to fill the hole, the order does not matter
+        *playerPlayback = _playerPlaybacks[_playerPlaybackCount - 1];
+        _playerPlaybackCount--;
     }
+    [self.playerTargetPixelSizes removeObjectForKey:player];
+    [self updateTargetPixelSize];
+    SD_UNLOCK(_frameBufferLock);
+}
+
+- (NSTimeInterval)averageDecodeDuration {
+    SD_LOCK(_frameBufferLock);
+    [self drainHandoffFrames];
+    NSTimeInterval averageDecodeDuration = _averageDecodeDuration;
+    SD_UNLOCK(_frameBufferLock);
+    return averageDecodeDuration;
+}
+
+- (NSUInteger)currentFrameCount {
+    SD_LOCK(_frameBufferLock);
+    [self drainHandoffFrames];
+    NSUInteger frameCount = _bufferedCount;
+    SD_UNLOCK(_frameBufferLock);
     return frameCount;
 }
 
 - (void)setFrame:(UIImage *)frame atIndex:(NSUInteger)index {
-    @synchronized (self) {
-        self.frameBuffer[@(index)] = frame;
-    }
+    SD_LOCK(_frameBufferLock);
+    [self drainHandoffFrames];
+    [self storeFrame:frame atIndex:index];
+    SD_UNLOCK(_frameBufferLock);
 }
 
 - (UIImage *)frameAtIndex:(NSUInteger)index {
+    return [self frameAtIndex:index currentFrameCount:NULL averageDecodeDuration:NULL];
+}
+
+- (UIImage *)frameAtIndex:(NSUInteger)index currentFrameCount:(NSUInteger *)currentFrameCount averageDecodeDuration:(NSTimeInterval *)averageDecodeDuration {
     UIImage *frame;
-    @synchronized (self) {
-        frame = self.frameBuffer[@(index)];
+    SD_LOCK(_frameBufferLock);
+    [self drainHandoffFrames];
+    if (index < self.frameBuffer.count) {
+        frame = (__bridge UIImage *)[self.frameBuffer pointerAtIndex:index];
+    }
+    if (currentFrameCount) {
+        *currentFrameCount = _bufferedCount;
     }
+    if (averageDecodeDuration) {
+        *averageDecodeDuration = _averageDecodeDuration;
+    }
+    SD_UNLOCK(_frameBufferLock);
     return frame;
 }
 
 - (void)removeFrameAtIndex:(NSUInteger)index {
-    @synchronized (self) {
-        self.frameBuffer[@(index)] = nil;
-    }
+    SD_LOCK(_frameBufferLock);
+    [self drainHandoffFrames];
+    [self storeFrame:nil atIndex:index];
+    SD_UNLOCK(_frameBufferLock);
 }
 
 - (void)removeAllFrames {
-    @synchronized (self) {
-        [self.frameBuffer removeAllObjects];
+    SD_LOCK(_frameBufferLock);
+    // Drain the in-flight frames as well, which also need to be freed
+    [self drainHandoffFrames];
+    self.frameBuffer.count = 0;
+    _bufferedCount = 0;
+    SD_UNLOCK(_frameBufferLock);
+}
+
+#pragma mark - Private
+
+// Called on the decoder threads, which only take the frame buffer lock when the ring is full
+- (void)handoffFrame:(UIImage *)frame atIndex:(NSUInteger)index generation:(NSUInteger)generation decodeDuration:(NSTimeInterval)decodeDuration {
+    SD_LOCK(_handoffProducerLock);
+    BOOL pushed = SDFrameHandoffRingPush(_handoffRing, frame, index, generation, decodeDuration);
+    if (pushed) {
+        [self finishFetchingAtIndex:index generation:generation];
+    }
+    SD_UNLOCK(_handoffProducerLock);
+    if (!pushed) {
+        // Slow path, the display side does not drain for a while (such as paused), store it directly
+        SD_LOCK(_frameBufferLock);
+        SD_LOCK(_handoffProducerLock);
+        [self drainHandoffFrames];
+        [self consumeFrame:frame atIndex:index generation:generation decodeDuration:decodeDuration];
+        [self finishFetchingAtIndex:index generation:generation];
+        SD_UNLOCK(_handoffProducerLock);
+        SD_UNLOCK(_frameBufferLock);
+    }
+}
+
+// Should be called inside producer lock
+- (void)finishFetchingAtIndex:(NSUInteger)index generation:(NSUInteger)generation {
+    // The fetching indexes of previous size are already cleared, do not clear the same index fetched at current size
+    if (generation == _targetPixelSizeGeneration) {
+        [self.fetchingIndexes removeIndex:index];
+    }
+}
+
+// Should be called inside lock, the lock ensure single consumer
+- (void)drainHandoffFrames {
+    SDFrameHandoffRing *ring = _handoffRing;
+    unsigned long head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    // Acquire the producer's write of the slots
+    unsigned long tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    if (head == tail) {
+        return;
+    }
+    for (; head != tail; head++) {
+        SDFrameHandoffSlot *slot = &ring->slots[head & (kSDFrameHandoffCapacity - 1)];
+        UIImage *frame = (__bridge_transfer UIImage *)slot->frame;
+        slot->frame = NULL;
+        [self consumeFrame:frame atIndex:slot->index generation:slot->generation decodeDuration:slot->decodeDuration];
+    }
+    // Release the slots to producer
+    atomic_store_explicit(&ring->head, head, memory_order_release);
+}
+
+// Should be called inside lock
+- (void)consumeFrame:(UIImage *)frame atIndex:(NSUInteger)index generation:(NSUInteger)generation decodeDuration:(NSTimeInterval)decodeDuration {
+    if (generation == _targetPixelSizeGeneration) {
+        [self storeFrame:frame atIndex:index];
+    }
+    if (frame) {
+        NSTimeInterval averageDecodeDuration = _averageDecodeDuration;
+        _averageDecodeDuration = averageDecodeDuration > 0 ? averageDecodeDuration + (decodeDuration - averageDecodeDuration) * kDecodeDurationSmoothing : decodeDuration;
+    }
+}
+
+// Should be called inside lock
+- (void)updateTargetPixelSize {
+    if (self.playerTargetPixelSizes.count == 0) {
+        return;
+    }
+    // The largest size requested, any player need the full size means full size
+    CGSize targetPixelSize = CGSizeZero;
+    for (NSValue *value in self.playerTargetPixelSizes.objectEnumerator) {
+#if SD_MAC
+        CGSize size = value.sizeValue;
+#else
+        CGSize size = value.CGSizeValue;
+#endif
+        if (size.width <= 0 || size.height <= 0) {
+            targetPixelSize = CGSizeZero;
+            break;
+        }
+        targetPixelSize = CGSizeMake(MAX(targetPixelSize.width, size.width), MAX(targetPixelSize.height, size.height));
+    }
+    CGSize currentPixelSize = _targetPixelSize;
+    if (CGSizeEqualToSize(targetPixelSize, currentPixelSize)) {
+        return;
+    }
+    BOOL isFullSize = targetPixelSize.width <= 0 || targetPixelSize.height <= 0;
+    BOOL isCurrentFullSize = currentPixelSize.width <= 0 || currentPixelSize.height <= 0;
+    if (!isFullSize && !isCurrentFullSize) {
+        // Ignore the small shrink, the buffered frames are a little larger but still sharp
+        BOOL larger = targetPixelSize.width > currentPixelSize.width || targetPixelSize.height > currentPixelSize.height;
+        BOOL muchSmaller = targetPixelSize.width * 2 <= currentPixelSize.width && targetPixelSize.height * 2 <= currentPixelSize.height;
+        if (!larger && !muchSmaller) {
+            return;
+        }
+    }
+    _targetPixelSize = targetPixelSize;
+    // The frames decoding at previous size are dropped, do not wait for them to fetch at the new size
+    SD_LOCK(_handoffProducerLock);
+    _targetPixelSizeGeneration++;
+    [self.fetchingIndexes removeAllIndexes];
+    SD_UNLOCK(_handoffProducerLock);
+    // Invalidate the frames of previous size, rebuilt by the next prefetch
+    self.frameBuffer.count = 0;
+    _bufferedCount = 0;
+}
+
+// Should be called inside lock
+- (void)storeFrame:(UIImage *)frame atIndex:(NSUInteger)index {
+    NSPointerArray *frameBuffer = self.frameBuffer;
+    if (index >= frameBuffer.count) {
+        if (!frame) {
+            return;
+        }
+        // Grow for progressive animation, the slots are NULL
+        frameBuffer.count = index + 1;
+    }
+    BOOL existed = [frameBuffer pointerAtIndex:index] != NULL;
+    [frameBuffer replacePointerAtIndex:index withPointer:(__bridge void *)frame];
+    if (existed && !frame) {
+        _bufferedCount--;
+    } else if (!existed && frame) {
+        _bufferedCount++;
+    }
+}
+
+// Should be called inside lock, return NULL if not found
+- (SDFramePlayerPlayback *)playerPlaybackForPlayer:(SDAnimatedImagePlayer *)player create:(BOOL)create {
+    const void *key = (__bridge const void *)player;
+    // Only a few players share one pool, linear search is enough
+    for (NSUInteger i = 0; i < _playerPlaybackCount; i++) {
+        if (_playerPlaybacks[i].player == key) {
+            return &_playerPlaybacks[i];
+        }
+    }
+    if (!create) {
+        return NULL;
+    }
+    if (_playerPlaybackCount == _playerPlaybackCapacity) {
+        NSUInteger capacity = MAX(_playerPlaybackCapacity * 2, 4);
+        SDFramePlayerPlayback *playerPlaybacks = realloc(_playerPlaybacks, sizeof(SDFramePlayerPlayback) * capacity);
+        if (!playerPlaybacks) {
+            return NULL;
+        }
+        _playerPlaybacks = playerPlaybacks;
+        _playerPlaybackCapacity = capacity;
+    }
+    SDFramePlayerPlayback *playerPlayback = &_playerPlaybacks[_playerPlaybackCount++];
+    *playerPlayback = (SDFramePlayerPlayback){.player = key};
+    return playerPlayback;
+}
+
+// Called on the decode queue, the own playback is for the callers without player, NULL if not need
+- (void)evictFramesWithOwnPlayback:(const SDImageFramePlayback *)ownPlayback {
+    SD_LOCK(_frameBufferLock);
+    _evictionScheduled = NO;
+    [self drainHandoffFrames];
+    NSUInteger count = _playerPlaybackCount + (ownPlayback ? 1 : 0);
+    // The buffer is shared by the players, so keep the sum of their buffer count
+    NSUInteger maxBufferCount = 0;
+    NSUInteger maxFrameIndex = 0;
+    for (NSUInteger i = 0; i < count; i++) {
+        const SDImageFramePlayback *playback = i < _playerPlaybackCount ? &_playerPlaybacks[i].playback : ownPlayback;
+        if (playback->maxBufferCount == 0) {
+            // Unlimited
+            SD_UNLOCK(_frameBufferLock);
+            return;
+        }
+        maxBufferCount += playback->maxBufferCount;
+        maxFrameIndex = MAX(maxFrameIndex, playback->frameIndex);
+    }
+    NSPointerArray *frameBuffer = self.frameBuffer;
+    NSUInteger slotCount = frameBuffer.count;
+    NSUInteger totalFrameCount = MAX(MAX(self.totalFrameCount, slotCount), maxFrameIndex + 1);
+    while (count > 0 && _bufferedCount > maxBufferCount) {
+        // Evict the frame which will be displayed latest by any player in its playback order, the current frame of each player is never evicted
+        NSUInteger evictIndex = NSNotFound;
+        NSUInteger evictDistance = 0;
+        for (NSUInteger i = 0; i < slotCount; i++) {
+            if ([frameBuffer pointerAtIndex:i] == NULL) {
+                continue;
+            }
+            NSUInteger distance = NSUIntegerMax;
+            for (NSUInteger j = 0; j < count; j++) {
+                const SDImageFramePlayback *playback = j < _playerPlaybackCount ? &_playerPlaybacks[j].playback : ownPlayback;
+                distance = MIN(distance, SDFramePlaybackDistance(playback->frameIndex, i, totalFrameCount, playback->reversed, playback->bounce));
+            }
+            if (distance == 0) {
+                continue;
+            }
+            if (evictIndex == NSNotFound || distance > evictDistance) {
+                evictIndex = i;
+                evictDistance = distance;
+            }
+        }
+        if (evictIndex == NSNotFound) {
+            break;
+        }
+        [frameBuffer replacePointerAtIndex:evictIndex withPointer:NULL];
+        _bufferedCount--;
     }
+    SD_UNLOCK(_frameBufferLock);
 }
 
 @end
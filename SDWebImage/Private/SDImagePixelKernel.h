@@ -0,0 +1,70 @@
+/*
+ * This file is part of the SDWebImage package.
+ * (c) Olivier Poitrey <rs@dailymotion.com>
+ *
+ * For the full copyright and license information, please view the LICENSE
+ * file that was distributed with this source code.
+ */
+
+#ifndef SDImagePixelKernel_h
+#define SDImagePixelKernel_h
+
+// The portable pixel kernels for 8-bit 4 channels bitmap, with NEON/SSE/AVX2 paths and the scalar fallback.
+// This is plain C without Apple frameworks dependency, so it can be built and benchmarked on any platform.
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// The alpha channel byte position of each pixel in memory
+typedef enum SDPixelAlphaPosition {
+    SDPixelAlphaPositionLast = 0, // RGBA/BGRA in memory
+    SDPixelAlphaPositionFirst = 1, // ARGB/ABGR in memory
+} SDPixelAlphaPosition;
+
+/// The resampling filter
+typedef enum SDPixelResizeFilter {
+    SDPixelResizeFilterBox = 0, // area average, fast and good for downscale
+    SDPixelResizeFilterBilinear = 1, // triangle filter
+    SDPixelResizeFilterLanczos3 = 2, // windowed sinc, sharpest but slowest
+} SDPixelResizeFilter;
+
+/// The 8-bit 4 channels bitmap buffer
+typedef struct SDPixelBuffer {
+    uint8_t *data;
+    size_t width;
+    size_t height;
+    size_t bytesPerRow;
+} SDPixelBuffer;
+
+/// The SIMD instruction set name used by kernels on current platform, such as "NEON", "AVX2", "SSSE3", "SSE2" or "Scalar".
+const char *SDPixelKernelSIMDName(void);
+
+/// Premultiply the color channels by alpha in-place, with exact rounding of `c * a / 255`.
+void SDPixelKernelPremultiply(const SDPixelBuffer *buffer, SDPixelAlphaPosition alphaPosition);
+
+/// Unpremultiply the color channels by alpha in-place, with exact rounding of `c * 255 / a`. The color is zero if alpha is zero.
+void SDPixelKernelUnpremultiply(const SDPixelBuffer *buffer, SDPixelAlphaPosition alphaPosition);
+
+/// Swap the red and blue channels in-place (RGBA <-> BGRA, or ARGB <-> ABGR).
+void SDPixelKernelSwapRedBlue(const SDPixelBuffer *buffer, SDPixelAlphaPosition alphaPosition);
+
+/// Resize the source bitmap into the destination bitmap with the separable filter. The channels are processed independently, so the alpha position does not matter, but the source should be premultiplied to avoid color fringes.
+/// The vertical pass streams through a ring of horizontally resized rows, so the temporary memory is `filter taps * destination width * 16` bytes, not the whole intermediate image.
+/// @return false if the size is invalid or memory allocation failed
+bool SDPixelKernelResize(const SDPixelBuffer *source, const SDPixelBuffer *destination, SDPixelResizeFilter filter);
+
+// The scalar reference implementations, which never take the SIMD paths. Used to verify the SIMD output and measure the speedup, without changing any global state.
+void SDPixelKernelPremultiplyReference(const SDPixelBuffer *buffer, SDPixelAlphaPosition alphaPosition);
+void SDPixelKernelSwapRedBlueReference(const SDPixelBuffer *buffer, SDPixelAlphaPosition alphaPosition);
+bool SDPixelKernelResizeReference(const SDPixelBuffer *source, const SDPixelBuffer *destination, SDPixelResizeFilter filter);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SDImagePixelKernel_h */
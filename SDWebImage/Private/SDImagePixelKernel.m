@@ -0,0 +1,631 @@
+/*
+ * This file is part of the SDWebImage package.
+ * (c) Olivier Poitrey <rs@dailymotion.com>
+ *
+ * For the full copyright and license information, please view the LICENSE
+ * file that was distributed with this source code.
+ */
+
+#include "SDImagePixelKernel.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Pick the SIMD path at compile time, the scalar fallback is always available
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define SD_PIXEL_NEON 1
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define SD_PIXEL_SSE2 1
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+#define SD_PIXEL_SSSE3 1
+#endif
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define SD_PIXEL_AVX2 1
+#endif
+#endif
+
+const char *SDPixelKernelSIMDName(void) {
+#if SD_PIXEL_NEON
+    return "NEON";
+#elif SD_PIXEL_AVX2
+    return "AVX2";
+#elif SD_PIXEL_SSSE3
+    return "SSSE3";
+#elif SD_PIXEL_SSE2
+    return "SSE2";
+#else
+    return "Scalar";
+#endif
+}
+
+// MARK: - Premultiply
+
+// Exact rounding of `c * a / 255`
+static inline uint8_t SDPixelMultiply(uint8_t c, uint8_t a) {
+    uint32_t t = (uint32_t)c * a + 128;
+    return (uint8_t)((t + (t >> 8)) >> 8);
+}
+
+static inline void SDPixelPremultiplyScalar(uint8_t *p, size_t count, SDPixelAlphaPosition alphaPosition) {
+    size_t ai = alphaPosition == SDPixelAlphaPositionFirst ? 0 : 3;
+    for (size_t i = 0; i < count; i++, p += 4) {
+        uint8_t a = p[ai];
+        for (size_t c = 0; c < 4; c++) {
+            if (c != ai) {
+                p[c] = SDPixelMultiply(p[c], a);
+            }
+        }
+    }
+}
+
+#if SD_PIXEL_NEON
+// 16 pixels each time
+static inline size_t SDPixelPremultiplyNEON(uint8_t *p, size_t count, SDPixelAlphaPosition alphaPosition) {
+    size_t ai = alphaPosition == SDPixelAlphaPositionFirst ? 0 : 3;
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16, p += 64) {
+        uint8x16x4_t px = vld4q_u8(p);
+        uint8x16_t alpha = px.val[ai];
+        for (size_t c = 0; c < 4; c++) {
+            if (c == ai) {
+                continue;
+            }
+            uint16x8_t lo = vmull_u8(vget_low_u8(px.val[c]), vget_low_u8(alpha));
+            uint16x8_t hi = vmull_u8(vget_high_u8(px.val[c]), vget_high_u8(alpha));
+            // (t + (t >> 8)) >> 8, t = c * a + 128
+            lo = vrsraq_n_u16(lo, lo, 8);
+            hi = vrsraq_n_u16(hi, hi, 8);
+            px.val[c] = vcombine_u8(vrshrn_n_u16(lo, 8), vrshrn_n_u16(hi, 8));
+        }
+        vst4q_u8(p, px);
+    }
+    return i;
+}
+#elif SD_PIXEL_SSE2
+// 4 pixels each time
+static inline __m128i SDPixelPremultiplyHalfSSE2(__m128i c, __m128i alphaMask, SDPixelAlphaPosition alphaPosition) {
+    __m128i a;
+    if (alphaPosition == SDPixelAlphaPositionFirst) {
+        a = _mm_shufflehi_epi16(_mm_shufflelo_epi16(c, _MM_SHUFFLE(0, 0, 0, 0)), _MM_SHUFFLE(0, 0, 0, 0));
+    } else {
+        a = _mm_shufflehi_epi16(_mm_shufflelo_epi16(c, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+    }
+    // Keep alpha by multiplying 255
+    a = _mm_or_si128(_mm_andnot_si128(alphaMask, a), _mm_and_si128(alphaMask, _mm_set1_epi16(255)));
+    __m128i t = _mm_add_epi16(_mm_mullo_epi16(c, a), _mm_set1_epi16(128));
+    return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+}
+
+static inline size_t SDPixelPremultiplySSE2(uint8_t *p, size_t count, SDPixelAlphaPosition alphaPosition) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i alphaMask = alphaPosition == SDPixelAlphaPositionFirst ? _mm_setr_epi16(-1, 0, 0, 0, -1, 0, 0, 0) : _mm_setr_epi16(0, 0, 0, -1, 0, 0, 0, -1);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4, p += 16) {
+        __m128i px = _mm_loadu_si128((const __m128i *)p);
+        __m128i lo = SDPixelPremultiplyHalfSSE2(_mm_unpacklo_epi8(px, zero), alphaMask, alphaPosition);
+        __m128i hi = SDPixelPremultiplyHalfSSE2(_mm_unpackhi_epi8(px, zero), alphaMask, alphaPosition);
+        _mm_storeu_si128((__m128i *)p, _mm_packus_epi16(lo, hi));
+    }
+    return i;
+}
+#endif
+
+static void SDPixelPremultiply(const SDPixelBuffer *buffer, SDPixelAlphaPosition alphaPosition, bool simd) {
+    if (!buffer || !buffer->data) {
+        return;
+    }
+    for (size_t y = 0; y < buffer->height; y++) {
+        uint8_t *row = buffer->data + y * buffer->bytesPerRow;
+        size_t done = 0;
+        if (simd) {
+#if SD_PIXEL_NEON
+            done = SDPixelPremultiplyNEON(row, buffer->width, alphaPosition);
+#elif SD_PIXEL_SSE2
+            done = SDPixelPremultiplySSE2(row, buffer->width, alphaPosition);
+#endif
+        }
+        SDPixelPremultiplyScalar(row + done * 4, buffer->width - done, alphaPosition);
+    }
+}
+
+void SDPixelKernelPremultiply(const SDPixelBuffer *buffer, SDPixelAlphaPosition alphaPosition) {
+    SDPixelPremultiply(buffer, alphaPosition, true);
+}
+
+void SDPixelKernelPremultiplyReference(const SDPixelBuffer *buffer, SDPixelAlphaPosition alphaPosition) {
+    SDPixelPremultiply(buffer, alphaPosition, false);
+}
+
+// MARK: - Unpremultiply
+
+void SDPixelKernelUnpremultiply(const SDPixelBuffer *buffer, SDPixelAlphaPosition alphaPosition) {
+    if (!buffer || !buffer->data) {
+        return;
+    }
+    // The integer division has no SIMD instruction, and the reciprocal approximation is not exact, so scalar only
+    size_t ai = alphaPosition == SDPixelAlphaPositionFirst ? 0 : 3;
+    for (size_t y = 0; y < buffer->height; y++) {
+        uint8_t *p = buffer->data + y * buffer->bytesPerRow;
+        for (size_t x = 0; x < buffer->width; x++, p += 4) {
+            uint32_t a = p[ai];
+            if (a == 255) {
+                continue;
+            }
+            for (size_t c = 0; c < 4; c++) {
+                if (c == ai) {
+                    continue;
+                }
+                if (a == 0) {
+                    p[c] = 0;
+                } else {
+                    uint32_t value = ((uint32_t)p[c] * 255 + a / 2) / a;
+                    p[c] = (uint8_t)(value > 255 ? 255 : value);
+                }
+            }
+        }
+    }
+}
+
+// MARK: - Swizzle
+
+static inline void SDPixelSwapRedBlueScalar(uint8_t *p, size_t count, SDPixelAlphaPosition alphaPosition) {
+    size_t r = alphaPosition == SDPixelAlphaPositionFirst ? 1 : 0;
+    size_t b = r + 2;
+    for (size_t i = 0; i < count; i++, p += 4) {
+        uint8_t t = p[r];
+        p[r] = p[b];
+        p[b] = t;
+    }
+}
+
+#if SD_PIXEL_NEON
+// 16 pixels each time
+static inline size_t SDPixelSwapRedBlueNEON(uint8_t *p, size_t count, SDPixelAlphaPosition alphaPosition) {
+    size_t r = alphaPosition == SDPixelAlphaPositionFirst ? 1 : 0;
+    size_t b = r + 2;
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16, p += 64) {
+        uint8x16x4_t px = vld4q_u8(p);
+        uint8x16_t t = px.val[r];
+        px.val[r] = px.val[b];
+        px.val[b] = t;
+        vst4q_u8(p, px);
+    }
+    return i;
+}
+#endif
+
+#if SD_PIXEL_AVX2
+// 8 pixels each time
+static inline size_t SDPixelSwapRedBlueAVX2(uint8_t *p, size_t count, SDPixelAlphaPosition alphaPosition) {
+    const __m256i mask = alphaPosition == SDPixelAlphaPositionFirst ?
+        _mm256_setr_epi8(0, 3, 2, 1, 4, 7, 6, 5, 8, 11, 10, 9, 12, 15, 14, 13, 0, 3, 2, 1, 4, 7, 6, 5, 8, 11, 10, 9, 12, 15, 14, 13) :
+        _mm256_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15, 2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8, p += 32) {
+        __m256i px = _mm256_loadu_si256((const __m256i *)p);
+        _mm256_storeu_si256((__m256i *)p, _mm256_shuffle_epi8(px, mask));
+    }
+    return i;
+}
+#endif
+
+#if SD_PIXEL_SSE2 && !SD_PIXEL_SSSE3
+// 4 pixels each time, without the byte shuffle, move the red and blue bytes with the 32-bit shifts
+static inline size_t SDPixelSwapRedBlueSSE2(uint8_t *p, size_t count, SDPixelAlphaPosition alphaPosition) {
+    // Little endian pixel in 32-bit lane: RGBA is `A B G R`, ARGB is `B G R A` from high to low byte
+    const __m128i keepMask = _mm_set1_epi32(alphaPosition == SDPixelAlphaPositionFirst ? 0x00FF00FF : (int32_t)0xFF00FF00);
+    const __m128i lowMask = _mm_set1_epi32(alphaPosition == SDPixelAlphaPositionFirst ? 0x0000FF00 : 0x000000FF);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4, p += 16) {
+        __m128i px = _mm_loadu_si128((const __m128i *)p);
+        __m128i low = _mm_slli_epi32(_mm_and_si128(px, lowMask), 16);
+        __m128i high = _mm_and_si128(_mm_srli_epi32(px, 16), lowMask);
+        px = _mm_or_si128(_mm_and_si128(px, keepMask), _mm_or_si128(low, high));
+        _mm_storeu_si128((__m128i *)p, px);
+    }
+    return i;
+}
+#endif
+
+#if SD_PIXEL_SSSE3
+// 4 pixels each time
+static inline size_t SDPixelSwapRedBlueSSSE3(uint8_t *p, size_t count, SDPixelAlphaPosition alphaPosition) {
+    const __m128i mask = alphaPosition == SDPixelAlphaPositionFirst ?
+        _mm_setr_epi8(0, 3, 2, 1, 4, 7, 6, 5, 8, 11, 10, 9, 12, 15, 14, 13) :
+        _mm_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4, p += 16) {
+        __m128i px = _mm_loadu_si128((const __m128i *)p);
+        _mm_storeu_si128((__m128i *)p, _mm_shuffle_epi8(px, mask));
+    }
+    return i;
+}
+#endif
+
+static void SDPixelSwapRedBlue(const SDPixelBuffer *buffer, SDPixelAlphaPosition alphaPosition, bool simd) {
+    if (!buffer || !buffer->data) {
+        return;
+    }
+    for (size_t y = 0; y < buffer->height; y++) {
+        uint8_t *row = buffer->data + y * buffer->bytesPerRow;
+        size_t done = 0;
+        if (simd) {
+#if SD_PIXEL_NEON
+            done = SDPixelSwapRedBlueNEON(row, buffer->width, alphaPosition);
+#else
+#if SD_PIXEL_AVX2
+            done = SDPixelSwapRedBlueAVX2(row, buffer->width, alphaPosition);
+#endif
+#if SD_PIXEL_SSSE3
+            done += SDPixelSwapRedBlueSSSE3(row + done * 4, buffer->width - done, alphaPosition);
+#elif SD_PIXEL_SSE2
+            done += SDPixelSwapRedBlueSSE2(row + done * 4, buffer->width - done, alphaPosition);
+#endif
+#endif
+        }
+        SDPixelSwapRedBlueScalar(row + done * 4, buffer->width - done, alphaPosition);
+    }
+}
+
+void SDPixelKernelSwapRedBlue(const SDPixelBuffer *buffer, SDPixelAlphaPosition alphaPosition) {
+    SDPixelSwapRedBlue(buffer, alphaPosition, true);
+}
+
+void SDPixelKernelSwapRedBlueReference(const SDPixelBuffer *buffer, SDPixelAlphaPosition alphaPosition) {
+    SDPixelSwapRedBlue(buffer, alphaPosition, false);
+}
+
+// MARK: - Resize
+
+static inline double SDPixelFilterSupport(SDPixelResizeFilter filter) {
+    switch (filter) {
+        case SDPixelResizeFilterBox:
+            return 0.5;
+        case SDPixelResizeFilterBilinear:
+            return 1.0;
+        case SDPixelResizeFilterLanczos3:
+            return 3.0;
+    }
+    return 1.0;
+}
+
+static inline double SDPixelFilterWeight(SDPixelResizeFilter filter, double x) {
+    switch (filter) {
+        case SDPixelResizeFilterBox:
+            return (x >= -0.5 && x < 0.5) ? 1.0 : 0.0;
+        case SDPixelResizeFilterBilinear:
+            x = fabs(x);
+            return x < 1.0 ? 1.0 - x : 0.0;
+        case SDPixelResizeFilterLanczos3: {
+            if (x == 0) {
+                return 1.0;
+            }
+            if (x <= -3.0 || x >= 3.0) {
+                return 0.0;
+            }
+            double pix = M_PI * x;
+            return 3.0 * sin(pix) * sin(pix / 3.0) / (pix * pix);
+        }
+    }
+    return 0.0;
+}
+
+// The source taps of each destination pixel along one axis
+typedef struct SDPixelContributions {
+    size_t *starts;
+    size_t *counts;
+    float *weights; // `maxCount` weights for each destination pixel
+    size_t maxCount;
+} SDPixelContributions;
+
+static void SDPixelContributionsFree(SDPixelContributions *contributions) {
+    free(contributions->starts);
+    free(contributions->counts);
+    free(contributions->weights);
+}
+
+static bool SDPixelContributionsCreate(SDPixelContributions *contributions, size_t sourceLength, size_t destinationLength, SDPixelResizeFilter filter) {
+    double scale = (double)destinationLength / sourceLength;
+    // Widen the filter when downscaling, to average all the source pixels
+    double filterScale = scale < 1 ? 1 / scale : 1;
+    double support = SDPixelFilterSupport(filter) * filterScale;
+    size_t maxCount = (size_t)ceil(support * 2) + 2;
+    contributions->maxCount = maxCount;
+    contributions->starts = malloc(destinationLength * sizeof(size_t));
+    contributions->counts = malloc(destinationLength * sizeof(size_t));
+    contributions->weights = malloc(destinationLength * maxCount * sizeof(float));
+    if (!contributions->starts || !contributions->counts || !contributions->weights) {
+        SDPixelContributionsFree(contributions);
+        return false;
+    }
+    for (size_t d = 0; d < destinationLength; d++) {
+        double center = (d + 0.5) / scale;
+        double left = floor(center - support);
+        double right = ceil(center + support);
+        size_t start = left < 0 ? 0 : (size_t)left;
+        size_t end = right > sourceLength ? sourceLength : (size_t)right;
+        float *weights = contributions->weights + d * maxCount;
+        // Store the raw weights in place and normalize them after, the total is accumulated in double
+        double total = 0;
+        size_t count = 0;
+        for (size_t s = start; s < end && count < maxCount; s++, count++) {
+            double weight = SDPixelFilterWeight(filter, (s + 0.5 - center) / filterScale);
+            weights[count] = (float)weight;
+            total += weight;
+        }
+        if (total == 0) {
+            // Fallback to the nearest pixel
+            size_t nearest = (size_t)center;
+            start = nearest < sourceLength ? nearest : sourceLength - 1;
+            count = 1;
+            weights[0] = 1;
+        } else {
+            for (size_t i = 0; i < count; i++) {
+                weights[i] = (float)(weights[i] / total);
+            }
+        }
+        contributions->starts[d] = start;
+        contributions->counts[d] = count;
+    }
+    return true;
+}
+
+static inline uint8_t SDPixelClampRound(float value) {
+    if (value <= 0) {
+        return 0;
+    }
+    if (value >= 255) {
+        return 255;
+    }
+    return (uint8_t)(value + 0.5f);
+}
+
+static void SDPixelResizeRowScalar(const uint8_t *source, float *destination, size_t destinationWidth, const SDPixelContributions *contributions) {
+    for (size_t x = 0; x < destinationWidth; x++) {
+        const uint8_t *p = source + contributions->starts[x] * 4;
+        const float *weights = contributions->weights + x * contributions->maxCount;
+        size_t count = contributions->counts[x];
+        float c0 = 0, c1 = 0, c2 = 0, c3 = 0;
+        for (size_t i = 0; i < count; i++, p += 4) {
+            float weight = weights[i];
+            c0 += weight * p[0];
+            c1 += weight * p[1];
+            c2 += weight * p[2];
+            c3 += weight * p[3];
+        }
+        float *d = destination + x * 4;
+        d[0] = c0; d[1] = c1; d[2] = c2; d[3] = c3;
+    }
+}
+
+static void SDPixelResizeColumnScalar(const float *const *rows, uint8_t *destination, size_t width, const float *weights, size_t count) {
+    for (size_t x = 0; x < width * 4; x++) {
+        float value = 0;
+        for (size_t i = 0; i < count; i++) {
+            value += weights[i] * rows[i][x];
+        }
+        destination[x] = SDPixelClampRound(value);
+    }
+}
+
+#if SD_PIXEL_NEON
+static inline float32x4_t SDPixelLoadNEON(const uint8_t *p) {
+    uint32_t value;
+    memcpy(&value, p, 4);
+    uint16x8_t wide = vmovl_u8(vreinterpret_u8_u32(vdup_n_u32(value)));
+    return vcvtq_f32_u32(vmovl_u16(vget_low_u16(wide)));
+}
+
+static inline void SDPixelStoreNEON(uint8_t *p, float32x4_t value) {
+    value = vminq_f32(vmaxq_f32(value, vdupq_n_f32(0)), vdupq_n_f32(255));
+    uint32x4_t integer = vcvtq_u32_f32(vaddq_f32(value, vdupq_n_f32(0.5f)));
+    uint16x4_t narrow = vmovn_u32(integer);
+    uint8x8_t bytes = vmovn_u16(vcombine_u16(narrow, narrow));
+    uint32_t result = vget_lane_u32(vreinterpret_u32_u8(bytes), 0);
+    memcpy(p, &result, 4);
+}
+
+static void SDPixelResizeRowNEON(const uint8_t *source, float *destination, size_t destinationWidth, const SDPixelContributions *contributions) {
+    for (size_t x = 0; x < destinationWidth; x++) {
+        const uint8_t *p = source + contributions->starts[x] * 4;
+        const float *weights = contributions->weights + x * contributions->maxCount;
+        size_t count = contributions->counts[x];
+        float32x4_t sum = vdupq_n_f32(0);
+        for (size_t i = 0; i < count; i++, p += 4) {
+            sum = vmlaq_n_f32(sum, SDPixelLoadNEON(p), weights[i]);
+        }
+        vst1q_f32(destination + x * 4, sum);
+    }
+}
+
+static void SDPixelResizeColumnNEON(const float *const *rows, uint8_t *destination, size_t width, const float *weights, size_t count) {
+    size_t x = 0;
+    // 4 pixels each time
+    for (; x + 4 <= width; x += 4) {
+        float32x4_t sum0 = vdupq_n_f32(0), sum1 = sum0, sum2 = sum0, sum3 = sum0;
+        for (size_t i = 0; i < count; i++) {
+            const float *p = rows[i] + x * 4;
+            float weight = weights[i];
+            sum0 = vmlaq_n_f32(sum0, vld1q_f32(p), weight);
+            sum1 = vmlaq_n_f32(sum1, vld1q_f32(p + 4), weight);
+            sum2 = vmlaq_n_f32(sum2, vld1q_f32(p + 8), weight);
+            sum3 = vmlaq_n_f32(sum3, vld1q_f32(p + 12), weight);
+        }
+        uint8_t *d = destination + x * 4;
+        SDPixelStoreNEON(d, sum0);
+        SDPixelStoreNEON(d + 4, sum1);
+        SDPixelStoreNEON(d + 8, sum2);
+        SDPixelStoreNEON(d + 12, sum3);
+    }
+    for (; x < width; x++) {
+        float32x4_t sum = vdupq_n_f32(0);
+        for (size_t i = 0; i < count; i++) {
+            sum = vmlaq_n_f32(sum, vld1q_f32(rows[i] + x * 4), weights[i]);
+        }
+        SDPixelStoreNEON(destination + x * 4, sum);
+    }
+}
+#elif SD_PIXEL_SSE2
+static inline __m128 SDPixelLoadSSE2(const uint8_t *p) {
+    int32_t value;
+    memcpy(&value, p, 4);
+    const __m128i zero = _mm_setzero_si128();
+    __m128i integer = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(value), zero), zero);
+    return _mm_cvtepi32_ps(integer);
+}
+
+static inline __m128i SDPixelRoundSSE2(__m128 value) {
+    value = _mm_min_ps(_mm_max_ps(value, _mm_setzero_ps()), _mm_set1_ps(255));
+    return _mm_cvttps_epi32(_mm_add_ps(value, _mm_set1_ps(0.5f)));
+}
+
+static inline void SDPixelStore4SSE2(uint8_t *p, __m128 value0, __m128 value1, __m128 value2, __m128 value3) {
+    __m128i lo = _mm_packs_epi32(SDPixelRoundSSE2(value0), SDPixelRoundSSE2(value1));
+    __m128i hi = _mm_packs_epi32(SDPixelRoundSSE2(value2), SDPixelRoundSSE2(value3));
+    _mm_storeu_si128((__m128i *)p, _mm_packus_epi16(lo, hi));
+}
+
+static inline void SDPixelStoreSSE2(uint8_t *p, __m128 value) {
+    __m128i integer = SDPixelRoundSSE2(value);
+    integer = _mm_packs_epi32(integer, integer);
+    integer = _mm_packus_epi16(integer, integer);
+    int32_t result = _mm_cvtsi128_si32(integer);
+    memcpy(p, &result, 4);
+}
+
+static void SDPixelResizeRowSSE2(const uint8_t *source, float *destination, size_t destinationWidth, const SDPixelContributions *contributions) {
+    for (size_t x = 0; x < destinationWidth; x++) {
+        const uint8_t *p = source + contributions->starts[x] * 4;
+        const float *weights = contributions->weights + x * contributions->maxCount;
+        size_t count = contributions->counts[x];
+        __m128 sum = _mm_setzero_ps();
+        for (size_t i = 0; i < count; i++, p += 4) {
+            sum = _mm_add_ps(sum, _mm_mul_ps(SDPixelLoadSSE2(p), _mm_set1_ps(weights[i])));
+        }
+        _mm_storeu_ps(destination + x * 4, sum);
+    }
+}
+
+static void SDPixelResizeColumnSSE2(const float *const *rows, uint8_t *destination, size_t width, const float *weights, size_t count) {
+    size_t x = 0;
+    // 4 pixels each time
+    for (; x + 4 <= width; x += 4) {
+        __m128 sum0 = _mm_setzero_ps(), sum1 = sum0, sum2 = sum0, sum3 = sum0;
+        for (size_t i = 0; i < count; i++) {
+            const float *p = rows[i] + x * 4;
+            __m128 weight = _mm_set1_ps(weights[i]);
+            sum0 = _mm_add_ps(sum0, _mm_mul_ps(_mm_loadu_ps(p), weight));
+            sum1 = _mm_add_ps(sum1, _mm_mul_ps(_mm_loadu_ps(p + 4), weight));
+            sum2 = _mm_add_ps(sum2, _mm_mul_ps(_mm_loadu_ps(p + 8), weight));
+            sum3 = _mm_add_ps(sum3, _mm_mul_ps(_mm_loadu_ps(p + 12), weight));
+        }
+        SDPixelStore4SSE2(destination + x * 4, sum0, sum1, sum2, sum3);
+    }
+    for (; x < width; x++) {
+        __m128 sum = _mm_setzero_ps();
+        for (size_t i = 0; i < count; i++) {
+            sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(rows[i] + x * 4), _mm_set1_ps(weights[i])));
+        }
+        SDPixelStoreSSE2(destination + x * 4, sum);
+    }
+}
+#endif
+
+static void SDPixelResizeRow(const uint8_t *source, float *destination, size_t destinationWidth, const SDPixelContributions *contributions, bool simd) {
+#if SD_PIXEL_NEON
+    if (simd) {
+        SDPixelResizeRowNEON(source, destination, destinationWidth, contributions);
+        return;
+    }
+#elif SD_PIXEL_SSE2
+    if (simd) {
+        SDPixelResizeRowSSE2(source, destination, destinationWidth, contributions);
+        return;
+    }
+#endif
+    SDPixelResizeRowScalar(source, destination, destinationWidth, contributions);
+}
+
+static void SDPixelResizeColumn(const float *const *rows, uint8_t *destination, size_t width, const float *weights, size_t count, bool simd) {
+#if SD_PIXEL_NEON
+    if (simd) {
+        SDPixelResizeColumnNEON(rows, destination, width, weights, count);
+        return;
+    }
+#elif SD_PIXEL_SSE2
+    if (simd) {
+        SDPixelResizeColumnSSE2(rows, destination, width, weights, count);
+        return;
+    }
+#endif
+    SDPixelResizeColumnScalar(rows, destination, width, weights, count);
+}
+
+static bool SDPixelResize(const SDPixelBuffer *source, const SDPixelBuffer *destination, SDPixelResizeFilter filter, bool simd) {
+    if (!source || !destination || !source->data || !destination->data) {
+        return false;
+    }
+    if (source->width == 0 || source->height == 0 || destination->width == 0 || destination->height == 0) {
+        return false;
+    }
+    SDPixelContributions horizontal = {0}, vertical = {0};
+    if (!SDPixelContributionsCreate(&horizontal, source->width, destination->width, filter)) {
+        return false;
+    }
+    if (!SDPixelContributionsCreate(&vertical, source->height, destination->height, filter)) {
+        SDPixelContributionsFree(&horizontal);
+        return false;
+    }
+    // The destination rows read the source rows in order, so only keep the horizontal pass output of the rows still in use, in float to avoid rounding twice
+    size_t ringCount = 1;
+    size_t end = 0;
+    for (size_t y = 0; y < destination->height; y++) {
+        size_t rowEnd = vertical.starts[y] + vertical.counts[y];
+        end = rowEnd > end ? rowEnd : end;
+        size_t used = end - vertical.starts[y];
+        ringCount = used > ringCount ? used : ringCount;
+    }
+    size_t stride = destination->width * 4;
+    float *ring = malloc(ringCount * stride * sizeof(float));
+    const float **rows = malloc(ringCount * sizeof(float *));
+    if (!ring || !rows) {
+        free(ring);
+        free(rows);
+        SDPixelContributionsFree(&horizontal);
+        SDPixelContributionsFree(&vertical);
+        return false;
+    }
+    size_t nextRow = 0;
+    for (size_t y = 0; y < destination->height; y++) {
+        size_t start = vertical.starts[y];
+        size_t count = vertical.counts[y];
+        for (; nextRow < start + count; nextRow++) {
+            const uint8_t *row = source->data + nextRow * source->bytesPerRow;
+            SDPixelResizeRow(row, ring + (nextRow % ringCount) * stride, destination->width, &horizontal, simd);
+        }
+        for (size_t i = 0; i < count; i++) {
+            rows[i] = ring + ((start + i) % ringCount) * stride;
+        }
+        const float *weights = vertical.weights + y * vertical.maxCount;
+        uint8_t *output = destination->data + y * destination->bytesPerRow;
+        SDPixelResizeColumn(rows, output, destination->width, weights, count, simd);
+    }
+    free(ring);
+    free(rows);
+    SDPixelContributionsFree(&horizontal);
+    SDPixelContributionsFree(&vertical);
+    return true;
+}
+
+bool SDPixelKernelResize(const SDPixelBuffer *source, const SDPixelBuffer *destination, SDPixelResizeFilter filter) {
+    return SDPixelResize(source, destination, filter, true);
+}
+
+bool SDPixelKernelResizeReference(const SDPixelBuffer *source, const SDPixelBuffer *destination, SDPixelResizeFilter filter) {
+    return SDPixelResize(source, destination, filter, false);
+}
@@ -0,0 +1 @@
+../../Core/SDImageCacheValidator.h
\ No newline at end of file
@@ -0,0 +1 @@
+../../Core/SDImageDecodeExecutor.h
\ No newline at end of file
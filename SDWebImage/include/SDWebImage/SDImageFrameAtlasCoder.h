@@ -0,0 +1 @@
+../../Core/SDImageFrameAtlasCoder.h
\ No newline at end of file
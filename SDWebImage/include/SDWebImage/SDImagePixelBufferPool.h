@@ -0,0 +1 @@
+../../Core/SDImagePixelBufferPool.h
\ No newline at end of file
@@ -0,0 +1 @@
+../../Core/SDWebImageBatchLoader.h
\ No newline at end of file
@@ -0,0 +1 @@
+../../Core/SDWebImageDownloaderHedgePolicy.h
\ No newline at end of file
@@ -0,0 +1 @@
+../../Core/SDWebImageDownloaderStatistics.h
\ No newline at end of file
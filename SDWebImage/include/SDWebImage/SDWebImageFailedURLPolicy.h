@@ -0,0 +1 @@
+../../Core/SDWebImageFailedURLPolicy.h
\ No newline at end of file
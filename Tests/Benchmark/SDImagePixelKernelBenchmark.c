@@ -0,0 +1,230 @@
+/*
+ * This file is part of the SDWebImage package.
+ * (c) Olivier Poitrey <rs@dailymotion.com>
+ *
+ * For the full copyright and license information, please view the LICENSE
+ * file that was distributed with this source code.
+ */
+
+// The standalone golden test and benchmark of the pixel kernels, without any Apple frameworks, so it runs on Linux as well.
+// Build and run from the repository root:
+//
+//   cc -O2 -I SDWebImage/Private -I Tests/Tests Tests/Benchmark/SDImagePixelKernelBenchmark.c -x c SDWebImage/Private/SDImagePixelKernel.m -lm -o SDImagePixelKernelBenchmark
+//   ./SDImagePixelKernelBenchmark
+//
+// Add `-mavx2` (x86_64) to build the AVX2 path. Pass `--generate` to print the golden values for `SDImagePixelKernelGolden.h`.
+// The exit status is non-zero if any kernel does not match the golden values, or the SIMD path does not match the scalar reference.
+
+#include "SDImagePixelKernel.h"
+#include "SDImagePixelKernelGolden.h"
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+typedef void (*SDPixelKernelInPlace)(const SDPixelBuffer *buffer, SDPixelAlphaPosition alphaPosition);
+typedef bool (*SDPixelKernelResizing)(const SDPixelBuffer *source, const SDPixelBuffer *destination, SDPixelResizeFilter filter);
+
+static const char *SDPixelFilterNames[3] = {"Box", "Bilinear", "Lanczos3"};
+static int failures = 0;
+
+static double SDBenchmarkNow(void) {
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return time.tv_sec + time.tv_nsec / 1e9;
+}
+
+static uint8_t *SDPatternCreate(size_t width, size_t height) {
+    uint8_t *data = malloc(width * height * 4);
+    if (data) {
+        SDPixelKernelGoldenFill(data, width, height, width * 4);
+    }
+    return data;
+}
+
+static int SDMaxDifference(const uint8_t *a, const uint8_t *b, size_t length) {
+    int maxDiff = 0;
+    for (size_t i = 0; i < length; i++) {
+        int diff = abs((int)a[i] - (int)b[i]);
+        maxDiff = diff > maxDiff ? diff : maxDiff;
+    }
+    return maxDiff;
+}
+
+static void SDCheck(bool condition, const char *name) {
+    printf("%-48s %s\n", name, condition ? "ok" : "FAILED");
+    if (!condition) {
+        failures++;
+    }
+}
+
+// MARK: - Golden
+
+static uint64_t SDInPlaceHash(SDPixelKernelInPlace kernel, SDPixelAlphaPosition alphaPosition, bool unpremultiply) {
+    size_t width = SDPixelKernelGoldenHashWidth, height = SDPixelKernelGoldenHashHeight;
+    uint8_t *data = SDPatternCreate(width, height);
+    SDPixelBuffer buffer = {data, width, height, width * 4};
+    kernel(&buffer, alphaPosition);
+    if (unpremultiply) {
+        SDPixelKernelUnpremultiply(&buffer, alphaPosition);
+    }
+    uint64_t hash = SDPixelKernelGoldenHash(data, width * height * 4);
+    free(data);
+    return hash;
+}
+
+static void SDResizeGolden(SDPixelKernelResizing kernel, size_t sourceWidth, size_t sourceHeight, size_t width, size_t height, SDPixelResizeFilter filter, uint8_t *output) {
+    uint8_t *source = SDPatternCreate(sourceWidth, sourceHeight);
+    SDPixelBuffer input = {source, sourceWidth, sourceHeight, sourceWidth * 4};
+    SDPixelBuffer destination = {output, width, height, width * 4};
+    if (!kernel(&input, &destination, filter)) {
+        memset(output, 0, width * height * 4);
+    }
+    free(source);
+}
+
+static void SDPrintBytes(const uint8_t *bytes, size_t length) {
+    printf("    {");
+    for (size_t i = 0; i < length; i++) {
+        printf("%s%u", i == 0 ? "" : ", ", bytes[i]);
+    }
+    printf("},\n");
+}
+
+static void SDGenerateGolden(void) {
+    printf("static const uint64_t SDPixelKernelGoldenPremultiplyLastHash = 0x%016" PRIx64 "ULL;\n", SDInPlaceHash(SDPixelKernelPremultiplyReference, SDPixelAlphaPositionLast, false));
+    printf("static const uint64_t SDPixelKernelGoldenPremultiplyFirstHash = 0x%016" PRIx64 "ULL;\n", SDInPlaceHash(SDPixelKernelPremultiplyReference, SDPixelAlphaPositionFirst, false));
+    printf("static const uint64_t SDPixelKernelGoldenUnpremultiplyLastHash = 0x%016" PRIx64 "ULL;\n", SDInPlaceHash(SDPixelKernelPremultiplyReference, SDPixelAlphaPositionLast, true));
+    printf("static const uint64_t SDPixelKernelGoldenSwapRedBlueLastHash = 0x%016" PRIx64 "ULL;\n", SDInPlaceHash(SDPixelKernelSwapRedBlueReference, SDPixelAlphaPositionLast, false));
+    printf("static const uint64_t SDPixelKernelGoldenSwapRedBlueFirstHash = 0x%016" PRIx64 "ULL;\n", SDInPlaceHash(SDPixelKernelSwapRedBlueReference, SDPixelAlphaPositionFirst, false));
+    uint8_t downscale[SDPixelKernelGoldenDownscaleWidth * SDPixelKernelGoldenDownscaleHeight * 4];
+    printf("static const uint8_t SDPixelKernelGoldenDownscale[3][%zu] = {\n", sizeof(downscale));
+    for (int filter = SDPixelResizeFilterBox; filter <= SDPixelResizeFilterLanczos3; filter++) {
+        SDResizeGolden(SDPixelKernelResizeReference, SDPixelKernelGoldenDownscaleSourceWidth, SDPixelKernelGoldenDownscaleSourceHeight, SDPixelKernelGoldenDownscaleWidth, SDPixelKernelGoldenDownscaleHeight, filter, downscale);
+        SDPrintBytes(downscale, sizeof(downscale));
+    }
+    printf("};\n");
+    uint8_t upscale[SDPixelKernelGoldenUpscaleWidth * SDPixelKernelGoldenUpscaleHeight * 4];
+    printf("static const uint8_t SDPixelKernelGoldenUpscale[3][%zu] = {\n", sizeof(upscale));
+    for (int filter = SDPixelResizeFilterBox; filter <= SDPixelResizeFilterLanczos3; filter++) {
+        SDResizeGolden(SDPixelKernelResizeReference, SDPixelKernelGoldenUpscaleSourceWidth, SDPixelKernelGoldenUpscaleSourceHeight, SDPixelKernelGoldenUpscaleWidth, SDPixelKernelGoldenUpscaleHeight, filter, upscale);
+        SDPrintBytes(upscale, sizeof(upscale));
+    }
+    printf("};\n");
+}
+
+static void SDVerifyGolden(void) {
+    // Both the SIMD and the reference path should match the golden values
+    SDPixelKernelInPlace premultiply[2] = {SDPixelKernelPremultiply, SDPixelKernelPremultiplyReference};
+    SDPixelKernelInPlace swap[2] = {SDPixelKernelSwapRedBlue, SDPixelKernelSwapRedBlueReference};
+    SDPixelKernelResizing resize[2] = {SDPixelKernelResize, SDPixelKernelResizeReference};
+    const char *paths[2] = {SDPixelKernelSIMDName(), "Reference"};
+    char name[64];
+    for (int i = 0; i < 2; i++) {
+        snprintf(name, sizeof(name), "Premultiply last (%s)", paths[i]);
+        SDCheck(SDInPlaceHash(premultiply[i], SDPixelAlphaPositionLast, false) == SDPixelKernelGoldenPremultiplyLastHash, name);
+        snprintf(name, sizeof(name), "Premultiply first (%s)", paths[i]);
+        SDCheck(SDInPlaceHash(premultiply[i], SDPixelAlphaPositionFirst, false) == SDPixelKernelGoldenPremultiplyFirstHash, name);
+        snprintf(name, sizeof(name), "Unpremultiply last (%s)", paths[i]);
+        SDCheck(SDInPlaceHash(premultiply[i], SDPixelAlphaPositionLast, true) == SDPixelKernelGoldenUnpremultiplyLastHash, name);
+        snprintf(name, sizeof(name), "Swap red blue last (%s)", paths[i]);
+        SDCheck(SDInPlaceHash(swap[i], SDPixelAlphaPositionLast, false) == SDPixelKernelGoldenSwapRedBlueLastHash, name);
+        snprintf(name, sizeof(name), "Swap red blue first (%s)", paths[i]);
+        SDCheck(SDInPlaceHash(swap[i], SDPixelAlphaPositionFirst, false) == SDPixelKernelGoldenSwapRedBlueFirstHash, name);
+        for (int filter = SDPixelResizeFilterBox; filter <= SDPixelResizeFilterLanczos3; filter++) {
+            uint8_t downscale[sizeof(SDPixelKernelGoldenDownscale[0])];
+            SDResizeGolden(resize[i], SDPixelKernelGoldenDownscaleSourceWidth, SDPixelKernelGoldenDownscaleSourceHeight, SDPixelKernelGoldenDownscaleWidth, SDPixelKernelGoldenDownscaleHeight, filter, downscale);
+            snprintf(name, sizeof(name), "Downscale %s (%s)", SDPixelFilterNames[filter], paths[i]);
+            SDCheck(SDMaxDifference(downscale, SDPixelKernelGoldenDownscale[filter], sizeof(downscale)) <= 1, name);
+            uint8_t upscale[sizeof(SDPixelKernelGoldenUpscale[0])];
+            SDResizeGolden(resize[i], SDPixelKernelGoldenUpscaleSourceWidth, SDPixelKernelGoldenUpscaleSourceHeight, SDPixelKernelGoldenUpscaleWidth, SDPixelKernelGoldenUpscaleHeight, filter, upscale);
+            snprintf(name, sizeof(name), "Upscale %s (%s)", SDPixelFilterNames[filter], paths[i]);
+            SDCheck(SDMaxDifference(upscale, SDPixelKernelGoldenUpscale[filter], sizeof(upscale)) <= 1, name);
+        }
+    }
+}
+
+// MARK: - Benchmark
+
+// 12MP, scale down to 3MP
+#define SDBenchmarkWidth 4000
+#define SDBenchmarkHeight 3000
+#define SDBenchmarkIterations 3
+
+static double SDBenchmarkInPlace(SDPixelKernelInPlace kernel, uint8_t *data) {
+    SDPixelBuffer buffer = {data, SDBenchmarkWidth, SDBenchmarkHeight, SDBenchmarkWidth * 4};
+    double best = 0;
+    for (int i = 0; i < SDBenchmarkIterations; i++) {
+        SDPixelKernelGoldenFill(data, SDBenchmarkWidth, SDBenchmarkHeight, SDBenchmarkWidth * 4);
+        double start = SDBenchmarkNow();
+        kernel(&buffer, SDPixelAlphaPositionLast);
+        double time = SDBenchmarkNow() - start;
+        best = (i == 0 || time < best) ? time : best;
+    }
+    return best;
+}
+
+static double SDBenchmarkResize(SDPixelKernelResizing kernel, const uint8_t *source, uint8_t *output, SDPixelResizeFilter filter) {
+    SDPixelBuffer input = {(uint8_t *)source, SDBenchmarkWidth, SDBenchmarkHeight, SDBenchmarkWidth * 4};
+    SDPixelBuffer destination = {output, SDBenchmarkWidth / 2, SDBenchmarkHeight / 2, SDBenchmarkWidth / 2 * 4};
+    double best = 0;
+    for (int i = 0; i < SDBenchmarkIterations; i++) {
+        double start = SDBenchmarkNow();
+        kernel(&input, &destination, filter);
+        double time = SDBenchmarkNow() - start;
+        best = (i == 0 || time < best) ? time : best;
+    }
+    return best;
+}
+
+static void SDRunBenchmark(void) {
+    size_t length = (size_t)SDBenchmarkWidth * SDBenchmarkHeight * 4;
+    size_t outputLength = length / 4;
+    uint8_t *source = malloc(length);
+    uint8_t *simdData = malloc(length);
+    uint8_t *referenceData = malloc(length);
+    uint8_t *simdOutput = malloc(outputLength);
+    uint8_t *referenceOutput = malloc(outputLength);
+    if (!source || !simdData || !referenceData || !simdOutput || !referenceOutput) {
+        fprintf(stderr, "Out of memory\n");
+        failures++;
+        goto done;
+    }
+    printf("\n%dx%d, best of %d, %s vs Reference\n", SDBenchmarkWidth, SDBenchmarkHeight, SDBenchmarkIterations, SDPixelKernelSIMDName());
+    double simdTime = SDBenchmarkInPlace(SDPixelKernelPremultiply, simdData);
+    double referenceTime = SDBenchmarkInPlace(SDPixelKernelPremultiplyReference, referenceData);
+    printf("%-24s %8.2f ms %8.2f ms %6.2fx\n", "Premultiply", simdTime * 1000, referenceTime * 1000, referenceTime / simdTime);
+    SDCheck(memcmp(simdData, referenceData, length) == 0, "Premultiply SIMD equals reference");
+    simdTime = SDBenchmarkInPlace(SDPixelKernelSwapRedBlue, simdData);
+    referenceTime = SDBenchmarkInPlace(SDPixelKernelSwapRedBlueReference, referenceData);
+    printf("%-24s %8.2f ms %8.2f ms %6.2fx\n", "Swap red blue", simdTime * 1000, referenceTime * 1000, referenceTime / simdTime);
+    SDCheck(memcmp(simdData, referenceData, length) == 0, "Swap red blue SIMD equals reference");
+    SDPixelKernelGoldenFill(source, SDBenchmarkWidth, SDBenchmarkHeight, SDBenchmarkWidth * 4);
+    for (int filter = SDPixelResizeFilterBox; filter <= SDPixelResizeFilterLanczos3; filter++) {
+        simdTime = SDBenchmarkResize(SDPixelKernelResize, source, simdOutput, filter);
+        referenceTime = SDBenchmarkResize(SDPixelKernelResizeReference, source, referenceOutput, filter);
+        char name[64];
+        snprintf(name, sizeof(name), "Resize %s", SDPixelFilterNames[filter]);
+        printf("%-24s %8.2f ms %8.2f ms %6.2fx\n", name, simdTime * 1000, referenceTime * 1000, referenceTime / simdTime);
+        snprintf(name, sizeof(name), "Resize %s SIMD equals reference", SDPixelFilterNames[filter]);
+        SDCheck(SDMaxDifference(simdOutput, referenceOutput, outputLength) <= 1, name);
+    }
+done:
+    free(source);
+    free(simdData);
+    free(referenceData);
+    free(simdOutput);
+    free(referenceOutput);
+}
+
+int main(int argc, const char *argv[]) {
+    if (argc > 1 && strcmp(argv[1], "--generate") == 0) {
+        SDGenerateGolden();
+        return 0;
+    }
+    SDVerifyGolden();
+    SDRunBenchmark();
+    printf("\n%s\n", failures == 0 ? "All passed" : "FAILED");
+    return failures == 0 ? 0 : 1;
+}
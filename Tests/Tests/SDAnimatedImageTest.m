@@ -10,6 +10,8 @@
 #import "SDTestCase.h"
 #import "SDInternalMacros.h"
 #import "SDImageFramePool.h"
+#import "SDAnimatedImageScheduler.h"
+#import "SDDisplayLinkHub.h"
 #import "SDWebImageTestTransformer.h"
 #import <KVOController/KVOController.h>
 
@@ -50,6 +52,15 @@ static BOOL _isCalled;
 
 @end
 
+// Check the frame pool is not shared with different provider class
+@interface SDAnimatedImageTestSubclass : SDAnimatedImage
+
+@end
+
+@implementation SDAnimatedImageTestSubclass
+
+@end
+
 // Internal header
 @interface SDAnimatedImageView ()
 
@@ -61,6 +72,19 @@ static BOOL _isCalled;
 @interface SDAnimatedImagePlayer ()
 
 @property (nonatomic, strong) SDImageFramePool *framePool;
+@property (nonatomic, assign) NSUInteger currentFrameBytes;
+@property (nonatomic, assign) NSUInteger maxBufferCount;
+@property (nonatomic, assign) NSOperationQueuePriority queuePriority;
+
+- (void)calculateMaxBufferCountWithFrame:(nonnull UIImage *)frame;
+
+@end
+
+@interface SDImageFramePool ()
+
+@property (nonatomic, strong) NSMutableIndexSet *fetchingIndexes;
+
+- (void)handoffFrame:(UIImage *)frame atIndex:(NSUInteger)index generation:(NSUInteger)generation decodeDuration:(NSTimeInterval)decodeDuration;
 
 @end
 
@@ -816,6 +840,413 @@ static BOOL _isCalled;
     expect(scaledImage).notTo.equal(image);
 }
 
+- (void)test38AnimatedImagePlayerSharedBufferBudget {
+    NSUInteger sharedMaxBufferSize = SDAnimatedImagePlayer.sharedMaxBufferSize;
+    SDAnimatedImage *image1 = [SDAnimatedImage imageWithData:[self testGIFData]];
+    SDAnimatedImage *image2 = [SDAnimatedImage imageWithData:[self testAPNGPData]];
+    SDAnimatedImagePlayer *player1 = [SDAnimatedImagePlayer playerWithProvider:image1];
+    SDAnimatedImagePlayer *player2 = [SDAnimatedImagePlayer playerWithProvider:image2];
+    [player1 startPlaying];
+    [player2 startPlaying];
+    expect(player1.currentFrameBytes).beGreaterThan(0);
+    expect(player2.currentFrameBytes).beGreaterThan(0);
+    // Visible players share the budget with the same buffer count
+    SDAnimatedImagePlayer.sharedMaxBufferSize = (player1.currentFrameBytes + player2.currentFrameBytes) * 10;
+    [player1 calculateMaxBufferCountWithFrame:image1];
+    [player2 calculateMaxBufferCountWithFrame:image2];
+    NSUInteger maxBufferCount = player1.maxBufferCount;
+    expect(maxBufferCount).beGreaterThanOrEqualTo(1);
+    expect(maxBufferCount).beLessThanOrEqualTo(10);
+    expect(player2.maxBufferCount).equal(maxBufferCount);
+    
+    // Invisible player keep only one frame, and release the budget to others
+    player2.visible = NO;
+    [player1 calculateMaxBufferCountWithFrame:image1];
+    [player2 calculateMaxBufferCountWithFrame:image2];
+    expect(player2.maxBufferCount).equal(1);
+    expect(player2.queuePriority).equal(NSOperationQueuePriorityVeryLow);
+    expect(player1.maxBufferCount).beGreaterThanOrEqualTo(maxBufferCount);
+    expect(player1.queuePriority).beGreaterThanOrEqualTo(NSOperationQueuePriorityNormal);
+    
+    // Explicit max buffer size does not use the shared budget
+    player2.maxBufferSize = player2.currentFrameBytes * 3;
+    [player2 calculateMaxBufferCountWithFrame:image2];
+    expect(player2.maxBufferCount).equal(3);
+    
+    [player1 stopPlaying];
+    [player2 stopPlaying];
+    SDAnimatedImagePlayer.sharedMaxBufferSize = sharedMaxBufferSize;
+}
+
+- (void)test39ImageFramePoolEvictFarthestFrameInPlaybackOrder {
+    SDAnimatedImage *image = [SDAnimatedImage imageWithData:[self testAPNGPData]];
+    SDImageFramePool *framePool = [SDImageFramePool registerProvider:image];
+    framePool.totalFrameCount = 10;
+    framePool.maxBufferCount = 4;
+    NSIndexSet *(^fillAndPrefetch)(NSUInteger) = ^NSIndexSet *(NSUInteger anchorIndex) {
+        for (NSUInteger i = 0; i < 10; i++) {
+            [framePool setFrame:image atIndex:i];
+        }
+        [framePool prefetchFrameAtIndex:anchorIndex];
+        // The frames are evicted on the decode queue
+        [SDAnimatedImageScheduler.sharedScheduler.decodeQueue waitUntilAllOperationsAreFinished];
+        NSMutableIndexSet *indexes = [NSMutableIndexSet indexSet];
+        for (NSUInteger i = 0; i < 10; i++) {
+            if ([framePool frameAtIndex:i]) {
+                [indexes addIndex:i];
+            }
+        }
+        return indexes;
+    };
+    // Normal, wrap around
+    NSMutableIndexSet *normalIndexes = [NSMutableIndexSet indexSetWithIndexesInRange:NSMakeRange(8, 2)];
+    [normalIndexes addIndexesInRange:NSMakeRange(0, 2)];
+    expect(fillAndPrefetch(8)).equal(normalIndexes);
+    expect(framePool.currentFrameCount).equal(4);
+    // Reverse
+    framePool.reversed = YES;
+    expect(fillAndPrefetch(5)).equal([NSIndexSet indexSetWithIndexesInRange:NSMakeRange(2, 4)]);
+    // Bounce, turn back at the last frame
+    framePool.bounce = YES;
+    framePool.reversed = NO;
+    expect(fillAndPrefetch(8)).equal([NSIndexSet indexSetWithIndexesInRange:NSMakeRange(6, 4)]);
+    [framePool removeAllFrames];
+    [SDImageFramePool unregisterProvider:image];
+}
+
+- (void)test40ImageFramePoolLookaheadPrefetch {
+    XCTestExpectation *expectation = [self expectationWithDescription:@"test SDImageFramePool lookahead prefetch"];
+    SDAnimatedImage *image = [SDAnimatedImage imageWithData:[self testAPNGPData]];
+    SDImageFramePool *framePool = [SDImageFramePool registerProvider:image];
+    framePool.totalFrameCount = image.animatedImageFrameCount;
+    framePool.maxBufferCount = 10;
+    framePool.maxConcurrentCount = 4;
+    // Reverse order wrap around from the first frame
+    framePool.reversed = YES;
+    [framePool prefetchFrameAtIndex:1 lookaheadCount:4];
+    
+    SDAnimatedImageView *imageView = [SDAnimatedImageView new];
+    imageView.allowsFrameSkipping = YES;
+    imageView.image = image;
+    expect(imageView.player.allowsFrameSkipping).beTruthy();
+    
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(0.5 * NSEC_PER_SEC)), dispatch_get_main_queue(), ^{
+        NSUInteger lastIndex = image.animatedImageFrameCount - 1;
+        expect([framePool frameAtIndex:1]).notTo.beNil();
+        expect([framePool frameAtIndex:0]).notTo.beNil();
+        expect([framePool frameAtIndex:lastIndex]).notTo.beNil();
+        expect([framePool frameAtIndex:lastIndex - 1]).notTo.beNil();
+        expect(framePool.currentFrameCount).equal(4);
+        expect(framePool.averageDecodeDuration).beGreaterThan(0);
+        [SDImageFramePool unregisterProvider:image];
+        [expectation fulfill];
+    });
+    
+    [self waitForExpectationsWithCommonTimeout];
+}
+
+- (void)test42AnimatedImagePlayerSharedDisplayLink {
+    XCTestExpectation *expectation = [self expectationWithDescription:@"test SDAnimatedImagePlayer shared display link"];
+    SDAnimatedImage *image = [SDAnimatedImage imageWithData:[self testAPNGPData]];
+    SDAnimatedImagePlayer *player1 = [SDAnimatedImagePlayer playerWithProvider:image];
+    SDAnimatedImagePlayer *player2 = [SDAnimatedImagePlayer playerWithProvider:image];
+    SDAnimatedImagePlayer *player3 = [SDAnimatedImagePlayer playerWithProvider:image];
+    player1.runLoopMode = NSRunLoopCommonModes;
+    player2.runLoopMode = NSRunLoopCommonModes;
+    player3.runLoopMode = NSRunLoopCommonModes;
+    SDDisplayLinkHub *hub = [SDDisplayLinkHub hubForRunLoopMode:NSRunLoopCommonModes];
+    [player1 startPlaying];
+    [player2 startPlaying];
+    [player3 startPlaying];
+    expect([hub containsTarget:(id<SDDisplayLinkHubTarget>)player1]).beTruthy();
+    expect([hub containsTarget:(id<SDDisplayLinkHubTarget>)player2]).beTruthy();
+    expect([hub containsTarget:(id<SDDisplayLinkHubTarget>)player3]).beTruthy();
+    expect(hub.isRunning).beTruthy();
+    // Invisible and paused player is unregistered, but the playing status is kept
+    player2.visible = NO;
+    [player3 pausePlaying];
+    expect([hub containsTarget:(id<SDDisplayLinkHubTarget>)player2]).beFalsy();
+    expect([hub containsTarget:(id<SDDisplayLinkHubTarget>)player3]).beFalsy();
+    expect(player2.isPlaying).beTruthy();
+    expect(player3.isPlaying).beFalsy();
+    __block NSUInteger frameChangeCount1 = 0;
+    __block NSUInteger frameChangeCount2 = 0;
+    player1.animationFrameHandler = ^(NSUInteger index, UIImage * _Nonnull frame) {
+        frameChangeCount1++;
+    };
+    player2.animationFrameHandler = ^(NSUInteger index, UIImage * _Nonnull frame) {
+        frameChangeCount2++;
+    };
+    
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(1 * NSEC_PER_SEC)), dispatch_get_main_queue(), ^{
+        expect(frameChangeCount1).beGreaterThan(0);
+        expect(frameChangeCount2).equal(0);
+        // Visible again, resume in the shared display link
+        player2.visible = YES;
+        expect([hub containsTarget:(id<SDDisplayLinkHubTarget>)player2]).beTruthy();
+        [player1 stopPlaying];
+        [player2 stopPlaying];
+        expect([hub containsTarget:(id<SDDisplayLinkHubTarget>)player1]).beFalsy();
+        expect([hub containsTarget:(id<SDDisplayLinkHubTarget>)player2]).beFalsy();
+        [expectation fulfill];
+    });
+    
+    [self waitForExpectationsWithCommonTimeout];
+}
+
+- (void)test43AnimatedImageViewStreamingPlayback {
+    XCTestExpectation *expectation = [self expectationWithDescription:@"test SDAnimatedImageView streaming playback"];
+    NSData *fullData = [self testAPNGPData];
+    SDImageAPNGCoder *coder = [[SDImageAPNGCoder alloc] initIncrementalWithOptions:nil];
+    [coder updateIncrementalData:[fullData subdataWithRange:NSMakeRange(0, fullData.length / 2)] finished:NO];
+    NSUInteger partialFrameCount = coder.animatedImageFrameCount;
+    expect(partialFrameCount).beGreaterThan(1);
+    
+    SDAnimatedImageView *imageView = [SDAnimatedImageView new];
+    imageView.shouldLoopIncrementalFrames = YES;
+    // The streaming continuation should not stop and reset the player
+    imageView.resetFrameIndexWhenStopped = YES;
+    imageView.clearBufferWhenStopped = YES;
+#if SD_UIKIT
+    [self.window addSubview:imageView];
+#else
+    [self.window.contentView addSubview:imageView];
+#endif
+    SDAnimatedImage *partialImage = [[SDAnimatedImage alloc] initWithAnimatedCoder:coder scale:1];
+    partialImage.sd_isIncremental = YES;
+    imageView.image = partialImage;
+    expect(imageView.isProgressive).beTruthy();
+    SDAnimatedImagePlayer *player = imageView.player;
+    expect(player.totalLoopCount).equal(0);
+    
+    __block BOOL looped = NO;
+    __block NSUInteger previousFrameIndex = 0;
+    [self.KVOController observe:imageView keyPath:NSStringFromSelector(@selector(currentFrameIndex)) options:NSKeyValueObservingOptionNew block:^(id  _Nullable observer, id  _Nonnull object, NSDictionary<NSString *,id> * _Nonnull change) {
+        NSUInteger currentFrameIndex = [change[NSKeyValueChangeNewKey] unsignedIntegerValue];
+        if (currentFrameIndex < previousFrameIndex) {
+            looped = YES;
+        }
+        previousFrameIndex = currentFrameIndex;
+    }];
+    
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(2 * NSEC_PER_SEC)), dispatch_get_main_queue(), ^{
+        // Loop the received frames, without counting the loop
+        expect(looped).beTruthy();
+        expect(player.isPlaying).beTruthy();
+        expect(imageView.currentLoopCount).equal(0);
+        [self.KVOController unobserve:imageView];
+        
+        // The complete image from the same coder continue the current player
+        [player seekToFrameAtIndex:1 loopCount:0];
+        [coder updateIncrementalData:fullData finished:YES];
+        SDAnimatedImage *fullImage = [[SDAnimatedImage alloc] initWithAnimatedCoder:coder scale:1];
+        imageView.image = fullImage;
+        expect(imageView.isProgressive).beFalsy();
+        expect(imageView.player).beIdenticalTo(player);
+        expect(player.isPlaying).beTruthy();
+        expect(player.currentFrameIndex).equal(1);
+        expect(player.totalFrameCount).equal(coder.animatedImageFrameCount);
+        expect(player.totalFrameCount).beGreaterThan(partialFrameCount);
+        expect(player.totalLoopCount).equal(coder.animatedImageLoopCount);
+        expect(player.currentLoopCount).equal(0);
+        [imageView removeFromSuperview];
+        [expectation fulfill];
+    });
+    
+    [self waitForExpectationsWithCommonTimeout];
+}
+
+- (void)test44AnimatedImageDecodeAtViewSize {
+    SDAnimatedImage *image = [SDAnimatedImage imageWithData:[self testAPNGPData]];
+    UIImage *fullFrame = [image animatedImageFrameAtIndex:1];
+    size_t fullPixelWidth = CGImageGetWidth(fullFrame.CGImage);
+    size_t fullPixelHeight = CGImageGetHeight(fullFrame.CGImage);
+    // Decode at target pixel size, keep the point size
+    CGSize targetPixelSize = CGSizeMake(fullPixelWidth / 4, fullPixelHeight / 4);
+    UIImage *smallFrame = [image animatedImageFrameAtIndex:1 targetPixelSize:targetPixelSize];
+    expect(CGImageGetWidth(smallFrame.CGImage)).beLessThanOrEqualTo(targetPixelSize.width);
+    expect(CGImageGetHeight(smallFrame.CGImage)).beLessThanOrEqualTo(targetPixelSize.height);
+    expect(smallFrame.size.width).beCloseToWithin(fullFrame.size.width, 0.01);
+    // Larger than full size use the full frame
+    UIImage *largeFrame = [image animatedImageFrameAtIndex:1 targetPixelSize:CGSizeMake(fullPixelWidth * 2, fullPixelHeight * 2)];
+    expect(CGImageGetWidth(largeFrame.CGImage)).equal(fullPixelWidth);
+    // The thumbnail image keep the point size of its thumbnail frame, instead of the full frame
+    SDAnimatedImage *thumbnailImage = [[SDAnimatedImage alloc] initWithData:[self testAPNGPData] scale:1 options:@{SDImageCoderDecodeThumbnailPixelSize : @(CGSizeMake(fullPixelWidth / 2, fullPixelHeight / 2))}];
+    UIImage *thumbnailFrame = [thumbnailImage animatedImageFrameAtIndex:1];
+    UIImage *smallThumbnailFrame = [thumbnailImage animatedImageFrameAtIndex:1 targetPixelSize:targetPixelSize];
+    expect(CGImageGetWidth(smallThumbnailFrame.CGImage)).beLessThan(CGImageGetWidth(thumbnailFrame.CGImage));
+    expect(smallThumbnailFrame.size.width).beCloseToWithin(thumbnailFrame.size.width, 0.01);
+    
+    // The frame pool rebuild the buffer only when the size changes significantly
+    SDAnimatedImagePlayer *player = [SDAnimatedImagePlayer playerWithProvider:image];
+    [player.framePool setFrame:fullFrame atIndex:1];
+    player.targetPixelSize = targetPixelSize;
+    expect(player.framePool.targetPixelSize).equal(targetPixelSize);
+    expect(player.framePool.currentFrameCount).equal(0);
+    [player.framePool setFrame:smallFrame atIndex:1];
+    player.targetPixelSize = CGSizeMake(targetPixelSize.width * 0.8, targetPixelSize.height * 0.8);
+    expect(player.framePool.targetPixelSize).equal(targetPixelSize);
+    expect(player.framePool.currentFrameCount).equal(1);
+    player.targetPixelSize = CGSizeMake(targetPixelSize.width * 2, targetPixelSize.height * 2);
+    expect(player.framePool.currentFrameCount).equal(0);
+    player.targetPixelSize = CGSizeZero;
+    expect(player.framePool.targetPixelSize).equal(CGSizeZero);
+    
+    // The view update the target pixel size from bounds
+    SDAnimatedImageView *imageView = [[SDAnimatedImageView alloc] initWithFrame:CGRectMake(0, 0, 10, 10)];
+    imageView.shouldDecodeAtViewSize = YES;
+    imageView.image = image;
+    CGSize viewPixelSize = imageView.player.targetPixelSize;
+    expect(viewPixelSize.width).beGreaterThan(0);
+    expect(viewPixelSize.width).beLessThan(fullPixelWidth);
+    imageView.shouldDecodeAtViewSize = NO;
+    expect(imageView.player.targetPixelSize).equal(CGSizeZero);
+}
+
+- (void)test45ImageFramePoolFrameHandoffStress {
+    SDAnimatedImage *image = [SDAnimatedImage imageWithData:[self testAPNGPData]];
+    SDImageFramePool *framePool = [SDImageFramePool registerProvider:image];
+    // More than the handoff ring capacity, the producers also hit the slow path
+    NSUInteger frameCount = 2000;
+    framePool.totalFrameCount = frameCount;
+    framePool.maxBufferCount = 0;
+    dispatch_group_t group = dispatch_group_create();
+    dispatch_group_async(group, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+        dispatch_apply(frameCount, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t i) {
+            [framePool handoffFrame:image atIndex:i generation:0 decodeDuration:0.001];
+        });
+    });
+    // The display side keep reading during handoff
+    BOOL consistent = YES;
+    while (dispatch_group_wait(group, DISPATCH_TIME_NOW) != 0) {
+        NSUInteger currentFrameCount = framePool.currentFrameCount;
+        UIImage *frame = [framePool frameAtIndex:currentFrameCount % frameCount];
+        if (currentFrameCount > frameCount || (frame && frame != image)) {
+            consistent = NO;
+        }
+    }
+    expect(consistent).beTruthy();
+    expect(framePool.currentFrameCount).equal(frameCount);
+    for (NSUInteger i = 0; i < frameCount; i++) {
+        if ([framePool frameAtIndex:i] != image) {
+            consistent = NO;
+        }
+    }
+    expect(consistent).beTruthy();
+    expect(framePool.averageDecodeDuration).beCloseToWithin(0.001, 0.0001);
+    [SDImageFramePool unregisterProvider:image];
+}
+
+- (void)test46ImageFramePoolFetchingFinishedWithoutDrain {
+    SDAnimatedImage *image = [SDAnimatedImage imageWithData:[self testAPNGPData]];
+    SDImageFramePool *framePool = [SDImageFramePool registerProvider:image];
+    framePool.totalFrameCount = image.animatedImageFrameCount;
+    // The decoded frame is no longer fetching, even if the display side does not read it yet
+    [framePool.fetchingIndexes addIndex:1];
+    [framePool handoffFrame:image atIndex:1 generation:0 decodeDuration:0.001];
+    expect([framePool.fetchingIndexes containsIndex:1]).beFalsy();
+    expect([framePool frameAtIndex:1]).beIdenticalTo(image);
+    
+    // Changing the target pixel size does not wait for the frames decoding at previous size
+    SDAnimatedImagePlayer *player = [SDAnimatedImagePlayer playerWithProvider:image];
+    [framePool.fetchingIndexes addIndex:2];
+    [framePool setTargetPixelSize:CGSizeMake(10, 10) forPlayer:player];
+    expect(framePool.fetchingIndexes.count).equal(0);
+    expect(framePool.currentFrameCount).equal(0);
+    // The stale frame is dropped, and does not clear the index fetching at the new size
+    [framePool.fetchingIndexes addIndex:2];
+    [framePool handoffFrame:image atIndex:2 generation:0 decodeDuration:0.001];
+    expect([framePool.fetchingIndexes containsIndex:2]).beTruthy();
+    expect([framePool frameAtIndex:2]).beNil();
+    [framePool removePlayer:player];
+    [SDImageFramePool unregisterProvider:image];
+}
+
+- (void)test47ImageFramePoolSharedByContent {
+    NSData *data = [self testAPNGPData];
+    SDAnimatedImage *image1 = [SDAnimatedImage imageWithData:data];
+    // Different instance and data object, but the same bytes
+    SDAnimatedImage *image2 = [SDAnimatedImage imageWithData:[data mutableCopy]];
+    SDImageFramePool *framePool1 = [SDImageFramePool registerProvider:image1];
+    SDImageFramePool *framePool2 = [SDImageFramePool registerProvider:image2];
+    expect(framePool2).beIdenticalTo(framePool1);
+    
+    // Different decode parameters use different pools
+    SDAnimatedImage *scaledImage = [SDAnimatedImage imageWithData:data scale:2];
+    SDImageFramePool *scaledFramePool = [SDImageFramePool registerProvider:scaledImage];
+    expect(scaledFramePool).notTo.beIdenticalTo(framePool1);
+    SDAnimatedImage *thumbnailImage = [[SDAnimatedImage alloc] initWithData:data scale:1 options:@{SDImageCoderDecodeThumbnailPixelSize : @(CGSizeMake(10, 10))}];
+    SDImageFramePool *thumbnailFramePool = [SDImageFramePool registerProvider:thumbnailImage];
+    expect(thumbnailFramePool).notTo.beIdenticalTo(framePool1);
+    expect(thumbnailFramePool).notTo.beIdenticalTo(scaledFramePool);
+    SDAnimatedImageTestSubclass *subclassImage = [SDAnimatedImageTestSubclass imageWithData:data];
+    SDImageFramePool *subclassFramePool = [SDImageFramePool registerProvider:subclassImage];
+    expect(subclassFramePool).notTo.beIdenticalTo(framePool1);
+    
+    // The incremental image is not shared
+    SDAnimatedImage *incrementalImage = [SDAnimatedImage imageWithData:data];
+    incrementalImage.sd_isIncremental = YES;
+    SDImageFramePool *incrementalFramePool = [SDImageFramePool registerProvider:incrementalImage];
+    expect(incrementalFramePool).notTo.beIdenticalTo(framePool1);
+    
+    // The pool keep decoding with the other provider, after the first one is released
+    [SDImageFramePool unregisterProvider:image1];
+    image1 = nil;
+    XCTestExpectation *expectation = [self expectationWithDescription:@"test SDImageFramePool shared by content"];
+    [framePool2 prefetchFrameAtIndex:1];
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(0.5 * NSEC_PER_SEC)), dispatch_get_main_queue(), ^{
+        expect([framePool2 frameAtIndex:1]).notTo.beNil();
+        [SDImageFramePool unregisterProvider:image2];
+        [SDImageFramePool unregisterProvider:scaledImage];
+        [SDImageFramePool unregisterProvider:thumbnailImage];
+        [SDImageFramePool unregisterProvider:subclassImage];
+        [SDImageFramePool unregisterProvider:incrementalImage];
+        [expectation fulfill];
+    });
+    [self waitForExpectationsWithCommonTimeout];
+}
+
+- (void)test48ImageFramePoolPlaybackPerPlayer {
+    SDAnimatedImage *image = [SDAnimatedImage imageWithData:[self testAPNGPData]];
+    SDAnimatedImage *sharedImage = [SDAnimatedImage imageWithData:[self testAPNGPData]];
+    SDAnimatedImagePlayer *player1 = [SDAnimatedImagePlayer playerWithProvider:image];
+    SDAnimatedImagePlayer *player2 = [SDAnimatedImagePlayer playerWithProvider:sharedImage];
+    SDImageFramePool *framePool = player1.framePool;
+    expect(player2.framePool).beIdenticalTo(framePool);
+    framePool.totalFrameCount = 10;
+    // Forward player at frame 2, and reversed player at frame 7, each keeps 2 frames
+    SDImageFramePlayback playback1 = {.frameIndex = 2, .lookaheadCount = 1, .maxBufferCount = 2, .queuePriority = NSOperationQueuePriorityNormal};
+    SDImageFramePlayback playback2 = {.frameIndex = 7, .lookaheadCount = 1, .maxBufferCount = 2, .queuePriority = NSOperationQueuePriorityNormal, .reversed = YES};
+    [framePool setPlayback:playback1 forPlayer:player1];
+    [framePool setPlayback:playback2 forPlayer:player2];
+    expect([framePool playbackForPlayer:player2].reversed).beTruthy();
+    expect([framePool playbackForPlayer:player1].reversed).beFalsy();
+    for (NSUInteger i = 0; i < 10; i++) {
+        [framePool setFrame:image atIndex:i];
+    }
+    [framePool prefetchFramesForPlayer:player1];
+    [SDAnimatedImageScheduler.sharedScheduler.decodeQueue waitUntilAllOperationsAreFinished];
+    // The sum of buffer count, and the frames displayed soonest by each player
+    NSMutableIndexSet *indexes = [NSMutableIndexSet indexSet];
+    for (NSUInteger i = 0; i < 10; i++) {
+        if ([framePool frameAtIndex:i]) {
+            [indexes addIndex:i];
+        }
+    }
+    NSMutableIndexSet *expectIndexes = [NSMutableIndexSet indexSetWithIndexesInRange:NSMakeRange(2, 2)];
+    [expectIndexes addIndexesInRange:NSMakeRange(6, 2)];
+    expect(indexes).equal(expectIndexes);
+    
+    // The removed player does not keep the frames any more
+    [framePool removePlayer:player2];
+    expect([framePool playbackForPlayer:player2].maxBufferCount).equal(0);
+    [framePool prefetchFramesWithPlayback:playback1 forPlayer:player1];
+    [SDAnimatedImageScheduler.sharedScheduler.decodeQueue waitUntilAllOperationsAreFinished];
+    expect(framePool.currentFrameCount).equal(2);
+    expect([framePool frameAtIndex:2]).notTo.beNil();
+    expect([framePool frameAtIndex:3]).notTo.beNil();
+}
+
 - (void)testAnimationTransformerWorks {
     XCTestExpectation *expectation = [self expectationWithDescription:@"test SDAnimatedImageView animationTransformer works"];
     SDAnimatedImageView *imageView = [SDAnimatedImageView new];
@@ -967,6 +967,112 @@ static NSString *kTestImageKeyPNG = @"TestImageKey.png";
     expect(cacheFiles.count).equal(0);
 }
 
+- (void)test59CacheValidatorWorks {
+    XCTestExpectation *expectation = [self expectationWithDescription:@"SDImageCache cache validator works"];
+    NSURL *url = [NSURL URLWithString:@"http://example.com/image.png"];
+    NSHTTPURLResponse *response = [[NSHTTPURLResponse alloc] initWithURL:url statusCode:200 HTTPVersion:@"HTTP/1.1" headerFields:@{@"ETag" : @"\"abc\"", @"cache-control" : @"public, max-age=60", @"Age" : @"10"}];
+    SDImageCacheValidator *validator = [SDImageCacheValidator validatorWithResponse:response];
+    expect(validator).notTo.beNil();
+    expect(validator.entityTag).equal(@"\"abc\"");
+    expect(validator.isFresh).beTruthy();
+    expect(validator.isConditional).beTruthy();
+    expect(validator.conditionalHeaders).equal(@{@"If-None-Match" : @"\"abc\""});
+    expect(validator.expirationDate.timeIntervalSinceNow).beLessThanOrEqualTo(50);
+    // No validator and freshness
+    NSHTTPURLResponse *noCacheResponse = [[NSHTTPURLResponse alloc] initWithURL:url statusCode:200 HTTPVersion:@"HTTP/1.1" headerFields:@{@"Cache-Control" : @"no-cache"}];
+    expect([SDImageCacheValidator validatorWithResponse:noCacheResponse]).beNil();
+    // Refresh by 304
+    NSHTTPURLResponse *notModifiedResponse = [[NSHTTPURLResponse alloc] initWithURL:url statusCode:304 HTTPVersion:@"HTTP/1.1" headerFields:@{@"Cache-Control" : @"no-cache"}];
+    SDImageCacheValidator *refreshedValidator = [validator validatorByRefreshingWithResponse:notModifiedResponse];
+    expect(refreshedValidator.entityTag).equal(validator.entityTag);
+    expect(refreshedValidator.isFresh).beFalsy();
+    
+    // Store and query
+    NSString *key = kTestImageKeyPNG;
+    [SDImageCache.sharedImageCache storeImageDataToDisk:[NSData dataWithContentsOfFile:[self testPNGPath]] forKey:key];
+    [SDImageCache.sharedImageCache storeCacheValidator:validator forKey:key];
+    [SDImageCache.sharedImageCache queryCacheValidatorForKey:key completion:^(SDImageCacheValidator * _Nullable cachedValidator) {
+        expect(cachedValidator.entityTag).equal(validator.entityTag);
+        expect(cachedValidator.expirationDate).equal(validator.expirationDate);
+        expect([SDImageCache.sharedImageCache diskCacheValidatorForKey:key]).notTo.beNil();
+        // Removed along with the image
+        [SDImageCache.sharedImageCache removeImageForKey:key withCompletion:^{
+            expect([SDImageCache.sharedImageCache diskCacheValidatorForKey:key]).beNil();
+            [expectation fulfill];
+        }];
+    }];
+    [self waitForExpectationsWithCommonTimeout];
+}
+
+- (void)test60FrameAtlasWorks {
+    XCTestExpectation *expectation = [self expectationWithDescription:@"SDImageCache frame atlas works"];
+    SDImageCacheConfig *config = [[SDImageCacheConfig alloc] init];
+    config.frameAtlasLimitBytes = 16 * 1024 * 1024;
+    SDImageCache *cache = [[SDImageCache alloc] initWithNamespace:@"FrameAtlas" diskCacheDirectory:nil config:config];
+    NSData *gifData = [NSData dataWithContentsOfFile:[self testGIFPath]];
+    SDAnimatedImage *animatedImage = [SDAnimatedImage imageWithData:gifData];
+    expect(animatedImage).notTo.beNil();
+    // Tiny limit does not create atlas
+    expect([SDImageFrameAtlasCoder frameAtlasDataWithAnimatedProvider:animatedImage limitBytes:1]).beNil();
+    NSString *key = @"TestFrameAtlas.gif";
+    [cache storeImage:animatedImage imageData:gifData forKey:key options:0 context:nil cacheType:SDImageCacheTypeDisk completion:^{
+        [cache queryCacheOperationForKey:key options:0 context:@{SDWebImageContextAnimatedImageClass : SDAnimatedImage.class} cacheType:SDImageCacheTypeDisk done:^(UIImage * _Nullable image, NSData * _Nullable data, SDImageCacheType cacheType) {
+            expect(image).beKindOf(SDAnimatedImage.class);
+            SDAnimatedImage *atlasImage = (SDAnimatedImage *)image;
+            expect(atlasImage.animatedCoder).beKindOf(SDImageFrameAtlasCoder.class);
+            expect(atlasImage.animatedImageFrameCount).equal(animatedImage.animatedImageFrameCount);
+            expect(atlasImage.animatedImageLoopCount).equal(animatedImage.animatedImageLoopCount);
+            expect([atlasImage animatedImageDurationAtIndex:1]).equal([animatedImage animatedImageDurationAtIndex:1]);
+            expect([atlasImage animatedImageFrameAtIndex:1].size).equal(animatedImage.size);
+            // Export the original data, not the atlas
+            expect(atlasImage.animatedImageData).equal(gifData);
+            expect(atlasImage.sd_imageFormat).equal(SDImageFormatGIF);
+            // Thumbnail is decoded by codec
+            UIImage *thumbnailImage = [cache imageFromDiskCacheForKey:key options:0 context:@{SDWebImageContextAnimatedImageClass : SDAnimatedImage.class, SDWebImageContextImageThumbnailPixelSize : @(CGSizeMake(10, 10))}];
+            expect(((SDAnimatedImage *)thumbnailImage).animatedCoder).notTo.beKindOf(SDImageFrameAtlasCoder.class);
+            // Overwrite the data removes the outdated atlas
+            [cache storeImageDataToDisk:[NSData dataWithContentsOfFile:[self testPNGPath]] forKey:key];
+            UIImage *pngImage = [cache imageFromDiskCacheForKey:key options:0 context:@{SDWebImageContextAnimatedImageClass : SDAnimatedImage.class}];
+            expect(pngImage.sd_imageFormat).equal(SDImageFormatPNG);
+            expect(((SDAnimatedImage *)pngImage).animatedCoder).notTo.beKindOf(SDImageFrameAtlasCoder.class);
+            // The atlas is removed along with the image
+            [cache removeImageForKey:key withCompletion:^{
+                [cache queryCacheOperationForKey:key options:0 context:@{SDWebImageContextAnimatedImageClass : SDAnimatedImage.class} cacheType:SDImageCacheTypeDisk done:^(UIImage * _Nullable image2, NSData * _Nullable data2, SDImageCacheType cacheType2) {
+                    expect(image2).beNil();
+                    [cache clearDiskOnCompletion:^{
+                        [expectation fulfill];
+                    }];
+                }];
+            }];
+        }];
+    }];
+    [self waitForExpectationsWithCommonTimeout];
+}
+
+- (void)test61FrameAtlasRejectCorruptedData {
+    NSData *gifData = [NSData dataWithContentsOfFile:[self testGIFPath]];
+    SDAnimatedImage *animatedImage = [SDAnimatedImage imageWithData:gifData];
+    NSData *atlasData = [SDImageFrameAtlasCoder frameAtlasDataWithAnimatedProvider:animatedImage limitBytes:0];
+    expect(atlasData).notTo.beNil();
+    SDImageFrameAtlasCoder *coder = [[SDImageFrameAtlasCoder alloc] initWithAnimatedImageData:atlasData options:nil];
+    expect(coder).notTo.beNil();
+    expect(coder.frameAtlasData).equal(atlasData);
+    // No source data, no export
+    expect(coder.animatedImageData).beNil();
+    // Truncated
+    expect([[SDImageFrameAtlasCoder alloc] initWithAnimatedImageData:[atlasData subdataWithRange:NSMakeRange(0, atlasData.length - 1)] options:nil]).beNil();
+    // The header is `magic, version, width, height, bytesPerRow, bitmapInfo, frameCount, loopCount` in uint32_t
+    NSMutableData *corruptedData = [atlasData mutableCopy];
+    uint32_t *fields = corruptedData.mutableBytes;
+    fields[4] += 64; // bytesPerRow
+    expect([[SDImageFrameAtlasCoder alloc] initWithAnimatedImageData:corruptedData options:nil]).beNil();
+    corruptedData = [atlasData mutableCopy];
+    fields = corruptedData.mutableBytes;
+    fields[3] = UINT32_MAX; // height
+    fields[6] = UINT32_MAX; // frameCount, overflow
+    expect([[SDImageFrameAtlasCoder alloc] initWithAnimatedImageData:corruptedData options:nil]).beNil();
+}
+
 #pragma mark Helper methods
 
 - (UIImage *)testJPEGImage {
@@ -9,6 +9,8 @@
 
 #import "SDTestCase.h"
 #import "UIColor+SDHexString.h"
+#import "SDImagePixelKernel.h"
+#import "SDImagePixelKernelGolden.h"
 
 @interface SDWebImageDecoderTests : SDTestCase
 
@@ -761,6 +763,348 @@
     }
 }
 
+- (void)test35ThatThumbnailDecodeReduceTimeAndMemory {
+    // Benchmark the decode-time downsampling (`kCGImageSourceThumbnailMaxPixelSize`) against full size decoding, for a 80pt@2x view
+    NSString *testImagePath = [[NSBundle bundleForClass:[self class]] pathForResource:@"TestImageLarge" ofType:@"jpg"];
+    NSData *data = [NSData dataWithContentsOfFile:testImagePath];
+    CGSize thumbnailSize = CGSizeMake(160, 160);
+    NSUInteger iterations = 5;
+    
+    __block size_t fullBytes = 0;
+    __block size_t thumbnailBytes = 0;
+    CFTimeInterval(^measure)(void(^)(void)) = ^CFTimeInterval(void(^block)(void)) {
+        CFTimeInterval start = CACurrentMediaTime();
+        for (NSUInteger i = 0; i < iterations; i++) {
+            @autoreleasepool {
+                block();
+            }
+        }
+        return (CACurrentMediaTime() - start) / iterations;
+    };
+    CFTimeInterval fullTime = measure(^{
+        UIImage *image = [SDImageIOCoder.sharedCoder decodedImageWithData:data options:nil];
+        UIImage *decodedImage = [SDImageCoderHelper decodedImageWithImage:image];
+        fullBytes = CGImageGetBytesPerRow(decodedImage.CGImage) * CGImageGetHeight(decodedImage.CGImage);
+    });
+    CFTimeInterval thumbnailTime = measure(^{
+        UIImage *image = [SDImageIOCoder.sharedCoder decodedImageWithData:data options:@{SDImageCoderDecodeThumbnailPixelSize : @(thumbnailSize)}];
+        UIImage *decodedImage = [SDImageCoderHelper decodedImageWithImage:image];
+        expect(MAX(CGImageGetWidth(decodedImage.CGImage), CGImageGetHeight(decodedImage.CGImage))).beLessThanOrEqualTo(160);
+        thumbnailBytes = CGImageGetBytesPerRow(decodedImage.CGImage) * CGImageGetHeight(decodedImage.CGImage);
+    });
+    expect(thumbnailTime).beLessThan(fullTime);
+    expect(thumbnailBytes).beGreaterThan(0);
+    expect(thumbnailBytes * 10).beLessThan(fullBytes);
+}
+
+- (void)test36ThatPixelKernelMatchGolden {
+    // Premultiply with exact rounding, alpha last and alpha first
+    uint8_t pixels[8] = {200, 100, 0, 100, 128, 255, 255, 255};
+    SDPixelBuffer buffer = {pixels, 2, 1, 8};
+    SDPixelKernelPremultiply(&buffer, SDPixelAlphaPositionLast);
+    expect(pixels[0]).equal(78);
+    expect(pixels[1]).equal(39);
+    expect(pixels[2]).equal(0);
+    expect(pixels[3]).equal(100);
+    expect(pixels[4]).equal(128);
+    expect(pixels[7]).equal(255);
+    uint8_t firstPixels[4] = {128, 255, 200, 1};
+    SDPixelBuffer firstBuffer = {firstPixels, 1, 1, 4};
+    SDPixelKernelPremultiply(&firstBuffer, SDPixelAlphaPositionFirst);
+    expect(firstPixels[0]).equal(128);
+    expect(firstPixels[1]).equal(128);
+    expect(firstPixels[2]).equal(100);
+    expect(firstPixels[3]).equal(1);
+    SDPixelKernelUnpremultiply(&firstBuffer, SDPixelAlphaPositionFirst);
+    expect(firstPixels[1]).equal(255);
+    expect(firstPixels[2]).equal(199);
+    // Swap red and blue
+    uint8_t swapPixels[4] = {1, 2, 3, 4};
+    SDPixelBuffer swapBuffer = {swapPixels, 1, 1, 4};
+    SDPixelKernelSwapRedBlue(&swapBuffer, SDPixelAlphaPositionLast);
+    expect(swapPixels[0]).equal(3);
+    expect(swapPixels[2]).equal(1);
+    
+    // Both the SIMD and the reference path match the golden values, which are shared with `Tests/Benchmark/SDImagePixelKernelBenchmark.c`
+    uint64_t(^inPlaceHash)(void(*)(const SDPixelBuffer *, SDPixelAlphaPosition), SDPixelAlphaPosition, BOOL) = ^uint64_t(void(*kernel)(const SDPixelBuffer *, SDPixelAlphaPosition), SDPixelAlphaPosition alphaPosition, BOOL unpremultiply) {
+        size_t width = SDPixelKernelGoldenHashWidth, height = SDPixelKernelGoldenHashHeight;
+        uint8_t data[SDPixelKernelGoldenHashWidth * SDPixelKernelGoldenHashHeight * 4];
+        SDPixelKernelGoldenFill(data, width, height, width * 4);
+        SDPixelBuffer goldenBuffer = {data, width, height, width * 4};
+        kernel(&goldenBuffer, alphaPosition);
+        if (unpremultiply) {
+            SDPixelKernelUnpremultiply(&goldenBuffer, alphaPosition);
+        }
+        return SDPixelKernelGoldenHash(data, sizeof(data));
+    };
+    int(^resizeDifference)(bool(*)(const SDPixelBuffer *, const SDPixelBuffer *, SDPixelResizeFilter), size_t, size_t, size_t, size_t, SDPixelResizeFilter, const uint8_t *) = ^int(bool(*kernel)(const SDPixelBuffer *, const SDPixelBuffer *, SDPixelResizeFilter), size_t sourceWidth, size_t sourceHeight, size_t width, size_t height, SDPixelResizeFilter filter, const uint8_t *golden) {
+        NSMutableData *sourceData = [NSMutableData dataWithLength:sourceWidth * sourceHeight * 4];
+        NSMutableData *outputData = [NSMutableData dataWithLength:width * height * 4];
+        SDPixelKernelGoldenFill(sourceData.mutableBytes, sourceWidth, sourceHeight, sourceWidth * 4);
+        SDPixelBuffer input = {sourceData.mutableBytes, sourceWidth, sourceHeight, sourceWidth * 4};
+        SDPixelBuffer output = {outputData.mutableBytes, width, height, width * 4};
+        if (!kernel(&input, &output, filter)) {
+            return INT_MAX;
+        }
+        const uint8_t *bytes = outputData.bytes;
+        int maxDiff = 0;
+        for (size_t i = 0; i < outputData.length; i++) {
+            maxDiff = MAX(maxDiff, abs((int)bytes[i] - (int)golden[i]));
+        }
+        return maxDiff;
+    };
+    void(*premultiplyKernels[2])(const SDPixelBuffer *, SDPixelAlphaPosition) = {SDPixelKernelPremultiply, SDPixelKernelPremultiplyReference};
+    void(*swapKernels[2])(const SDPixelBuffer *, SDPixelAlphaPosition) = {SDPixelKernelSwapRedBlue, SDPixelKernelSwapRedBlueReference};
+    bool(*resizeKernels[2])(const SDPixelBuffer *, const SDPixelBuffer *, SDPixelResizeFilter) = {SDPixelKernelResize, SDPixelKernelResizeReference};
+    for (int i = 0; i < 2; i++) {
+        expect(inPlaceHash(premultiplyKernels[i], SDPixelAlphaPositionLast, NO)).equal(SDPixelKernelGoldenPremultiplyLastHash);
+        expect(inPlaceHash(premultiplyKernels[i], SDPixelAlphaPositionFirst, NO)).equal(SDPixelKernelGoldenPremultiplyFirstHash);
+        expect(inPlaceHash(premultiplyKernels[i], SDPixelAlphaPositionLast, YES)).equal(SDPixelKernelGoldenUnpremultiplyLastHash);
+        expect(inPlaceHash(swapKernels[i], SDPixelAlphaPositionLast, NO)).equal(SDPixelKernelGoldenSwapRedBlueLastHash);
+        expect(inPlaceHash(swapKernels[i], SDPixelAlphaPositionFirst, NO)).equal(SDPixelKernelGoldenSwapRedBlueFirstHash);
+        for (SDPixelResizeFilter filter = SDPixelResizeFilterBox; filter <= SDPixelResizeFilterLanczos3; filter++) {
+            expect(resizeDifference(resizeKernels[i], SDPixelKernelGoldenDownscaleSourceWidth, SDPixelKernelGoldenDownscaleSourceHeight, SDPixelKernelGoldenDownscaleWidth, SDPixelKernelGoldenDownscaleHeight, filter, SDPixelKernelGoldenDownscale[filter])).beLessThanOrEqualTo(1);
+            expect(resizeDifference(resizeKernels[i], SDPixelKernelGoldenUpscaleSourceWidth, SDPixelKernelGoldenUpscaleSourceHeight, SDPixelKernelGoldenUpscaleWidth, SDPixelKernelGoldenUpscaleHeight, filter, SDPixelKernelGoldenUpscale[filter])).beLessThanOrEqualTo(1);
+        }
+    }
+    
+    // SIMD and reference produce the same output on the large bitmap, and the constant color keep constant after resize
+    size_t width = 333, height = 217;
+    NSMutableData *sourceData = [NSMutableData dataWithLength:width * height * 4];
+    uint8_t *source = sourceData.mutableBytes;
+    SDPixelKernelGoldenFill(source, width, height, width * 4);
+    NSMutableData *referenceData = [sourceData mutableCopy];
+    SDPixelBuffer simdBuffer = {source, width, height, width * 4};
+    SDPixelBuffer referenceBuffer = {referenceData.mutableBytes, width, height, width * 4};
+    SDPixelKernelPremultiply(&simdBuffer, SDPixelAlphaPositionLast);
+    SDPixelKernelSwapRedBlue(&simdBuffer, SDPixelAlphaPositionLast);
+    SDPixelKernelPremultiplyReference(&referenceBuffer, SDPixelAlphaPositionLast);
+    SDPixelKernelSwapRedBlueReference(&referenceBuffer, SDPixelAlphaPositionLast);
+    expect([sourceData isEqualToData:referenceData]).beTruthy();
+    
+    SDPixelBuffer input = {source, width, height, width * 4};
+    for (SDPixelResizeFilter filter = SDPixelResizeFilterBox; filter <= SDPixelResizeFilterLanczos3; filter++) {
+        size_t outputSizes[3][2] = {{100, 70}, {500, 400}, {1, 1}};
+        for (int j = 0; j < 3; j++) {
+            size_t outputWidth = outputSizes[j][0], outputHeight = outputSizes[j][1];
+            NSMutableData *simdData = [NSMutableData dataWithLength:outputWidth * outputHeight * 4];
+            NSMutableData *scalarData = [NSMutableData dataWithLength:outputWidth * outputHeight * 4];
+            SDPixelBuffer simdOutput = {simdData.mutableBytes, outputWidth, outputHeight, outputWidth * 4};
+            SDPixelBuffer scalarOutput = {scalarData.mutableBytes, outputWidth, outputHeight, outputWidth * 4};
+            expect(SDPixelKernelResize(&input, &simdOutput, filter)).beTruthy();
+            expect(SDPixelKernelResizeReference(&input, &scalarOutput, filter)).beTruthy();
+            const uint8_t *simdBytes = simdData.bytes, *scalarBytes = scalarData.bytes;
+            int maxDiff = 0;
+            for (size_t i = 0; i < simdData.length; i++) {
+                maxDiff = MAX(maxDiff, abs((int)simdBytes[i] - (int)scalarBytes[i]));
+            }
+            expect(maxDiff).beLessThanOrEqualTo(1);
+        }
+    }
+    memset(source, 77, sourceData.length);
+    for (SDPixelResizeFilter filter = SDPixelResizeFilterBox; filter <= SDPixelResizeFilterLanczos3; filter++) {
+        uint8_t constant[64 * 64 * 4];
+        SDPixelBuffer constantOutput = {constant, 64, 64, 64 * 4};
+        expect(SDPixelKernelResize(&input, &constantOutput, filter)).beTruthy();
+        for (size_t i = 0; i < sizeof(constant); i++) {
+            if (constant[i] != 77) {
+                XCTFail(@"Constant color changed after resize with filter: %d", filter);
+                break;
+            }
+        }
+    }
+}
+
+- (void)test37ThatPixelKernelSIMDMatchReferenceOnLargeImage {
+    // Benchmark the SIMD paths against the scalar reference, 12MP scale down to 3MP, the full report is `Tests/Benchmark/SDImagePixelKernelBenchmark.c`
+    // The timing depends on the machine load, so it's only logged
+    size_t width = 4000, height = 3000;
+    NSMutableData *sourceData = [NSMutableData dataWithLength:width * height * 4];
+    NSMutableData *simdData = [NSMutableData dataWithLength:(width / 2) * (height / 2) * 4];
+    NSMutableData *referenceData = [NSMutableData dataWithLength:(width / 2) * (height / 2) * 4];
+    SDPixelBuffer input = {sourceData.mutableBytes, width, height, width * 4};
+    CFTimeInterval(^measure)(void(*)(const SDPixelBuffer *, SDPixelAlphaPosition), bool(*)(const SDPixelBuffer *, const SDPixelBuffer *, SDPixelResizeFilter), NSMutableData *) = ^CFTimeInterval(void(*premultiply)(const SDPixelBuffer *, SDPixelAlphaPosition), bool(*resize)(const SDPixelBuffer *, const SDPixelBuffer *, SDPixelResizeFilter), NSMutableData *outputData) {
+        SDPixelBuffer output = {outputData.mutableBytes, width / 2, height / 2, width / 2 * 4};
+        CFTimeInterval best = DBL_MAX;
+        for (int i = 0; i < 3; i++) {
+            // Refill each time, the premultiply is in-place
+            SDPixelKernelGoldenFill(input.data, width, height, input.bytesPerRow);
+            CFTimeInterval start = CACurrentMediaTime();
+            premultiply(&input, SDPixelAlphaPositionLast);
+            expect(resize(&input, &output, SDPixelResizeFilterLanczos3)).beTruthy();
+            best = MIN(best, CACurrentMediaTime() - start);
+        }
+        return best;
+    };
+    CFTimeInterval referenceTime = measure(SDPixelKernelPremultiplyReference, SDPixelKernelResizeReference, referenceData);
+    CFTimeInterval simdTime = measure(SDPixelKernelPremultiply, SDPixelKernelResize, simdData);
+    NSLog(@"Pixel kernel %s: %.2f ms, Reference: %.2f ms", SDPixelKernelSIMDName(), simdTime * 1000, referenceTime * 1000);
+    const uint8_t *simdBytes = simdData.bytes, *referenceBytes = referenceData.bytes;
+    int maxDiff = 0;
+    for (size_t i = 0; i < simdData.length; i++) {
+        maxDiff = MAX(maxDiff, abs((int)simdBytes[i] - (int)referenceBytes[i]));
+    }
+    expect(maxDiff).beLessThanOrEqualTo(1);
+}
+
+- (void)test38ThatParallelTileScaleDownIsByteIdentical {
+    // Benchmark the Tile Decoding megapixels per second against concurrency, and the output should be byte-identical
+    NSString *testImagePath = [[NSBundle bundleForClass:[self class]] pathForResource:@"TestImageLarge" ofType:@"jpg"];
+    NSData *data = [NSData dataWithContentsOfFile:testImagePath];
+    SDImageCoderDecodeSolution decodeSolution = SDImageCoderHelper.defaultDecodeSolution;
+    // Force CoreGraphics to use Tile Decoding
+    SDImageCoderHelper.defaultDecodeSolution = SDImageCoderDecodeSolutionCoreGraphics;
+    NSData *serialData;
+    for (NSNumber *threadCount in @[@1, @2, @4, @8]) {
+        SDImageCoderHelper.defaultScaleDownConcurrency = threadCount.unsignedIntegerValue;
+        // Clamped to the tiles the memory limit is split for
+        expect(SDImageCoderHelper.defaultScaleDownConcurrency).equal(MIN(threadCount.unsignedIntegerValue, 4));
+        UIImage *image = [[UIImage alloc] initWithData:data];
+        CGFloat megapixels = CGImageGetWidth(image.CGImage) * CGImageGetHeight(image.CGImage) / 1e6;
+        CFTimeInterval start = CACurrentMediaTime();
+        UIImage *decodedImage = [SDImageCoderHelper decodedAndScaledDownImageWithImage:image limitBytes:4 * 1024 * 1024];
+        CFTimeInterval time = CACurrentMediaTime() - start;
+        expect(decodedImage.sd_isDecoded).beTruthy();
+        NSLog(@"Tile Decoding with %@ threads: %.2f MP/s", threadCount, megapixels / time);
+        CFDataRef pixelData = CGDataProviderCopyData(CGImageGetDataProvider(decodedImage.CGImage));
+        NSData *outputData = (__bridge_transfer NSData *)pixelData;
+        if (!serialData) {
+            serialData = outputData;
+        } else {
+            expect([outputData isEqualToData:serialData]).beTruthy();
+        }
+    }
+    SDImageCoderHelper.defaultDecodeSolution = decodeSolution;
+    SDImageCoderHelper.defaultScaleDownConcurrency = 0;
+}
+
+- (void)test39ThatNormalizerConvertOnlyNonPreferredFormat {
+    [SDImageCoderHelper resetNormalizationStatistics];
+    NSUInteger checkCount = SDImageCoderHelper.normalizationCheckCount;
+    NSUInteger convertCount = SDImageCoderHelper.normalizationConvertCount;
+    size_t width = 10;
+    size_t height = 8;
+    // Preferred format, keep the same
+    size_t bytesPerRow = SDByteAlign(4 * width, [SDImageCoderHelper preferredPixelFormat:YES].alignment);
+    NSMutableData *data = [NSMutableData dataWithLength:bytesPerRow * height];
+    CGDataProviderRef provider = CGDataProviderCreateWithCFData((__bridge CFDataRef)data);
+    CGImageRef cgImage = CGImageCreate(width, height, 8, 32, bytesPerRow, [SDImageCoderHelper colorSpaceGetDeviceRGB], [SDImageCoderHelper preferredPixelFormat:YES].bitmapInfo, provider, NULL, YES, kCGRenderingIntentDefault);
+    CGDataProviderRelease(provider);
+    CGImageRef normalizedImageRef = [SDImageCoderHelper CGImageCreateNormalized:cgImage];
+    expect(normalizedImageRef == cgImage).beTruthy();
+    CGImageRelease(normalizedImageRef);
+    CGImageRelease(cgImage);
+    expect(SDImageCoderHelper.normalizationCheckCount).beGreaterThanOrEqualTo(checkCount + 1);
+    
+    // Grayscale keep the single channel
+    CGColorSpaceRef grayColorSpace = CGColorSpaceCreateDeviceGray();
+    NSMutableData *grayData = [NSMutableData dataWithLength:width * height];
+    CGDataProviderRef grayProvider = CGDataProviderCreateWithCFData((__bridge CFDataRef)grayData);
+    CGImageRef grayImage = CGImageCreate(width, height, 8, 8, width, grayColorSpace, kCGImageAlphaNone, grayProvider, NULL, YES, kCGRenderingIntentDefault);
+    CGDataProviderRelease(grayProvider);
+    CGColorSpaceRelease(grayColorSpace);
+    normalizedImageRef = [SDImageCoderHelper CGImageCreateNormalized:grayImage];
+    expect(normalizedImageRef == grayImage).beTruthy();
+    CGImageRelease(normalizedImageRef);
+    CGImageRelease(grayImage);
+    
+    // RGB888 with unaligned row, convert to preferred format
+    NSMutableData *rgbData = [NSMutableData dataWithLength:width * 3 * height];
+    CGDataProviderRef rgbProvider = CGDataProviderCreateWithCFData((__bridge CFDataRef)rgbData);
+    CGImageRef rgbImage = CGImageCreate(width, height, 8, 24, width * 3, [SDImageCoderHelper colorSpaceGetDeviceRGB], kCGBitmapByteOrderDefault | kCGImageAlphaNone, rgbProvider, NULL, YES, kCGRenderingIntentDefault);
+    CGDataProviderRelease(rgbProvider);
+#if SD_MAC
+    UIImage *image = [[UIImage alloc] initWithCGImage:rgbImage scale:1 orientation:kCGImagePropertyOrientationUp];
+#else
+    UIImage *image = [[UIImage alloc] initWithCGImage:rgbImage scale:1 orientation:UIImageOrientationUp];
+#endif
+    CGImageRelease(rgbImage);
+    image.sd_imageFormat = SDImageFormatPNG;
+    UIImage *normalizedImage = [SDImageCoderHelper normalizedImageWithImage:image];
+    expect(normalizedImage).notTo.equal(image);
+    expect(normalizedImage.sd_imageFormat).equal(SDImageFormatPNG);
+    expect(CGImageGetBitsPerPixel(normalizedImage.CGImage)).equal(32);
+    expect([SDImageCoderHelper CGImageIsHardwareSupported:normalizedImage.CGImage]).beTruthy();
+    expect(SDImageCoderHelper.normalizationCheckCount).beGreaterThanOrEqualTo(checkCount + 3);
+    expect(SDImageCoderHelper.normalizationConvertCount).beGreaterThanOrEqualTo(convertCount + 1);
+    // Normalized image keep the same
+    expect([SDImageCoderHelper normalizedImageWithImage:normalizedImage]).equal(normalizedImage);
+    
+    // The unaligned row policy does not effect the normalizer output, which is not converted again
+    SDImageRowAlignment rowAlignment = SDImageCoderHelper.defaultRowAlignment;
+    SDImageCoderHelper.defaultRowAlignment = SDImageRowAlignmentNone;
+    UIImage *unalignedNormalizedImage = [SDImageCoderHelper normalizedImageWithImage:image];
+    expect([SDImageCoderHelper CGImageIsHardwareSupported:unalignedNormalizedImage.CGImage]).beTruthy();
+    expect([SDImageCoderHelper normalizedImageWithImage:unalignedNormalizedImage]).equal(unalignedNormalizedImage);
+    SDImageCoderHelper.defaultRowAlignment = rowAlignment;
+}
+
+- (void)test40ThatRowAlignmentPolicyWorks {
+    // Odd width to make the policies different
+    size_t width = 1001;
+    size_t height = 800;
+    expect([SDImageCoderHelper bytesPerRowWithWidth:width bytesPerPixel:4 rowAlignment:SDImageRowAlignmentNone]).equal(4004);
+    expect([SDImageCoderHelper bytesPerRowWithWidth:width bytesPerPixel:4 rowAlignment:SDImageRowAlignmentPixelFormat]).equal(4032);
+    expect([SDImageCoderHelper bytesPerRowWithWidth:width bytesPerPixel:4 rowAlignment:SDImageRowAlignmentCacheLine]).equal(4032);
+    expect([SDImageCoderHelper bytesPerRowWithWidth:1003 bytesPerPixel:4 rowAlignment:SDImageRowAlignmentCacheLine]).equal(4032);
+    expect([SDImageCoderHelper bytesPerRowWithWidth:16 bytesPerPixel:3 rowAlignment:SDImageRowAlignmentCacheLine]).equal(64);
+    
+    NSMutableData *sourceData = [NSMutableData dataWithLength:width * 3 * height];
+    uint8_t *source = sourceData.mutableBytes;
+    for (size_t i = 0; i < sourceData.length; i++) {
+        source[i] = (uint8_t)(i * 31);
+    }
+    // 24-bit RGB source, so the decode always redraw
+    CGDataProviderRef provider = CGDataProviderCreateWithCFData((__bridge CFDataRef)sourceData);
+    CGImageRef sourceImage = CGImageCreate(width, height, 8, 24, width * 3, [SDImageCoderHelper colorSpaceGetDeviceRGB], kCGImageAlphaNone, provider, NULL, NO, kCGRenderingIntentDefault);
+    CGDataProviderRelease(provider);
+    SDImageRowAlignment alignments[] = {SDImageRowAlignmentNone, SDImageRowAlignmentCacheLine};
+    NSData *referenceData;
+    for (size_t i = 0; i < sizeof(alignments) / sizeof(alignments[0]); i++) {
+        SDImageRowAlignment alignment = alignments[i];
+        CGImageRef decodedImage = [SDImageCoderHelper CGImageCreateDecoded:sourceImage orientation:kCGImagePropertyOrientationUp rowAlignment:alignment];
+        expect(decodedImage).notTo.beNil();
+        size_t bytesPerRow = CGImageGetBytesPerRow(decodedImage);
+        expect(bytesPerRow).equal([SDImageCoderHelper bytesPerRowWithWidth:width bytesPerPixel:4 rowAlignment:alignment]);
+        CGImageRef scaledImage = [SDImageCoderHelper CGImageCreateScaled:decodedImage size:CGSizeMake(width / 2, height / 2) rowAlignment:alignment];
+        expect(scaledImage).notTo.beNil();
+        expect(CGImageGetBytesPerRow(scaledImage)).equal([SDImageCoderHelper bytesPerRowWithWidth:width / 2 bytesPerPixel:4 rowAlignment:alignment]);
+        CGImageRelease(scaledImage);
+        
+        // Blit: draw into the aligned destination, like the render server composition
+        CGContextRef context = CGBitmapContextCreate(NULL, width, height, 8, 0, [SDImageCoderHelper colorSpaceGetDeviceRGB], [SDImageCoderHelper preferredPixelFormat:YES].bitmapInfo);
+        CFTimeInterval blitStart = CACurrentMediaTime();
+        for (int j = 0; j < 20; j++) {
+            CGContextDrawImage(context, CGRectMake(0, 0, width, height), decodedImage);
+        }
+        CFTimeInterval blitTime = CACurrentMediaTime() - blitStart;
+        CGContextRelease(context);
+        
+        // Upload: copy rows into the tightly packed destination, like the texture upload
+        CFDataRef data = CGDataProviderCopyData(CGImageGetDataProvider(decodedImage));
+        const uint8_t *bytes = CFDataGetBytePtr(data);
+        NSMutableData *packedData = [NSMutableData dataWithLength:width * 4 * height];
+        uint8_t *packedBytes = packedData.mutableBytes;
+        CFTimeInterval uploadStart = CACurrentMediaTime();
+        for (int j = 0; j < 20; j++) {
+            for (size_t y = 0; y < height; y++) {
+                memcpy(packedBytes + y * width * 4, bytes + y * bytesPerRow, width * 4);
+            }
+        }
+        CFTimeInterval uploadTime = CACurrentMediaTime() - uploadStart;
+        CFRelease(data);
+        CGImageRelease(decodedImage);
+        // Pixels are the same regardless of the stride
+        if (!referenceData) {
+            referenceData = [packedData copy];
+        } else {
+            expect([packedData isEqualToData:referenceData]).beTruthy();
+        }
+        NSLog(@"Row alignment %ld, bytesPerRow %zu: blit %.2fms, upload %.2fms", (long)alignment, bytesPerRow, blitTime * 1000 / 20, uploadTime * 1000 / 20);
+    }
+    CGImageRelease(sourceImage);
+}
+
 #pragma mark - Utils
 
 - (void)verifyCoder:(id<SDImageCoder>)coder
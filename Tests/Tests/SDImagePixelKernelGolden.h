@@ -0,0 +1,72 @@
+/*
+ * This file is part of the SDWebImage package.
+ * (c) Olivier Poitrey <rs@dailymotion.com>
+ *
+ * For the full copyright and license information, please view the LICENSE
+ * file that was distributed with this source code.
+ */
+
+#ifndef SDImagePixelKernelGolden_h
+#define SDImagePixelKernelGolden_h
+
+// The golden values of the pixel kernels, shared by the unit test and the standalone benchmark in `Tests/Benchmark`.
+// Regenerate with `SDImagePixelKernelBenchmark --generate` only when the kernel output changes on purpose.
+
+#include <stddef.h>
+#include <stdint.h>
+
+// The deterministic input pattern, which covers alpha 0, 255 and the values between
+static inline uint8_t SDPixelKernelGoldenPattern(size_t x, size_t y, size_t c) {
+    return (uint8_t)((x * 37 + y * 91 + c * 53 + (x * y) % 17) & 0xFF);
+}
+
+static inline void SDPixelKernelGoldenFill(uint8_t *data, size_t width, size_t height, size_t bytesPerRow) {
+    for (size_t y = 0; y < height; y++) {
+        for (size_t x = 0; x < width; x++) {
+            for (size_t c = 0; c < 4; c++) {
+                data[y * bytesPerRow + x * 4 + c] = SDPixelKernelGoldenPattern(x, y, c);
+            }
+        }
+    }
+}
+
+// FNV-1a 64 bits
+static inline uint64_t SDPixelKernelGoldenHash(const uint8_t *data, size_t length) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= data[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+// The integer kernels are exact, so compare the hash of a 37x5 pattern, the odd width covers both the SIMD body and the scalar tail
+#define SDPixelKernelGoldenHashWidth 37
+#define SDPixelKernelGoldenHashHeight 5
+static const uint64_t SDPixelKernelGoldenPremultiplyLastHash = 0x6289a37c6e12a277ULL;
+static const uint64_t SDPixelKernelGoldenPremultiplyFirstHash = 0x6d76e980573532a5ULL;
+static const uint64_t SDPixelKernelGoldenUnpremultiplyLastHash = 0x00a78a2a71e3240aULL;
+static const uint64_t SDPixelKernelGoldenSwapRedBlueLastHash = 0xbcd0d231fe97f035ULL;
+static const uint64_t SDPixelKernelGoldenSwapRedBlueFirstHash = 0xe7d1f9c448260ad1ULL;
+
+// The float resize may differ by 1 between platforms (FMA contraction), so compare the bytes with tolerance 1
+#define SDPixelKernelGoldenDownscaleSourceWidth 9
+#define SDPixelKernelGoldenDownscaleSourceHeight 7
+#define SDPixelKernelGoldenDownscaleWidth 4
+#define SDPixelKernelGoldenDownscaleHeight 3
+static const uint8_t SDPixelKernelGoldenDownscale[3][4 * 3 * 4] = {
+    {64, 117, 170, 159, 139, 128, 117, 106, 148, 115, 126, 136, 71, 124, 177, 102, 122, 133, 143, 111, 117, 127, 138, 105, 126, 122, 118, 143, 135, 145, 113, 123, 138, 127, 116, 169, 91, 144, 197, 122, 139, 149, 117, 127, 145, 70, 123, 176},
+    {98, 128, 139, 145, 133, 112, 133, 119, 128, 130, 126, 126, 112, 126, 145, 110, 110, 131, 141, 118, 121, 132, 141, 115, 139, 113, 119, 132, 131, 129, 119, 134, 134, 140, 141, 132, 120, 140, 158, 142, 124, 130, 134, 135, 138, 103, 114, 143},
+    {86, 122, 132, 156, 134, 116, 142, 112, 140, 131, 120, 122, 103, 121, 143, 115, 123, 138, 139, 102, 116, 122, 133, 123, 132, 115, 124, 141, 147, 140, 114, 120, 128, 140, 146, 131, 126, 147, 166, 138, 121, 128, 128, 139, 131, 95, 116, 147},
+};
+#define SDPixelKernelGoldenUpscaleSourceWidth 3
+#define SDPixelKernelGoldenUpscaleSourceHeight 3
+#define SDPixelKernelGoldenUpscaleWidth 5
+#define SDPixelKernelGoldenUpscaleHeight 5
+static const uint8_t SDPixelKernelGoldenUpscale[3][5 * 5 * 4] = {
+    {0, 53, 106, 159, 0, 53, 106, 159, 37, 90, 143, 196, 74, 127, 180, 233, 74, 127, 180, 233, 0, 53, 106, 159, 0, 53, 106, 159, 37, 90, 143, 196, 74, 127, 180, 233, 74, 127, 180, 233, 91, 144, 197, 250, 91, 144, 197, 250, 129, 182, 235, 32, 167, 220, 17, 70, 167, 220, 17, 70, 182, 235, 32, 85, 182, 235, 32, 85, 221, 18, 71, 124, 4, 57, 110, 163, 4, 57, 110, 163, 182, 235, 32, 85, 182, 235, 32, 85, 221, 18, 71, 124, 4, 57, 110, 163, 4, 57, 110, 163},
+    {0, 53, 106, 159, 15, 68, 121, 174, 37, 90, 143, 196, 59, 112, 165, 218, 74, 127, 180, 233, 36, 89, 142, 195, 51, 104, 157, 169, 74, 127, 180, 130, 96, 149, 141, 153, 111, 164, 115, 168, 91, 144, 197, 250, 106, 159, 212, 163, 129, 182, 235, 32, 152, 205, 104, 55, 167, 220, 17, 70, 146, 199, 98, 151, 161, 153, 113, 125, 184, 84, 137, 87, 115, 107, 98, 110, 69, 122, 73, 126, 182, 235, 32, 85, 198, 148, 48, 101, 221, 18, 71, 124, 91, 41, 94, 147, 4, 57, 110, 163},
+    {0, 44, 89, 137, 2, 52, 95, 164, 30, 75, 128, 217, 53, 102, 180, 249, 60, 115, 207, 255, 19, 68, 146, 215, 26, 91, 173, 178, 58, 137, 190, 133, 104, 169, 145, 150, 127, 176, 108, 176, 88, 141, 186, 255, 100, 153, 232, 174, 129, 182, 235, 32, 158, 211, 93, 35, 170, 223, 0, 81, 153, 230, 89, 158, 188, 167, 116, 121, 200, 81, 134, 77, 115, 94, 90, 96, 51, 129, 54, 122, 177, 255, 9, 57, 227, 157, 16, 85, 228, 0, 50, 139, 68, 0, 105, 173, 0, 49, 132, 180},
+};
+
+#endif /* SDImagePixelKernelGolden_h */
@@ -217,6 +217,117 @@
     [self waitForExpectationsWithCommonTimeout];
 }
 
+- (void)testSDImageDecodeExecutor {
+    XCTestExpectation *expectation = [self expectationWithDescription:@"SDImageDecodeExecutor keep the dependency order"];
+    SDImageDecodeExecutor *executor = [[SDImageDecodeExecutor alloc] initWithMaxConcurrentDecodeCount:2];
+    expect(executor.maxConcurrentDecodeCount).equal(2);
+    expect(executor.maxPendingDecodeCount).equal(8);
+    
+    NSMutableArray<NSNumber *> *orders = [NSMutableArray array];
+    NSOperation *previousOperation;
+    for (int i = 0; i < 5; i++) {
+        NSArray<NSOperation *> *dependencies = previousOperation ? @[previousOperation] : nil;
+        previousOperation = [executor addDecodeBlock:^{
+            @synchronized (orders) {
+                [orders addObject:@(i)];
+            }
+        } dependencies:dependencies queuePriority:NSOperationQueuePriorityNormal qualityOfService:NSQualityOfServiceUserInitiated];
+    }
+    NSOperation *cancelledOperation = [executor addDecodeBlock:^{
+        XCTFail(@"Cancelled decoding should not execute");
+    } dependencies:@[previousOperation] queuePriority:NSOperationQueuePriorityLow qualityOfService:NSQualityOfServiceUtility];
+    [cancelledOperation cancel];
+    [executor addDecodeBlock:^{
+        dispatch_async(dispatch_get_main_queue(), ^{
+            expect(orders).equal(@[@0, @1, @2, @3, @4]);
+            expect(executor.finishedDecodeCount).beGreaterThanOrEqualTo(5);
+            expect(executor.totalDecodeDuration).beGreaterThanOrEqualTo(0);
+            [expectation fulfill];
+        });
+    } dependencies:@[previousOperation, cancelledOperation] queuePriority:NSOperationQueuePriorityHigh qualityOfService:NSQualityOfServiceUserInitiated];
+    
+    [self waitForExpectationsWithCommonTimeout];
+}
+
+- (void)testSDImagePixelBufferPool {
+    SDImagePixelBufferPool *pool = [SDImagePixelBufferPool new];
+    void *buffer = [pool acquireBufferWithLength:100 * 1024];
+    expect(buffer != NULL).beTruthy();
+    expect(pool.missCount).equal(1);
+    [pool recycleBuffer:buffer];
+    expect(pool.idleBytes).beGreaterThanOrEqualTo(100 * 1024);
+    // Similar length use the same bucket
+    void *reusedBuffer = [pool acquireBufferWithLength:100 * 1024 + 100];
+    expect(reusedBuffer == buffer).beTruthy();
+    expect(pool.hitCount).equal(1);
+    expect(pool.hitRate).equal(0.5);
+    expect(pool.idleBytes).equal(0);
+    [pool recycleBuffer:reusedBuffer];
+    
+    // The image shares the context's backing store, returned after both released
+    CGContextRef context = [pool newBitmapContextWithWidth:100 height:100 bitsPerComponent:8 bytesPerRow:0 colorSpace:SDImageCoderHelper.colorSpaceGetDeviceRGB bitmapInfo:kCGBitmapByteOrderDefault | kCGImageAlphaPremultipliedLast];
+    expect(context != NULL).beTruthy();
+    expect(pool.hitCount).equal(2);
+    CGContextSetFillColorWithColor(context, [UIColor redColor].CGColor);
+    CGContextFillRect(context, CGRectMake(0, 0, 100, 100));
+    CGImageRef imageRef = [pool newImageFromBitmapContext:context];
+    expect(CGImageGetWidth(imageRef)).equal(100);
+    // The pooled image reports the whole bucket
+    expect([pool backingStoreLengthForImage:imageRef]).beGreaterThanOrEqualTo(CGImageGetBytesPerRow(imageRef) * 100);
+    CGContextRelease(context);
+    expect(pool.idleBytes).equal(0);
+    NSData *pixelData = (__bridge_transfer NSData *)CGDataProviderCopyData(CGImageGetDataProvider(imageRef));
+    const uint8_t *pixels = pixelData.bytes;
+    expect(pixels[0]).beGreaterThan(200);
+    expect(pixels[1]).beLessThan(50);
+    expect(pixels[3]).equal(255);
+    CGImageRelease(imageRef);
+    expect(pool.idleBytes).beGreaterThan(0);
+    
+    // The reused buffer is cleared for the new context, same as the fresh one
+    CGContextRef reusedContext = [pool newBitmapContextWithWidth:100 height:100 bitsPerComponent:8 bytesPerRow:0 colorSpace:SDImageCoderHelper.colorSpaceGetDeviceRGB bitmapInfo:kCGBitmapByteOrderDefault | kCGImageAlphaPremultipliedLast];
+    expect(pool.hitCount).equal(3);
+    const uint8_t *reusedPixels = CGBitmapContextGetData(reusedContext);
+    size_t reusedLength = CGBitmapContextGetBytesPerRow(reusedContext) * 100;
+    BOOL zeroFilled = YES;
+    for (size_t i = 0; i < reusedLength; i++) {
+        if (reusedPixels[i] != 0) {
+            zeroFilled = NO;
+            break;
+        }
+    }
+    expect(zeroFilled).beTruthy();
+    CGContextRelease(reusedContext);
+    
+    // The idle buffers are bounded
+    pool.maxIdleBytes = 0;
+    expect(pool.idleBytes).equal(0);
+    [pool resetStatistics];
+    expect(pool.hitRate).equal(0);
+    
+    // Decoded images reuse the shared pool during scrolling
+    SDImagePixelBufferPool *sharedPool = SDImagePixelBufferPool.sharedPool;
+    UIImage *image = [[UIImage alloc] initWithContentsOfFile:[self testJPEGPath]];
+    @autoreleasepool {
+        CGImageRef decodedImageRef = [SDImageCoderHelper CGImageCreateDecoded:image.CGImage];
+        CGImageRelease(decodedImageRef);
+    }
+    NSUInteger hitCount = sharedPool.hitCount;
+    @autoreleasepool {
+        CGImageRef decodedImageRef = [SDImageCoderHelper CGImageCreateDecoded:image.CGImage];
+        // The memory cost counts the whole bucket of pooled backing store
+        size_t backingStoreLength = [sharedPool backingStoreLengthForImage:decodedImageRef];
+        expect(backingStoreLength).beGreaterThanOrEqualTo(CGImageGetBytesPerRow(decodedImageRef) * CGImageGetHeight(decodedImageRef));
+#if SD_UIKIT
+        UIImage *decodedImage = [[UIImage alloc] initWithCGImage:decodedImageRef];
+        expect(decodedImage.sd_memoryCost).equal(backingStoreLength);
+#endif
+        CGImageRelease(decodedImageRef);
+    }
+    expect(sharedPool.hitCount).beGreaterThan(hitCount);
+    expect([sharedPool backingStoreLengthForImage:image.CGImage]).equal(0);
+}
+
 - (void)testInternalMacro {
     @weakify(self);
     @onExit {
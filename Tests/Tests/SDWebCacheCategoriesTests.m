@@ -666,6 +666,64 @@
     
 }
 
+#if SD_UIKIT
+- (void)testUIViewThumbnailFromViewBoundsWorks {
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Thumbnail pixel size should derive from view bounds"];
+    UIImageView *imageView = [[UIImageView alloc] initWithFrame:CGRectMake(0, 0, 40, 30)];
+    imageView.contentMode = UIViewContentModeScaleAspectFit;
+    NSString *testImagePath = [[NSBundle bundleForClass:[self class]] pathForResource:@"TestImageLarge" ofType:@"jpg"];
+    NSURL *url = [NSURL fileURLWithPath:testImagePath];
+    CGFloat scale = imageView.traitCollection.displayScale ?: UIScreen.mainScreen.scale;
+    [imageView sd_setImageWithURL:url placeholderImage:nil options:SDWebImageThumbnailFromViewBounds | SDWebImageFromLoaderOnly completed:^(UIImage * _Nullable image, NSError * _Nullable error, SDImageCacheType cacheType, NSURL * _Nullable imageURL) {
+        expect(image).notTo.beNil();
+        expect(image.sd_isThumbnail).beTruthy();
+        expect(image.size.width * image.scale).beLessThanOrEqualTo(ceil(40 * scale));
+        expect(image.size.height * image.scale).beLessThanOrEqualTo(ceil(30 * scale));
+        [expectation fulfill];
+    }];
+    [self waitForExpectationsWithCommonTimeout];
+}
+
+- (void)testUIViewThumbnailFromViewBoundsAspectFill {
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Aspect fill thumbnail should cover the view bounds"];
+    UIImageView *imageView = [[UIImageView alloc] initWithFrame:CGRectMake(0, 0, 40, 30)];
+    imageView.contentMode = UIViewContentModeScaleAspectFill;
+    NSString *testImagePath = [[NSBundle bundleForClass:[self class]] pathForResource:@"TestImageLarge" ofType:@"jpg"];
+    NSURL *url = [NSURL fileURLWithPath:testImagePath];
+    UIImage *fullImage = [[UIImage alloc] initWithContentsOfFile:testImagePath];
+    CGFloat scale = imageView.traitCollection.displayScale ?: UIScreen.mainScreen.scale;
+    CGFloat fillScale = MAX(40 * scale / (fullImage.size.width * fullImage.scale), 30 * scale / (fullImage.size.height * fullImage.scale));
+    [imageView sd_setImageWithURL:url placeholderImage:nil options:SDWebImageThumbnailFromViewBounds | SDWebImageFromLoaderOnly completed:^(UIImage * _Nullable image, NSError * _Nullable error, SDImageCacheType cacheType, NSURL * _Nullable imageURL) {
+        expect(image).notTo.beNil();
+        expect(image.sd_isThumbnail).beTruthy();
+        // Both dimensions cover the view, and the image is scaled by the fill scale
+        expect(image.size.width * image.scale).beGreaterThanOrEqualTo(floor(40 * scale));
+        expect(image.size.height * image.scale).beGreaterThanOrEqualTo(floor(30 * scale));
+        expect(image.size.width * image.scale).beCloseToWithin(ceil(fullImage.size.width * fullImage.scale * fillScale), 2);
+        [expectation fulfill];
+    }];
+    [self waitForExpectationsWithCommonTimeout];
+}
+
+- (void)testUIViewOffscreenPauseProgressiveDecode {
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Off-screen view should pause progressive decoding"];
+    // Not in window
+    UIImageView *imageView = [[UIImageView alloc] init];
+    __block SDWebImageCombinedOperation *operation;
+    operation = (SDWebImageCombinedOperation *)[imageView sd_internalSetImageWithURL:[NSURL URLWithString:kTestProgressiveJPEGURL] placeholderImage:nil options:SDWebImageProgressiveLoad | SDWebImageFromLoaderOnly context:nil setImageBlock:nil progress:nil completed:^(UIImage * _Nullable image, NSData * _Nullable data, NSError * _Nullable error, SDImageCacheType cacheType, BOOL finished, NSURL * _Nullable imageURL) {
+        if (!finished) {
+            return;
+        }
+        expect(image).notTo.beNil();
+        SDWebImageDownloadToken *token = (SDWebImageDownloadToken *)operation.loaderOperation;
+        expect(token).beKindOf(SDWebImageDownloadToken.class);
+        expect(token.isProgressiveDecodePaused).beTruthy();
+        [expectation fulfill];
+    }];
+    [self waitForExpectationsWithCommonTimeout];
+}
+#endif
+
 #pragma mark - Helper
 
 - (NSString *)testJPEGPath {
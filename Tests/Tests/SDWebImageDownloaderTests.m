@@ -11,6 +11,7 @@
 #import "SDWebImageTestDownloadOperation.h"
 #import "SDWebImageTestCoder.h"
 #import "SDWebImageTestLoader.h"
+#import "SDWebImageTestURLProtocol.h"
 #import <compression.h>
 
 #define kPlaceholderTestURLTemplate @"https://placehold.co/10000x%d.png"
@@ -27,6 +28,35 @@
 @end
 
 
+// The batch adapter which loads the same local image for every URL in batch
+@interface SDWebImageTestBatchAdapter : NSObject <SDWebImageBatchLoaderAdapter>
+@property (nonatomic, strong) NSURL *batchURL;
+@property (nonatomic, assign) NSUInteger batchRequestCount;
+@property (nonatomic, copy) NSArray<NSURL *> *lastBatchURLs;
+@end
+
+@implementation SDWebImageTestBatchAdapter
+
+- (NSString *)batchKeyForURL:(NSURL *)url {
+    return [url.scheme isEqualToString:@"batch"] ? url.host : nil;
+}
+
+- (NSURLRequest *)batchRequestWithURLs:(NSArray<NSURL *> *)URLs batchKey:(NSString *)batchKey {
+    self.batchRequestCount++;
+    self.lastBatchURLs = URLs;
+    return [NSURLRequest requestWithURL:self.batchURL];
+}
+
+- (NSDictionary<NSURL *, NSData *> *)imageDataWithBatchData:(NSData *)data response:(NSURLResponse *)response URLs:(NSArray<NSURL *> *)URLs {
+    NSMutableDictionary<NSURL *, NSData *> *imageDatas = [NSMutableDictionary dictionary];
+    for (NSURL *URL in URLs) {
+        imageDatas[URL] = data;
+    }
+    return imageDatas;
+}
+
+@end
+
 @interface SDWebImageDownloaderTests : SDTestCase
 
 @property (nonatomic, strong) NSMutableArray<NSURL *> *executionOrderURLs;
@@ -772,7 +802,7 @@
 
 - (void)test30ThatDifferentThumbnailLoadShouldCallbackDifferentSize {
     // We move the logic into SDWebImageDownloaderOperation, which decode each callback's thumbnail size with different decoding pipeline, and callback independently
-    // Note the progressiveLoad does not support this and always callback first size
+    // Note the progressiveLoad callback the partial images with first size, the final image use each callback's size
     
     NSURL *url = [NSURL URLWithString:@"https://placehold.co/501x501.png"];
     NSString *fullSizeKey = [SDWebImageManager.sharedManager cacheKeyForURL:url];
@@ -856,6 +886,244 @@
     [self waitForExpectations:expectations timeout:kAsyncTestTimeout * 2];
 }
 
+- (void)test32ThatCoalescingKeyFilterShareDownloadOperation {
+    XCTestExpectation *expectation1 = [self expectationWithDescription:@"First request with tracking query should callback"];
+    XCTestExpectation *expectation2 = [self expectationWithDescription:@"Second request with tracking query should callback"];
+    SDWebImageDownloader *downloader = [[SDWebImageDownloader alloc] init];
+    downloader.coalescingKeyFilter = [SDWebImageCacheKeyFilter cacheKeyFilterWithBlock:^NSString * _Nullable(NSURL * _Nonnull url) {
+        NSURLComponents *components = [NSURLComponents componentsWithURL:url resolvingAgainstBaseURL:NO];
+        components.query = nil;
+        return components.URL.absoluteString;
+    }];
+    NSURL *url1 = [NSURL URLWithString:@"https://placehold.co/301x301.png?utm_source=1"];
+    NSURL *url2 = [NSURL URLWithString:@"https://placehold.co/301x301.png?utm_source=2"];
+    CGSize thumbnailSize = CGSizeMake(100, 100);
+    SDWebImageDownloadToken *token1 = [downloader downloadImageWithURL:url1 completed:^(UIImage * _Nullable image, NSData * _Nullable data, NSError * _Nullable error, BOOL finished) {
+        expect(image.size).equal(CGSizeMake(301, 301));
+        [expectation1 fulfill];
+    }];
+    // Each subscriber still use its own decode options
+    SDWebImageDownloadToken *token2 = [downloader downloadImageWithURL:url2 options:0 context:@{SDWebImageContextImageThumbnailPixelSize : @(thumbnailSize)} progress:nil completed:^(UIImage * _Nullable image, NSData * _Nullable data, NSError * _Nullable error, BOOL finished) {
+        expect(image.size).equal(thumbnailSize);
+        [expectation2 fulfill];
+    }];
+    expect(token1.downloadOperation).notTo.beNil();
+    expect(token1.downloadOperation).equal(token2.downloadOperation);
+    expect(token2.url).equal(url2);
+    
+    [self waitForExpectationsWithCommonTimeoutUsingHandler:^(NSError * _Nullable error) {
+        [downloader invalidateSessionAndCancel:YES];
+    }];
+}
+
+- (void)test33ThatProgressiveLoadFinalImageUseEachDecodeOptions {
+    XCTestExpectation *expectation1 = [self expectationWithDescription:@"Progressive load first request should callback final animated image"];
+    XCTestExpectation *expectation2 = [self expectationWithDescription:@"Progressive load coalesced thumbnail request should callback final thumbnail image"];
+    SDWebImageDownloader *downloader = [[SDWebImageDownloader alloc] init];
+    NSURL *url = [NSURL fileURLWithPath:[self testGIFPath]];
+    CGSize thumbnailSize = CGSizeMake(50, 50);
+    SDWebImageDownloadToken *token1 = [downloader downloadImageWithURL:url options:SDWebImageDownloaderProgressiveLoad context:@{SDWebImageContextAnimatedImageClass : SDAnimatedImage.class} progress:nil completed:^(UIImage * _Nullable image, NSData * _Nullable data, NSError * _Nullable error, BOOL finished) {
+        if (!finished) {
+            return;
+        }
+        expect(image).beKindOf(SDAnimatedImage.class);
+        expect(image.sd_isIncremental).beFalsy();
+        [expectation1 fulfill];
+    }];
+    // The final image is fully decoded with its own options, instead of the first request's progressive decoder
+    SDWebImageDownloadToken *token2 = [downloader downloadImageWithURL:url options:SDWebImageDownloaderProgressiveLoad context:@{SDWebImageContextImageThumbnailPixelSize : @(thumbnailSize)} progress:nil completed:^(UIImage * _Nullable image, NSData * _Nullable data, NSError * _Nullable error, BOOL finished) {
+        if (!finished) {
+            return;
+        }
+        expect(image.sd_isAnimated).beTruthy();
+        expect(image.size.width).beLessThanOrEqualTo(thumbnailSize.width);
+        expect(image.size.height).beLessThanOrEqualTo(thumbnailSize.height);
+        [expectation2 fulfill];
+    }];
+    expect(token1.downloadOperation).equal(token2.downloadOperation);
+    
+    [self waitForExpectationsWithCommonTimeoutUsingHandler:^(NSError * _Nullable error) {
+        [downloader invalidateSessionAndCancel:YES];
+    }];
+}
+
+- (void)test34ThatProgressiveDecodeThrottleWorks {
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Progressive decode should be throttled"];
+    SDWebImageDownloaderConfig *config = [[SDWebImageDownloaderConfig alloc] init];
+    config.minimumProgressiveDecodeInterval = 100; // This will make only the first progressive decoding pass happen
+    SDWebImageDownloader *downloader = [[SDWebImageDownloader alloc] initWithConfig:config];
+    
+    __block NSUInteger partialImageCount = 0;
+    __block SDWebImageDownloadToken *token;
+    token = [downloader downloadImageWithURL:[NSURL URLWithString:kTestProgressiveJPEGURL] options:SDWebImageDownloaderProgressiveLoad progress:nil completed:^(UIImage * _Nullable image, NSData * _Nullable data, NSError * _Nullable error, BOOL finished) {
+        if (!finished) {
+            partialImageCount++;
+            return;
+        }
+        expect(error).beNil();
+        expect(image).notTo.beNil();
+        expect(partialImageCount).beLessThanOrEqualTo(1);
+        [expectation fulfill];
+    }];
+    
+    [self waitForExpectationsWithCommonTimeoutUsingHandler:^(NSError * _Nullable error) {
+        [downloader invalidateSessionAndCancel:YES];
+    }];
+}
+
+- (void)test35ThatPausedProgressiveDecodeOnlyCallbackFinalImage {
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Paused progressive decode should only callback final image"];
+    SDWebImageDownloaderConfig *config = [[SDWebImageDownloaderConfig alloc] init];
+    config.sessionConfiguration = SDWebImageTestURLProtocol.sessionConfiguration;
+    SDWebImageDownloader *downloader = [[SDWebImageDownloader alloc] initWithConfig:config];
+    NSURL *url = [NSURL URLWithString:@"http://via.placeholder.com/paused-progressive.jpg"];
+    NSData *imageData = [NSData dataWithContentsOfFile:[[NSBundle bundleForClass:[self class]] pathForResource:@"TestImage" ofType:@"jpg"]];
+    // The response is held until the download is paused, then the data arrives in 4 chunks
+    dispatch_semaphore_t pausedSemaphore = dispatch_semaphore_create(0);
+    [SDWebImageTestURLProtocol stubURL:url chunkSize:(imageData.length + 3) / 4 responseBlock:^NSHTTPURLResponse * _Nonnull(NSURLRequest * _Nonnull request, NSData * _Nullable __autoreleasing * _Nonnull data) {
+        dispatch_semaphore_wait(pausedSemaphore, DISPATCH_TIME_FOREVER);
+        *data = imageData;
+        return [[NSHTTPURLResponse alloc] initWithURL:request.URL statusCode:200 HTTPVersion:@"HTTP/1.1" headerFields:@{@"Content-Type" : @"image/jpeg", @"Content-Length" : @(imageData.length).stringValue}];
+    }];
+    
+    __block SDWebImageDownloadToken *token;
+    token = [downloader downloadImageWithURL:url options:SDWebImageDownloaderProgressiveLoad progress:nil completed:^(UIImage * _Nullable image, NSData * _Nullable data, NSError * _Nullable error, BOOL finished) {
+        expect(finished).beTruthy();
+        expect(error).beNil();
+        expect(image).notTo.beNil();
+        // The skipped count is captured when download stopped
+        dispatch_async(dispatch_get_main_queue(), ^{
+            // The partial chunks skip the progressive decoding pass
+            expect(token.skippedProgressiveDecodeCount).beGreaterThan(0);
+            [expectation fulfill];
+        });
+    }];
+    token.progressiveDecodePaused = YES;
+    dispatch_semaphore_signal(pausedSemaphore);
+
+    [self waitForExpectationsWithCommonTimeoutUsingHandler:^(NSError * _Nullable error) {
+        [SDWebImageTestURLProtocol removeAllStubs];
+        [downloader invalidateSessionAndCancel:YES];
+    }];
+}
+
+- (void)test36ThatHedgeRequestWorks {
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Hedge request should race with the original request"];
+    SDWebImageDownloaderHedgePolicy *hedgePolicy = [[SDWebImageDownloaderHedgePolicy alloc] init];
+    // Hedge immediately, and each request earns one hedge
+    hedgePolicy.initialDeadline = 0;
+    hedgePolicy.minimumDeadline = 0;
+    hedgePolicy.budgetRatio = 1;
+    __block BOOL hedgeRequestModified = NO;
+    hedgePolicy.requestModifier = [SDWebImageDownloaderRequestModifier requestModifierWithBlock:^NSURLRequest * _Nullable(NSURLRequest * _Nonnull request) {
+        hedgeRequestModified = YES;
+        NSMutableURLRequest *mutableRequest = [request mutableCopy];
+        [mutableRequest setValue:@"1" forHTTPHeaderField:@"X-Hedge-Request"];
+        return [mutableRequest copy];
+    }];
+    SDWebImageDownloaderConfig *config = [[SDWebImageDownloaderConfig alloc] init];
+    config.hedgePolicy = hedgePolicy;
+    config.sessionConfiguration = SDWebImageTestURLProtocol.sessionConfiguration;
+    SDWebImageDownloader *downloader = [[SDWebImageDownloader alloc] initWithConfig:config];
+    NSURL *url = [NSURL URLWithString:@"http://via.placeholder.com/hedge.png"];
+    NSData *imageData = [NSData dataWithContentsOfFile:[self testPNGPath]];
+    // The original response is held until the hedge request is issued, so the hedge always happens
+    dispatch_semaphore_t hedgeSemaphore = dispatch_semaphore_create(0);
+    [SDWebImageTestURLProtocol stubURL:url responseBlock:^NSHTTPURLResponse * _Nonnull(NSURLRequest * _Nonnull request, NSData * _Nullable __autoreleasing * _Nonnull data) {
+        if ([request valueForHTTPHeaderField:@"X-Hedge-Request"]) {
+            dispatch_semaphore_signal(hedgeSemaphore);
+        } else {
+            dispatch_semaphore_wait(hedgeSemaphore, dispatch_time(DISPATCH_TIME_NOW, (int64_t)(kAsyncTestTimeout * NSEC_PER_SEC)));
+        }
+        *data = imageData;
+        return [[NSHTTPURLResponse alloc] initWithURL:request.URL statusCode:200 HTTPVersion:@"HTTP/1.1" headerFields:@{@"Content-Type" : @"image/png"}];
+    }];
+
+    [downloader downloadImageWithURL:url options:0 progress:nil completed:^(UIImage * _Nullable image, NSData * _Nullable data, NSError * _Nullable error, BOOL finished) {
+        expect(error).beNil();
+        expect(image).notTo.beNil();
+        expect(hedgeRequestModified).beTruthy();
+        expect([SDWebImageTestURLProtocol requestCountForURL:url]).equal(2);
+        expect(hedgePolicy.hedgedRequestCount).equal(1);
+        expect(hedgePolicy.hedgeWinCount).beLessThanOrEqualTo(1);
+        [expectation fulfill];
+    }];
+
+    [self waitForExpectationsWithCommonTimeoutUsingHandler:^(NSError * _Nullable error) {
+        [SDWebImageTestURLProtocol removeAllStubs];
+        [downloader invalidateSessionAndCancel:YES];
+    }];
+}
+
+- (void)test37ThatDownloaderStatisticsWorks {
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Downloader statistics should record the data usage"];
+    SDWebImageDownloader *downloader = [[SDWebImageDownloader alloc] init];
+    NSURL *url = [NSURL URLWithString:kTestJPEGURL];
+
+    // The second request coalesces into the first one
+    [downloader downloadImageWithURL:url options:0 progress:nil completed:^(UIImage * _Nullable image, NSData * _Nullable data, NSError * _Nullable error, BOOL finished) {}];
+    [downloader downloadImageWithURL:url options:0 progress:nil completed:^(UIImage * _Nullable image, NSData * _Nullable data, NSError * _Nullable error, BOOL finished) {
+        expect(error).beNil();
+        SDWebImageDownloaderStatisticsSnapshot *snapshot = downloader.statistics.snapshot;
+        expect(snapshot.requestCount).equal(1);
+        expect(snapshot.completedCount).equal(1);
+        expect(snapshot.receivedBytes).equal(data.length);
+        expect(snapshot.coalescedRequestCount).equal(1);
+        expect(snapshot.coalescedBytes).equal(data.length);
+        expect([[snapshot.timeToFirstByteHistogram valueForKeyPath:@"@sum.self"] unsignedIntegerValue]).equal(1);
+        expect(snapshot.timeToFirstByteHistogram.count).equal(SDWebImageDownloaderStatistics.histogramBucketUpperBounds.count);
+        SDWebImageDownloaderStatisticsSnapshot *hostSnapshot = snapshot.hostSnapshots[url.host];
+        expect(hostSnapshot.receivedBytes).equal(data.length);
+        expect(hostSnapshot.hostSnapshots).beNil();
+        [downloader.statistics reset];
+        expect(downloader.statistics.snapshot.receivedBytes).equal(0);
+        [expectation fulfill];
+    }];
+
+    [self waitForExpectationsWithCommonTimeoutUsingHandler:^(NSError * _Nullable error) {
+        [downloader invalidateSessionAndCancel:YES];
+    }];
+}
+
+- (void)test38ThatDownloaderStatisticsCountPerOperation {
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Downloader statistics should skip cancelled subscribers and count 304 as completed"];
+    SDWebImageDownloaderConfig *config = [[SDWebImageDownloaderConfig alloc] init];
+    config.sessionConfiguration = SDWebImageTestURLProtocol.sessionConfiguration;
+    SDWebImageDownloader *downloader = [[SDWebImageDownloader alloc] initWithConfig:config];
+    NSURL *url = [NSURL URLWithString:@"http://via.placeholder.com/statistics.png"];
+    NSURL *notModifiedURL = [NSURL URLWithString:@"http://via.placeholder.com/statistics-304.png"];
+    NSData *imageData = [NSData dataWithContentsOfFile:[self testPNGPath]];
+    [SDWebImageTestURLProtocol stubURL:url statusCode:200 headerFields:@{@"Content-Type" : @"image/png"} data:imageData];
+    [SDWebImageTestURLProtocol stubURL:notModifiedURL statusCode:304 headerFields:nil data:nil];
+
+    // The cancelled subscriber does not receive any bytes, so it's not coalesced
+    [downloader downloadImageWithURL:url options:0 progress:nil completed:nil];
+    SDWebImageDownloadToken *cancelledToken = [downloader downloadImageWithURL:url options:0 progress:nil completed:nil];
+    [cancelledToken cancel];
+    [downloader downloadImageWithURL:url options:0 progress:nil completed:^(UIImage * _Nullable image, NSData * _Nullable data, NSError * _Nullable error, BOOL finished) {
+        expect(error).beNil();
+        SDWebImageDownloaderStatisticsSnapshot *snapshot = downloader.statistics.snapshot;
+        expect(snapshot.requestCount).equal(1);
+        expect(snapshot.completedCount).equal(1);
+        expect(snapshot.receivedBytes).equal(imageData.length);
+        expect(snapshot.coalescedRequestCount).equal(1);
+        [downloader.statistics reset];
+
+        [downloader downloadImageWithURL:notModifiedURL options:0 progress:nil completed:^(UIImage * _Nullable image, NSData * _Nullable data, NSError * _Nullable error, BOOL finished) {
+            expect(error.code).equal(SDWebImageErrorCacheNotModified);
+            SDWebImageDownloaderStatisticsSnapshot *notModifiedSnapshot = downloader.statistics.snapshot;
+            expect(notModifiedSnapshot.completedCount).equal(1);
+            expect(notModifiedSnapshot.failedCount).equal(0);
+            [expectation fulfill];
+        }];
+    }];
+
+    [self waitForExpectationsWithCommonTimeoutUsingHandler:^(NSError * _Nullable error) {
+        [SDWebImageTestURLProtocol removeAllStubs];
+        [downloader invalidateSessionAndCancel:YES];
+    }];
+}
+
 #pragma mark - SDWebImageLoader
 - (void)testCustomImageLoaderWorks {
     XCTestExpectation *expectation = [self expectationWithDescription:@"Custom image not works"];
@@ -901,6 +1169,52 @@
     [self waitForExpectationsWithCommonTimeout];
 }
 
+- (void)testThatBatchLoaderWorks {
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Batch loader should collect requests into one batched request"];
+    SDWebImageTestBatchAdapter *adapter = [SDWebImageTestBatchAdapter new];
+    adapter.batchURL = [NSURL fileURLWithPath:[self testPNGPath]];
+    SDWebImageBatchLoader *loader = [[SDWebImageBatchLoader alloc] initWithAdapter:adapter];
+    loader.batchWindow = 0.1;
+    SDImageLoadersManager *manager = [[SDImageLoadersManager alloc] init];
+    [manager addLoader:loader];
+    NSURL *url1 = [NSURL URLWithString:@"batch://tiles/1.png"];
+    NSURL *url2 = [NSURL URLWithString:@"batch://tiles/2.png"];
+    NSURL *url3 = [NSURL URLWithString:@"batch://tiles/3.png"];
+    expect([manager canRequestImageForURL:url1 options:0 context:nil]).beTruthy();
+    expect([loader canRequestImageForURL:[NSURL URLWithString:kTestJPEGURL] options:0 context:nil]).beFalsy();
+    
+    __block NSUInteger completedCount = 0;
+    void(^completion)(UIImage *, NSData *, NSError *, BOOL) = ^(UIImage * _Nullable image, NSData * _Nullable data, NSError * _Nullable error, BOOL finished) {
+        expect(error).beNil();
+        expect(image).notTo.beNil();
+        completedCount++;
+        if (completedCount == 2) {
+            expect(adapter.batchRequestCount).equal(1);
+            expect(adapter.lastBatchURLs).equal(@[url1, url2]);
+            [expectation fulfill];
+        }
+    };
+    [manager requestImageWithURL:url1 options:0 context:nil progress:nil completed:completion];
+    [manager requestImageWithURL:url2 options:0 context:nil progress:nil completed:completion];
+    // Cancelled request should be excluded from batch
+    id<SDWebImageOperation> operation = [manager requestImageWithURL:url3 options:0 context:nil progress:nil completed:^(UIImage * _Nullable image, NSData * _Nullable data, NSError * _Nullable error, BOOL finished) {
+        expect(error.code).equal(SDWebImageErrorCancelled);
+    }];
+    [operation cancel];
+    
+    [self waitForExpectationsWithCommonTimeout];
+}
+
+- (void)testThatBatchLoaderSplitMultipartResponse {
+    NSURL *url = [NSURL URLWithString:@"https://example.com/batch"];
+    NSHTTPURLResponse *response = [[NSHTTPURLResponse alloc] initWithURL:url statusCode:200 HTTPVersion:@"HTTP/1.1" headerFields:@{@"Content-Type" : @"multipart/mixed; boundary=\"sd-boundary\""}];
+    NSString *body = @"--sd-boundary\r\nContent-Type: image/png\r\nContent-Location: /tiles/1.png\r\n\r\nfirst\r\n--sd-boundary\r\ncontent-location: /tiles/2.png\r\n\r\nsecond\r\n--sd-boundary--\r\n";
+    NSDictionary<NSString *, NSData *> *parts = [SDWebImageBatchLoader partsFromMultipartData:[body dataUsingEncoding:NSUTF8StringEncoding] response:response];
+    expect(parts.count).equal(2);
+    expect(parts[@"/tiles/1.png"]).equal([@"first" dataUsingEncoding:NSUTF8StringEncoding]);
+    expect(parts[@"/tiles/2.png"]).equal([@"second" dataUsingEncoding:NSUTF8StringEncoding]);
+}
+
 #pragma mark - Helper
 
 - (NSString *)testPNGPath {
@@ -908,4 +1222,9 @@
     return [testBundle pathForResource:@"TestImage" ofType:@"png"];
 }
 
+- (NSString *)testGIFPath {
+    NSBundle *testBundle = [NSBundle bundleForClass:[self class]];
+    return [testBundle pathForResource:@"TestImage" ofType:@"gif"];
+}
+
 @end
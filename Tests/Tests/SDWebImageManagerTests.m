@@ -10,6 +10,7 @@
 #import "SDWebImageTestTransformer.h"
 #import "SDWebImageTestCache.h"
 #import "SDWebImageTestLoader.h"
+#import "SDWebImageTestURLProtocol.h"
 
 // Keep strong references for object
 @interface SDObjectContainer<ObjectType> : NSObject
@@ -663,6 +664,180 @@
     [self waitForExpectationsWithCommonTimeout];
 }
 
+- (void)test23ThatFailedURLPolicyBackoffWorks {
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Failed URL policy should block with exponential backoff and circuit breaker"];
+    SDWebImageFailedURLPolicy *policy = [SDWebImageFailedURLPolicy new];
+    policy.initialBackoff = 0.2;
+    policy.jitter = 0;
+    policy.hostFailureThreshold = 2;
+    policy.hostOpenDuration = 0.2;
+    NSURL *url1 = [NSURL URLWithString:@"http://www.example.com/1.png"];
+    NSURL *url2 = [NSURL URLWithString:@"http://www.example.com/2.png"];
+    NSURL *url3 = [NSURL URLWithString:@"http://www.example.com/3.png"];
+    NSURL *otherHostURL = [NSURL URLWithString:@"http://www.example.org/1.png"];
+    NSError *notFoundError = [NSError errorWithDomain:SDWebImageErrorDomain code:SDWebImageErrorInvalidDownloadStatusCode userInfo:@{SDWebImageErrorDownloadStatusCodeKey : @(404)}];
+    NSError *hostError = [NSError errorWithDomain:NSURLErrorDomain code:NSURLErrorCannotConnectToHost userInfo:nil];
+    
+    // URL backoff
+    [policy recordFailureForURL:url1 error:notFoundError];
+    expect([policy shouldBlockURL:url1 ignoreBackoff:NO]).beTruthy();
+    expect([policy shouldBlockURL:url1 ignoreBackoff:YES]).beFalsy();
+    expect([policy isHostBlockedForURL:url1]).beFalsy();
+    // Host circuit breaker
+    [policy recordFailureForURL:url2 error:hostError];
+    [policy recordFailureForURL:url3 error:hostError];
+    expect([policy isHostBlockedForURL:url1]).beTruthy();
+    expect([policy shouldBlockURL:url1 ignoreBackoff:YES]).beTruthy();
+    expect([policy shouldBlockURL:otherHostURL ignoreBackoff:NO]).beFalsy();
+    
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(0.3 * NSEC_PER_SEC)), dispatch_get_main_queue(), ^{
+        // Half-open, only a single probe request is allowed
+        expect([policy shouldBlockURL:url1 ignoreBackoff:NO]).beFalsy();
+        expect([policy shouldBlockURL:url1 ignoreBackoff:NO]).beTruthy();
+        // Probe success closes the circuit
+        [policy recordSuccessForURL:url1];
+        expect([policy isHostBlockedForURL:url2]).beFalsy();
+        // The backoff grows on each consecutive failure
+        [policy recordFailureForURL:url1 error:notFoundError];
+        [policy recordFailureForURL:url1 error:notFoundError];
+        dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(0.3 * NSEC_PER_SEC)), dispatch_get_main_queue(), ^{
+            expect([policy shouldBlockURL:url1 ignoreBackoff:NO]).beTruthy();
+            [policy removeAllURLs];
+            expect([policy shouldBlockURL:url1 ignoreBackoff:NO]).beFalsy();
+            [expectation fulfill];
+        });
+    });
+    [self waitForExpectationsWithCommonTimeout];
+}
+
+- (void)test24ThatManagerUseFailedURLPolicy {
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Manager should use failed URL policy instead of permanent blocking"];
+    SDWebImageDownloaderConfig *config = [[SDWebImageDownloaderConfig alloc] init];
+    config.sessionConfiguration = SDWebImageTestURLProtocol.sessionConfiguration;
+    SDWebImageDownloader *downloader = [[SDWebImageDownloader alloc] initWithConfig:config];
+    SDImageCache *cache = [[SDImageCache alloc] initWithNamespace:@"FailedURLPolicy"];
+    SDWebImageManager *manager = [[SDWebImageManager alloc] initWithCache:cache loader:downloader];
+    SDWebImageFailedURLPolicy *policy = [SDWebImageFailedURLPolicy new];
+    policy.jitter = 0;
+    manager.failedURLPolicy = policy;
+    NSURL *url = [NSURL URLWithString:@"http://via.placeholder.com/failedURLPolicy.png"];
+    [SDWebImageTestURLProtocol stubURL:url statusCode:404 headerFields:nil data:nil];
+    [manager loadImageWithURL:url options:0 progress:nil completed:^(UIImage * _Nullable image, NSData * _Nullable data, NSError * _Nullable error, SDImageCacheType cacheType, BOOL finished, NSURL * _Nullable imageURL) {
+        expect(error.code).equal(SDWebImageErrorInvalidDownloadStatusCode);
+        expect([policy shouldBlockURL:url ignoreBackoff:NO]).beTruthy();
+        [manager loadImageWithURL:url options:0 progress:nil completed:^(UIImage * _Nullable image2, NSData * _Nullable data2, NSError * _Nullable error2, SDImageCacheType cacheType2, BOOL finished2, NSURL * _Nullable imageURL2) {
+            expect(error2.code).equal(SDWebImageErrorBlackListed);
+            expect([SDWebImageTestURLProtocol requestCountForURL:url]).equal(1);
+            // The backoff does not block the cached image
+            UIImage *cachedImage = [[UIImage alloc] initWithContentsOfFile:[self testJPEGPath]];
+            [cache storeImageToMemory:cachedImage forKey:[manager cacheKeyForURL:url]];
+            [manager loadImageWithURL:url options:0 progress:nil completed:^(UIImage * _Nullable image3, NSData * _Nullable data3, NSError * _Nullable error3, SDImageCacheType cacheType3, BOOL finished3, NSURL * _Nullable imageURL3) {
+                expect(error3).beNil();
+                expect(image3).equal(cachedImage);
+                expect(cacheType3).equal(SDImageCacheTypeMemory);
+                // The 404 is not blocked permanently by the downloader
+                [manager removeFailedURL:url];
+                expect([policy shouldBlockURL:url ignoreBackoff:NO]).beFalsy();
+                [expectation fulfill];
+            }];
+        }];
+    }];
+    [self waitForExpectationsWithCommonTimeoutUsingHandler:^(NSError * _Nullable error) {
+        [SDWebImageTestURLProtocol removeAllStubs];
+        [cache clearMemory];
+        [downloader invalidateSessionAndCancel:YES];
+    }];
+}
+
+- (void)test25ThatRevalidateCachedWithNotModifiedResponse {
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Revalidate cached should serve stale image and refresh it with 304"];
+    SDWebImageDownloaderConfig *config = [[SDWebImageDownloaderConfig alloc] init];
+    config.sessionConfiguration = SDWebImageTestURLProtocol.sessionConfiguration;
+    SDWebImageDownloader *downloader = [[SDWebImageDownloader alloc] initWithConfig:config];
+    SDImageCache *cache = [[SDImageCache alloc] initWithNamespace:@"RevalidateCached"];
+    SDWebImageManager *manager = [[SDWebImageManager alloc] initWithCache:cache loader:downloader];
+    NSURL *url = [NSURL URLWithString:@"http://via.placeholder.com/revalidate.jpg"];
+    NSString *key = [manager cacheKeyForURL:url];
+    NSData *imageData = [NSData dataWithContentsOfFile:[self testJPEGPath]];
+    __block NSString *conditionalEntityTag;
+    [SDWebImageTestURLProtocol stubURL:url responseBlock:^NSHTTPURLResponse * _Nonnull(NSURLRequest * _Nonnull request, NSData * _Nullable __autoreleasing * _Nonnull data) {
+        conditionalEntityTag = [request valueForHTTPHeaderField:@"If-None-Match"];
+        if ([conditionalEntityTag isEqualToString:@"\"v1\""]) {
+            // Not modified, and fresh for a while
+            return [[NSHTTPURLResponse alloc] initWithURL:request.URL statusCode:304 HTTPVersion:@"HTTP/1.1" headerFields:@{@"Cache-Control" : @"max-age=3600"}];
+        }
+        // Stale immediately, need revalidation for next load
+        *data = imageData;
+        return [[NSHTTPURLResponse alloc] initWithURL:request.URL statusCode:200 HTTPVersion:@"HTTP/1.1" headerFields:@{@"Content-Type" : @"image/jpeg", @"ETag" : @"\"v1\"", @"Cache-Control" : @"max-age=0"}];
+    }];
+    SDWebImageOptions options = SDWebImageRevalidateCached | SDWebImageWaitStoreCache;
+
+    [manager loadImageWithURL:url options:options progress:nil completed:^(UIImage * _Nullable image, NSData * _Nullable data, NSError * _Nullable error, SDImageCacheType cacheType, BOOL finished, NSURL * _Nullable imageURL) {
+        expect(error).beNil();
+        expect(cacheType).equal(SDImageCacheTypeNone);
+        expect(conditionalEntityTag).beNil();
+        // The validator is stored along with the image
+        expect([cache diskCacheValidatorForKey:key].entityTag).equal(@"\"v1\"");
+        expect([cache diskCacheValidatorForKey:key].isFresh).beFalsy();
+        [cache clearMemory];
+        // Stale, the cached image is served instantly, and the 304 does not callback again
+        __block NSUInteger callbackCount = 0;
+        [manager loadImageWithURL:url options:options progress:nil completed:^(UIImage * _Nullable image2, NSData * _Nullable data2, NSError * _Nullable error2, SDImageCacheType cacheType2, BOOL finished2, NSURL * _Nullable imageURL2) {
+            callbackCount++;
+            expect(callbackCount).equal(1);
+            expect(error2).beNil();
+            expect(image2).notTo.beNil();
+            expect(cacheType2).equal(SDImageCacheTypeDisk);
+        }];
+        dispatch_after(dispatch_time(DISPATCH_TIME_NOW, 2 * kMinDelayNanosecond), dispatch_get_main_queue(), ^{
+            expect([SDWebImageTestURLProtocol requestCountForURL:url]).equal(2);
+            expect(conditionalEntityTag).equal(@"\"v1\"");
+            // The 304 refresh the freshness
+            expect([cache diskCacheValidatorForKey:key].isFresh).beTruthy();
+            [cache clearMemory];
+            // Fresh, no request at all
+            [manager loadImageWithURL:url options:options progress:nil completed:^(UIImage * _Nullable image3, NSData * _Nullable data3, NSError * _Nullable error3, SDImageCacheType cacheType3, BOOL finished3, NSURL * _Nullable imageURL3) {
+                expect(image3).notTo.beNil();
+                expect(cacheType3).equal(SDImageCacheTypeDisk);
+                expect([SDWebImageTestURLProtocol requestCountForURL:url]).equal(2);
+                [expectation fulfill];
+            }];
+        });
+    }];
+    [self waitForExpectationsWithCommonTimeoutUsingHandler:^(NSError * _Nullable error) {
+        [SDWebImageTestURLProtocol removeAllStubs];
+        [cache clearDiskOnCompletion:nil];
+        [downloader invalidateSessionAndCancel:YES];
+    }];
+}
+
+- (void)test26ThatTransformedImageHonorForceDecodePolicy {
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Transformed image should not be normalized with never force-decode policy"];
+    // RGB888 with unaligned row, which the normalizer converts
+    size_t width = 10, height = 8;
+    NSMutableData *bitmapData = [NSMutableData dataWithLength:width * 3 * height];
+    CGDataProviderRef provider = CGDataProviderCreateWithCFData((__bridge CFDataRef)bitmapData);
+    CGImageRef cgImage = CGImageCreate(width, height, 8, 24, width * 3, [SDImageCoderHelper colorSpaceGetDeviceRGB], kCGBitmapByteOrderDefault | kCGImageAlphaNone, provider, NULL, YES, kCGRenderingIntentDefault);
+    CGDataProviderRelease(provider);
+#if SD_MAC
+    UIImage *testImage = [[UIImage alloc] initWithCGImage:cgImage scale:1 orientation:kCGImagePropertyOrientationUp];
+#else
+    UIImage *testImage = [[UIImage alloc] initWithCGImage:cgImage scale:1 orientation:UIImageOrientationUp];
+#endif
+    CGImageRelease(cgImage);
+    SDWebImageTestTransformer *transformer = [[SDWebImageTestTransformer alloc] init];
+    transformer.testImage = testImage;
+    NSURL *url = [NSURL fileURLWithPath:[self testJPEGPath]];
+    SDWebImageContext *context = @{SDWebImageContextImageTransformer : transformer, SDWebImageContextImageForceDecodePolicy : @(SDImageForceDecodePolicyNever), SDWebImageContextStoreCacheType : @(SDImageCacheTypeNone)};
+    [SDWebImageManager.sharedManager loadImageWithURL:url options:SDWebImageFromLoaderOnly context:context progress:nil completed:^(UIImage * _Nullable image, NSData * _Nullable data, NSError * _Nullable error, SDImageCacheType cacheType, BOOL finished, NSURL * _Nullable imageURL) {
+        expect(image.sd_isTransformed).beTruthy();
+        expect(image.CGImage == testImage.CGImage).beTruthy();
+        expect(CGImageGetBitsPerPixel(image.CGImage)).equal(24);
+        [expectation fulfill];
+    }];
+    [self waitForExpectationsWithCommonTimeout];
+}
+
 - (NSString *)testJPEGPath {
     NSBundle *testBundle = [NSBundle bundleForClass:[self class]];
     return [testBundle pathForResource:@"TestImage" ofType:@"jpg"];
@@ -0,0 +1,27 @@
+/*
+ * This file is part of the SDWebImage package.
+ * (c) Olivier Poitrey <rs@dailymotion.com>
+ *
+ * For the full copyright and license information, please view the LICENSE
+ * file that was distributed with this source code.
+ */
+
+#import <Foundation/Foundation.h>
+
+/// Return the response for the request, and the body data if any. This is called outside the loading thread, it can wait for other requests before return
+typedef NSHTTPURLResponse * _Nonnull (^SDWebImageTestURLResponseBlock)(NSURLRequest * _Nonnull request, NSData * _Nullable __autoreleasing * _Nonnull data);
+
+// A URL protocol which answer the stubbed URLs locally, so tests for HTTP status code (like 304) does not depend on network
+@interface SDWebImageTestURLProtocol : NSURLProtocol
+
+/// A session configuration which route the requests through this protocol
+@property (nonatomic, class, readonly, nonnull) NSURLSessionConfiguration *sessionConfiguration;
+
++ (void)stubURL:(nonnull NSURL *)url statusCode:(NSInteger)statusCode headerFields:(nullable NSDictionary<NSString *, NSString *> *)headerFields data:(nullable NSData *)data;
++ (void)stubURL:(nonnull NSURL *)url responseBlock:(nonnull SDWebImageTestURLResponseBlock)responseBlock;
+/// Deliver the body data in chunks of `chunkSize` bytes, to simulate the partial data during download. 0 means the whole data at once
++ (void)stubURL:(nonnull NSURL *)url chunkSize:(NSUInteger)chunkSize responseBlock:(nonnull SDWebImageTestURLResponseBlock)responseBlock;
++ (NSUInteger)requestCountForURL:(nonnull NSURL *)url;
++ (void)removeAllStubs;
+
+@end
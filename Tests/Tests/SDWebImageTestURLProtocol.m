@@ -0,0 +1,127 @@
+/*
+ * This file is part of the SDWebImage package.
+ * (c) Olivier Poitrey <rs@dailymotion.com>
+ *
+ * For the full copyright and license information, please view the LICENSE
+ * file that was distributed with this source code.
+ */
+
+#import "SDWebImageTestURLProtocol.h"
+
+static NSMutableDictionary<NSString *, SDWebImageTestURLResponseBlock> *SDTestURLStubs;
+static NSMutableDictionary<NSString *, NSNumber *> *SDTestURLRequestCounts;
+static NSMutableDictionary<NSString *, NSNumber *> *SDTestURLChunkSizes;
+
+@implementation SDWebImageTestURLProtocol {
+    BOOL _stopped; // accessed on the loading thread
+}
+
++ (void)initialize {
+    if (self == [SDWebImageTestURLProtocol class]) {
+        SDTestURLStubs = [NSMutableDictionary dictionary];
+        SDTestURLRequestCounts = [NSMutableDictionary dictionary];
+        SDTestURLChunkSizes = [NSMutableDictionary dictionary];
+    }
+}
+
++ (NSURLSessionConfiguration *)sessionConfiguration {
+    NSURLSessionConfiguration *configuration = [NSURLSessionConfiguration defaultSessionConfiguration];
+    configuration.protocolClasses = [@[self] arrayByAddingObjectsFromArray:configuration.protocolClasses ?: @[]];
+    configuration.URLCache = nil;
+    return configuration;
+}
+
++ (void)stubURL:(NSURL *)url statusCode:(NSInteger)statusCode headerFields:(NSDictionary<NSString *,NSString *> *)headerFields data:(NSData *)data {
+    [self stubURL:url responseBlock:^NSHTTPURLResponse * _Nonnull(NSURLRequest * _Nonnull request, NSData * _Nullable __autoreleasing * _Nonnull outData) {
+        *outData = data;
+        return [[NSHTTPURLResponse alloc] initWithURL:request.URL statusCode:statusCode HTTPVersion:@"HTTP/1.1" headerFields:headerFields];
+    }];
+}
+
++ (void)stubURL:(NSURL *)url responseBlock:(SDWebImageTestURLResponseBlock)responseBlock {
+    [self stubURL:url chunkSize:0 responseBlock:responseBlock];
+}
+
++ (void)stubURL:(NSURL *)url chunkSize:(NSUInteger)chunkSize responseBlock:(SDWebImageTestURLResponseBlock)responseBlock {
+    @synchronized (self) {
+        SDTestURLStubs[url.absoluteString] = [responseBlock copy];
+        SDTestURLChunkSizes[url.absoluteString] = @(chunkSize);
+    }
+}
+
++ (NSUInteger)requestCountForURL:(NSURL *)url {
+    @synchronized (self) {
+        return SDTestURLRequestCounts[url.absoluteString].unsignedIntegerValue;
+    }
+}
+
++ (void)removeAllStubs {
+    @synchronized (self) {
+        [SDTestURLStubs removeAllObjects];
+        [SDTestURLRequestCounts removeAllObjects];
+        [SDTestURLChunkSizes removeAllObjects];
+    }
+}
+
++ (SDWebImageTestURLResponseBlock)responseBlockForRequest:(NSURLRequest *)request {
+    @synchronized (self) {
+        return SDTestURLStubs[request.URL.absoluteString];
+    }
+}
+
+#pragma mark - NSURLProtocol
+
++ (BOOL)canInitWithRequest:(NSURLRequest *)request {
+    return [self responseBlockForRequest:request] != nil;
+}
+
++ (NSURLRequest *)canonicalRequestForRequest:(NSURLRequest *)request {
+    return request;
+}
+
+- (void)startLoading {
+    SDWebImageTestURLResponseBlock responseBlock = [self.class responseBlockForRequest:self.request];
+    if (!responseBlock) {
+        [self.client URLProtocol:self didFailWithError:[NSError errorWithDomain:NSURLErrorDomain code:NSURLErrorResourceUnavailable userInfo:nil]];
+        return;
+    }
+    NSUInteger chunkSize;
+    @synchronized (self.class) {
+        NSString *key = self.request.URL.absoluteString;
+        SDTestURLRequestCounts[key] = @(SDTestURLRequestCounts[key].unsignedIntegerValue + 1);
+        chunkSize = SDTestURLChunkSizes[key].unsignedIntegerValue;
+    }
+    // The response block may hold the response (such as waiting for another request), so call it outside the loading thread, and call the client back on the loading thread
+    NSThread *clientThread = [NSThread currentThread];
+    NSArray<NSRunLoopMode> *modes = @[[NSRunLoop currentRunLoop].currentMode ?: NSDefaultRunLoopMode];
+    NSURLRequest *request = self.request;
+    dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+        NSData *data;
+        NSHTTPURLResponse *response = responseBlock(request, &data);
+        [self performSelector:@selector(deliverResponse:) onThread:clientThread withObject:@[response, data ?: [NSData data], @(chunkSize)] waitUntilDone:NO modes:modes];
+    });
+}
+
+- (void)deliverResponse:(NSArray *)arguments {
+    if (_stopped) {
+        return;
+    }
+    NSHTTPURLResponse *response = arguments[0];
+    NSData *data = arguments[1];
+    NSUInteger chunkSize = [arguments[2] unsignedIntegerValue];
+    [self.client URLProtocol:self didReceiveResponse:response cacheStoragePolicy:NSURLCacheStorageNotAllowed];
+    if (chunkSize == 0) {
+        chunkSize = data.length;
+    }
+    for (NSUInteger offset = 0; offset < data.length; offset += chunkSize) {
+        NSUInteger length = MIN(chunkSize, data.length - offset);
+        [self.client URLProtocol:self didLoadData:[data subdataWithRange:NSMakeRange(offset, length)]];
+    }
+    [self.client URLProtocolDidFinishLoading:self];
+}
+
+- (void)stopLoading {
+    _stopped = YES;
+}
+
+@end
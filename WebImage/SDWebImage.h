@@ -26,6 +26,7 @@ FOUNDATION_EXPORT const unsigned char SDWebImageVersionString[];
 #import <SDWebImage/SDMemoryCache.h>
 #import <SDWebImage/SDDiskCache.h>
 #import <SDWebImage/SDImageCacheDefine.h>
+#import <SDWebImage/SDImageCacheValidator.h>
 #import <SDWebImage/SDImageCachesManager.h>
 #import <SDWebImage/UIView+WebCache.h>
 #import <SDWebImage/UIImageView+WebCache.h>
@@ -33,10 +34,13 @@ FOUNDATION_EXPORT const unsigned char SDWebImageVersionString[];
 #import <SDWebImage/SDWebImageDownloaderConfig.h>
 #import <SDWebImage/SDWebImageDownloaderOperation.h>
 #import <SDWebImage/SDWebImageDownloaderRequestModifier.h>
+#import <SDWebImage/SDWebImageDownloaderHedgePolicy.h>
+#import <SDWebImage/SDWebImageDownloaderStatistics.h>
 #import <SDWebImage/SDWebImageDownloaderResponseModifier.h>
 #import <SDWebImage/SDWebImageDownloaderDecryptor.h>
 #import <SDWebImage/SDImageLoader.h>
 #import <SDWebImage/SDImageLoadersManager.h>
+#import <SDWebImage/SDWebImageBatchLoader.h>
 #import <SDWebImage/UIButton+WebCache.h>
 #import <SDWebImage/SDWebImagePrefetcher.h>
 #import <SDWebImage/UIView+WebCacheOperation.h>
@@ -59,9 +63,12 @@ FOUNDATION_EXPORT const unsigned char SDWebImageVersionString[];
 #import <SDWebImage/SDImageCoder.h>
 #import <SDWebImage/SDImageAPNGCoder.h>
 #import <SDWebImage/SDImageGIFCoder.h>
+#import <SDWebImage/SDImageFrameAtlasCoder.h>
 #import <SDWebImage/SDImageIOCoder.h>
 #import <SDWebImage/SDImageFrame.h>
 #import <SDWebImage/SDImageCoderHelper.h>
+#import <SDWebImage/SDImageDecodeExecutor.h>
+#import <SDWebImage/SDImagePixelBufferPool.h>
 #import <SDWebImage/SDImageGraphics.h>
 #import <SDWebImage/SDGraphicsImageRenderer.h>
 #import <SDWebImage/UIImage+GIF.h>
@@ -70,6 +77,7 @@ FOUNDATION_EXPORT const unsigned char SDWebImageVersionString[];
 #import <SDWebImage/SDWebImageDefine.h>
 #import <SDWebImage/SDWebImageError.h>
 #import <SDWebImage/SDWebImageOptionsProcessor.h>
+#import <SDWebImage/SDWebImageFailedURLPolicy.h>
 #import <SDWebImage/SDImageIOAnimatedCoder.h>
 #import <SDWebImage/SDImageHEICCoder.h>
 #import <SDWebImage/SDImageAWebPCoder.h>